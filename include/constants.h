@@ -61,6 +61,31 @@
  */
 #define DEFAULT_TTY_WIDTH 80
 
+/**
+ * @def DELTA_MAX_BYTES
+ *
+ * Default limit on the size of a unified diff generated for result
+ * details.  Output past this is dropped and noted at the end.
+ */
+#define DELTA_MAX_BYTES (512 * 1024)
+
+/**
+ * @def DELTA_MAX_HUNKS
+ *
+ * Default limit on the number of hunks in a unified diff generated
+ * for result details.
+ */
+#define DELTA_MAX_HUNKS 1000
+
+/**
+ * @def DELTA_HISTOGRAM_SIZE
+ *
+ * Inputs to the diff engine larger than this many bytes are compared
+ * with the histogram algorithm rather than the default Myers
+ * algorithm.
+ */
+#define DELTA_HISTOGRAM_SIZE (1024 * 1024)
+
 /** @} */
 
 /**
@@ -118,6 +143,144 @@
  */
 #define DEFAULT_WORKDIR "/var/tmp/rpminspect"
 
+/**
+ * @def MEMORY_WORKDIR
+ *
+ * Memory-backed directory the working subdirectory goes in when the
+ * workdir_memory setting is used.  /dev/shm is a tmpfs on any modern
+ * Linux system.  The user ID is appended so each user gets their own
+ * directory.
+ */
+#define MEMORY_WORKDIR "/dev/shm/rpminspect"
+
+/**
+ * @def SPILL_DIVISOR
+ *
+ * With the working subdirectory in memory, a file larger than this
+ * share of the workdir_memory budget is always extracted to disk.
+ */
+#define SPILL_DIVISOR 16
+
+/**
+ * @def TRASH_DIR
+ *
+ * Directory trees being removed are renamed in to a directory of
+ * this name next to them and deleted in the background.
+ */
+#define TRASH_DIR ".rpminspect-trash"
+
+/**
+ * @def TRASH_NICE
+ *
+ * Nice value of the background process deleting the trash.
+ */
+#define TRASH_NICE 19
+
+/**
+ * @def SHARD_MANIFEST
+ *
+ * File name format of the shard manifests written by --plan-shards,
+ * given the shard number.
+ */
+#define SHARD_MANIFEST "shard-%u.json"
+
+/**
+ * @def SHARD_NOUN
+ *
+ * Noun of the diagnostics result a --shard worker adds to its
+ * results, given the shard number and the number of shards.
+ * --merge reads it back to check that every shard is there.
+ */
+#define SHARD_NOUN "shard %u/%u"
+
+/**
+ * @def DOWNLOAD_CONNECTIONS
+ *
+ * Default number of concurrent connections used by fetch-only mode
+ * when the download_connections setting is not used.
+ */
+#define DOWNLOAD_CONNECTIONS 8
+
+/**
+ * @def HISTORY_DIR
+ *
+ * Subdirectory of $XDG_CACHE_HOME (or ~/.cache) holding the
+ * inspection runtime history.
+ */
+#define HISTORY_DIR "rpminspect"
+
+/**
+ * @def HISTORY_FILE
+ *
+ * Name of the inspection runtime history file.  It records how long
+ * each inspection took on each package so later runs can start the
+ * longest inspections first.
+ */
+#define HISTORY_FILE "history.json"
+
+/**
+ * @def HISTORY_RUNS
+ *
+ * Number of recent runs the runtime history averages over.
+ */
+#define HISTORY_RUNS 5
+
+/**
+ * @def HISTORY_PACKAGES
+ *
+ * Most packages the runtime history keeps.  The packages inspected
+ * least recently are dropped first.
+ */
+#define HISTORY_PACKAGES 500
+
+/**
+ * @def HISTORY_ENTRIES
+ *
+ * Most inspections the runtime history keeps for one package.  The
+ * inspections run least recently, such as ones that no longer exist,
+ * are dropped first.
+ */
+#define HISTORY_ENTRIES 128
+
+/**
+ * @def JOBS_AUTO
+ *
+ * Argument to -j that picks the number of jobs from the CPUs and
+ * memory available to the process.
+ */
+#define JOBS_AUTO "auto"
+
+/**
+ * @def CGROUP_ROOT
+ *
+ * Mount point of the cgroup v2 hierarchy.
+ */
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+/**
+ * @def CGROUP_SELF
+ *
+ * Lists the cgroups of the running process.  The cgroup v2 entry is
+ * the line starting with "0::".
+ */
+#define CGROUP_SELF "/proc/self/cgroup"
+
+/**
+ * @def TIMEOUT_DEFAULT
+ *
+ * Key in the timeouts configuration section giving the time limit of
+ * inspections that are not listed.
+ */
+#define TIMEOUT_DEFAULT "default"
+
+/**
+ * @def TIMEOUT_COMMAND
+ *
+ * Key in the timeouts configuration section giving the time limit of
+ * each command an inspection runs.
+ */
+#define TIMEOUT_COMMAND "command"
+
 /**
  * @def ROOT_SUBDIR
  *
@@ -409,6 +572,15 @@
  */
 #define RPM_X86_ARCH_PATTERN "i?86"
 
+/**
+ * @def RPM_PAYLOAD_BUFSIZ
+ *
+ * Size of the buffer used when extracting RPM payload members with
+ * the librpm archive reader.  Packages that take this path usually
+ * carry very large files, so read them in large chunks.
+ */
+#define RPM_PAYLOAD_BUFSIZ (1024 * 1024)
+
 /**
  * @def BIN_OWNER
  *
@@ -724,6 +896,13 @@
  */
 #define SPEC_SECTION_CHANGELOG "%changelog"
 
+/**
+ * @def SPEC_SECTION_PACKAGE
+ *
+ * Starts the preamble of a subpackage in the spec file.
+ */
+#define SPEC_SECTION_PACKAGE   "%package"
+
 /**
  * @def SPEC_TAG_RELEASE
  *
@@ -738,6 +917,13 @@
  */
 #define SPEC_TAG_PATCH         "Patch"
 
+/**
+ * @def SPEC_TAG_SOURCE
+ *
+ * The leading text of the RPMTAG_SOURCE identifier in a spec file.
+ */
+#define SPEC_TAG_SOURCE        "Source"
+
 /**
  * @def SPEC_DISTTAG
  *
@@ -38,6 +38,65 @@
 #define EM_BPF 247
 #endif
 
+/**
+ * @def ELF_SECTIONS_SCANNED
+ *
+ * Set in the value returned by get_elf_section_flags() and cached by
+ * get_rpmfile_elf_sections() once a file has been scanned.  The
+ * remaining ELF_SECTION_* bits are only meaningful when this is set.
+ */
+#define ELF_SECTIONS_SCANNED     (((uint64_t) 1) << 0)
+
+/**
+ * @def ELF_SECTION_SYMTAB
+ *
+ * The file has a .symtab section.
+ */
+#define ELF_SECTION_SYMTAB       (((uint64_t) 1) << 1)
+
+/**
+ * @def ELF_SECTION_GDB_INDEX
+ *
+ * The file has a .gdb_index section.
+ */
+#define ELF_SECTION_GDB_INDEX    (((uint64_t) 1) << 2)
+
+/**
+ * @def ELF_SECTION_GNU_DEBUGDATA
+ *
+ * The file has a .gnu_debugdata section.
+ */
+#define ELF_SECTION_GNU_DEBUGDATA (((uint64_t) 1) << 3)
+
+/**
+ * @def ELF_SECTION_GNU_DEBUGLINK
+ *
+ * The file has a .gnu_debuglink section.
+ */
+#define ELF_SECTION_GNU_DEBUGLINK (((uint64_t) 1) << 4)
+
+/**
+ * @def ELF_SECTION_DEBUG_INFO
+ *
+ * The file has a .debug_info section.
+ */
+#define ELF_SECTION_DEBUG_INFO   (((uint64_t) 1) << 5)
+
+/**
+ * @def ELF_SECTION_GOSYMTAB
+ *
+ * The file has a .gosymtab section.
+ */
+#define ELF_SECTION_GOSYMTAB     (((uint64_t) 1) << 6)
+
+/**
+ * @def ELF_SECTION_GUILE
+ *
+ * The file has at least one SHT_PROGBITS section whose name begins
+ * with ".guile.", which means it is a Guile object file.
+ */
+#define ELF_SECTION_GUILE        (((uint64_t) 1) << 7)
+
 /** @} */
 
 /**
@@ -192,6 +251,42 @@ bool is_elf_archive(const char *path);
  */
 bool have_elf_section(Elf *elf, int64_t section, const char *name);
 
+/**
+ * @brief Scan an ELF object's section headers once and return a
+ * bitmask of the known sections it carries.
+ *
+ * The bits are the ELF_SECTION_* values.  ELF_SECTIONS_SCANNED is
+ * always set in the returned value so callers can cache it.
+ *
+ * @param elf The Elf object to scan.
+ * @return Bitmask of ELF_SECTION_* values.
+ */
+uint64_t get_elf_section_flags(Elf *elf);
+
+/**
+ * @brief Return the ELF section bitmask for a payload file.
+ *
+ * The first call opens the file and runs get_elf_section_flags() on
+ * it; the result is cached in the rpmfile_entry_t so every inspection
+ * after that gets it for free, along with the ELF type.  Files that
+ * are not ELF objects only have ELF_SECTIONS_SCANNED set.
+ *
+ * @param file The payload file.
+ * @return Bitmask of ELF_SECTION_* values.
+ */
+uint64_t get_rpmfile_elf_sections(rpmfile_entry_t *file);
+
+/**
+ * @brief Return the ELF type (e_type) of a payload file.
+ *
+ * This is read from the same open of the file as the section flags
+ * and cached with them by get_rpmfile_elf_sections().
+ *
+ * @param file The payload file.
+ * @return The ELF type, ET_NONE if the file is not an ELF object.
+ */
+GElf_Half get_rpmfile_elf_type(rpmfile_entry_t *file);
+
 /**
  * @brief Given an ELF starting section, collect all section names.
  *
@@ -274,6 +369,20 @@ GElf_Phdr *get_elf_phdr(Elf *elf, Elf64_Word type, GElf_Phdr *out);
  */
 char *get_elf_soname(const char *filepath);
 
+/**
+ * @brief Return the GNU build-id of the specified file.
+ *
+ * Read the NT_GNU_BUILD_ID note from the specified file and return
+ * it as a newly allocated lowercase hexadecimal string.  This is the
+ * same string used to name files under the .build-id directory in
+ * debuginfo packages.  The caller must free this string.  The
+ * function returns NULL if the file has no build-id.
+ *
+ * @param filepath The path to the file to search
+ * @return Newly allocated string containing the build-id or NULL
+ */
+char *get_elf_build_id(const char *filepath);
+
 /**
  * @brief Check for tag in the specified ELF object
  *
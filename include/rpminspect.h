@@ -148,6 +148,10 @@ string_list_t *list_from_array(const char **);
 bool list_contains(const string_list_t *, const char *);
 string_list_t *list_add(string_list_t *list, const char *s);
 void list_remove(string_list_t *list, const char *s);
+string_set_t *list_to_set(const string_list_t *);
+string_set_t *set_add(string_set_t *, const char *);
+bool set_contains(const string_set_t *, const char *);
+void free_string_set(string_set_t *);
 
 /* llvm.c */
 bool is_llvm_ir_bitcode(const char *file);
@@ -176,8 +180,10 @@ const char *buildtype_desc(const koji_build_type_t type);
 
 /* kmods.c */
 #ifdef _WITH_LIBKMOD
-bool compare_module_parameters(const struct kmod_list *, const struct kmod_list *, string_list_t **, string_list_t **);
-bool compare_module_dependencies(const struct kmod_list *, const struct kmod_list *, string_list_t **, string_list_t **);
+kmod_info_t *get_kmod_info(struct kmod_ctx *, kmod_info_t **, const char *);
+void free_kmod_info(kmod_info_t *);
+bool compare_module_parameters(const kmod_info_t *, const kmod_info_t *, string_list_t **, string_list_t **);
+bool compare_module_dependencies(const kmod_info_t *, const kmod_info_t *, string_list_t **, string_list_t **);
 kernel_alias_data_t *gather_module_aliases(const char *module_name, const struct kmod_list *modinfo_list);
 void free_module_aliases(kernel_alias_data_t *);
 bool compare_module_aliases(kernel_alias_data_t *, kernel_alias_data_t *, module_alias_callback, void *);
@@ -190,6 +196,21 @@ int mkdirp(const char *, mode_t);
 /* rmtree.c */
 int rmtree(const char *, const bool, const bool);
 
+/* trash.c */
+int trash_tree(const char *path);
+void reap_trash(void);
+void trash_on_signal(char **path);
+void trash_signalled(void);
+void sweep_trash(const char *parent);
+
+/* strbuf.c */
+void strbuf_append_len(strbuf_t *, const char *, const size_t);
+void strbuf_append(strbuf_t *, const char *);
+void strbuf_appendf(strbuf_t *, const char *, ...) __attribute__((__format__(printf, 2, 3)));
+size_t strbuf_replace(strbuf_t *, const char *, const char *);
+char *strbuf_finish(strbuf_t *);
+void strbuf_free(strbuf_t *);
+
 /* strfuncs.c */
 bool strprefix(const char *, const char *);
 bool strsuffix(const char *, const char *);
@@ -198,6 +219,9 @@ bool versioned_match(const char *, Header, const char *, Header);
 char *strseverity(const severity_t);
 severity_t getseverity(const char *, const severity_t);
 char *strwaiverauth(const waiverauth_t);
+waiverauth_t getwaiverauth(const char *, const waiverauth_t);
+char *strverb(const verb_t);
+verb_t getverb(const char *, const verb_t);
 char *strreplace(const char *, const char *, const char *);
 char *strxmlescape(const char *);
 char *strappend(char *, ...);
@@ -220,7 +244,16 @@ char *strtrim(char *s);
 const char *strexitcode(int exitcode);
 
 /* badwords.c */
-bool has_bad_word(const char *, const string_list_t *);
+bool has_bad_word(const char *, const matcher_t *);
+
+/* matcher.c */
+matcher_t *new_matcher(const matcher_type_t type, const bool icase);
+void add_matcher_pattern(matcher_t *m, const char *pattern, const void *data);
+void compile_matcher(matcher_t *m);
+matcher_t *list_to_matcher(const string_list_t *list, const matcher_type_t type, const bool icase);
+bool match_patterns(const matcher_t *m, const char *s, matcher_cb cb, void *user_data);
+const matcher_pattern_t *match_first(const matcher_t *m, const char *s);
+void free_matcher(matcher_t *m);
 
 /* copyfile.c */
 int copyfile(const char *, const char *, bool, bool);
@@ -234,12 +267,13 @@ char *get_nevra(Header);
 const char *get_rpm_header_arch(Header);
 string_list_t *get_rpm_header_string_array(Header h, rpmTagVal tag);
 char *get_rpm_header_value(const rpmfile_entry_t *file, rpmTag tag);
-char *extract_rpm_payload(const char *rpm);
+rpmfile_t *extract_rpm_payload(const char *rpm, Header hdr, const char *output_dir);
 
 /* peers.c */
 rpmpeer_t *init_peers(void);
 void free_peers(rpmpeer_t *);
 void add_peer(rpmpeer_t **, deprule_ignore_map_t *, int, bool, const char *, Header);
+void reset_before_peers(struct rpminspect *ri);
 
 /**
  * @brief Iterate over all packages and extract them.
@@ -268,12 +302,17 @@ bool is_debug_or_build_path(const char *path);
 size_t tty_width(void);
 
 /* results.c */
+struct json_object;
 void init_result_params(struct result_params *);
 results_t *init_results(void);
 void free_results(results_t *);
 void add_result_entry(results_t **, struct result_params *);
 void add_result(struct rpminspect *, struct result_params *);
+void set_results_baseline(results_t *results, const char *baseline);
+results_entry_t *add_json_result(results_t **results, const char *header, struct json_object *jr);
 bool suppressed_results(const results_t *results, const char *header, const severity_t suppress);
+void write_result(FILE *fp, const results_entry_t *entry);
+results_t *read_results(FILE *fp, const char *header);
 
 /* output.c */
 const char *format_desc(unsigned int);
@@ -295,6 +334,7 @@ int unpack_archive(const char *, const char *, const bool);
 
 /* magic.c */
 char *mime_type(const char *);
+char *mime_type_buffer(const void *, const size_t);
 char *get_mime_type(rpmfile_entry_t *);
 bool is_text_file(rpmfile_entry_t *);
 
@@ -305,9 +345,25 @@ char *checksum(rpmfile_entry_t *);
 /* runcmd.c */
 char *run_cmd_vpe(int *exitcode, const char *workdir, char **argv);
 char *run_cmd(int *, const char *, const char *, ...) __attribute__((__sentinel__));
+char *run_cmd_stdout(int *exitcode, char **errors, const char *workdir, char **argv);
 void free_argv_table(struct rpminspect *ri, string_list_map_t *table);
 char **build_argv(const char *cmd);
 void free_argv(char **argv);
+void run_jobs(job_list_t *jobs, const unsigned int max);
+void free_jobs(job_list_t *jobs);
+void kill_jobs(void);
+void run_checks(file_check_t *checks, const size_t count, file_check_fn check, const unsigned int max);
+unsigned int online_cpus(void);
+unsigned int inspection_jobs(const struct rpminspect *ri);
+unsigned long available_memory(void);
+double monotonic_time(void);
+void set_command_timeout(const unsigned int seconds);
+void set_deadline(const unsigned int seconds);
+bool have_deadline(void);
+bool deadline_passed(void);
+unsigned int get_command_timeouts(void);
+void stop_jobs(void);
+void set_memory_budget(const unsigned long kib);
 
 /* fileinfo.c */
 bool match_fileinfo_mode(struct rpminspect *, const rpmfile_entry_t *, const char *, const char *, bool *, bool *);
@@ -317,12 +373,17 @@ bool match_fileinfo_group(struct rpminspect *, const rpmfile_entry_t *, const ch
 caps_filelist_entry_t *get_caps_entry(struct rpminspect *, const char *, const char *);
 #endif
 
+/* cgroup.c */
+char *get_cgroup(void);
+unsigned int get_cgroup_cpus(const char *root, const char *cgroup);
+unsigned long long get_cgroup_memory(const char *root, const char *cgroup);
+
 /* flags.c */
 bool process_inspection_flag(const char *, const bool, uint64_t *);
 
 /* debug.c */
 void set_debug_mode(bool);
-void dump_cfg(const struct rpminspect *);
+void dump_cfg(FILE *, const struct rpminspect *);
 
 /* readfile.c */
 void *read_file_bytes(const char *path, off_t *len);
@@ -335,11 +396,43 @@ const char *get_after_rel(struct rpminspect *);
 
 /* builds.c */
 int gather_builds(struct rpminspect *, bool);
+int gather_baseline(struct rpminspect *ri, const char *before);
+int fetch_builds(struct rpminspect *, const string_list_t *);
 
 /* macros.c */
 void load_macros(struct rpminspect *ri);
 string_list_t *get_macros(const char *);
-int get_specfile_macros(struct rpminspect *, const char *);
+
+/* reuse.c */
+void compute_fingerprints(struct rpminspect *ri, const string_list_t *diags);
+bool read_previous_results(struct rpminspect *ri, const char *path);
+bool reuse_results(struct rpminspect *ri, const char *inspection);
+void set_results_fingerprint(struct rpminspect *ri, const char *inspection);
+void free_previous_results(previous_results_t *previous);
+
+/* history.c */
+char *get_history_file(void);
+bool read_history(struct rpminspect *ri, const char *path);
+void record_runtime(struct rpminspect *ri, const char *package, const char *inspection, const double seconds, const unsigned long files);
+double predict_runtime(const struct rpminspect *ri, const char *package, const char *inspection, const unsigned long files);
+void record_memory(struct rpminspect *ri, const char *package, const char *inspection, const unsigned long kib);
+double predict_memory(const struct rpminspect *ri, const char *package, const char *inspection);
+bool write_history(const struct rpminspect *ri);
+void free_history(history_t *history);
+
+/* schedule.c */
+bool run_inspections(struct rpminspect *ri);
+
+/* shard.c */
+bool write_shard_manifests(struct rpminspect *ri, const unsigned int shards, const char *dir);
+bool read_shard_manifest(struct rpminspect *ri, const char *path);
+results_t *merge_shard_results(const string_list_t *paths, severity_t *worst);
+
+/* specfile.c */
+bool spec_section_is(const spec_section_t *section, const char *name);
+spec_model_t *get_spec_model(struct rpminspect *ri, const char *specfile);
+spec_macro_t *get_spec_macro(const spec_model_t *spec, const char *name);
+void free_spec_models(spec_model_t *specs);
 
 /* inspect_elf.c */
 /*
@@ -414,7 +507,7 @@ string_list_map_t *get_abidiff_dir_arg(struct rpminspect *ri, const size_t size,
 char *add_abidiff_arg(char *cmd, string_list_map_t *table, const char *arch, const char *arg);
 
 /* uncompress.c */
-char *uncompress_file(struct rpminspect *ri, const char *infile, const char *subdir);
+char *uncompress_to_memory(const char *infile, const size_t max, size_t *len);
 
 /* filecmp.c */
 int filecmp(const char *x, const char *y);
@@ -441,6 +534,7 @@ bool deprules_match(const deprule_entry_t *a, const deprule_entry_t *b);
 char *strdeprule(const deprule_entry_t *deprule);
 
 /* delta.c */
+char *get_buffer_delta(const char *a, const size_t alen, const char *b, const size_t blen, const delta_opts_t *opts);
 char *get_file_delta(const char *a, const char *b);
 
 /* fs.c */
@@ -458,6 +552,11 @@ char *get_file_delta(const char *a, const char *b);
  * @return Number of bytes available.
  */
 unsigned long int get_available_space(const char *path);
+bool is_memory_fs(const char *path);
+char *get_memory_workdir(const bool create);
+int clone_file(const char *src, const char *dest);
+bool spill_file(struct rpminspect *ri, const off_t size, const bool linked);
+char *get_spill_path(const struct rpminspect *ri, const char *path);
 
 /* curl.c */
 /**
@@ -495,6 +594,34 @@ curl_off_t curl_get_size(const char *src);
  */
 bool is_remote_rpm(const char *url);
 
+/**
+ * @brief Queue a file for curl_get_queued().
+ *
+ * Files are queued by source URL, so the same URL queued for several
+ * destinations is downloaded once and cloned to the others.
+ *
+ * @param src URL to download
+ * @param dst Full path to the local destination (including filename)
+ */
+void curl_queue_file(const char *src, const char *dst);
+
+/**
+ * @brief Download all queued files concurrently.
+ *
+ * @param verbose True to report each completed file
+ * @param connections Maximum concurrent transfers, 0 for
+ *        DOWNLOAD_CONNECTIONS
+ * @param bandwidth Total bandwidth limit in bytes per second, 0 for
+ *        none
+ * @return The number of files that could not be downloaded
+ */
+int curl_get_queued(const bool verbose, const unsigned int connections, const unsigned long long bandwidth);
+
+/**
+ * @brief Drop all queued files without downloading them.
+ */
+void curl_clear_queue(void);
+
 /* humansize.c */
 /**
  * @brief Return human-readable size for the bytes given.
@@ -8,6 +8,7 @@
  */
 
 #include <regex.h>
+#include <stdio.h>
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/stat.h>
@@ -65,6 +66,46 @@ typedef struct _pair_entry_t {
 
 typedef TAILQ_HEAD(pair_entry_s, _pair_entry_t) pair_list_t;
 
+/*
+ * List of jobs for run_jobs().  Each job runs in its own child
+ * process, either executing argv in workdir or calling fn with data.
+ * Anything the child writes to stdout or stderr is collected in
+ * output and the exit code (or the return value of fn) is stored in
+ * exitcode.  If done is set, run_jobs() calls it in the parent as
+ * soon as the job finishes.  A job running longer than timeout
+ * seconds (or the command timeout for argv jobs if timeout is 0) is
+ * killed and timed_out is set.  With group set, the job runs in its
+ * own process group and everything it started is killed with it.
+ * Jobs that stop_jobs() kept from starting or killed have cancelled
+ * set.  memory is the predicted peak memory use of the job in KiB for
+ * the memory budget, 0 if unknown, and maxrss is the actual peak
+ * after it finishes.  The started, pid, fd, len, and size members are
+ * private to run_jobs().
+ */
+typedef struct _job_entry_t {
+    char **argv;
+    const char *workdir;
+    int (*fn)(void *);
+    void *data;
+    void (*done)(struct _job_entry_t *);
+    unsigned int timeout;
+    bool group;
+    bool timed_out;
+    bool cancelled;
+    unsigned long memory;
+    long maxrss;
+    int exitcode;
+    char *output;
+    double started;
+    pid_t pid;
+    int fd;
+    size_t len;
+    size_t size;
+    TAILQ_ENTRY(_job_entry_t) items;
+} job_entry_t;
+
+typedef TAILQ_HEAD(job_entry_s, _job_entry_t) job_list_t;
+
 /*
  * A file is information about a file in an RPM payload.
  *
@@ -113,11 +154,26 @@ typedef struct _rpmfile_entry_t {
     struct _rpmfile_entry_t *peer_file;
     bool moved_path;
     bool moved_subpackage;
+    uint64_t elf_sections;      /* cached get_rpmfile_elf_sections() */
+    uint16_t elf_type;          /* cached get_rpmfile_elf_type() */
     TAILQ_ENTRY(_rpmfile_entry_t) items;
 } rpmfile_entry_t;
 
 typedef TAILQ_HEAD(rpmfile_s, _rpmfile_entry_t) rpmfile_t;
 
+/*
+ * One file to check with run_checks().  The check function fills in
+ * status and output (which may be NULL) for the file.
+ */
+typedef struct _file_check_t {
+    rpmfile_entry_t *file;
+    int status;
+    char *output;
+    bool done;
+} file_check_t;
+
+typedef int (*file_check_fn)(rpmfile_entry_t *file, char **output);
+
 /*
  * RPM dependency information
  */
@@ -225,7 +281,8 @@ typedef enum _verb_t {
     VERB_CHANGED = 3,   /* changed file or metadata */
     VERB_FAILED = 4,    /* check failing */
     VERB_OK = 5,        /* the everything is ok alarm */
-    VERB_SKIP = 6       /* for skipped inspections or checks */
+    VERB_SKIP = 6,      /* for skipped inspections or checks */
+    VERB_TIMEOUT = 7    /* inspection or command ran out of time */
 } verb_t;
 
 /*
@@ -258,11 +315,48 @@ typedef struct _results_entry_t {
                                         string) */
     char *arch;               /* architecture impacted (${ARCH}) */
     char *file;               /* file impacted (${FILE}) */
+    char *fingerprint;        /* inputs of the inspection (optional) */
+    char *baseline;           /* before build of an N-way comparison */
     TAILQ_ENTRY(_results_entry_t) items;
 } results_entry_t;
 
 typedef TAILQ_HEAD(results_s, _results_entry_t) results_t;
 
+/*
+ * Results of one inspection read from a previous JSON results file,
+ * along with the fingerprint of the inputs they were computed from.
+ */
+typedef struct _previous_results_t {
+    const char *header;       /* inspection name */
+    char *fingerprint;
+    results_t *results;
+    UT_hash_handle hh;
+} previous_results_t;
+
+/*
+ * Runtime history of one inspection for one package.  The runtime,
+ * file count, and memory use are averages over the last few runs.
+ */
+typedef struct _history_entry_t {
+    char *inspection;
+    double seconds;           /* wall clock runtime */
+    double files;             /* payload files in the builds inspected */
+    double memory;            /* peak RSS in KiB, 0 if never measured */
+    unsigned int runs;        /* number of runs averaged */
+    time_t updated;           /* when it last ran, 0 if unknown */
+    UT_hash_handle hh;
+} history_entry_t;
+
+/*
+ * Runtime history of all inspections run on a package, indexed by
+ * package name.
+ */
+typedef struct _history_t {
+    char *package;
+    history_entry_t *entries;
+    UT_hash_handle hh;
+} history_t;
+
 /*
  * Known types of Koji builds
  */
@@ -291,6 +385,7 @@ typedef struct _fileinfo_entry_t {
     char *group;
     char *filename;
     TAILQ_ENTRY(_fileinfo_entry_t) items;
+    UT_hash_handle hh;
 } fileinfo_entry_t;
 
 typedef TAILQ_HEAD(fileinfo_entry_s, _fileinfo_entry_t) fileinfo_t;
@@ -354,6 +449,21 @@ typedef struct _header_cache_t {
     UT_hash_handle hh;
 } header_cache_t;
 
+/*
+ * Debuginfo file index for a build.  Keys are "<arch>:<localpath>"
+ * for each regular debug file (including .build-id links) found in
+ * the build's debuginfo packages, with root pointing at the extracted
+ * package root.  A bare "<arch>" key counts the debuginfo packages
+ * for that architecture so lookups can fall back to a single
+ * debuginfo package on older systems.
+ */
+typedef struct _debuginfo_index_t {
+    char *key;
+    const char *root;
+    unsigned int count;
+    UT_hash_handle hh;
+} debuginfo_index_t;
+
 /* Product release string favoring */
 typedef enum _favor_release_t {
     FAVOR_NONE = 0,
@@ -398,6 +508,19 @@ typedef struct _string_map_t {
     UT_hash_handle hh;
 } string_map_t;
 
+/* Growable string buffer (see strbuf.c), zero it before use */
+typedef struct _strbuf_t {
+    char *data;
+    size_t len;
+    size_t size;
+} strbuf_t;
+
+/* Set of strings.  The keys point at strings owned by the caller. */
+typedef struct _string_set_t {
+    const char *key;
+    UT_hash_handle hh;
+} string_set_t;
+
 /* Hash table with a string key and a string_list_t value. */
 typedef struct _string_list_map_t {
     char *key;
@@ -405,6 +528,67 @@ typedef struct _string_list_map_t {
     UT_hash_handle hh;
 } string_list_map_t;
 
+/*
+ * Options for get_buffer_delta().  The limits cap the size of the
+ * generated diff, 0 means no limit.  The histogram algorithm is used
+ * when requested or when an input is larger than DELTA_HISTOGRAM_SIZE.
+ */
+typedef struct _delta_opts_t {
+    size_t max_bytes;
+    size_t max_hunks;
+    bool histogram;
+} delta_opts_t;
+
+/* Kinds of compiled string matchers (see matcher.c) */
+typedef enum _matcher_type_t {
+    MATCHER_SUBSTRING = 0,     /* pattern anywhere in the string */
+    MATCHER_PREFIX = 1,        /* string begins with the pattern */
+    MATCHER_SUFFIX = 2         /* string ends with the pattern   */
+} matcher_type_t;
+
+/* A pattern in a matcher and the caller's data for it */
+typedef struct _matcher_pattern_t {
+    char *pattern;
+    size_t len;
+    const void *data;
+} matcher_pattern_t;
+
+/* Edge in the matcher trie */
+typedef struct _matcher_edge_t {
+    unsigned char c;
+    size_t next;
+} matcher_edge_t;
+
+/* Node in the matcher trie, node 0 is the root */
+typedef struct _matcher_node_t {
+    matcher_edge_t *edges;
+    size_t nedges;
+    size_t fail;               /* longest proper suffix node         */
+    ssize_t dict;              /* next pattern node on the fail path */
+    ssize_t pattern;           /* pattern ending here or -1          */
+} matcher_node_t;
+
+/*
+ * Set of patterns compiled for matching many at once.  Prefix and
+ * suffix matchers are tries walked from either end of the string,
+ * substring matchers are Aho-Corasick automatons.
+ */
+typedef struct _matcher_t {
+    matcher_type_t type;
+    bool icase;
+    bool compiled;
+    matcher_pattern_t *patterns;
+    size_t npatterns;
+    matcher_node_t *nodes;
+    size_t nnodes;
+} matcher_t;
+
+/*
+ * Called for each pattern found by match_patterns() with the offset
+ * of the match in the string.  Return true to stop searching.
+ */
+typedef bool (*matcher_cb)(const matcher_pattern_t *, size_t, void *);
+
 /*
  * Security rule actions hash table
  * There is one of these for each row in the vendor security
@@ -453,6 +637,61 @@ typedef struct _applied_patches_t {
     UT_hash_handle hh;
 } applied_patches_t;
 
+/*
+ * A macro defined in a spec file with %define or %global.  Every
+ * definition of the name is kept in values, in the order found.
+ */
+typedef struct _spec_macro_t {
+    char *name;
+    string_list_t *values;
+    UT_hash_handle hh;
+} spec_macro_t;
+
+/*
+ * A section of a spec file.  The section covers lines start up to
+ * but not including end.  The preamble is the first section and has
+ * an empty name.
+ */
+typedef struct _spec_section_t {
+    const char *name;      /* header line, e.g. "%files devel" */
+    size_t start;
+    size_t end;
+} spec_section_t;
+
+/*
+ * A numbered spec file entry: a PatchN: or SourceN: tag or a %patch
+ * application in %prep.  For tags value is the file name and for
+ * %patch lines it is any options following the patch number.
+ */
+typedef struct _spec_tag_t {
+    long num;
+    char *value;
+    size_t line;           /* index in to the spec_model_t lines */
+} spec_tag_t;
+
+/*
+ * A spec file parsed once and shared by the inspections that need
+ * it.  Lines are split in place in buf with line endings removed.
+ * Everything from %changelog on is only available in lines.
+ */
+typedef struct _spec_model_t {
+    char *path;
+    char *buf;
+    char **lines;
+    size_t nlines;
+    size_t changelog;      /* index of %changelog or nlines */
+    spec_section_t *sections;
+    size_t nsections;
+    spec_tag_t *patches;
+    size_t npatches;
+    spec_tag_t *sources;
+    size_t nsources;
+    spec_tag_t *applied;
+    size_t napplied;
+    spec_macro_t *macros;
+    UT_hash_handle hh;
+} spec_model_t;
+
 /*
  * Configuration and state instance for librpminspect run.
  * Applications using librpminspect should initialize the
@@ -467,6 +706,10 @@ struct rpminspect {
     char *workdir;             /* full path to working directory */
     char *profiledir;          /* full path to profiles directory */
     char *worksubdir;          /* within workdir, where these builds go */
+    char *spilldir;            /* within workdir, for files too big for
+                                  a worksubdir in memory */
+    unsigned long long workdir_memory;      /* bytes, 0 for none */
+    unsigned long long workdir_memory_used;
 
     /* Commands */
     struct command_paths commands;
@@ -482,28 +725,38 @@ struct rpminspect {
     /* Populated at runtime for the product release */
     char *fileinfo_filename;
     fileinfo_t *fileinfo;
+    fileinfo_entry_t *fileinfo_table;  /* fileinfo indexed by filename */
+    bool fileinfo_initialized;
     caps_t *caps;
     char *caps_filename;
+    bool caps_initialized;
     string_list_t *rebaseable;
     char *rebaseable_filename;
+    bool rebaseable_initialized;
     politics_list_t *politics;
     char *politics_filename;
+    bool politics_initialized;
     security_list_t *security;
     char *security_filename;
     bool security_initialized;
     string_list_t *icons;
+    string_set_t *icons_set;
     char *icons_filename;
+    bool icons_initialized;
     bool librpm_initialized;
 
     /* Koji information (from config file) */
     char *kojihub;             /* URL of Koji hub */
     char *kojiursine;          /* URL to access packages built in Koji */
     char *kojimbs;             /* URL to access module packages in Koji */
+    unsigned int download_connections;      /* 0 for the default */
+    unsigned long long download_bandwidth;  /* bytes/s, 0 for none */
 
     /* Information used by different tests */
     string_list_t *badwords;   /* Space-delimited list of words prohibited
                                 * from certain package strings.
                                 */
+    matcher_t *badwords_matcher;
     char *vendor;              /* Required vendor string */
 
 #ifdef _HAVE_MODULARITYLABEL
@@ -537,6 +790,11 @@ struct rpminspect {
     string_list_t *forbidden_path_suffixes;
     string_list_t *forbidden_directories;
 
+    /* The forbidden path lists compiled for matching */
+    matcher_t *forbidden_path_prefixes_matcher;
+    matcher_t *forbidden_path_suffixes_matcher;
+    matcher_t *forbidden_directories_matcher;
+
     /*
      * Optional: List of auto macros that handle patch setup.
      */
@@ -548,6 +806,9 @@ struct rpminspect {
      */
     string_list_t *bad_functions;
 
+    /* bad_functions as a hash table for symbol lookups */
+    string_map_t *bad_functions_set;
+
     /*
      * Optional: if not NULL, contains a map of file paths in packages
      * and a list of allowed forbidden functions it can use.
@@ -594,6 +855,7 @@ struct rpminspect {
 
     /* Optional: ELF LTO symbol prefixes */
     string_list_t *lto_symbol_name_prefixes;
+    matcher_t *lto_symbol_name_prefixes_matcher;
 
     /* Spec filename matching type */
     specname_match_t specmatch;
@@ -610,6 +872,8 @@ struct rpminspect {
     /* hash table of path migrations */
     string_map_t *pathmigration;
     string_list_t *pathmigration_excluded_paths;
+    matcher_t *pathmigration_matcher;
+    matcher_t *pathmigration_excluded_matcher;
 
     /* hash table of product release regexps */
     string_map_t *products;
@@ -689,6 +953,10 @@ struct rpminspect {
     char *before;              /* before build ID arg given on cmdline */
     char *after;               /* after build ID arg given on cmdline */
     uint64_t tests;            /* which tests to run (default: ALL) */
+    uint64_t skipped_tests;    /* tests reported as skipped when not
+                                  run (default: ALL) */
+    unsigned int shard;        /* shard of a --shard worker, 1 based */
+    unsigned int shards;       /* number of shards in the run */
     bool verbose;              /* verbose inspection output? */
     bool rebase_detection;     /* Is rebase detection enabled for
                                   builds? (default true) */
@@ -713,6 +981,8 @@ struct rpminspect {
     /* accumulated data of the build set */
     rpmpeer_t *peers;               /* list of packages */
     header_cache_t *header_cache;   /* RPM header cache */
+    debuginfo_index_t *debuginfo_index[2]; /* indexed by BEFORE_BUILD/AFTER_BUILD */
+    bool debuginfo_indexed[2];
     char *before_rel;               /* before Release w/o %{?dist} */
     char *after_rel;                /* after Release w/o ${?dist} */
     int rebase_build;               /* indicates if this is a rebased build */
@@ -725,11 +995,33 @@ struct rpminspect {
     unsigned long int download_size;
     unsigned long int unpacked_size;
 
-    /* spec file macros */
-    pair_list_t *macros;
+    /* parsed spec files, indexed by path */
+    spec_model_t *specs;
 
     /* inspection results */
     results_t *results;
+
+    /* inspection input fingerprints and reusable previous results */
+    string_map_t *fingerprints;
+    previous_results_t *previous;
+
+    /* number of inspections to run at once */
+    unsigned int jobs;
+
+    /* stop once a result reaches the threshold, cheapest first */
+    bool fail_fast;
+
+    /* time limits, inspection name or "default" to seconds */
+    string_map_t *timeouts;
+    unsigned int command_timeout;
+
+    /* an inspection child writes its results here as they are added */
+    FILE *results_stream;
+
+    /* inspection runtime history used for scheduling */
+    bool use_history;
+    char *history_file;
+    history_t *history;
 };
 
 /*
@@ -1003,6 +1295,16 @@ typedef struct _kernel_alias_data_t {
     UT_hash_handle hh;
 } kernel_alias_data_t;
 
+/* modinfo of a kernel module, read once per file and cached */
+typedef struct _kmod_info_t {
+    char *path;                       /* full path to the module */
+    char *name;                       /* NULL if not a kernel module */
+    string_list_t *parameters;
+    string_list_t *dependencies;
+    kernel_alias_data_t *aliases;
+    UT_hash_handle hh;
+} kmod_info_t;
+
 #endif
 
 /* Types of workdirs */
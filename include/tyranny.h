@@ -10,6 +10,7 @@
 #define _LIBRPMINSPECT_TYRANNY_H
 
 #include <yaml.h>
+#include "uthash.h"
 
 /* This is a private header, so enums are cool. */
 typedef enum {
@@ -19,6 +20,13 @@ typedef enum {
     Y_DICT, /* "mapping", in YAML parlance */
 } y_type;
 
+/* Index of a dict's keys, built while parsing.  pos is the index in keys. */
+typedef struct y_index {
+    const char *key;
+    size_t pos;
+    UT_hash_handle hh;
+} y_index;
+
 /* This is a public type.  Feel free to traverse it yourself, if you want. */
 typedef struct y_value {
     y_type type;
@@ -31,6 +39,7 @@ typedef struct y_value {
         struct {
             char **keys;
             struct y_value **values;
+            y_index *index; /* first occurrence of each key */
         } dict;
     } v; /* Anonymous unions would require C11 :( */
 } y_value;
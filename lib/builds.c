@@ -32,6 +32,7 @@
 static struct rpminspect *workri = NULL;
 static int whichbuild = BEFORE_BUILD;
 static bool fetch_only = false;
+static bool queue_rpms = false;
 static int mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
 
 /* This array holds strings that map to the whichbuild index value. */
@@ -52,6 +53,9 @@ static int download_rpm(struct rpminspect *ri, const char *rpm);
  */
 static void set_worksubdir(struct rpminspect *ri, workdir_t wd, const struct koji_build *build, const struct koji_task *task)
 {
+    const char *dir = NULL;
+    char *memdir = NULL;
+
     assert(ri != NULL);
     assert(wd != NULL_WORKDIR);
 
@@ -73,21 +77,53 @@ static void set_worksubdir(struct rpminspect *ri, workdir_t wd, const struct koj
             err(RI_PROGRAM_ERROR, _("unable to create download directory %s"), ri->worksubdir);
         }
     } else {
-        if (wd == LOCAL_WORKDIR) {
-            xasprintf(&ri->worksubdir, "%s/local.XXXXXX", ri->workdir);
-        } else if (wd == TASK_WORKDIR) {
-            assert(task != NULL);
-            xasprintf(&ri->worksubdir, "%s/scratch-%d.XXXXXX", ri->workdir, task->id);
-        } else if (wd == BUILD_WORKDIR) {
-            assert(build != NULL);
-            xasprintf(&ri->worksubdir, "%s/%s-%s.XXXXXX", ri->workdir, build->name, build->version);
-        } else {
-            errx(RI_PROGRAM_ERROR, _("unknown workdir type %d"), wd);
+        dir = ri->workdir;
+
+        /* keep the builds in memory, spilling big files to workdir */
+        if (ri->workdir_memory > 0) {
+            memdir = get_memory_workdir(true);
+
+            if (memdir != NULL) {
+                dir = memdir;
+            } else {
+                warnx(_("*** unable to use a memory-backed working directory, using %s"), ri->workdir);
+            }
+        }
+
+        while (true) {
+            if (wd == LOCAL_WORKDIR) {
+                xasprintf(&ri->worksubdir, "%s/local.XXXXXX", dir);
+            } else if (wd == TASK_WORKDIR) {
+                assert(task != NULL);
+                xasprintf(&ri->worksubdir, "%s/scratch-%d.XXXXXX", dir, task->id);
+            } else if (wd == BUILD_WORKDIR) {
+                assert(build != NULL);
+                xasprintf(&ri->worksubdir, "%s/%s-%s.XXXXXX", dir, build->name, build->version);
+            } else {
+                errx(RI_PROGRAM_ERROR, _("unknown workdir type %d"), wd);
+            }
+
+            if (mkdtemp(ri->worksubdir) != NULL) {
+                break;
+            }
+
+            if (dir == ri->workdir) {
+                err(RI_PROGRAM_ERROR, "mkdtemp");
+            }
+
+            /* fall back to the working directory on disk */
+            warn(_("*** unable to create a directory in %s, using %s"), dir, ri->workdir);
+            free(ri->worksubdir);
+            ri->worksubdir = NULL;
+            dir = ri->workdir;
         }
 
-        if (mkdtemp(ri->worksubdir) == NULL) {
-            err(RI_PROGRAM_ERROR, "mkdtemp");
+        /* same name on disk, created as files spill there */
+        if (dir != ri->workdir) {
+            xasprintf(&ri->spilldir, "%s%s", ri->workdir, ri->worksubdir + strlen(dir));
         }
+
+        free(memdir);
     }
 
     return;
@@ -111,6 +147,54 @@ static void get_rpm_info(const char *pkg)
     return;
 }
 
+/*
+ * Download a package and collect its peer information.  In
+ * fetch_builds() the package is only queued, there is no peer
+ * information to collect when fetching.  When the working
+ * subdirectory is in memory the package is only read to extract it,
+ * so it is downloaded to ri->spilldir on disk and a symlink to it is
+ * left at dst.
+ */
+static void get_rpm(const char *src, const char *dst)
+{
+    char *path = NULL;
+    char *dir = NULL;
+
+    if (queue_rpms) {
+        curl_queue_file(src, dst);
+        return;
+    }
+
+    if (workri->spilldir != NULL) {
+        path = get_spill_path(workri, dst);
+        dir = strdup(path);
+        assert(dir != NULL);
+
+        if (mkdirp(dirname(dir), mode)) {
+            warn("mkdirp %s", dir);
+            free(path);
+            path = NULL;
+        }
+
+        free(dir);
+    }
+
+    if (path == NULL) {
+        curl_get_file(workri->verbose, src, dst);
+    } else {
+        curl_get_file(workri->verbose, src, path);
+
+        if (access(path, F_OK) == 0 && symlink(path, dst) == -1) {
+            warn("symlink %s", dst);
+        }
+
+        free(path);
+    }
+
+    get_rpm_info(dst);
+    return;
+}
+
 /*
  * Walk a local build tree and prune empty arch subdirectories.
  */
@@ -149,7 +233,11 @@ static void prune_local(const int whichbuild)
 }
 
 /*
- * Used to recursively copy a build tree over to the working directory.
+ * Used to recursively bring a local build tree in to the working
+ * directory.  Packages are not copied, they are inspected where they
+ * are.  Everything else is cloned in to the working directory, which
+ * is a reflink or hard link when the filesystem allows it and a copy
+ * only when it does not.
  */
 static int copytree(const char *fpath, const struct stat *sb, int tflag, struct FTW *ftwbuf)
 {
@@ -189,19 +277,17 @@ static int copytree(const char *fpath, const struct stat *sb, int tflag, struct
             /* filter out RPMs from excluded architectures */
             arch = get_rpm_header_arch(h);
 
-            if (!allowed_arch(workri, arch)) {
-                free(bufpath);
-                return 0;
+            if (allowed_arch(workri, arch)) {
+                /* Gather the RPM header for packages, in place */
+                get_rpm_info(fpath);
             }
-        }
-
-        if (copyfile(fpath, bufpath, true, false)) {
+        } else if (S_ISLNK(sb->st_mode) && copyfile(fpath, bufpath, true, false)) {
             warn("copyfile");
             ret = -1;
+        } else if (S_ISREG(sb->st_mode) && clone_file(fpath, bufpath)) {
+            warn("clone_file");
+            ret = -1;
         }
-
-        /* Gather the RPM header for packages */
-        get_rpm_info(bufpath);
     } else {
         warnx(_("unknown directory member encountered: %s"), fpath);
         ret = -1;
@@ -276,6 +362,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
     parser_plugin *p = &yaml_parser;
     parser_context *ctx = NULL;
     string_list_t *filter = NULL;
+    string_set_t *filter_set = NULL;
 
     assert(build != NULL);
     assert(build->builds != NULL);
@@ -388,6 +475,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                 }
 
                 p->fini(ctx);
+                filter_set = list_to_set(filter);
             }
 
             /* Need to use this in the next loop */
@@ -435,7 +523,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
 
             /* for module builds, filter out packages */
             if (workri->buildtype == KOJI_BUILD_MODULE && filter != NULL) {
-                if (list_contains(filter, rpm->name)) {
+                if (set_contains(filter_set, rpm->name)) {
                     continue;
                 }
             }
@@ -466,10 +554,7 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
                       pkg);
 
             /* download the package */
-            curl_get_file(workri->verbose, src, dst);
-
-            /* gather the RPM header */
-            get_rpm_info(dst);
+            get_rpm(src, dst);
 
             /* start over */
             free(src);
@@ -477,6 +562,8 @@ static int download_build(struct rpminspect *ri, const struct koji_build *build)
             free(pkg);
         }
 
+        free_string_set(filter_set);
+        filter_set = NULL;
         list_free(filter, free);
         filter = NULL;
     }
@@ -600,10 +687,7 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
                 assert(dst != NULL);
 
                 xasprintf(&src, "%s/work/%s", workri->kojiursine, entry->data);
-                curl_get_file(workri->verbose, src, dst);
-
-                /* gather the RPM header */
-                get_rpm_info(dst);
+                get_rpm(src, dst);
 
                 free(dst);
                 free(src);
@@ -625,10 +709,7 @@ static int download_task(struct rpminspect *ri, struct koji_task *task)
             }
 
             xasprintf(&src, "%s/work/%s", workri->kojiursine, entry->data);
-            curl_get_file(workri->verbose, src, dst);
-
-            /* gather the RPM header */
-            get_rpm_info(dst);
+            get_rpm(src, dst);
 
             free(dst);
             free(src);
@@ -690,10 +771,7 @@ static int download_rpm(struct rpminspect *ri, const char *rpm)
 
     /* download the package */
     xasprintf(&dst, "%s/%s", dstdir, basename(pkg));
-    curl_get_file(workri->verbose, rpm, dst);
-
-    /* gather the RPM header */
-    get_rpm_info(dst);
+    get_rpm(rpm, dst);
 
     /* clean up */
     free(pkg);
@@ -973,3 +1051,156 @@ int gather_builds(struct rpminspect *ri, bool fo)
      */
     return extract_peers(ri, fo);
 }
+
+/* Bytes of memory-backed files removed by remove_tree() */
+static unsigned long long tree_bytes = 0;
+
+static int add_tree_bytes(__attribute__((unused)) const char *fpath, const struct stat *sb, int tflag, __attribute__((unused)) struct FTW *ftwbuf)
+{
+    /* the links of a file were counted once between them */
+    if (tflag == FTW_F && S_ISREG(sb->st_mode)) {
+        tree_bytes += sb->st_size / ((sb->st_nlink > 0) ? sb->st_nlink : 1);
+    }
+
+    return 0;
+}
+
+/*
+ * Remove a tree of the working subdirectory.  If it is in memory, the
+ * size of the files in it is given back to ri->workdir_memory_used so
+ * the next build can use the space.
+ */
+static void remove_tree(struct rpminspect *ri, const char *dir, const bool memory)
+{
+    tree_bytes = 0;
+
+    if (memory && ri->workdir_memory > 0 && ri->spilldir != NULL) {
+        (void) nftw(dir, add_tree_bytes, FOPEN_MAX, FTW_MOUNT | FTW_PHYS);
+    }
+
+    if (rmtree(dir, true, false) != 0) {
+        warn("rmtree %s", dir);
+    }
+
+    ri->workdir_memory_used -= (tree_bytes < ri->workdir_memory_used) ? tree_bytes : ri->workdir_memory_used;
+    return;
+}
+
+/**
+ * @brief Replace the before build with another one.
+ *
+ * Used to compare one after build against several before builds in
+ * one run.  The after build gathered by gather_builds() is kept as it
+ * is, extracted files and all, and only the new before build is
+ * gathered and extracted.  The previous before build is removed
+ * first, so only one before build is on disk or in memory at a time.
+ *
+ * @param ri The main program data structure, after gather_builds()
+ *        and run_inspections() for the previous before build.
+ * @param before The before build specification.
+ * @return 0 on success, non-zero on failure (program exit code).
+ */
+int gather_baseline(struct rpminspect *ri, const char *before)
+{
+    int r = 0;
+    char *dir = NULL;
+
+    assert(ri != NULL);
+    assert(ri->worksubdir != NULL);
+    assert(before != NULL);
+
+    workri = ri;
+    fetch_only = false;
+
+    reset_before_peers(ri);
+
+    /* downloads and extracted files of the previous before build */
+    dir = joinpath(ri->worksubdir, BEFORE_SUBDIR, NULL);
+    remove_tree(ri, dir, false);
+    free(dir);
+
+    dir = joinpath(ri->worksubdir, ROOT_SUBDIR, BEFORE_SUBDIR, NULL);
+    remove_tree(ri, dir, true);
+    free(dir);
+
+    if (ri->spilldir != NULL) {
+        dir = joinpath(ri->spilldir, BEFORE_SUBDIR, NULL);
+        remove_tree(ri, dir, false);
+        free(dir);
+
+        dir = joinpath(ri->spilldir, ROOT_SUBDIR, BEFORE_SUBDIR, NULL);
+        remove_tree(ri, dir, false);
+        free(dir);
+    }
+
+    free(ri->before);
+    ri->before = strdup(before);
+    assert(ri->before != NULL);
+
+    whichbuild = BEFORE_BUILD;
+    r = _gather_build_types(ri);
+
+    if (r) {
+        return r;
+    }
+
+    return extract_peers(ri, false);
+}
+
+/**
+ * @brief Fetch a list of builds in to the working directory.
+ *
+ * Every build is resolved and its directory laid out first, then all
+ * of the packages are downloaded together through one set of
+ * concurrent connections limited by the download_connections and
+ * download_bandwidth settings.  Packages found in more than one build
+ * are downloaded once.  This is the fetch-only (-f) mode; nothing is
+ * extracted.
+ *
+ * @param ri The main program data structure.
+ * @param specs The build specifications from the command line.
+ * @return 0 on success, non-zero on failure (program exit code).
+ */
+int fetch_builds(struct rpminspect *ri, const string_list_t *specs)
+{
+    int r = 0;
+    string_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(specs != NULL);
+
+    workri = ri;
+    fetch_only = true;
+    whichbuild = AFTER_BUILD;
+    queue_rpms = true;
+
+    TAILQ_FOREACH(entry, specs, items) {
+        free(ri->after);
+        ri->after = strdup(entry->data);
+        assert(ri->after != NULL);
+
+        r = _gather_build_types(ri);
+
+        free(ri->worksubdir);
+        ri->worksubdir = NULL;
+
+        if (r) {
+            break;
+        }
+    }
+
+    queue_rpms = false;
+    free(ri->after);
+    ri->after = NULL;
+
+    if (r) {
+        curl_clear_queue();
+        return r;
+    }
+
+    if (curl_get_queued(ri->verbose, ri->download_connections, ri->download_bandwidth)) {
+        return RI_PROGRAM_ERROR;
+    }
+
+    return 0;
+}
@@ -0,0 +1,192 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * cgroup v2 resource limits.  In a container the CPU quota and memory
+ * limit of the cgroup are usually far below what the host has, so
+ * they are what decides how much can run at once.  A limit set on any
+ * ancestor cgroup applies too, so the whole path up to the root is
+ * checked and the tightest limit wins.
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "rpminspect.h"
+
+/*
+ * Read the first line of a cgroup control file.  Returns NULL if the
+ * file does not exist, as when the controller is not enabled.
+ */
+static char *read_control(const char *root, const char *path, const char *file)
+{
+    FILE *fp = NULL;
+    char *fn = NULL;
+    char *line = NULL;
+    size_t len = 0;
+
+    xasprintf(&fn, "%s%s/%s", root, path, file);
+    fp = fopen(fn, "r");
+    free(fn);
+
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    if (getline(&line, &len, fp) == -1) {
+        free(line);
+        line = NULL;
+    }
+
+    fclose(fp);
+    return line;
+}
+
+/*
+ * Strip the last component from a cgroup path.  Returns false at the
+ * root.
+ */
+static bool parent_cgroup(char *path)
+{
+    char *slash = strrchr(path, '/');
+
+    if (slash == NULL || *path == '\0') {
+        return false;
+    }
+
+    *slash = '\0';
+    return true;
+}
+
+/**
+ * @brief Return the cgroup v2 path of the running process.
+ *
+ * @return Newly allocated path relative to CGROUP_ROOT, "" for the
+ * root cgroup, or NULL if the process is not in a cgroup v2
+ * hierarchy; caller must free.
+ */
+char *get_cgroup(void)
+{
+    FILE *fp = NULL;
+    char *line = NULL;
+    char *r = NULL;
+    size_t len = 0;
+    ssize_t n = 0;
+
+    fp = fopen(CGROUP_SELF, "r");
+
+    if (fp == NULL) {
+        return NULL;
+    }
+
+    while ((n = getline(&line, &len, fp)) != -1) {
+        if (strncmp(line, "0::", 3)) {
+            continue;
+        }
+
+        if (n > 0 && line[n - 1] == '\n') {
+            line[n - 1] = '\0';
+        }
+
+        /* the root cgroup is "/", kept as "" so paths join cleanly */
+        r = strdup(strcmp(line + 3, "/") ? line + 3 : "");
+        assert(r != NULL);
+        break;
+    }
+
+    free(line);
+    fclose(fp);
+    return r;
+}
+
+/**
+ * @brief Return the number of CPUs the cpu.max quota of a cgroup
+ * allows.
+ *
+ * The quota divided by the period, rounded up, of the cgroup and each
+ * of its ancestors.
+ *
+ * @param root Mount point of the cgroup v2 hierarchy.
+ * @param cgroup Path of the cgroup under root, as returned by
+ * get_cgroup().
+ * @return The lowest limit found, or 0 if there is none.
+ */
+unsigned int get_cgroup_cpus(const char *root, const char *cgroup)
+{
+    unsigned int r = 0;
+    unsigned int cpus = 0;
+    char *path = NULL;
+    char *line = NULL;
+    unsigned long long quota = 0;
+    unsigned long long period = 0;
+
+    assert(root != NULL);
+    assert(cgroup != NULL);
+
+    path = strdup(cgroup);
+    assert(path != NULL);
+
+    do {
+        line = read_control(root, path, "cpu.max");
+
+        /* "max 100000" is no limit */
+        if (line != NULL && sscanf(line, "%llu %llu", &quota, &period) == 2 && quota > 0 && period > 0) {
+            cpus = (quota + period - 1) / period;
+
+            if (r == 0 || cpus < r) {
+                r = cpus;
+            }
+        }
+
+        free(line);
+    } while (parent_cgroup(path));
+
+    free(path);
+    return r;
+}
+
+/**
+ * @brief Return the memory.max limit of a cgroup in bytes.
+ *
+ * @param root Mount point of the cgroup v2 hierarchy.
+ * @param cgroup Path of the cgroup under root, as returned by
+ * get_cgroup().
+ * @return The lowest limit of the cgroup and its ancestors, or 0 if
+ * there is none.
+ */
+unsigned long long get_cgroup_memory(const char *root, const char *cgroup)
+{
+    unsigned long long r = 0;
+    unsigned long long bytes = 0;
+    char *path = NULL;
+    char *line = NULL;
+    char *end = NULL;
+
+    assert(root != NULL);
+    assert(cgroup != NULL);
+
+    path = strdup(cgroup);
+    assert(path != NULL);
+
+    do {
+        line = read_control(root, path, "memory.max");
+
+        /* "max" is no limit */
+        if (line != NULL) {
+            bytes = strtoull(line, &end, 10);
+
+            if (end != line && bytes > 0 && (r == 0 || bytes < r)) {
+                r = bytes;
+            }
+        }
+
+        free(line);
+    } while (parent_cgroup(path));
+
+    free(path);
+    return r;
+}
@@ -301,3 +301,244 @@ bool is_remote_rpm(const char *url)
 
     return (r == CURLE_OK);
 }
+
+/*
+ * Download queue used by fetch-only mode.  Files are keyed by their
+ * source URL, so a package listed more than once (module builds share
+ * components heavily) is downloaded once and the other copies are
+ * cloned from it.
+ */
+typedef struct _queued_file_t {
+    char *src;
+    char *dst;
+    string_list_t *copies;      /* more destinations for the same file */
+    FILE *fp;
+    CURL *c;
+    UT_hash_handle hh;
+} queued_file_t;
+
+static queued_file_t *queued_files = NULL;
+
+static void free_queued_files(void)
+{
+    queued_file_t *q = NULL;
+    queued_file_t *tmp = NULL;
+
+    HASH_ITER(hh, queued_files, q, tmp) {
+        HASH_DEL(queued_files, q);
+        free(q->src);
+        free(q->dst);
+        list_free(q->copies, free);
+        free(q);
+    }
+
+    queued_files = NULL;
+    return;
+}
+
+/* Add a queued file to the multi handle, returns false on error */
+static bool start_transfer(CURLM *multi, queued_file_t *q, const curl_off_t speed)
+{
+    assert(multi != NULL);
+    assert(q != NULL);
+
+    DEBUG_PRINT("src=|%s|\ndst=|%s|\n", q->src, q->dst);
+
+    q->fp = fopen(q->dst, "wb");
+
+    if (q->fp == NULL) {
+        warn("fopen %s", q->dst);
+        return false;
+    }
+
+    q->c = curl_easy_init();
+
+    if (q->c == NULL) {
+        warn("curl_easy_init");
+        fclose(q->fp);
+        q->fp = NULL;
+        return false;
+    }
+
+    curl_easy_setopt(q->c, CURLOPT_WRITEFUNCTION, NULL);
+    curl_easy_setopt(q->c, CURLOPT_WRITEDATA, q->fp);
+    curl_easy_setopt(q->c, CURLOPT_FOLLOWLOCATION, 1L);
+    curl_easy_setopt(q->c, CURLOPT_MAXREDIRS, 10L);
+    curl_easy_setopt(q->c, CURLOPT_URL, q->src);
+    curl_easy_setopt(q->c, CURLOPT_FAILONERROR, true);
+    curl_easy_setopt(q->c, CURLOPT_PRIVATE, q);
+#ifdef CURLOPT_TCP_FASTOPEN /* not available on all versions of libcurl (e.g., <= 7.29) */
+    curl_easy_setopt(q->c, CURLOPT_TCP_FASTOPEN, 1);
+#endif
+
+    if (speed > 0) {
+        curl_easy_setopt(q->c, CURLOPT_MAX_RECV_SPEED_LARGE, speed);
+    }
+
+    curl_multi_add_handle(multi, q->c);
+    return true;
+}
+
+/* Finish a completed transfer, returns the number of failed files */
+static int finish_transfer(CURLM *multi, queued_file_t *q, const CURLcode cc, const bool verbose)
+{
+    int r = 0;
+    string_entry_t *entry = NULL;
+
+    assert(multi != NULL);
+    assert(q != NULL);
+
+    curl_multi_remove_handle(multi, q->c);
+    curl_easy_cleanup(q->c);
+    q->c = NULL;
+
+    if (fclose(q->fp) != 0) {
+        err(RI_PROGRAM_ERROR, "fclose");
+    }
+
+    q->fp = NULL;
+
+    /* remove output file if there was a download error (e.g., 404) */
+    if (cc != CURLE_OK) {
+        warnx(_("unable to download %s: %s"), q->src, curl_easy_strerror(cc));
+
+        if (unlink(q->dst)) {
+            warn("unlink");
+        }
+
+        return 1;
+    }
+
+    if (verbose) {
+        printf(">>> %s\n", rindex(q->src, '/') + 1);
+        fflush(stdout);
+    }
+
+    if (q->copies != NULL) {
+        TAILQ_FOREACH(entry, q->copies, items) {
+            (void) unlink(entry->data);
+
+            if (clone_file(q->dst, entry->data)) {
+                warnx(_("unable to copy %s to %s"), q->dst, entry->data);
+                r++;
+            }
+        }
+    }
+
+    return r;
+}
+
+/*
+ * Queue src to be downloaded to dst by curl_get_queued().
+ */
+void curl_queue_file(const char *src, const char *dst)
+{
+    queued_file_t *q = NULL;
+
+    assert(src != NULL);
+    assert(dst != NULL);
+
+    HASH_FIND_STR(queued_files, src, q);
+
+    if (q != NULL) {
+        if (strcmp(q->dst, dst) && !list_contains(q->copies, dst)) {
+            q->copies = list_add(q->copies, dst);
+        }
+
+        return;
+    }
+
+    q = calloc(1, sizeof(*q));
+    assert(q != NULL);
+    q->src = strdup(src);
+    assert(q->src != NULL);
+    q->dst = strdup(dst);
+    assert(q->dst != NULL);
+    HASH_ADD_KEYPTR(hh, queued_files, q->src, strlen(q->src), q);
+    return;
+}
+
+/*
+ * Download everything queued with curl_queue_file() over at most
+ * connections concurrent transfers.  A non-zero bandwidth in bytes
+ * per second is the limit for all of them together; each connection
+ * gets an equal share.
+ */
+int curl_get_queued(const bool verbose, const unsigned int connections, const unsigned long long bandwidth)
+{
+    int r = 0;
+    int running = 0;
+    int left = 0;
+    unsigned int active = 0;
+    unsigned int max = (connections > 0) ? connections : DOWNLOAD_CONNECTIONS;
+    curl_off_t speed = 0;
+    CURLM *multi = NULL;
+    CURLMsg *msg = NULL;
+    CURL *c = NULL;
+    CURLcode cc;
+    queued_file_t *q = NULL;
+    queued_file_t *next = queued_files;
+
+    if (queued_files == NULL) {
+        return 0;
+    }
+
+    if (bandwidth > 0) {
+        speed = (bandwidth / max > 0) ? (curl_off_t) (bandwidth / max) : 1;
+    }
+
+    multi = curl_multi_init();
+
+    if (multi == NULL) {
+        warnx("curl_multi_init");
+        r = HASH_COUNT(queued_files);
+        free_queued_files();
+        return r;
+    }
+
+    while (active > 0 || next != NULL) {
+        /* keep the connections busy */
+        while (active < max && next != NULL) {
+            q = next;
+            next = next->hh.next;
+
+            if (start_transfer(multi, q, speed)) {
+                active++;
+            } else {
+                r++;
+            }
+        }
+
+        curl_multi_perform(multi, &running);
+
+        while ((msg = curl_multi_info_read(multi, &left)) != NULL) {
+            if (msg->msg != CURLMSG_DONE) {
+                continue;
+            }
+
+            /* msg does not survive removing the handle */
+            c = msg->easy_handle;
+            cc = msg->data.result;
+            curl_easy_getinfo(c, CURLINFO_PRIVATE, (char **) &q);
+            r += finish_transfer(multi, q, cc, verbose);
+            active--;
+        }
+
+        if (active > 0) {
+            curl_multi_wait(multi, NULL, 0, 1000, NULL);
+        }
+    }
+
+    curl_multi_cleanup(multi);
+    free_queued_files();
+    return r;
+}
+
+/*
+ * Drop everything queued with curl_queue_file() without downloading.
+ */
+void curl_clear_queue(void)
+{
+    free_queued_files();
+    return;
+}
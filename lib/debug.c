@@ -19,7 +19,7 @@
 /*
  * Given an inspection, print any per-inspection ignores.
  */
-static void dump_inspection_ignores(const string_list_map_t *ignores, const char *key)
+static void dump_inspection_ignores(FILE *fp, const string_list_map_t *ignores, const char *key)
 {
     string_list_map_t *mapentry = NULL;
     string_entry_t *entry = NULL;
@@ -31,10 +31,10 @@ static void dump_inspection_ignores(const string_list_map_t *ignores, const char
     HASH_FIND_STR(ignores, key, mapentry);
 
     if (mapentry != NULL && mapentry->value != NULL && !TAILQ_EMPTY(mapentry->value)) {
-        printf("    ignore:\n");
+        fprintf(fp, "    ignore:\n");
 
         TAILQ_FOREACH(entry, mapentry->value, items) {
-            printf("        - %s\n", entry->data);
+            fprintf(fp, "        - %s\n", entry->data);
         }
     }
 
@@ -58,12 +58,13 @@ void set_debug_mode(bool debug)
 
 /**
  * In debug mode, dump the current configuration settings that are in
- * effect for this run of rpminspect.  The configuration is displayed
- * on stderr in YAML structure.
+ * effect for this run of rpminspect.  The configuration is written to
+ * the given stream in YAML structure.
  *
+ * @param fp The stream to write to, usually stdout.
  * @param ri The main struct rpminspect for the program.
  */
-void dump_cfg(const struct rpminspect *ri)
+void dump_cfg(FILE *fp, const struct rpminspect *ri)
 {
     int i = 0;
     string_entry_t *entry = NULL;
@@ -76,162 +77,192 @@ void dump_cfg(const struct rpminspect *ri)
 
     assert(ri != NULL);
 
-    printf("# rpminspect configuration\n\n---\n");
+    fprintf(fp, "# rpminspect configuration\n\n---\n");
 
     /* common */
 
-    if (ri->workdir || ri->profiledir) {
-        printf("common:\n");
+    if (ri->workdir || ri->profiledir || !ri->use_history) {
+        fprintf(fp, "common:\n");
 
         if (ri->workdir) {
-            printf("    workdir: %s\n", ri->workdir);
+            fprintf(fp, "    workdir: %s\n", ri->workdir);
+        }
+
+        if (ri->workdir_memory > 0) {
+            fprintf(fp, "    workdir_memory: %llu\n", ri->workdir_memory);
         }
 
         if (ri->profiledir) {
-            printf("    profiledir: %s\n", ri->profiledir);
+            fprintf(fp, "    profiledir: %s\n", ri->profiledir);
+        }
+
+        if (!ri->use_history) {
+            fprintf(fp, "    history: off\n");
         }
     }
 
     /* environment */
     if (ri->have_environment) {
-        printf("environment:\n");
-        printf("    product_release: %s\n", ri->product_release);
+        fprintf(fp, "environment:\n");
+        fprintf(fp, "    product_release: %s\n", ri->product_release);
     }
 
     /* koji */
 
     if (ri->kojihub || ri->kojiursine || ri->kojimbs) {
-        printf("koji:\n");
+        fprintf(fp, "koji:\n");
 
         if (ri->kojihub) {
-            printf("    hub: %s\n", ri->kojihub);
+            fprintf(fp, "    hub: %s\n", ri->kojihub);
         }
 
         if (ri->kojiursine) {
-            printf("    download_ursine: %s\n", ri->kojiursine);
+            fprintf(fp, "    download_ursine: %s\n", ri->kojiursine);
         }
 
         if (ri->kojimbs) {
-            printf("    download_mbs: %s\n", ri->kojimbs);
+            fprintf(fp, "    download_mbs: %s\n", ri->kojimbs);
+        }
+
+        if (ri->download_connections > 0) {
+            fprintf(fp, "    download_connections: %u\n", ri->download_connections);
+        }
+
+        if (ri->download_bandwidth > 0) {
+            fprintf(fp, "    download_bandwidth: %llu\n", ri->download_bandwidth);
         }
     }
 
     /* commands */
 
-    printf("commands:\n");
+    fprintf(fp, "commands:\n");
 
     if (ri->commands.msgunfmt) {
-        printf("    msgunfmt: %s\n", ri->commands.msgunfmt);
+        fprintf(fp, "    msgunfmt: %s\n", ri->commands.msgunfmt);
     }
 
     if (ri->commands.desktop_file_validate) {
-        printf("    desktop-file-validate: %s\n", ri->commands.desktop_file_validate);
+        fprintf(fp, "    desktop-file-validate: %s\n", ri->commands.desktop_file_validate);
     }
 
     if (ri->commands.abidiff) {
-        printf("    abidiff: %s\n", ri->commands.abidiff);
+        fprintf(fp, "    abidiff: %s\n", ri->commands.abidiff);
     }
 
     if (ri->commands.kmidiff) {
-        printf("    kmidiff: %s\n", ri->commands.kmidiff);
+        fprintf(fp, "    kmidiff: %s\n", ri->commands.kmidiff);
     }
 
 #ifdef _WITH_ANNOCHECK
     if (ri->commands.annocheck) {
-        printf("    annocheck: %s\n", ri->commands.annocheck);
+        fprintf(fp, "    annocheck: %s\n", ri->commands.annocheck);
     }
 #endif
 
+    /* timeouts */
+
+    if (ri->timeouts || ri->command_timeout > 0) {
+        fprintf(fp, "timeouts:\n");
+
+        if (ri->command_timeout > 0) {
+            fprintf(fp, "    %s: %u\n", TIMEOUT_COMMAND, ri->command_timeout);
+        }
+
+        HASH_ITER(hh, ri->timeouts, hentry, tmp_hentry) {
+            fprintf(fp, "    %s: %s\n", hentry->key, hentry->value);
+        }
+    }
+
     /* vendor */
 
-    printf("vendor:\n");
+    fprintf(fp, "vendor:\n");
 
     if (ri->vendor_data_dir) {
-        printf("    vendor_data_dir: %s\n", ri->vendor_data_dir);
+        fprintf(fp, "    vendor_data_dir: %s\n", ri->vendor_data_dir);
     }
 
     if (ri->licensedb && !TAILQ_EMPTY(ri->licensedb)) {
-        printf("    licensedb:\n");
+        fprintf(fp, "    licensedb:\n");
 
         TAILQ_FOREACH(entry, ri->licensedb, items) {
-            printf("        - %s\n", entry->data);
+            fprintf(fp, "        - %s\n", entry->data);
         }
     }
 
-    printf("    favor_release: %s\n", (ri->favor_release == FAVOR_NONE) ? "none" : (ri->favor_release == FAVOR_OLDEST) ? "oldest" : (ri->favor_release == FAVOR_NEWEST) ? "newest" : "?");
+    fprintf(fp, "    favor_release: %s\n", (ri->favor_release == FAVOR_NONE) ? "none" : (ri->favor_release == FAVOR_OLDEST) ? "oldest" : (ri->favor_release == FAVOR_NEWEST) ? "newest" : "?");
 
     /* inspections */
 
-    printf("inspections:\n");
+    fprintf(fp, "inspections:\n");
 
     for (i = 0; inspections[i].name != NULL; i++) {
-        printf("    %s: %s\n", inspections[i].name, (ri->tests & inspections[i].flag) ? "on" : "off");
+        fprintf(fp, "    %s: %s\n", inspections[i].name, (ri->tests & inspections[i].flag) ? "on" : "off");
     }
 
     /* products */
 
     if (ri->products) {
-        printf("products:\n");
+        fprintf(fp, "products:\n");
 
         HASH_ITER(hh, ri->products, hentry, tmp_hentry) {
-            printf("    %s: %s\n", hentry->key, hentry->value);
+            fprintf(fp, "    %s: %s\n", hentry->key, hentry->value);
         }
     }
 
     /* macrofiles */
 
     if (ri->macrofiles && !TAILQ_EMPTY(ri->macrofiles)) {
-        printf("macrofiles:\n");
+        fprintf(fp, "macrofiles:\n");
 
         TAILQ_FOREACH(entry, ri->macrofiles, items) {
-            printf("    - %s\n", entry->data);
+            fprintf(fp, "    - %s\n", entry->data);
         }
     }
 
     /* ignore */
 
     if (ri->ignores && !TAILQ_EMPTY(ri->ignores)) {
-        printf("ignore:\n");
+        fprintf(fp, "ignore:\n");
 
         TAILQ_FOREACH(entry, ri->ignores, items) {
-            printf("    - %s\n", entry->data);
+            fprintf(fp, "    - %s\n", entry->data);
         }
     }
 
     /* security_path_prefix */
 
     if (ri->security_path_prefix && !TAILQ_EMPTY(ri->security_path_prefix)) {
-        printf("security_path_prefix:\n");
+        fprintf(fp, "security_path_prefix:\n");
 
         TAILQ_FOREACH(entry, ri->security_path_prefix, items) {
-            printf("    - %s\n", entry->data);
+            fprintf(fp, "    - %s\n", entry->data);
         }
     }
 
     /* badwords */
 
     if (ri->badwords && !TAILQ_EMPTY(ri->badwords)) {
-        printf("badwords:\n");
+        fprintf(fp, "badwords:\n");
 
         TAILQ_FOREACH(entry, ri->badwords, items) {
-            printf("    - %s\n", entry->data);
+            fprintf(fp, "    - %s\n", entry->data);
         }
     }
 
     /* metadata */
 
     if (ri->vendor || (ri->buildhost_subdomain && !TAILQ_EMPTY(ri->buildhost_subdomain))) {
-        printf("metadata:\n");
+        fprintf(fp, "metadata:\n");
 
         if (ri->vendor) {
-            printf("    vendor: %s\n", ri->vendor);
+            fprintf(fp, "    vendor: %s\n", ri->vendor);
         }
 
         if (ri->buildhost_subdomain && !TAILQ_EMPTY(ri->buildhost_subdomain)) {
-            printf("    buildhost_subdomain:\n");
+            fprintf(fp, "    buildhost_subdomain:\n");
 
             TAILQ_FOREACH(entry, ri->buildhost_subdomain, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
     }
@@ -240,18 +271,18 @@ void dump_cfg(const struct rpminspect *ri)
     /* modularity */
 
     if (ri->modularity_static_context != STATIC_CONTEXT_NULL) {
-        printf("modularity:\n");
-        printf("    static_context: ");
+        fprintf(fp, "modularity:\n");
+        fprintf(fp, "    static_context: ");
 
         if (ri->modularity_static_context == STATIC_CONTEXT_REQUIRED) {
-            printf("required");
+            fprintf(fp, "required");
         } else if (ri->modularity_static_context == STATIC_CONTEXT_FORBIDDEN) {
-            printf("forbidden");
+            fprintf(fp, "forbidden");
         } else if (ri->modularity_static_context == STATIC_CONTEXT_RECOMMEND) {
-            printf("recommend");
+            fprintf(fp, "recommend");
         }
 
-        printf("\n");
+        fprintf(fp, "\n");
     }
 #endif
 
@@ -260,27 +291,27 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_ELF, mapentry);
 
     if (ri->elf_path_include_pattern || ri->elf_path_exclude_pattern || mapentry != NULL) {
-        printf("elf:\n");
+        fprintf(fp, "elf:\n");
 
         if (ri->elf_path_include_pattern) {
-            printf("    include_path: %s\n", ri->elf_path_include_pattern);
+            fprintf(fp, "    include_path: %s\n", ri->elf_path_include_pattern);
         }
 
         if (ri->elf_path_exclude_pattern) {
-            printf("    exclude_path: %s\n", ri->elf_path_exclude_pattern);
+            fprintf(fp, "    exclude_path: %s\n", ri->elf_path_exclude_pattern);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_ELF);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_ELF);
     }
 
     /* emptyrpm */
 
     if (ri->expected_empty_rpms && !TAILQ_EMPTY(ri->expected_empty_rpms)) {
-        printf("emptyrpm:\n");
-        printf("    expected_empty:\n");
+        fprintf(fp, "emptyrpm:\n");
+        fprintf(fp, "    expected_empty:\n");
 
         TAILQ_FOREACH(entry, ri->expected_empty_rpms, items) {
-            printf("        - %s\n", entry->data);
+            fprintf(fp, "        - %s\n", entry->data);
         }
     }
 
@@ -289,17 +320,17 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_MANPAGE, mapentry);
 
     if (ri->manpage_path_include_pattern || ri->manpage_path_exclude_pattern || mapentry != NULL) {
-        printf("manpage:\n");
+        fprintf(fp, "manpage:\n");
 
         if (ri->manpage_path_include_pattern) {
-            printf("    include_path: %s\n", ri->manpage_path_include_pattern);
+            fprintf(fp, "    include_path: %s\n", ri->manpage_path_include_pattern);
         }
 
         if (ri->manpage_path_exclude_pattern) {
-            printf("    exclude_path: %s\n", ri->manpage_path_exclude_pattern);
+            fprintf(fp, "    exclude_path: %s\n", ri->manpage_path_exclude_pattern);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_MANPAGE);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_MANPAGE);
     }
 
     /* xml */
@@ -307,17 +338,17 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_XML, mapentry);
 
     if (ri->xml_path_include_pattern || ri->xml_path_exclude_pattern || mapentry != NULL) {
-        printf("xml:\n");
+        fprintf(fp, "xml:\n");
 
         if (ri->xml_path_include_pattern) {
-            printf("    include_path: %s\n", ri->xml_path_include_pattern);
+            fprintf(fp, "    include_path: %s\n", ri->xml_path_include_pattern);
         }
 
         if (ri->xml_path_exclude_pattern) {
-            printf("    exclude_path: %s\n", ri->xml_path_exclude_pattern);
+            fprintf(fp, "    exclude_path: %s\n", ri->xml_path_exclude_pattern);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_XML);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_XML);
     }
 
     /* desktop */
@@ -325,13 +356,13 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_DESKTOP, mapentry);
 
     if (ri->desktop_entry_files_dir || mapentry != NULL) {
-        printf("desktop:\n");
+        fprintf(fp, "desktop:\n");
 
         if (ri->desktop_entry_files_dir) {
-            printf("    desktop_entry_files_dir: %s\n", ri->desktop_entry_files_dir);
+            fprintf(fp, "    desktop_entry_files_dir: %s\n", ri->desktop_entry_files_dir);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_DESKTOP);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_DESKTOP);
     }
 
     /* changedfiles */
@@ -339,17 +370,17 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_CHANGEDFILES, mapentry);
 
     if ((ri->header_file_extensions && !TAILQ_EMPTY(ri->header_file_extensions)) || mapentry != NULL) {
-        printf("changedfiles:\n");
+        fprintf(fp, "changedfiles:\n");
 
         if (ri->header_file_extensions && !TAILQ_EMPTY(ri->header_file_extensions)) {
-            printf("    header_file_extensions:\n");
+            fprintf(fp, "    header_file_extensions:\n");
 
             TAILQ_FOREACH(entry, ri->header_file_extensions, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_CHANGEDFILES);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_CHANGEDFILES);
     }
 
     /* addedfiles */
@@ -360,33 +391,33 @@ void dump_cfg(const struct rpminspect *ri)
         || (ri->forbidden_path_suffixes && !TAILQ_EMPTY(ri->forbidden_path_suffixes))
         || (ri->forbidden_directories && !TAILQ_EMPTY(ri->forbidden_directories))
         || mapentry != NULL) {
-        printf("addedfiles:\n");
+        fprintf(fp, "addedfiles:\n");
 
         if (ri->forbidden_path_prefixes && !TAILQ_EMPTY(ri->forbidden_path_prefixes)) {
-            printf("    forbidden_path_prefixes:\n");
+            fprintf(fp, "    forbidden_path_prefixes:\n");
 
             TAILQ_FOREACH(entry, ri->forbidden_path_prefixes, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->forbidden_path_suffixes && !TAILQ_EMPTY(ri->forbidden_path_suffixes)) {
-            printf("    forbidden_path_suffixes:\n");
+            fprintf(fp, "    forbidden_path_suffixes:\n");
 
             TAILQ_FOREACH(entry, ri->forbidden_path_suffixes, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->forbidden_directories && !TAILQ_EMPTY(ri->forbidden_directories)) {
-            printf("    forbidden_directories:\n");
+            fprintf(fp, "    forbidden_directories:\n");
 
             TAILQ_FOREACH(entry, ri->forbidden_directories, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_ADDEDFILES);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_ADDEDFILES);
     }
 
     /* movedfiles */
@@ -394,8 +425,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_MOVEDFILES, mapentry);
 
     if (mapentry != NULL) {
-        printf("movedfiles:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_MOVEDFILES);
+        fprintf(fp, "movedfiles:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_MOVEDFILES);
     }
 
     /* removedfiles */
@@ -403,8 +434,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_REMOVEDFILES, mapentry);
 
     if (mapentry != NULL) {
-        printf("removedfiles:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_REMOVEDFILES);
+        fprintf(fp, "removedfiles:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_REMOVEDFILES);
     }
 
     /* ownership */
@@ -417,41 +448,41 @@ void dump_cfg(const struct rpminspect *ri)
         || (ri->forbidden_owners && !TAILQ_EMPTY(ri->forbidden_owners))
         || (ri->forbidden_groups && !TAILQ_EMPTY(ri->forbidden_groups))
         || mapentry != NULL) {
-        printf("ownership:\n");
+        fprintf(fp, "ownership:\n");
 
         if (ri->bin_paths && !TAILQ_EMPTY(ri->bin_paths)) {
-            printf("    bin_paths:\n");
+            fprintf(fp, "    bin_paths:\n");
 
             TAILQ_FOREACH(entry, ri->bin_paths, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->bin_owner) {
-            printf("    bin_owner: %s\n", ri->bin_owner);
+            fprintf(fp, "    bin_owner: %s\n", ri->bin_owner);
         }
 
         if (ri->bin_group) {
-            printf("    bin_group: %s\n", ri->bin_group);
+            fprintf(fp, "    bin_group: %s\n", ri->bin_group);
         }
 
         if (ri->forbidden_owners && !TAILQ_EMPTY(ri->forbidden_owners)) {
-            printf("    forbidden_owners:\n");
+            fprintf(fp, "    forbidden_owners:\n");
 
             TAILQ_FOREACH(entry, ri->forbidden_owners, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->forbidden_groups && !TAILQ_EMPTY(ri->forbidden_groups)) {
-            printf("    forbidden_groups:\n");
+            fprintf(fp, "    forbidden_groups:\n");
 
             TAILQ_FOREACH(entry, ri->forbidden_groups, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_OWNERSHIP);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_OWNERSHIP);
     }
 
     /* shellsyntax */
@@ -459,13 +490,13 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_SHELLSYNTAX, mapentry);
 
     if ((ri->shells && !TAILQ_EMPTY(ri->shells)) || mapentry != NULL) {
-        printf("shellsyntax:\n    shells:\n");
+        fprintf(fp, "shellsyntax:\n    shells:\n");
 
         TAILQ_FOREACH(entry, ri->shells, items) {
-            printf("        - %s\n", entry->data);
+            fprintf(fp, "        - %s\n", entry->data);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_SHELLSYNTAX);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_SHELLSYNTAX);
     }
 
     /* filesize */
@@ -473,16 +504,16 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_FILESIZE, mapentry);
 
     if (ri->size_threshold || mapentry != NULL) {
-        printf("filesize:\n    size_threshold: ");
+        fprintf(fp, "filesize:\n    size_threshold: ");
 
         if (ri->size_threshold == -1) {
-            printf("info");
+            fprintf(fp, "info");
         } else {
-            printf("%ld", ri->size_threshold);
+            fprintf(fp, "%ld", ri->size_threshold);
         }
 
-        printf("\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_FILESIZE);
+        fprintf(fp, "\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_FILESIZE);
     }
 
     /* lto */
@@ -490,25 +521,25 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_LTO, mapentry);
 
     if ((ri->lto_symbol_name_prefixes && !TAILQ_EMPTY(ri->lto_symbol_name_prefixes)) || mapentry != NULL) {
-        printf("lto:\n    lto_symbol_name_prefixes:\n");
+        fprintf(fp, "lto:\n    lto_symbol_name_prefixes:\n");
 
         TAILQ_FOREACH(entry, ri->lto_symbol_name_prefixes, items) {
-            printf("        - %s\n", entry->data);
+            fprintf(fp, "        - %s\n", entry->data);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_LTO);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_LTO);
     }
 
     /* specname */
 
-    printf("specname:\n");
-    printf("    match: %s\n", (ri->specmatch == MATCH_FULL) ? "full" : (ri->specmatch == MATCH_PREFIX) ? "prefix" : (ri->specmatch == MATCH_SUFFIX) ? "suffix" : "?");
-    printf("    primary: %s\n", (ri->specprimary == PRIMARY_NAME) ? "name" : (ri->specprimary == PRIMARY_FILENAME) ? "filename" : "?");
+    fprintf(fp, "specname:\n");
+    fprintf(fp, "    match: %s\n", (ri->specmatch == MATCH_FULL) ? "full" : (ri->specmatch == MATCH_PREFIX) ? "prefix" : (ri->specmatch == MATCH_SUFFIX) ? "suffix" : "?");
+    fprintf(fp, "    primary: %s\n", (ri->specprimary == PRIMARY_NAME) ? "name" : (ri->specprimary == PRIMARY_FILENAME) ? "filename" : "?");
 
     HASH_FIND_STR(ri->inspection_ignores, NAME_SPECNAME, mapentry);
 
     if (mapentry != NULL) {
-        dump_inspection_ignores(ri->inspection_ignores, NAME_SPECNAME);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_SPECNAME);
     }
 
     /* annocheck */
@@ -516,20 +547,20 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_ANNOCHECK, mapentry);
 
     if (ri->annocheck || mapentry != NULL) {
-        printf("annocheck:\n");
-        printf("    failure_severity: %s\n", strseverity(ri->annocheck_failure_severity));
+        fprintf(fp, "annocheck:\n");
+        fprintf(fp, "    failure_severity: %s\n", strseverity(ri->annocheck_failure_severity));
 
         if (ri->annocheck_profile != NULL) {
-            printf("    profile: %s\n", ri->annocheck_profile);
+            fprintf(fp, "    profile: %s\n", ri->annocheck_profile);
         }
 
-        printf("    jobs:\n");
+        fprintf(fp, "    jobs:\n");
 
         HASH_ITER(hh, ri->annocheck, hentry, tmp_hentry) {
-            printf("        %s: %s\n", hentry->key, hentry->value);
+            fprintf(fp, "        %s: %s\n", hentry->key, hentry->value);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_ANNOCHECK);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_ANNOCHECK);
     }
 
     /* javabytecode */
@@ -537,13 +568,13 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_JAVABYTECODE, mapentry);
 
     if (ri->jvm || mapentry != NULL) {
-        printf("javabytecode:\n");
+        fprintf(fp, "javabytecode:\n");
 
         HASH_ITER(hh, ri->jvm, hentry, tmp_hentry) {
-            printf("    %s: %s\n", hentry->key, hentry->value);
+            fprintf(fp, "    %s: %s\n", hentry->key, hentry->value);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_JAVABYTECODE);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_JAVABYTECODE);
     }
 
     /* pathmigration */
@@ -553,25 +584,25 @@ void dump_cfg(const struct rpminspect *ri)
     if (ri->pathmigration
         || (ri->pathmigration_excluded_paths && !TAILQ_EMPTY(ri->pathmigration_excluded_paths))
         || mapentry != NULL) {
-        printf("pathmigration:\n");
+        fprintf(fp, "pathmigration:\n");
 
         if (ri->pathmigration) {
-            printf("    migrated_paths:\n");
+            fprintf(fp, "    migrated_paths:\n");
 
             HASH_ITER(hh, ri->pathmigration, hentry, tmp_hentry) {
-                printf("        %s: %s\n", hentry->key, hentry->value);
+                fprintf(fp, "        %s: %s\n", hentry->key, hentry->value);
             }
         }
 
         if (ri->pathmigration_excluded_paths && !TAILQ_EMPTY(ri->pathmigration_excluded_paths)) {
-            printf("    excluded_paths:\n");
+            fprintf(fp, "    excluded_paths:\n");
 
             TAILQ_FOREACH(entry, ri->pathmigration_excluded_paths, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_PATHMIGRATION);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_PATHMIGRATION);
     }
 
     /* politics */
@@ -579,8 +610,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_POLITICS, mapentry);
 
     if (mapentry != NULL) {
-        printf("politics:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_POLITICS);
+        fprintf(fp, "politics:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_POLITICS);
     }
 
     /* files */
@@ -588,14 +619,14 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_FILES, mapentry);
 
     if (ri->forbidden_paths && !TAILQ_EMPTY(ri->forbidden_paths)) {
-        printf("files:\n");
-        printf("    forbidden_paths:\n");
+        fprintf(fp, "files:\n");
+        fprintf(fp, "    forbidden_paths:\n");
 
         TAILQ_FOREACH(entry, ri->forbidden_paths, items) {
-            printf("        - %s\n", entry->data);
+            fprintf(fp, "        - %s\n", entry->data);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_FILES);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_FILES);
     }
 
     /* abidiff */
@@ -603,25 +634,25 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_ABIDIFF, mapentry);
 
     if (ri->abidiff_suppression_file || ri->abidiff_debuginfo_path || ri->abidiff_extra_args || mapentry != NULL) {
-        printf("abidiff:\n");
+        fprintf(fp, "abidiff:\n");
 
         if (ri->abidiff_suppression_file) {
-            printf("    suppression_file: %s\n", ri->abidiff_suppression_file);
+            fprintf(fp, "    suppression_file: %s\n", ri->abidiff_suppression_file);
         }
 
         if (ri->abidiff_debuginfo_path) {
-            printf("    debuginfo_path: %s\n", ri->abidiff_debuginfo_path);
+            fprintf(fp, "    debuginfo_path: %s\n", ri->abidiff_debuginfo_path);
         }
 
         if (ri->abidiff_extra_args) {
-            printf("    extra_args: %s\n", ri->abidiff_extra_args);
+            fprintf(fp, "    extra_args: %s\n", ri->abidiff_extra_args);
         }
 
-        printf("    security_level_threshold: %ld\n", ri->abi_security_threshold);
-        dump_inspection_ignores(ri->inspection_ignores, NAME_ABIDIFF);
+        fprintf(fp, "    security_level_threshold: %ld\n", ri->abi_security_threshold);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_ABIDIFF);
     } else {
-        printf("abidiff:\n");
-        printf("    security_level_threshold: %ld\n", ri->abi_security_threshold);
+        fprintf(fp, "abidiff:\n");
+        fprintf(fp, "    security_level_threshold: %ld\n", ri->abi_security_threshold);
     }
 
     /* kmidiff */
@@ -635,57 +666,57 @@ void dump_cfg(const struct rpminspect *ri)
         || ri->kabi_dir
         || ri->kabi_filename
         || mapentry != NULL) {
-        printf("kmidiff:\n");
+        fprintf(fp, "kmidiff:\n");
 
         if (ri->kmidiff_suppression_file) {
-            printf("    suppression_file: %s\n", ri->kmidiff_suppression_file);
+            fprintf(fp, "    suppression_file: %s\n", ri->kmidiff_suppression_file);
         }
 
         if (ri->kmidiff_debuginfo_path) {
-            printf("    debuginfo_path: %s\n", ri->kmidiff_debuginfo_path);
+            fprintf(fp, "    debuginfo_path: %s\n", ri->kmidiff_debuginfo_path);
         }
 
         if (ri->kmidiff_extra_args) {
-            printf("    extra_args: %s\n", ri->kmidiff_extra_args);
+            fprintf(fp, "    extra_args: %s\n", ri->kmidiff_extra_args);
         }
 
         if (ri->kernel_filenames && !TAILQ_EMPTY(ri->kernel_filenames)) {
-            printf("    kernel_filenames:\n");
+            fprintf(fp, "    kernel_filenames:\n");
 
             TAILQ_FOREACH(entry, ri->kernel_filenames, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->kabi_dir) {
-            printf("    kabi_dir: %s\n", ri->kabi_dir);
+            fprintf(fp, "    kabi_dir: %s\n", ri->kabi_dir);
         }
 
         if (ri->kabi_filename) {
-            printf("    kabi_filename: %s\n", ri->kabi_filename);
+            fprintf(fp, "    kabi_filename: %s\n", ri->kabi_filename);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_KMIDIFF);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_KMIDIFF);
     }
 
     /* patches */
 
     if ((ri->automacros && !TAILQ_EMPTY(ri->automacros)) || (ri->patch_ignore_list && !TAILQ_EMPTY(ri->patch_ignore_list))) {
-        printf("patches:\n");
+        fprintf(fp, "patches:\n");
 
         if (ri->automacros && !TAILQ_EMPTY(ri->automacros)) {
-            printf("    automacros:\n");
+            fprintf(fp, "    automacros:\n");
 
             TAILQ_FOREACH(entry, ri->automacros, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->patch_ignore_list && !TAILQ_EMPTY(ri->patch_ignore_list)) {
-            printf("    ignore_list:\n");
+            fprintf(fp, "    ignore_list:\n");
 
             TAILQ_FOREACH(entry, ri->patch_ignore_list, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
     }
@@ -695,35 +726,35 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_BADFUNCS, mapentry);
 
     if ((ri->bad_functions && !TAILQ_EMPTY(ri->bad_functions)) || ri->bad_functions_allowed || mapentry != NULL) {
-        printf("badfuncs:\n");
+        fprintf(fp, "badfuncs:\n");
 
         if (ri->bad_functions && !TAILQ_EMPTY(ri->bad_functions)) {
-            printf("    forbidden:\n");
+            fprintf(fp, "    forbidden:\n");
 
             TAILQ_FOREACH(entry, ri->bad_functions, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->bad_functions_allowed) {
-            printf("    allowed:\n");
+            fprintf(fp, "    allowed:\n");
 
             HASH_ITER(hh, ri->bad_functions_allowed, mapentry, tmp_mapentry) {
                 if (mapentry->key == NULL || (mapentry->value == NULL || TAILQ_EMPTY(mapentry->value))) {
                     continue;
                 }
 
-                printf("        %s\n", mapentry->key);
+                fprintf(fp, "        %s\n", mapentry->key);
 
                 if (mapentry->value && !TAILQ_EMPTY(mapentry->value)) {
                     TAILQ_FOREACH(entry, mapentry->value, items) {
-                        printf("            - %s\n", entry->data);
+                        fprintf(fp, "            - %s\n", entry->data);
                     }
                 }
             }
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_BADFUNCS);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_BADFUNCS);
     }
 
     /* runpath */
@@ -734,33 +765,33 @@ void dump_cfg(const struct rpminspect *ri)
         || (ri->runpath_allowed_origin_paths && !TAILQ_EMPTY(ri->runpath_allowed_origin_paths))
         || (ri->runpath_origin_prefix_trim && !TAILQ_EMPTY(ri->runpath_origin_prefix_trim))
         || mapentry != NULL) {
-        printf("runpath:\n");
+        fprintf(fp, "runpath:\n");
 
         if (ri->runpath_allowed_paths && !TAILQ_EMPTY(ri->runpath_allowed_paths)) {
-            printf("    allowed_paths:\n");
+            fprintf(fp, "    allowed_paths:\n");
 
             TAILQ_FOREACH(entry, ri->runpath_allowed_paths, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->runpath_allowed_origin_paths && !TAILQ_EMPTY(ri->runpath_allowed_origin_paths)) {
-            printf("    allowed_origin_paths:\n");
+            fprintf(fp, "    allowed_origin_paths:\n");
 
             TAILQ_FOREACH(entry, ri->runpath_allowed_origin_paths, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->runpath_origin_prefix_trim && !TAILQ_EMPTY(ri->runpath_origin_prefix_trim)) {
-            printf("    origin_prefix_trim:\n");
+            fprintf(fp, "    origin_prefix_trim:\n");
 
             TAILQ_FOREACH(entry, ri->runpath_origin_prefix_trim, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_RUNPATH);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_RUNPATH);
     }
 
     /* types */
@@ -768,8 +799,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_TYPES, mapentry);
 
     if (mapentry != NULL) {
-        printf("types:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_TYPES);
+        fprintf(fp, "types:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_TYPES);
     }
 
     /* unicode */
@@ -780,41 +811,41 @@ void dump_cfg(const struct rpminspect *ri)
         || (ri->unicode_excluded_mime_types && !TAILQ_EMPTY(ri->unicode_excluded_mime_types))
         || (ri->unicode_forbidden_codepoints && !TAILQ_EMPTY(ri->unicode_forbidden_codepoints))
         || mapentry != NULL) {
-        printf("unicode:\n");
+        fprintf(fp, "unicode:\n");
 
         if (ri->unicode_exclude) {
-            printf("    exclude: [SET]\n");
+            fprintf(fp, "    exclude: [SET]\n");
         }
 
         if (ri->unicode_excluded_mime_types && !TAILQ_EMPTY(ri->unicode_excluded_mime_types)) {
-            printf("    excluded_mime_types:\n");
+            fprintf(fp, "    excluded_mime_types:\n");
 
             TAILQ_FOREACH(entry, ri->unicode_excluded_mime_types, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (ri->unicode_forbidden_codepoints && !TAILQ_EMPTY(ri->unicode_forbidden_codepoints)) {
-            printf("    forbidden_codepoints:\n");
+            fprintf(fp, "    forbidden_codepoints:\n");
 
             TAILQ_FOREACH(entry, ri->unicode_forbidden_codepoints, items) {
-                printf("        - %s\n", entry->data);
+                fprintf(fp, "        - %s\n", entry->data);
             }
         }
 
         if (mapentry != NULL) {
-            dump_inspection_ignores(ri->inspection_ignores, NAME_UNICODE);
+            dump_inspection_ignores(fp, ri->inspection_ignores, NAME_UNICODE);
         }
     }
 
     /* rpmdeps */
 
     if (ri->deprules_ignore) {
-        printf("rpmdeps:\n");
-        printf("    ignore:\n");
+        fprintf(fp, "rpmdeps:\n");
+        fprintf(fp, "    ignore:\n");
 
         HASH_ITER(hh, ri->deprules_ignore, drentry, tmp_drentry) {
-            printf("        %s: %s\n", get_deprule_desc(drentry->type), (drentry->pattern == NULL) ? "" : drentry->pattern);
+            fprintf(fp, "        %s: %s\n", get_deprule_desc(drentry->type), (drentry->pattern == NULL) ? "" : drentry->pattern);
         }
     }
 
@@ -823,8 +854,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_VIRUS, mapentry);
 
     if (mapentry != NULL) {
-        printf("virus:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_VIRUS);
+        fprintf(fp, "virus:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_VIRUS);
     }
 
 #ifdef _WITH_LIBCAP
@@ -833,8 +864,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_CAPABILITIES, mapentry);
 
     if (mapentry != NULL) {
-        printf("capabilities:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_CAPABILITIES);
+        fprintf(fp, "capabilities:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_CAPABILITIES);
     }
 #endif
 
@@ -843,8 +874,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_CONFIG, mapentry);
 
     if (mapentry != NULL) {
-        printf("config:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_CONFIG);
+        fprintf(fp, "config:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_CONFIG);
     }
 
     /* doc */
@@ -852,8 +883,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_DOC, mapentry);
 
     if (mapentry != NULL) {
-        printf("doc:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_DOC);
+        fprintf(fp, "doc:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_DOC);
     }
 
 #ifdef _WITH_LIBKMOD
@@ -862,8 +893,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_KMOD, mapentry);
 
     if (mapentry != NULL) {
-        printf("kmod:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_KMOD);
+        fprintf(fp, "kmod:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_KMOD);
     }
 #endif
 
@@ -872,8 +903,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_PERMISSIONS, mapentry);
 
     if (mapentry != NULL) {
-        printf("permissions:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_PERMISSIONS);
+        fprintf(fp, "permissions:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_PERMISSIONS);
     }
 
     /* symlinks */
@@ -881,8 +912,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_SYMLINKS, mapentry);
 
     if (mapentry != NULL) {
-        printf("symlinks:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_SYMLINKS);
+        fprintf(fp, "symlinks:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_SYMLINKS);
     }
 
     /* upstream */
@@ -890,8 +921,8 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_UPSTREAM, mapentry);
 
     if (mapentry != NULL) {
-        printf("upstream:\n");
-        dump_inspection_ignores(ri->inspection_ignores, NAME_UPSTREAM);
+        fprintf(fp, "upstream:\n");
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_UPSTREAM);
     }
 
     /* debuginfo */
@@ -899,15 +930,15 @@ void dump_cfg(const struct rpminspect *ri)
     HASH_FIND_STR(ri->inspection_ignores, NAME_DEBUGINFO, mapentry);
 
     if (ri->debuginfo_sections || mapentry != NULL) {
-        printf("debuginfo:\n");
+        fprintf(fp, "debuginfo:\n");
 
         if (ri->debuginfo_sections) {
-            printf("    debuginfo_sections: %s\n", ri->debuginfo_sections);
+            fprintf(fp, "    debuginfo_sections: %s\n", ri->debuginfo_sections);
         }
 
-        dump_inspection_ignores(ri->inspection_ignores, NAME_DEBUGINFO);
+        dump_inspection_ignores(fp, ri->inspection_ignores, NAME_DEBUGINFO);
     }
 
-    printf("\n\n");
+    fprintf(fp, "\n\n");
     return;
 }
@@ -12,173 +12,222 @@
 #include <errno.h>
 #include <sys/types.h>
 #include <sys/stat.h>
+#include <sys/mman.h>
 #include <fcntl.h>
 #include "xdiff.h"
 #include "rpminspect.h"
 
-static int fill_mmfile(mmfile_t *mf, const char *file)
+/* Unified diff output collected by delta_out() */
+struct delta_buf {
+    strbuf_t text;
+    size_t max_bytes;
+    size_t max_hunks;
+    size_t hunks;
+    size_t dropped;
+    bool truncated;
+};
+
+/*
+ * Called by the diff engine with each hunk header and each record.
+ * The buffers of a single call are kept or dropped together so a
+ * truncated diff always ends on a whole line.  The "\ No newline at
+ * end of file" marker the engine adds after a last line without a
+ * newline is left out, the line just ends like the others.
+ */
+static int delta_out(void *priv, mmbuffer_t *mb, int nbuf)
 {
-    int fd = 0;
-    struct stat sb;
-    char *buf = NULL;
-    unsigned long size = 0;
-    int retval = 0;
+    int i = 0;
+    size_t len = 0;
+    struct delta_buf *out = priv;
 
-    mf->ptr = NULL;
-    mf->size = 0;
-    fd = open(file, O_RDONLY);
+    if (nbuf == 3 && mb[2].size > 1 && mb[2].ptr[0] == '\n' && mb[2].ptr[1] == '\\') {
+        mb[2].size = 1;
+    }
+
+    if (nbuf > 0 && mb[0].size > 3 && !strncmp(mb[0].ptr, "@@ ", 3)) {
+        out->hunks++;
+
+        if (out->max_hunks > 0 && out->hunks > out->max_hunks) {
+            out->truncated = true;
+        }
+    }
 
-    if (fd < 0) {
+    for (i = 0; i < nbuf; i++) {
+        len += mb[i].size;
+    }
+
+    if (out->max_bytes > 0 && out->text.len + len > out->max_bytes) {
+        out->truncated = true;
+    }
+
+    if (out->truncated) {
+        out->dropped += len;
         return 0;
     }
 
-    if (stat(file, &sb)) {
-        warn("stat");
-        return 1;
+    for (i = 0; i < nbuf; i++) {
+        strbuf_append_len(&out->text, mb[i].ptr, mb[i].size);
     }
 
-    /* extra byte for the \0 */
-    size = sb.st_size;
-    buf = calloc(1, size + 1);
+    return 0;
+}
+
+/*
+ * Given two buffers (a and b), generate a unified diff between them.
+ * The buffers do not need to be NUL terminated.  If opts is NULL, the
+ * output is limited to DELTA_MAX_BYTES and DELTA_MAX_HUNKS.  Output
+ * past the limits is dropped and a line noting how much was left out
+ * ends the diff.  The function returns the formatted delta or NULL if
+ * there are no differences.  The caller must free the returned
+ * string.
+ */
+char *get_buffer_delta(const char *a, const size_t alen, const char *b, const size_t blen, const delta_opts_t *opts)
+{
+    mmfile_t old;
+    mmfile_t new;
+    xpparam_t xpp;
+    xdemitconf_t xecfg;
+    xdemitcb_t ecb;
+    struct delta_buf out;
 
-    if (buf == NULL) {
-        warn("malloc");
-        return 1;
+    memset(&xpp, 0, sizeof(xpp));
+    memset(&xecfg, 0, sizeof(xecfg));
+    memset(&ecb, 0, sizeof(ecb));
+    memset(&out, 0, sizeof(out));
+
+    /* the diff engine does not modify the inputs */
+    old.ptr = (char *) ((a == NULL) ? "" : a);
+    old.size = (a == NULL) ? 0 : alen;
+    new.ptr = (char *) ((b == NULL) ? "" : b);
+    new.size = (b == NULL) ? 0 : blen;
+
+    if (opts == NULL) {
+        out.max_bytes = DELTA_MAX_BYTES;
+        out.max_hunks = DELTA_MAX_HUNKS;
+    } else {
+        out.max_bytes = opts->max_bytes;
+        out.max_hunks = opts->max_hunks;
     }
 
-    mf->ptr = buf;
-    mf->ptr[size] = '\0';
-    mf->size = size;
+    xpp.flags = XDF_IGNORE_WHITESPACE;
 
-    while (size) {
-        retval = read(fd, buf, size);
+    /* the default algorithm is quadratic in the worst case */
+    if ((opts && opts->histogram) || alen > DELTA_HISTOGRAM_SIZE || blen > DELTA_HISTOGRAM_SIZE) {
+        xpp.flags |= XDF_HISTOGRAM_DIFF;
+    }
 
-        if (retval < 0) {
-            if (errno == EINTR || errno == EAGAIN) {
-                continue;
-            }
+    xecfg.ctxlen = 3;
+    ecb.priv = &out;
+    ecb.outf = delta_out;
 
-            break;
-        }
+    if (xdl_diff(&old, &new, &xpp, &xecfg, &ecb) < 0) {
+        warn("xdl_diff");
+    }
 
-        if (!retval) {
-            break;
-        }
+    if (out.text.len == 0 && !out.truncated) {
+        strbuf_free(&out.text);
+        return NULL;
+    }
 
-        buf += retval;
-        size -= retval;
+    /* drop the trailing newline */
+    if (out.text.len > 0 && out.text.data[out.text.len - 1] == '\n') {
+        out.text.data[--out.text.len] = '\0';
     }
 
-    mf->size -= size;
+    if (out.truncated) {
+        if (out.text.len > 0) {
+            strbuf_append(&out.text, "\n");
+        }
 
-    if (close(fd) < 0) {
-        warn("close");
+        if (out.max_hunks > 0 && out.hunks > out.max_hunks) {
+            strbuf_appendf(&out.text, _("[diff truncated: %zu of %zu hunks shown, %zu bytes omitted]"), out.max_hunks, out.hunks, out.dropped);
+        } else {
+            strbuf_appendf(&out.text, _("[diff truncated: %zu bytes omitted]"), out.dropped);
+        }
     }
 
-    return 0;
+    return strbuf_finish(&out.text);
 }
 
-static int delta_out(void *priv, mmbuffer_t *mb, int nbuf)
+/*
+ * Map the named file read-only.  Missing or empty files give an empty
+ * region.  Returns false on error.
+ */
+static bool map_file(const char *file, char **data, size_t *len)
 {
-    int i = 0;
-    char *prefix = NULL;
-    string_list_t *list = (string_list_t *) priv;
-    string_entry_t *entry = NULL;
+    int fd = -1;
+    struct stat sb;
 
-    for (i = 0; i < nbuf; i++) {
-        /* single byte entries are the +/-/' ' prefix */
-        if (mb[i].size == 1 && (mb[i].ptr[0] == ' ' || mb[i].ptr[0] == '+' || mb[i].ptr[0] == '-')) {
-            switch (mb[i].ptr[0]) {
-                case ' ':
-                    prefix = " ";
-                    break;
-                case '+':
-                    prefix = "+";
-                    break;
-                case '-':
-                    prefix = "-";
-                    break;
-            }
-
-            continue;
-        }
+    *data = NULL;
+    *len = 0;
 
-        /* capture the line */
-        entry = calloc(1, sizeof(*entry));
-        assert(entry != NULL);
-
-        if ((mb[i].size > 1) && mb[i].ptr != NULL) {
-            if (prefix) {
-                xasprintf(&entry->data, "%s%s", prefix, mb[i].ptr);
-            } else {
-                entry->data = calloc(1, mb[i].size + 1);
-                assert(entry->data != NULL);
-                entry->data = strncpy(entry->data, mb[i].ptr, mb[i].size);
-            }
-        } else {
-            entry->data = strdup("");
+    fd = open(file, O_RDONLY | O_CLOEXEC);
+
+    if (fd == -1) {
+        return (errno == ENOENT);
+    }
+
+    if (fstat(fd, &sb) == -1) {
+        warn("fstat");
+        close(fd);
+        return false;
+    }
+
+    if (sb.st_size > 0) {
+        *data = mmap(NULL, sb.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+        if (*data == MAP_FAILED) {
+            warn("mmap");
+            *data = NULL;
+            close(fd);
+            return false;
         }
 
-        assert(entry->data != NULL);
-        entry->data[strcspn(entry->data, "\n")] = '\0';
-        entry->data = realloc(entry->data, strlen(entry->data) + 1);
-        TAILQ_INSERT_TAIL(list, entry, items);
-        prefix = NULL;
+        *len = sb.st_size;
     }
 
-    return 0;
+    if (close(fd) == -1) {
+        warn("close");
+    }
+
+    return true;
 }
 
 /*
- * Given two paths to files (a and b), load them and generate a
- * unified diff.  The function returns the formatted delta or NULL if
- * there are no differences.
+ * Given two paths to files (a and b), map them and generate a
+ * unified diff with the default output limits.  The function returns
+ * the formatted delta or NULL if there are no differences.
  */
 char *get_file_delta(const char *a, const char *b)
 {
-    mmfile_t old;
-    mmfile_t new;
-    xpparam_t xpp;
-    xdemitconf_t xecfg;
-    xdemitcb_t ecb;
-    string_list_t *list = NULL;
+    char *old = NULL;
+    char *new = NULL;
+    size_t oldlen = 0;
+    size_t newlen = 0;
     char *r = NULL;
 
-    if (fill_mmfile(&old, a) < 0 || fill_mmfile(&new, b) < 0) {
-        warn("fill_mmfile");
-        return NULL;
-    }
+    assert(a != NULL);
+    assert(b != NULL);
 
-    memset(&xpp, 0, sizeof(xpp));
-    memset(&xecfg, 0, sizeof(xecfg));
-    memset(&ecb, 0, sizeof(ecb));
+    if (!map_file(a, &old, &oldlen) || !map_file(b, &new, &newlen)) {
+        warnx(_("unable to read %s or %s for comparison"), a, b);
 
-    list = calloc(1, sizeof(*list));
-    assert(list != NULL);
-    TAILQ_INIT(list);
+        if (old) {
+            munmap(old, oldlen);
+        }
 
-    xpp.flags = 0;
-    xpp.flags |= XDF_IGNORE_WHITESPACE;
+        return NULL;
+    }
 
-    xecfg.ctxlen = 3;
-    ecb.priv = list;
-    ecb.outf = delta_out;
+    r = get_buffer_delta(old, oldlen, new, newlen, NULL);
 
-    if (xdl_diff(&old, &new, &xpp, &xecfg, &ecb) < 0) {
-        warn("xdl_diff");
+    if (old && munmap(old, oldlen) == -1) {
+        warn("munmap");
     }
 
-    if (TAILQ_EMPTY(list)) {
-        free(old.ptr);
-        free(new.ptr);
-        free(list);
-        return NULL;
+    if (new && munmap(new, newlen) == -1) {
+        warn("munmap");
     }
 
-    r = list_to_string(list, "\n");
-    list_free(list, free);
-    free(old.ptr);
-    free(new.ptr);
-
     return r;
 }
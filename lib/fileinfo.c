@@ -20,6 +20,15 @@ static mode_t get_interesting_perms(const mode_t mode)
     return mode & interesting;
 }
 
+/* Return the fileinfo entry for the given path, or NULL */
+static fileinfo_entry_t *get_fileinfo_entry(const struct rpminspect *ri, const char *path)
+{
+    fileinfo_entry_t *fientry = NULL;
+
+    HASH_FIND_STR(ri->fileinfo_table, path, fientry);
+    return fientry;
+}
+
 /**
  * @brief Check for the given path on the fileinfo list.  If found,
  * check the st_mode value and report accordingly.
@@ -57,34 +66,28 @@ bool match_fileinfo_mode(struct rpminspect *ri, const rpmfile_entry_t *file, con
         params.remedy = strdup(remedy);
     }
 
-    if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (file->st.st_mode == fientry->mode) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected mode %04o"), file->localpath, pkg, params.arch, perms);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
-                    add_result(ri, &params);
-                    free(params.msg);
-                    free(params.remedy);
-                    *reported = true;
-                    return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries unexpected mode %04o; expected mode %04o; requires inspection by the Security Team"), file->localpath, pkg, params.arch, perms, fientry->mode);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        free(params.remedy);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
-                }
-
-                break;
+    if (init_fileinfo(ri) && (fientry = get_fileinfo_entry(ri, file->localpath)) != NULL) {
+        if (file->st.st_mode == fientry->mode) {
+            xasprintf(&params.msg, _("%s in %s on %s carries expected mode %04o"), file->localpath, pkg, params.arch, perms);
+            params.severity = RESULT_INFO;
+            params.waiverauth = NOT_WAIVABLE;
+            add_result(ri, &params);
+            free(params.msg);
+            free(params.remedy);
+            *reported = true;
+            return true;
+        } else {
+            params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+            if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                params.waiverauth = WAIVABLE_BY_SECURITY;
+                xasprintf(&params.msg, _("%s in %s on %s carries unexpected mode %04o; expected mode %04o; requires inspection by the Security Team"), file->localpath, pkg, params.arch, perms, fientry->mode);
+                add_result(ri, &params);
+                free(params.msg);
+                free(params.remedy);
+                *result = false;
+                *reported = true;
+                return true;
             }
         }
     }
@@ -150,34 +153,28 @@ bool match_fileinfo_owner(struct rpminspect *ri, const rpmfile_entry_t *file, co
         xasprintf(&params.remedy, remedy, fname);
     }
 
-    if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (!strcmp(owner, fientry->owner)) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected owner '%s'"), file->localpath, pkg, params.arch, fientry->owner);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
-                    add_result(ri, &params);
-                    free(params.msg);
-                    free(params.remedy);
-                    *reported = true;
-                    return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries unexpected owner '%s'; expected owner '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, owner, fientry->owner);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        free(params.remedy);
-                        *result = false;
-                        *reported = true;
-                        return true;
-                    }
-                }
-
-                break;
+    if (init_fileinfo(ri) && (fientry = get_fileinfo_entry(ri, file->localpath)) != NULL) {
+        if (!strcmp(owner, fientry->owner)) {
+            xasprintf(&params.msg, _("%s in %s on %s carries expected owner '%s'"), file->localpath, pkg, params.arch, fientry->owner);
+            params.severity = RESULT_INFO;
+            params.waiverauth = NOT_WAIVABLE;
+            add_result(ri, &params);
+            free(params.msg);
+            free(params.remedy);
+            *reported = true;
+            return true;
+        } else {
+            params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+            if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                params.waiverauth = WAIVABLE_BY_SECURITY;
+                xasprintf(&params.msg, _("%s in %s on %s carries unexpected owner '%s'; expected owner '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, owner, fientry->owner);
+                add_result(ri, &params);
+                free(params.msg);
+                free(params.remedy);
+                *result = false;
+                *reported = true;
+                return true;
             }
         }
     }
@@ -244,34 +241,28 @@ bool match_fileinfo_group(struct rpminspect *ri, const rpmfile_entry_t *file, co
         xasprintf(&params.remedy, remedy, fname);
     }
 
-    if (init_fileinfo(ri)) {
-        TAILQ_FOREACH(fientry, ri->fileinfo, items) {
-            if (!strcmp(file->localpath, fientry->filename)) {
-                if (!strcmp(group, fientry->group)) {
-                    xasprintf(&params.msg, _("%s in %s on %s carries expected group '%s'"), file->localpath, pkg, params.arch, fientry->group);
-                    params.severity = RESULT_INFO;
-                    params.waiverauth = NOT_WAIVABLE;
-                    add_result(ri, &params);
-                    free(params.msg);
-                    free(params.remedy);
-                    *reported = true;
-                    return true;
-                } else {
-                    params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
-
-                    if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
-                        params.waiverauth = WAIVABLE_BY_SECURITY;
-                        xasprintf(&params.msg, _("%s in %s on %s carries group unexpected '%s'; expected group '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, group, fientry->group);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        free(params.remedy);
-                        *result = false;
-                        *reported = false;
-                        return true;
-                    }
-                }
-
-                break;
+    if (init_fileinfo(ri) && (fientry = get_fileinfo_entry(ri, file->localpath)) != NULL) {
+        if (!strcmp(group, fientry->group)) {
+            xasprintf(&params.msg, _("%s in %s on %s carries expected group '%s'"), file->localpath, pkg, params.arch, fientry->group);
+            params.severity = RESULT_INFO;
+            params.waiverauth = NOT_WAIVABLE;
+            add_result(ri, &params);
+            free(params.msg);
+            free(params.remedy);
+            *reported = true;
+            return true;
+        } else {
+            params.severity = get_secrule_result_severity(ri, file, SECRULE_MODES);
+
+            if (params.severity != RESULT_NULL && params.severity != RESULT_SKIP) {
+                params.waiverauth = WAIVABLE_BY_SECURITY;
+                xasprintf(&params.msg, _("%s in %s on %s carries group unexpected '%s'; expected group '%s'; requires inspection by the Security Team"), file->localpath, pkg, params.arch, group, fientry->group);
+                add_result(ri, &params);
+                free(params.msg);
+                free(params.remedy);
+                *result = false;
+                *reported = false;
+                return true;
             }
         }
     }
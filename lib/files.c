@@ -147,6 +147,12 @@ static struct archive *new_archive_reader(void)
  * extraction.  Returns an rpmfile_t list of all the payload members.
  * The caller is responsible for freeing this returned list.
  *
+ * When the working subdirectory is in memory, regular files that do
+ * not fit the memory budget are extracted to the spill directory on
+ * disk instead.  Their fullpath points there and a symlink to them
+ * takes their place in the working subdirectory, so tools walking the
+ * extracted tree still find them.
+ *
  * @param ri The main program data structure.
  * @param pkg Path to the RPM package to extract.
  * @param hdr RPM Header for the specified package.
@@ -164,8 +170,9 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
     struct file_data *path_entry = NULL;
     struct file_data *tmp_entry = NULL;
 
-    char *payload = NULL;
     char *hardlinkpath = NULL;
+    char *spilled = NULL;
+    char *spilldir = NULL;
     struct archive *archive = NULL;
     struct archive_entry *entry = NULL;
     const char *archive_path = NULL;
@@ -233,22 +240,12 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
     archive = new_archive_reader();
 
     if (archive_read_open_filename(archive, pkg, 10240) != ARCHIVE_OK) {
-        /* maybe the payload has large files, so try to convert */
-        payload = extract_rpm_payload(pkg);
-
-        if (payload == NULL) {
-            /* can't do anything if the payload extraction failed */
-            goto cleanup;
-        }
-
-        archive_read_free(archive);
-        archive = new_archive_reader();
-
-        if (archive_read_open_filename(archive, payload, 10240) != ARCHIVE_OK) {
-            /* still bad, so bail */
-            warnx("archive_read_open_filename: %s", archive_error_string(archive));
-            goto cleanup;
-        }
+        /*
+         * maybe the payload has large files, so extract it directly
+         * with the librpm archive reader
+         */
+        file_list = extract_rpm_payload(pkg, hdr, *output_dir);
+        goto cleanup;
     }
 
     /* Allocate space for the return value */
@@ -328,6 +325,16 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
         }
 
         xasprintf(&file_entry->fullpath, "%s%s%s", *output_dir, div, tmp);
+
+        /*
+         * too big for the memory budget, this one goes to disk; only
+         * one of the links of a hard linked file has its contents
+         */
+        if (S_ISREG(file_entry->st.st_mode) && spill_file(ri, file_entry->st.st_size, archive_entry_nlink(entry) > 1)) {
+            spilled = file_entry->fullpath;
+            file_entry->fullpath = get_spill_path(ri, spilled);
+        }
+
         archive_entry_set_pathname(entry, file_entry->fullpath);
 
         /* Ensure the resulting file is user-rw and global-unwritable */
@@ -355,9 +362,25 @@ rpmfile_t *extract_rpm(struct rpminspect *ri, const char *pkg, Header hdr, const
             file_list = NULL;
             goto cleanup;
         }
+
+        /* leave a symlink to a spilled file where it would have gone */
+        if (spilled != NULL) {
+            spilldir = strdup(spilled);
+            assert(spilldir != NULL);
+
+            if (mkdirp(dirname(spilldir), S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH) == -1 || symlink(file_entry->fullpath, spilled) == -1) {
+                warn("symlink %s", spilled);
+            }
+
+            free(spilldir);
+            free(spilled);
+            spilled = NULL;
+        }
     }
 
 cleanup:
+    free(spilled);
+
     HASH_ITER(hh, path_table, path_entry, tmp_entry) {
         HASH_DEL(path_table, path_entry);
         free(path_entry->path);
@@ -368,14 +391,6 @@ cleanup:
         archive_read_free(archive);
     }
 
-    if (payload) {
-        if (unlink(payload) == -1) {
-            warn("unlink");
-        }
-
-        free(payload);
-    }
-
     rpmtdFree(td);
 
     return file_list;
@@ -90,6 +90,9 @@ void free_rpminspect(struct rpminspect *ri)
     security_entry_t *sentry = NULL;
     secrule_t *srentry = NULL;
     secrule_t *tmp_srentry = NULL;
+    debuginfo_index_t *dentry = NULL;
+    debuginfo_index_t *tmp_dentry = NULL;
+    int i = 0;
 
     if (ri == NULL) {
         return;
@@ -104,10 +107,13 @@ void free_rpminspect(struct rpminspect *ri)
     free(ri->kojiursine);
     free(ri->kojimbs);
     free(ri->worksubdir);
+    free(ri->spilldir);
 
     free(ri->vendor_data_dir);
     list_free(ri->licensedb, free);
 
+    HASH_CLEAR(hh, ri->fileinfo_table);
+
     if (ri->fileinfo) {
         while (!TAILQ_EMPTY(ri->fileinfo)) {
             fientry = TAILQ_FIRST(ri->fileinfo);
@@ -196,6 +202,8 @@ void free_rpminspect(struct rpminspect *ri)
 
     free(ri->security_filename);
     list_free(ri->badwords, free);
+    free_matcher(ri->badwords_matcher);
+    free_string_set(ri->icons_set);
     list_free(ri->icons, free);
     free(ri->icons_filename);
 
@@ -210,6 +218,7 @@ void free_rpminspect(struct rpminspect *ri)
     free(ri->elf_path_exclude_pattern);
     list_free(ri->automacros, free);
     list_free(ri->bad_functions, free);
+    free_string_map(ri->bad_functions_set);
     free_string_list_map(ri->bad_functions_allowed);
     free(ri->manpage_path_include_pattern);
     free(ri->manpage_path_exclude_pattern);
@@ -234,6 +243,9 @@ void free_rpminspect(struct rpminspect *ri)
     list_free(ri->forbidden_path_prefixes, free);
     list_free(ri->forbidden_path_suffixes, free);
     list_free(ri->forbidden_directories, free);
+    free_matcher(ri->forbidden_path_prefixes_matcher);
+    free_matcher(ri->forbidden_path_suffixes_matcher);
+    free_matcher(ri->forbidden_directories_matcher);
     free(ri->before);
     free(ri->after);
     free(ri->product_release);
@@ -249,9 +261,12 @@ void free_rpminspect(struct rpminspect *ri)
     free(ri->annocheck_profile);
     free_string_map(ri->pathmigration);
     list_free(ri->pathmigration_excluded_paths, free);
+    free_matcher(ri->pathmigration_matcher);
+    free_matcher(ri->pathmigration_excluded_matcher);
     free_string_map(ri->products);
     list_free(ri->ignores, free);
     list_free(ri->lto_symbol_name_prefixes, free);
+    free_matcher(ri->lto_symbol_name_prefixes_matcher);
     list_free(ri->forbidden_paths, free);
     free(ri->abidiff_suppression_file);
     free(ri->abidiff_debuginfo_path);
@@ -283,11 +298,24 @@ void free_rpminspect(struct rpminspect *ri)
         free(hentry);
     }
 
+    for (i = BEFORE_BUILD; i <= AFTER_BUILD; i++) {
+        HASH_ITER(hh, ri->debuginfo_index[i], dentry, tmp_dentry) {
+            HASH_DEL(ri->debuginfo_index[i], dentry);
+            free(dentry->key);
+            free(dentry);
+        }
+    }
+
     free(ri->before_rel);
     free(ri->after_rel);
-    free_pair(ri->macros);
+    free_spec_models(ri->specs);
 
     free_results(ri->results);
+    free_string_map(ri->fingerprints);
+    free_previous_results(ri->previous);
+    free(ri->history_file);
+    free_history(ri->history);
+    free_string_map(ri->timeouts);
 
     return;
 }
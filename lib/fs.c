@@ -5,6 +5,15 @@
 
 #include <assert.h>
 #include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <unistd.h>
+#include <linux/fs.h>
+#include <linux/magic.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <sys/statfs.h>
 #include <sys/statvfs.h>
 
 #include "rpminspect.h"
@@ -25,3 +34,197 @@ unsigned long int get_available_space(const char *path)
 
     return r;
 }
+
+/**
+ * @brief Return true if path is on a memory-backed filesystem.
+ *
+ * @param path The filesystem path to check.
+ * @return True for tmpfs and ramfs, false otherwise.
+ */
+bool is_memory_fs(const char *path)
+{
+    struct statfs sfb;
+
+    assert(path != NULL);
+
+    if (statfs(path, &sfb) == -1) {
+        return false;
+    }
+
+    return (sfb.f_type == TMPFS_MAGIC || sfb.f_type == RAMFS_MAGIC);
+}
+
+/**
+ * @brief Return this user's memory-backed working directory.
+ *
+ * The directory is MEMORY_WORKDIR followed by the user ID so users
+ * do not share it.  Since /dev/shm is writable by everyone, the
+ * directory must be a real directory owned by this user that no one
+ * else can access.  Anything else is refused with a warning.
+ *
+ * @param create True to create the directory if it does not exist.
+ * @return Newly allocated path, or NULL if the directory cannot be
+ *         used.  Caller must free.
+ */
+char *get_memory_workdir(const bool create)
+{
+    char *r = NULL;
+    struct stat sb;
+
+    xasprintf(&r, "%s-%u", MEMORY_WORKDIR, (unsigned int) getuid());
+
+    if (create && mkdir(r, S_IRWXU) == -1 && errno != EEXIST) {
+        warn("mkdir %s", r);
+        free(r);
+        return NULL;
+    }
+
+    if (lstat(r, &sb) == -1) {
+        if (errno != ENOENT || create) {
+            warn("lstat %s", r);
+        }
+
+        free(r);
+        return NULL;
+    }
+
+    if (!S_ISDIR(sb.st_mode) || sb.st_uid != getuid() || (sb.st_mode & (S_IRWXG | S_IRWXO))) {
+        warnx(_("*** %s is not a private directory owned by this user"), r);
+        free(r);
+        return NULL;
+    }
+
+    if (!is_memory_fs(r)) {
+        warnx(_("*** %s is not memory-backed"), r);
+        free(r);
+        return NULL;
+    }
+
+    return r;
+}
+
+/*
+ * Make dest share the data blocks of src on filesystems that support
+ * reflinks (btrfs, XFS).  dest must not exist.
+ */
+static bool reflink_file(const char *src, const char *dest, const mode_t mode)
+{
+    int sfd = -1;
+    int dfd = -1;
+    bool r = false;
+
+    sfd = open(src, O_RDONLY | O_CLOEXEC);
+
+    if (sfd == -1) {
+        return false;
+    }
+
+    dfd = open(dest, O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, mode);
+
+    if (dfd != -1) {
+        r = (ioctl(dfd, FICLONE, sfd) == 0);
+        close(dfd);
+
+        if (!r) {
+            unlink(dest);
+        }
+    }
+
+    close(sfd);
+    return r;
+}
+
+/**
+ * @brief Give dest the contents of the regular file src as cheaply as
+ * possible.
+ *
+ * A reflink is tried first, then a hard link, and only if neither
+ * works (e.g., across filesystems) is the data copied.  Either way
+ * dest must be treated as read-only since it may share its data with
+ * src.
+ *
+ * @param src Full path to the source file.
+ * @param dest Full path to the destination, which must not exist.
+ * @return 0 on success, -1 on error.
+ */
+int clone_file(const char *src, const char *dest)
+{
+    struct stat sb;
+
+    assert(src != NULL);
+    assert(dest != NULL);
+
+    if (stat(src, &sb) == -1) {
+        warn("stat %s", src);
+        return -1;
+    }
+
+    if (reflink_file(src, dest, (sb.st_mode & 0777) | S_IRUSR | S_IWUSR)) {
+        return 0;
+    }
+
+    if (link(src, dest) == 0) {
+        return 0;
+    }
+
+    return copyfile(src, dest, true, false);
+}
+
+/**
+ * @brief Decide whether a file being extracted goes to disk.
+ *
+ * When the working subdirectory is in memory, files are extracted
+ * there while they fit in ri->workdir_memory.  A file that does not
+ * fit, or that is larger than a SPILL_DIVISOR share of the budget on
+ * its own, spills to ri->spilldir on disk instead.  Files kept in
+ * memory are counted against the budget.  A hard linked file has to
+ * stay next to its other links, so it is only counted.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param size Size of the file in bytes.
+ * @param linked True if the file is one of several hard links.
+ * @return True if the file should be extracted to disk.
+ */
+bool spill_file(struct rpminspect *ri, const off_t size, const bool linked)
+{
+    unsigned long long bytes = (size > 0) ? size : 0;
+
+    assert(ri != NULL);
+
+    if (ri->spilldir == NULL || ri->workdir_memory == 0) {
+        return false;
+    }
+
+    if (!linked && (bytes > ri->workdir_memory / SPILL_DIVISOR || ri->workdir_memory_used + bytes > ri->workdir_memory)) {
+        return true;
+    }
+
+    ri->workdir_memory_used += bytes;
+    return false;
+}
+
+/**
+ * @brief Return where a spilled file goes on disk.
+ *
+ * This is the same path under ri->spilldir that the file has under
+ * ri->worksubdir.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param path Full path of the file in ri->worksubdir.
+ * @return Newly allocated path; caller must free.
+ */
+char *get_spill_path(const struct rpminspect *ri, const char *path)
+{
+    char *r = NULL;
+    size_t len = 0;
+
+    assert(ri != NULL);
+    assert(ri->worksubdir != NULL);
+    assert(ri->spilldir != NULL);
+    assert(path != NULL);
+
+    len = strlen(ri->worksubdir);
+    assert(!strncmp(path, ri->worksubdir, len));
+    xasprintf(&r, "%s%s", ri->spilldir, path + len);
+    return r;
+}
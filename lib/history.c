@@ -0,0 +1,591 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Inspection runtime history.  After each run the wall clock time
+ * every inspection took is recorded by package name along with the
+ * number of payload files inspected and, when it ran in a child
+ * process, its peak memory use.  Later runs use the history to
+ * predict how long each inspection will take so the longest ones can
+ * be started first, and how much memory it needs so -j auto does not
+ * run more at once than fits.  The history is a small JSON file:
+ *
+ *     { "package": { "inspection": { "seconds": 1.5, "files": 120,
+ *                                    "memory": 20480, "runs": 3,
+ *                                    "updated": 1700000000 },
+ *                    ... }, ... }
+ *
+ * Only the HISTORY_PACKAGES packages and the HISTORY_ENTRIES
+ * inspections per package that ran most recently are written back,
+ * so the file does not grow without bound.
+ */
+
+#include <assert.h>
+#include <err.h>
+#include <errno.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <json.h>
+
+#include "rpminspect.h"
+
+static history_t *find_package(const struct rpminspect *ri, const char *package)
+{
+    history_t *pkg = NULL;
+
+    HASH_FIND_STR(ri->history, package, pkg);
+    return pkg;
+}
+
+static history_entry_t *find_entry(const history_t *pkg, const char *inspection)
+{
+    history_entry_t *entry = NULL;
+
+    if (pkg == NULL) {
+        return NULL;
+    }
+
+    HASH_FIND_STR(pkg->entries, inspection, entry);
+    return entry;
+}
+
+/* Find or add the history entry of an inspection on a package */
+static history_entry_t *get_entry(struct rpminspect *ri, const char *package, const char *inspection)
+{
+    history_t *pkg = NULL;
+    history_entry_t *entry = NULL;
+
+    pkg = find_package(ri, package);
+
+    if (pkg == NULL) {
+        pkg = calloc(1, sizeof(*pkg));
+        assert(pkg != NULL);
+        pkg->package = strdup(package);
+        assert(pkg->package != NULL);
+        HASH_ADD_KEYPTR(hh, ri->history, pkg->package, strlen(pkg->package), pkg);
+    }
+
+    entry = find_entry(pkg, inspection);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        assert(entry != NULL);
+        entry->inspection = strdup(inspection);
+        assert(entry->inspection != NULL);
+        HASH_ADD_KEYPTR(hh, pkg->entries, entry->inspection, strlen(entry->inspection), entry);
+    }
+
+    return entry;
+}
+
+static double get_number(json_object *jo, const char *key)
+{
+    json_object *val = NULL;
+
+    if (!json_object_object_get_ex(jo, key, &val)) {
+        return -1;
+    }
+
+    if (!json_object_is_type(val, json_type_double) && !json_object_is_type(val, json_type_int)) {
+        return -1;
+    }
+
+    return json_object_get_double(val);
+}
+
+/**
+ * @brief Return the default location of the runtime history file.
+ *
+ * This is HISTORY_FILE in the HISTORY_DIR subdirectory of
+ * $XDG_CACHE_HOME, or of ~/.cache if that is not set.
+ *
+ * @return Newly allocated path, or NULL if there is no home
+ * directory to use; caller must free.
+ */
+char *get_history_file(void)
+{
+    const char *cache = getenv("XDG_CACHE_HOME");
+    const char *home = getenv("HOME");
+    char *r = NULL;
+
+    if (cache != NULL && *cache == '/') {
+        xasprintf(&r, "%s/%s/%s", cache, HISTORY_DIR, HISTORY_FILE);
+    } else if (home != NULL && *home != '\0') {
+        xasprintf(&r, "%s/.cache/%s/%s", home, HISTORY_DIR, HISTORY_FILE);
+    }
+
+    return r;
+}
+
+/**
+ * @brief Read the runtime history in to ri->history.
+ *
+ * A missing file is not an error, the history starts out empty and
+ * is written to path by write_history().  Entries that do not parse
+ * are ignored.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param path The history file.
+ * @return False if the file exists but could not be read.
+ */
+bool read_history(struct rpminspect *ri, const char *path)
+{
+    off_t len = 0;
+    char *buf = NULL;
+    json_tokener *tok = NULL;
+    json_object *jo = NULL;
+    history_entry_t *entry = NULL;
+    double seconds = 0;
+    double files = 0;
+    double memory = 0;
+    double runs = 0;
+    double updated = 0;
+
+    assert(ri != NULL);
+    assert(path != NULL);
+
+    free(ri->history_file);
+    ri->history_file = strdup(path);
+    assert(ri->history_file != NULL);
+
+    if (access(path, F_OK) == -1) {
+        return true;
+    }
+
+    buf = read_file_bytes(path, &len);
+
+    if (buf == NULL) {
+        return (len == 0);
+    }
+
+    tok = json_tokener_new();
+    assert(tok != NULL);
+    jo = json_tokener_parse_ex(tok, buf, len);
+
+    if (json_tokener_get_error(tok) != json_tokener_success || !json_object_is_type(jo, json_type_object)) {
+        warnx(_("*** ignoring unreadable runtime history %s"), path);
+        json_object_put(jo);
+        json_tokener_free(tok);
+        free(buf);
+        return false;
+    }
+
+    json_object_object_foreach(jo, package, jp) {
+        if (!json_object_is_type(jp, json_type_object)) {
+            continue;
+        }
+
+        json_object_object_foreach(jp, inspection, ji) {
+            seconds = get_number(ji, "seconds");
+            files = get_number(ji, "files");
+            memory = get_number(ji, "memory");
+            runs = get_number(ji, "runs");
+            updated = get_number(ji, "updated");
+
+            if (seconds < 0 || files < 0 || runs < 1) {
+                continue;
+            }
+
+            entry = get_entry(ri, package, inspection);
+            entry->seconds = seconds;
+            entry->files = files;
+            entry->memory = (memory > 0) ? memory : 0;
+            entry->runs = (runs > HISTORY_RUNS) ? HISTORY_RUNS : (unsigned int) runs;
+            entry->updated = (updated > 0) ? (time_t) updated : 0;
+        }
+    }
+
+    json_object_put(jo);
+    json_tokener_free(tok);
+    free(buf);
+    return true;
+}
+
+/**
+ * @brief Record how long an inspection took on a package.
+ *
+ * The runtime and file count are folded in to a moving average over
+ * the last HISTORY_RUNS runs.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param package The package name.
+ * @param inspection The inspection name.
+ * @param seconds The wall clock runtime of the inspection.
+ * @param files The number of payload files in the builds.
+ */
+void record_runtime(struct rpminspect *ri, const char *package, const char *inspection, const double seconds, const unsigned long files)
+{
+    history_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(package != NULL);
+    assert(inspection != NULL);
+
+    entry = get_entry(ri, package, inspection);
+
+    if (entry->runs < HISTORY_RUNS) {
+        entry->runs++;
+    }
+
+    entry->seconds += (seconds - entry->seconds) / entry->runs;
+    entry->files += (files - entry->files) / entry->runs;
+    entry->updated = time(NULL);
+    return;
+}
+
+/**
+ * @brief Record the peak memory use of an inspection on a package.
+ *
+ * Call this after record_runtime() for the same run, the memory use
+ * is folded in to the same moving average.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param package The package name.
+ * @param inspection The inspection name.
+ * @param kib The peak resident set size of the inspection in KiB.
+ */
+void record_memory(struct rpminspect *ri, const char *package, const char *inspection, const unsigned long kib)
+{
+    history_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(package != NULL);
+    assert(inspection != NULL);
+
+    entry = get_entry(ri, package, inspection);
+
+    if (entry->memory == 0 || entry->runs < 2) {
+        entry->memory = kib;
+    } else {
+        entry->memory += (kib - entry->memory) / entry->runs;
+    }
+
+    return;
+}
+
+/**
+ * @brief Predict how long an inspection will take on a package.
+ *
+ * If the inspection has run on the package before, the average
+ * runtime is scaled by the change in the number of files.  Otherwise
+ * the prediction is the number of files times the average cost per
+ * file of the inspection across all packages in the history.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param package The package name.
+ * @param inspection The inspection name.
+ * @param files The number of payload files in the builds.
+ * @return The predicted runtime in seconds, or -1 if there is no
+ * history to go on.
+ */
+double predict_runtime(const struct rpminspect *ri, const char *package, const char *inspection, const unsigned long files)
+{
+    history_t *pkg = NULL;
+    history_t *tmp_pkg = NULL;
+    history_entry_t *entry = NULL;
+    double seconds = 0;
+    double total = 0;
+
+    assert(ri != NULL);
+    assert(inspection != NULL);
+
+    if (package != NULL) {
+        entry = find_entry(find_package(ri, package), inspection);
+
+        if (entry != NULL) {
+            if (entry->files >= 1 && files > 0) {
+                return entry->seconds * files / entry->files;
+            }
+
+            return entry->seconds;
+        }
+    }
+
+    HASH_ITER(hh, ri->history, pkg, tmp_pkg) {
+        entry = find_entry(pkg, inspection);
+
+        if (entry != NULL && entry->files >= 1) {
+            seconds += entry->seconds;
+            total += entry->files;
+        }
+    }
+
+    if (total < 1) {
+        return -1;
+    }
+
+    return seconds * files / total;
+}
+
+/**
+ * @brief Predict the peak memory use of an inspection on a package.
+ *
+ * This is what it used on the package before, or the average across
+ * all packages in the history if it has not run on this one.  Memory
+ * use is not scaled by the number of files, it depends more on the
+ * largest file than on how many there are.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param package The package name.
+ * @param inspection The inspection name.
+ * @return The predicted peak memory use in KiB, or -1 if there is no
+ * history to go on.
+ */
+double predict_memory(const struct rpminspect *ri, const char *package, const char *inspection)
+{
+    history_t *pkg = NULL;
+    history_t *tmp_pkg = NULL;
+    history_entry_t *entry = NULL;
+    double memory = 0;
+    unsigned int n = 0;
+
+    assert(ri != NULL);
+    assert(inspection != NULL);
+
+    if (package != NULL) {
+        entry = find_entry(find_package(ri, package), inspection);
+
+        if (entry != NULL && entry->memory > 0) {
+            return entry->memory;
+        }
+    }
+
+    HASH_ITER(hh, ri->history, pkg, tmp_pkg) {
+        entry = find_entry(pkg, inspection);
+
+        if (entry != NULL && entry->memory > 0) {
+            memory += entry->memory;
+            n++;
+        }
+    }
+
+    if (n == 0) {
+        return -1;
+    }
+
+    return memory / n;
+}
+
+/* When any inspection last ran on a package */
+static time_t package_updated(const history_t *pkg)
+{
+    time_t r = 0;
+    history_entry_t *entry = NULL;
+    history_entry_t *tmp_entry = NULL;
+
+    HASH_ITER(hh, pkg->entries, entry, tmp_entry) {
+        if (entry->updated > r) {
+            r = entry->updated;
+        }
+    }
+
+    return r;
+}
+
+/* Sort packages, most recently inspected first */
+static int cmp_packages(const void *a, const void *b)
+{
+    time_t ta = package_updated(*(history_t * const *) a);
+    time_t tb = package_updated(*(history_t * const *) b);
+
+    return (ta < tb) - (ta > tb);
+}
+
+/* Sort entries, most recently run first */
+static int cmp_entries(const void *a, const void *b)
+{
+    time_t ta = (*(history_entry_t * const *) a)->updated;
+    time_t tb = (*(history_entry_t * const *) b)->updated;
+
+    return (ta < tb) - (ta > tb);
+}
+
+/**
+ * @brief Write ri->history back to the file it was read from.
+ *
+ * The file is replaced atomically so concurrent runs never see a
+ * partial history, the last one to finish wins.  Only the packages
+ * and inspections that ran most recently are kept, see
+ * HISTORY_PACKAGES and HISTORY_ENTRIES.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @return True on success, false otherwise.
+ */
+bool write_history(const struct rpminspect *ri)
+{
+    int fd = -1;
+    bool r = false;
+    char *dir = NULL;
+    char *tmp = NULL;
+    const char *s = NULL;
+    size_t len = 0;
+    json_object *jo = NULL;
+    json_object *jp = NULL;
+    json_object *ji = NULL;
+    history_t *pkg = NULL;
+    history_t *tmp_pkg = NULL;
+    history_entry_t *entry = NULL;
+    history_entry_t *tmp_entry = NULL;
+    history_t **pkgs = NULL;
+    history_entry_t **entries = NULL;
+    size_t npkgs = 0;
+    size_t nentries = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    assert(ri != NULL);
+
+    if (ri->history_file == NULL) {
+        return false;
+    }
+
+    jo = json_object_new_object();
+    assert(jo != NULL);
+
+    /* keep the most recent packages */
+    npkgs = HASH_COUNT(ri->history);
+    pkgs = calloc(npkgs + 1, sizeof(*pkgs));
+    assert(pkgs != NULL);
+
+    HASH_ITER(hh, ri->history, pkg, tmp_pkg) {
+        pkgs[i++] = pkg;
+    }
+
+    qsort(pkgs, npkgs, sizeof(*pkgs), cmp_packages);
+
+    if (npkgs > HISTORY_PACKAGES) {
+        npkgs = HISTORY_PACKAGES;
+    }
+
+    for (i = 0; i < npkgs; i++) {
+        pkg = pkgs[i];
+        jp = json_object_new_object();
+        assert(jp != NULL);
+
+        /* and the most recent inspections of each */
+        nentries = HASH_COUNT(pkg->entries);
+        entries = calloc(nentries + 1, sizeof(*entries));
+        assert(entries != NULL);
+        j = 0;
+
+        HASH_ITER(hh, pkg->entries, entry, tmp_entry) {
+            entries[j++] = entry;
+        }
+
+        qsort(entries, nentries, sizeof(*entries), cmp_entries);
+
+        if (nentries > HISTORY_ENTRIES) {
+            nentries = HISTORY_ENTRIES;
+        }
+
+        for (j = 0; j < nentries; j++) {
+            entry = entries[j];
+            ji = json_object_new_object();
+            assert(ji != NULL);
+            json_object_object_add(ji, "seconds", json_object_new_double(entry->seconds));
+            json_object_object_add(ji, "files", json_object_new_double(entry->files));
+
+            if (entry->memory > 0) {
+                json_object_object_add(ji, "memory", json_object_new_double(entry->memory));
+            }
+
+            json_object_object_add(ji, "runs", json_object_new_int(entry->runs));
+
+            if (entry->updated > 0) {
+                json_object_object_add(ji, "updated", json_object_new_int64(entry->updated));
+            }
+
+            json_object_object_add(jp, entry->inspection, ji);
+        }
+
+        free(entries);
+        json_object_object_add(jo, pkg->package, jp);
+    }
+
+    free(pkgs);
+
+    s = json_object_to_json_string_ext(jo, JSON_C_TO_STRING_PRETTY);
+    len = strlen(s);
+
+    /* dirname() may modify its argument */
+    tmp = strdup(ri->history_file);
+    assert(tmp != NULL);
+    dir = strdup(dirname(tmp));
+    assert(dir != NULL);
+    free(tmp);
+    tmp = NULL;
+
+    if (mkdirp(dir, S_IRWXU) == -1) {
+        warn("mkdirp %s", dir);
+        goto out;
+    }
+
+    xasprintf(&tmp, "%s.XXXXXX", ri->history_file);
+    fd = mkstemp(tmp);
+
+    if (fd == -1) {
+        warn("mkstemp %s", tmp);
+        goto out;
+    }
+
+    if (write(fd, s, len) != (ssize_t) len || write(fd, "\n", 1) != 1) {
+        warn("write %s", tmp);
+        close(fd);
+        unlink(tmp);
+        goto out;
+    }
+
+    if (close(fd) == -1) {
+        warn("close %s", tmp);
+        unlink(tmp);
+        goto out;
+    }
+
+    if (rename(tmp, ri->history_file) == -1) {
+        warn("rename %s", ri->history_file);
+        unlink(tmp);
+        goto out;
+    }
+
+    r = true;
+
+out:
+    json_object_put(jo);
+    free(dir);
+    free(tmp);
+    return r;
+}
+
+/**
+ * @brief Free the runtime history.
+ *
+ * @param history The history table, may be NULL.
+ */
+void free_history(history_t *history)
+{
+    history_t *pkg = NULL;
+    history_t *tmp_pkg = NULL;
+    history_entry_t *entry = NULL;
+    history_entry_t *tmp_entry = NULL;
+
+    HASH_ITER(hh, history, pkg, tmp_pkg) {
+        HASH_ITER(hh, pkg->entries, entry, tmp_entry) {
+            HASH_DEL(pkg->entries, entry);
+            free(entry->inspection);
+            free(entry);
+        }
+
+        HASH_DEL(history, pkg);
+        free(pkg->package);
+        free(pkg);
+    }
+
+    return;
+}
@@ -555,6 +555,109 @@ static inline void handle_inspections(struct rpminspect *ri, parser_plugin *p, p
     return;
 }
 
+/* lambda for the timeouts config section */
+static bool timeouts_cb(const char *key, const char *value, void *cb_data)
+{
+    struct rpminspect *ri = cb_data;
+    string_map_t *entry = NULL;
+    unsigned long seconds = 0;
+    uint64_t tests = 0;
+    char *end = NULL;
+
+    errno = 0;
+    seconds = strtoul(value, &end, 10);
+
+    if (errno != 0 || end == value || *end != '\0' || seconds > UINT_MAX) {
+        warnx(_("*** ignoring invalid %s timeout: `%s`"), key, value);
+        return false;
+    }
+
+    if (!strcmp(key, TIMEOUT_COMMAND)) {
+        ri->command_timeout = seconds;
+        return false;
+    }
+
+    if (strcmp(key, TIMEOUT_DEFAULT) && !process_inspection_flag(key, false, &tests)) {
+        warnx(_("*** ignoring timeout for unknown inspection `%s`"), key);
+        return false;
+    }
+
+    HASH_FIND_STR(ri->timeouts, key, entry);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        assert(entry != NULL);
+        entry->key = strdup(key);
+        assert(entry->key != NULL);
+        HASH_ADD_KEYPTR(hh, ri->timeouts, entry->key, strlen(entry->key), entry);
+    } else {
+        free(entry->value);
+    }
+
+    entry->value = strdup(value);
+    assert(entry->value != NULL);
+    return false;
+}
+
+/*
+ * Compile the configuration lists that are matched against strings
+ * and paths.  Called once all configuration files are read.
+ */
+static void compile_matchers(struct rpminspect *ri)
+{
+    const char *pattern = NULL;
+    char *old = NULL;
+    string_entry_t *entry = NULL;
+    string_map_t *hentry = NULL;
+    string_map_t *tmp_hentry = NULL;
+
+    assert(ri != NULL);
+
+    ri->badwords_matcher = list_to_matcher(ri->badwords, MATCHER_SUBSTRING, true);
+    ri->forbidden_path_suffixes_matcher = list_to_matcher(ri->forbidden_path_suffixes, MATCHER_SUFFIX, false);
+    ri->forbidden_directories_matcher = list_to_matcher(ri->forbidden_directories, MATCHER_SUFFIX, false);
+    ri->pathmigration_excluded_matcher = list_to_matcher(ri->pathmigration_excluded_paths, MATCHER_PREFIX, false);
+    ri->lto_symbol_name_prefixes_matcher = list_to_matcher(ri->lto_symbol_name_prefixes, MATCHER_PREFIX, false);
+
+    /* forbidden path prefixes are matched without leading slashes */
+    if (ri->forbidden_path_prefixes && !TAILQ_EMPTY(ri->forbidden_path_prefixes)) {
+        ri->forbidden_path_prefixes_matcher = new_matcher(MATCHER_PREFIX, false);
+
+        TAILQ_FOREACH(entry, ri->forbidden_path_prefixes, items) {
+            pattern = entry->data;
+
+            while (*pattern == '/') {
+                pattern++;
+            }
+
+            add_matcher_pattern(ri->forbidden_path_prefixes_matcher, pattern, entry->data);
+        }
+
+        compile_matcher(ri->forbidden_path_prefixes_matcher);
+    }
+
+    /* path migrations match the old path as a directory */
+    if (ri->pathmigration) {
+        ri->pathmigration_matcher = new_matcher(MATCHER_PREFIX, false);
+
+        HASH_ITER(hh, ri->pathmigration, hentry, tmp_hentry) {
+            if (strsuffix(hentry->key, "/")) {
+                old = strdup(hentry->key);
+                assert(old != NULL);
+            } else {
+                xasprintf(&old, "%s/", hentry->key);
+            }
+
+            add_matcher_pattern(ri->pathmigration_matcher, old, hentry);
+            free(old);
+        }
+
+        compile_matcher(ri->pathmigration_matcher);
+    }
+
+    return;
+}
+
 /* lambda for adding entries from the badfuncs_allowed configuration. */
 static bool badfuncs_allowed_cb(const char *key, const char *value, void *cb_data)
 {
@@ -564,6 +667,38 @@ static bool badfuncs_allowed_cb(const char *key, const char *value, void *cb_dat
     return false;
 }
 
+/*
+ * Parse a size in bytes with an optional K, M, G, or T suffix for
+ * powers of 1024.  Returns false if the string is not a size.
+ */
+static bool parse_size(const char *s, unsigned long long *size)
+{
+    const char *units = "KMGT";
+    const char *unit = NULL;
+    unsigned long long r = 0;
+    char *end = NULL;
+
+    errno = 0;
+    r = strtoull(s, &end, 10);
+
+    if (errno != 0 || end == s) {
+        return false;
+    }
+
+    if (*end != '\0') {
+        unit = strchr(units, toupper(*end));
+
+        if (unit == NULL || *(end + 1) != '\0') {
+            return false;
+        }
+
+        r <<= 10 * (unit - units + 1);
+    }
+
+    *size = r;
+    return true;
+}
+
 /*
  * Read either the main configuration file or a configuration file
  * overlay (profile) and populate the struct rpminspect members.
@@ -573,6 +708,7 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
     parser_plugin *p = NULL;
     parser_context *ctx = NULL;
     char *s = NULL;
+    char *end = NULL;
     tabledict_cb_data annocheck_cb_data = { false, false, &ri->annocheck };
 
     assert(ri != NULL);
@@ -587,10 +723,60 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
 
     /* Processing order doesn't matter, so match data/generic.yaml. */
     strget(p, ctx, "common", "workdir", &ri->workdir);
+
+    s = p->getstr(ctx, "common", "workdir_memory");
+
+    if (s != NULL) {
+        if (!parse_size(s, &ri->workdir_memory)) {
+            warnx(_("*** ignoring invalid workdir_memory: `%s`"), s);
+        }
+
+        free(s);
+    }
+
     strget(p, ctx, "common", "profiledir", &ri->profiledir);
+
+    s = p->getstr(ctx, "common", "history");
+
+    if (s != NULL) {
+        if (!strcasecmp(s, "off")) {
+            ri->use_history = false;
+        } else if (!strcasecmp(s, "on")) {
+            ri->use_history = true;
+        } else {
+            warnx(_("*** history must be 'on' or 'off'; ignoring '%s'"), s);
+        }
+
+        free(s);
+    }
     strget(p, ctx, "koji", "hub", &ri->kojihub);
     strget(p, ctx, "koji", "download_ursine", &ri->kojiursine);
     strget(p, ctx, "koji", "download_mbs", &ri->kojimbs);
+
+    s = p->getstr(ctx, "koji", "download_connections");
+
+    if (s != NULL) {
+        errno = 0;
+        ri->download_connections = strtoul(s, &end, 10);
+
+        if (errno != 0 || end == s || *end != '\0') {
+            warnx(_("*** ignoring invalid download_connections: `%s`"), s);
+            ri->download_connections = 0;
+        }
+
+        free(s);
+    }
+
+    s = p->getstr(ctx, "koji", "download_bandwidth");
+
+    if (s != NULL) {
+        if (!parse_size(s, &ri->download_bandwidth)) {
+            warnx(_("*** ignoring invalid download_bandwidth: `%s`"), s);
+        }
+
+        free(s);
+    }
+
     strget(p, ctx, "commands", "msgunfmt", &ri->commands.msgunfmt);
     strget(p, ctx, "commands", "desktop-file-validate", &ri->commands.desktop_file_validate);
     strget(p, ctx, "commands", "abidiff", &ri->commands.abidiff);
@@ -622,6 +808,11 @@ static void read_cfgfile(struct rpminspect *ri, const char *filename)
     }
 
     handle_inspections(ri, p, ctx);
+
+    if (p->strdict_foreach(ctx, "timeouts", NULL, timeouts_cb, ri)) {
+        warnx(_("malformed timeouts section"));
+    }
+
     tabledict(p, ctx, "products", NULL, &ri->products, false, false);
     array(p, ctx, "macrofiles", NULL, &ri->macrofiles);
     array(p, ctx, "ignore", NULL, &ri->ignores);
@@ -884,16 +1075,19 @@ bool init_fileinfo(struct rpminspect *ri)
     char *fnpart = NULL;
     fileinfo_field_t field = MODE;
     fileinfo_entry_t *fientry = NULL;
+    fileinfo_entry_t *found = NULL;
 
     assert(ri != NULL);
     assert(ri->vendor_data_dir != NULL);
     assert(ri->product_release != NULL);
 
-    /* already initialized */
-    if (ri->fileinfo) {
-        return true;
+    /* already initialized, or already found to be missing */
+    if (ri->fileinfo_initialized) {
+        return (ri->fileinfo != NULL);
     }
 
+    ri->fileinfo_initialized = true;
+
     /* the actual fileinfo file */
     if (ri->fileinfo_filename == NULL) {
         xasprintf(&ri->fileinfo_filename, "%s/%s/%s", ri->vendor_data_dir, FILEINFO_DIR, ri->product_release);
@@ -961,7 +1155,7 @@ bool init_fileinfo(struct rpminspect *ri)
                     free(fientry->owner);
                     free(fientry->group);
                     free(fientry);
-                    entry = NULL;
+                    fientry = NULL;
                 } else {
                     fientry->filename = strdup(token);
                 }
@@ -972,9 +1166,17 @@ bool init_fileinfo(struct rpminspect *ri)
             field++;
         }
 
-        /* add the entry */
+        /* add the entry, only the first entry for a file is used */
         if (fientry != NULL) {
             TAILQ_INSERT_TAIL(ri->fileinfo, fientry, items);
+
+            if (fientry->filename != NULL) {
+                HASH_FIND_STR(ri->fileinfo_table, fientry->filename, found);
+
+                if (found == NULL) {
+                    HASH_ADD_KEYPTR(hh, ri->fileinfo_table, fientry->filename, strlen(fientry->filename), fientry);
+                }
+            }
         }
 
         /* clean up */
@@ -1008,11 +1210,13 @@ bool init_caps(struct rpminspect *ri)
     assert(ri->vendor_data_dir != NULL);
     assert(ri->product_release != NULL);
 
-    /* already initialized */
-    if (ri->caps) {
-        return true;
+    /* already initialized, or already found to be missing */
+    if (ri->caps_initialized) {
+        return (ri->caps != NULL);
     }
 
+    ri->caps_initialized = true;
+
     /* the actual caps list file */
     if (ri->caps_filename == NULL) {
         xasprintf(&ri->caps_filename, "%s/%s/%s", ri->vendor_data_dir, CAPABILITIES_DIR, ri->product_release);
@@ -1142,11 +1346,13 @@ bool init_rebaseable(struct rpminspect *ri)
     assert(ri->vendor_data_dir != NULL);
     assert(ri->product_release != NULL);
 
-    /* already initialized */
-    if (ri->rebaseable) {
-        return true;
+    /* already initialized, or already found to be missing */
+    if (ri->rebaseable_initialized) {
+        return (ri->rebaseable != NULL);
     }
 
+    ri->rebaseable_initialized = true;
+
     /* the actual rebaseable list file */
     if (ri->rebaseable_filename == NULL) {
         xasprintf(&ri->rebaseable_filename, "%s/%s/%s", ri->vendor_data_dir, REBASEABLE_DIR, ri->product_release);
@@ -1205,11 +1411,13 @@ bool init_politics(struct rpminspect *ri)
     assert(ri->vendor_data_dir != NULL);
     assert(ri->product_release != NULL);
 
-    /* already initialized */
-    if (ri->politics) {
-        return true;
+    /* already initialized, or already found to be missing */
+    if (ri->politics_initialized) {
+        return (ri->politics != NULL);
     }
 
+    ri->politics_initialized = true;
+
     /* the actual politics file */
     xasprintf(&ri->politics_filename, "%s/%s/%s", ri->vendor_data_dir, POLITICS_DIR, ri->product_release);
     assert(ri->politics_filename != NULL);
@@ -1479,11 +1687,13 @@ bool init_icons(struct rpminspect *ri)
     assert(ri->vendor_data_dir != NULL);
     assert(ri->product_release != NULL);
 
-    /* already initialized */
-    if (ri->icons) {
-        return true;
+    /* already initialized, or already found to be missing */
+    if (ri->icons_initialized) {
+        return (ri->icons != NULL);
     }
 
+    ri->icons_initialized = true;
+
     /* the actual icons list file */
     xasprintf(&ri->icons_filename, "%s/%s/%s", ri->vendor_data_dir, ICONS_DIR, ri->product_release);
     assert(ri->icons_filename != NULL);
@@ -1518,6 +1728,7 @@ bool init_icons(struct rpminspect *ri)
     }
 
     list_free(contents, free);
+    ri->icons_set = list_to_set(ri->icons);
 
     return true;
 }
@@ -1540,6 +1751,9 @@ struct rpminspect *calloc_rpminspect(struct rpminspect *ri)
     ri->vendor_data_dir = strdup(VENDOR_DATA_DIR);
     ri->favor_release = FAVOR_NEWEST;
     ri->tests = ~0;
+    ri->skipped_tests = ~0;
+    ri->jobs = 1;
+    ri->use_history = true;
     ri->desktop_entry_files_dir = strdup(DESKTOP_ENTRY_FILES_DIR);
     ri->bin_paths = list_from_array(BIN_PATHS);
     ri->bin_owner = strdup(BIN_OWNER);
@@ -1677,6 +1891,12 @@ struct rpminspect *init_rpminspect(struct rpminspect *ri, const char *cfgfile, c
         }
     }
 
+    /* compile the forbidden function list for symbol lookups */
+    ri->bad_functions_set = list_to_table(ri->bad_functions);
+
+    /* compile the lists used to match strings and paths */
+    compile_matchers(ri);
+
     /* the rest of the members are used at runtime */
     ri->threshold = RESULT_VERIFY;
     ri->worst_result = RESULT_OK;
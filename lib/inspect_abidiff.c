@@ -358,6 +358,11 @@ bool inspect_abidiff(struct rpminspect *ri)
     list_free(suppressions, free);
     free_pair(before_headers);
     free_pair(after_headers);
+    abi = NULL;
+    cmdprefix = NULL;
+    suppressions = NULL;
+    before_headers = NULL;
+    after_headers = NULL;
 
     /* report the inspection results */
     if (result) {
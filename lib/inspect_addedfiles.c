@@ -18,23 +18,21 @@ static bool reported = false;
 static char *remedy_addedfiles = NULL;
 
 /*
- * Check the given file to see if the path has any forbidden directory in it.
+ * Check the given file to see if the path has any forbidden directory
+ * in it.  Returns the first forbidden directory in the configuration
+ * that the file or one of its parent directories ends with, or NULL.
  */
-static bool have_forbidden_directory(const rpmfile_entry_t *file, const char *forbidden)
+static const char *have_forbidden_directory(const struct rpminspect *ri, const rpmfile_entry_t *file)
 {
-    bool r = false;
+    const matcher_pattern_t *match = NULL;
+    const matcher_pattern_t *first = NULL;
     char *local = NULL;
     char *full = NULL;
     char *tmp = NULL;
     struct stat sb;
 
+    assert(ri != NULL);
     assert(file != NULL);
-    assert(forbidden != NULL);
-
-    /* first see if the actual rpm file is the forbidden directory */
-    if (stat(file->fullpath, &sb) == 0 && S_ISDIR(sb.st_mode) && strsuffix(file->localpath, forbidden)) {
-        return true;
-    }
 
     /* copy paths for the loop below */
     local = strdup(file->localpath);
@@ -42,18 +40,19 @@ static bool have_forbidden_directory(const rpmfile_entry_t *file, const char *fo
     full = strdup(file->fullpath);
     assert(full != NULL);
 
-    /* walk the path backwards checking for the forbidden directory */
+    /* walk the path backwards checking for forbidden directories */
     while (full && local) {
         /* path component is a directory and is a forbidden one */
-        if (stat(full, &sb) == 0 && S_ISDIR(sb.st_mode) && strsuffix(full, forbidden)) {
-            r = true;
-            break;
+        match = match_first(ri->forbidden_directories_matcher, full);
+
+        if (match && (first == NULL || match < first) && stat(full, &sb) == 0 && S_ISDIR(sb.st_mode)) {
+            first = match;
         }
 
         /* back up the path */
         tmp = strrchr(local, '/');
 
-        if (tmp == local) {
+        if (tmp == NULL || tmp == local) {
             break;
         } else {
             *tmp = '\0';
@@ -65,7 +64,7 @@ static bool have_forbidden_directory(const rpmfile_entry_t *file, const char *fo
     free(local);
     free(full);
 
-    return r;
+    return (first == NULL) ? NULL : first->data;
 }
 
 /*
@@ -77,7 +76,9 @@ static bool addedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     bool ignore = false;
     const char *name = NULL;
     char *subpath = NULL;
-    char *localpath = NULL;
+    const char *localpath = NULL;
+    const char *forbidden = NULL;
+    const matcher_pattern_t *match = NULL;
     const char *arch = NULL;
     bool peer_new = false;
     string_entry_t *entry = NULL;
@@ -127,60 +128,45 @@ static bool addedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     if (!ignore) {
         /* Check for any forbidden path prefixes */
-        if (ri->forbidden_path_prefixes && (ri->tests & INSPECT_ADDEDFILES)) {
-            TAILQ_FOREACH(entry, ri->forbidden_path_prefixes, items) {
-                subpath = entry->data;
-                localpath = file->localpath;
-
-                /* ensure the paths do not start with '/' */
-                if (*subpath == '/') {
-                    while (*subpath == '/') {
-                        subpath++;
-                    }
-                }
+        if (ri->forbidden_path_prefixes_matcher && (ri->tests & INSPECT_ADDEDFILES)) {
+            /* the prefixes are matched without leading slashes */
+            localpath = file->localpath;
 
-                if (*localpath == '/') {
-                    while (*localpath == '/') {
-                        localpath++;
-                    }
-                }
+            while (*localpath == '/') {
+                localpath++;
+            }
 
-                if (strprefix(localpath, subpath)) {
-                    xasprintf(&params.msg, _("Packages should not contain files or directories starting with `%s` on %s in %s: %s"), entry->data, arch, name, file->localpath);
-                    params.noun = _("invalid directory ${FILE} on ${ARCH}");
-                    add_result(ri, &params);
-                    result = !(params.severity >= RESULT_VERIFY);
-                    reported = true;
-                    goto done;
-                }
+            if ((match = match_first(ri->forbidden_path_prefixes_matcher, localpath)) != NULL) {
+                xasprintf(&params.msg, _("Packages should not contain files or directories starting with `%s` on %s in %s: %s"), (const char *) match->data, arch, name, file->localpath);
+                params.noun = _("invalid directory ${FILE} on ${ARCH}");
+                add_result(ri, &params);
+                result = !(params.severity >= RESULT_VERIFY);
+                reported = true;
+                goto done;
             }
         }
 
         /* Check for any forbidden path suffixes */
-        if (ri->forbidden_path_suffixes && (ri->tests & INSPECT_ADDEDFILES)) {
-            TAILQ_FOREACH(entry, ri->forbidden_path_suffixes, items) {
-                if (strsuffix(file->localpath, entry->data)) {
-                    xasprintf(&params.msg, _("Packages should not contain files or directories ending with `%s` on %s in %s: %s"), entry->data, arch, name, file->localpath);
-                    params.noun = _("invalid directory ${FILE} on ${ARCH}");
-                    add_result(ri, &params);
-                    result = !(params.severity >= RESULT_VERIFY);
-                    reported = true;
-                    goto done;
-                }
+        if (ri->forbidden_path_suffixes_matcher && (ri->tests & INSPECT_ADDEDFILES)) {
+            if ((match = match_first(ri->forbidden_path_suffixes_matcher, file->localpath)) != NULL) {
+                xasprintf(&params.msg, _("Packages should not contain files or directories ending with `%s` on %s in %s: %s"), (const char *) match->data, arch, name, file->localpath);
+                params.noun = _("invalid directory ${FILE} on ${ARCH}");
+                add_result(ri, &params);
+                result = !(params.severity >= RESULT_VERIFY);
+                reported = true;
+                goto done;
             }
         }
 
         /* Check for any forbidden directories */
-        if (ri->forbidden_directories && (ri->tests & INSPECT_ADDEDFILES)) {
-            TAILQ_FOREACH(entry, ri->forbidden_directories, items) {
-                if (have_forbidden_directory(file, entry->data)) {
-                    xasprintf(&params.msg, _("Forbidden directory `%s` found on %s in %s: %s"), entry->data, arch, name, file->localpath);
-                    params.noun = _("forbidden directory ${FILE} on ${ARCH}");
-                    add_result(ri, &params);
-                    result = !(params.severity >= RESULT_VERIFY);
-                    reported = true;
-                    goto done;
-                }
+        if (ri->forbidden_directories_matcher && (ri->tests & INSPECT_ADDEDFILES)) {
+            if ((forbidden = have_forbidden_directory(ri, file)) != NULL) {
+                xasprintf(&params.msg, _("Forbidden directory `%s` found on %s in %s: %s"), forbidden, arch, name, file->localpath);
+                params.noun = _("forbidden directory ${FILE} on ${ARCH}");
+                add_result(ri, &params);
+                result = !(params.severity >= RESULT_VERIFY);
+                reported = true;
+                goto done;
             }
         }
     }
@@ -245,6 +231,9 @@ bool inspect_addedfiles(struct rpminspect *ri)
     bool result;
     struct result_params params;
 
+    /* state left over from a previous run */
+    reported = false;
+
     xasprintf(&remedy_addedfiles, REMEDY_ADDEDFILES, ri->fileinfo_filename ? ri->fileinfo_filename : _("the fileinfo list"));
     assert(remedy_addedfiles != NULL);
     result = foreach_peer_file(ri, NAME_ADDEDFILES, addedfiles_driver);
@@ -16,8 +16,25 @@
 
 #include "rpminspect.h"
 
+/*
+ * One queued annocheck run of a test on a file.  All runs are queued
+ * up front and run concurrently, then the driver reports on them.
+ */
+typedef struct _annocheck_job_t {
+    char *key;                   /* "<test>:<fullpath>" */
+    struct rpminspect *ri;
+    const rpmfile_entry_t *file;
+    const char *opts;            /* options for this annocheck test */
+    const char *debugpath;       /* extracted debuginfo root (or NULL) */
+    char *cmd;                   /* annocheck(1) command for reporting */
+    job_entry_t *job;
+    UT_hash_handle hh;
+} annocheck_job_t;
+
 /* Global variables */
 static bool reported = false;
+static job_list_t *jobs = NULL;
+static annocheck_job_t *job_table = NULL;
 #ifdef _WITH_ANNOCHECK
 static const char *annocheck_profile = NULL;
 #endif
@@ -199,15 +216,12 @@ static libannocheck_test_state get_worst(libannocheck_test_state worst, libannoc
 }
 
 /*
- * Do the libannocheck setup for a file.  If this is the first call,
- * it will initializae libannocheck.  Otherwise, it will reinit the
- * existing handle.  Returns libannocheck handle on success, NULL
- * otherwise.
+ * Do the libannocheck setup for a file.  Returns libannocheck handle
+ * on success, NULL otherwise.
  */
-static struct libannocheck_internals *libannocheck_setup(struct rpminspect *ri, const rpmfile_entry_t *file, char *opts, struct libannocheck_internals *h)
+static struct libannocheck_internals *libannocheck_setup(struct rpminspect *ri, const rpmfile_entry_t *file, const char *opts, const char *debugpath)
 {
-    struct libannocheck_internals *anno = h;
-    const char *arch = NULL;
+    struct libannocheck_internals *anno = NULL;
     libannocheck_error annoerr = 0;
     string_list_t *args = NULL;
     string_entry_t *entry = NULL;
@@ -216,109 +230,238 @@ static struct libannocheck_internals *libannocheck_setup(struct rpminspect *ri,
     assert(ri != NULL);
     assert(file != NULL);
 
-    arch = get_rpm_header_arch(file->rpm_header);
-
-    if (anno == NULL) {
-        /* initialize libannocheck for this test on this file */
-        annoerr = libannocheck_init(libannocheck_get_version(), file->fullpath, get_debuginfo_path(ri, file, arch, AFTER_BUILD), &anno);
+    /* initialize libannocheck for this test on this file */
+    annoerr = libannocheck_init(libannocheck_get_version(), file->fullpath, debugpath, &anno);
 
-        if (annoerr != libannocheck_error_none) {
-             warnx(_("libannocheck_init error: %s"), libannocheck_get_error_message(anno, annoerr));
-             return NULL;
-        }
-
-        /*
-         * handle annocheck options if there are any, otherwise
-         * enable all tests
-         */
-        if (opts) {
-            args = strsplit(opts, " \t");
+    if (annoerr != libannocheck_error_none) {
+         warnx(_("libannocheck_init error: %s"), libannocheck_get_error_message(anno, annoerr));
+         return NULL;
+    }
 
-            if (args) {
-                TAILQ_FOREACH(entry, args, items) {
-                    if (strstr(entry->data, "=") || !strprefix(entry->data, "--test-") || !strprefix(entry->data, "--skip-")) {
-                        continue;
-                    }
+    /*
+     * handle annocheck options if there are any, otherwise
+     * enable all tests
+     */
+    if (opts) {
+        args = strsplit(opts, " \t");
 
-                    /* the argument past the leading --test- or --skip- */
-                    test = entry->data + 7;
+        if (args) {
+            TAILQ_FOREACH(entry, args, items) {
+                if (strstr(entry->data, "=") || !strprefix(entry->data, "--test-") || !strprefix(entry->data, "--skip-")) {
+                    continue;
+                }
 
-                    if (strprefix(entry->data, "--test-")) {
-                        annoerr = libannocheck_enable_test(anno, test);
-                        test = "enable";
-                    } else {
-                        annoerr = libannocheck_disable_test(anno, test);
-                        test = "disable";
-                    }
+                /* the argument past the leading --test- or --skip- */
+                test = entry->data + 7;
 
-                    if (annoerr != libannocheck_error_none) {
-                        warnx(_("libannocheck_%s_test error: %s:"), test, libannocheck_get_error_message(anno, annoerr));
-                        libannocheck_finish(anno);
-                        return NULL;
-                    }
+                if (strprefix(entry->data, "--test-")) {
+                    annoerr = libannocheck_enable_test(anno, test);
+                    test = "enable";
+                } else {
+                    annoerr = libannocheck_disable_test(anno, test);
+                    test = "disable";
                 }
 
-                list_free(args, free);
+                if (annoerr != libannocheck_error_none) {
+                    warnx(_("libannocheck_%s_test error: %s:"), test, libannocheck_get_error_message(anno, annoerr));
+                    list_free(args, free);
+                    libannocheck_finish(anno);
+                    return NULL;
+                }
             }
-        } else {
-            annoerr = libannocheck_enable_all_tests(anno);
 
-            if (annoerr != libannocheck_error_none) {
-                warnx(_("libannocheck_enable_all_tests error: %s:"), libannocheck_get_error_message(anno, annoerr));
-                libannocheck_finish(anno);
-                return NULL;
-            }
+            list_free(args, free);
         }
-
-        /* enable libannocheck profile if there's a match */
-        set_libannocheck_profile(anno, ri->annocheck_profile, ri->product_release);
     } else {
-        /* reinitialize with a new file */
-        annoerr = libannocheck_reinit(anno, file->fullpath, get_debuginfo_path(ri, file, arch, AFTER_BUILD));
+        annoerr = libannocheck_enable_all_tests(anno);
 
         if (annoerr != libannocheck_error_none) {
-             warnx(_("libannocheck_reinit error: %s"), libannocheck_get_error_message(anno, annoerr));
-             libannocheck_finish(anno);
-             return NULL;
+            warnx(_("libannocheck_enable_all_tests error: %s:"), libannocheck_get_error_message(anno, annoerr));
+            libannocheck_finish(anno);
+            return NULL;
         }
     }
 
+    /* enable libannocheck profile if there's a match */
+    set_libannocheck_profile(anno, ri->annocheck_profile, ri->product_release);
+
     return anno;
 }
-#endif
 
-static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Job function run in a child process by run_jobs().  Runs the
+ * libannocheck tests on one file and writes one line per test that
+ * ran to stdout:
+ *
+ *     <state>\t<name>\t<description>\t<doc_url>
+ *
+ * libannocheck keeps global state, so concurrency comes from running
+ * each file in its own process rather than from multiple handles in
+ * this one.
+ */
+static int libannocheck_job(void *data)
 {
-    bool result = true;
-    bool ignore = false;
-    const char *arch = NULL;
-    string_map_t *hentry = NULL;
-    string_map_t *tmp_hentry = NULL;
-    struct result_params params;
-#ifdef _WITH_LIBANNOCHECK
-    struct libannocheck_internals *ah = NULL;
+    annocheck_job_t *aj = data;
+    struct libannocheck_internals *anno = NULL;
     libannocheck_error annoerr = 0;
     struct libannocheck_test *annotests = NULL;
-    unsigned int i = 0;
     unsigned int numtests = 0;
     unsigned int failed = 0;
     unsigned int maybe = 0;
-    char *tmp = NULL;
-    string_list_t *details = NULL;
-    libannocheck_test_state after_worst = 0;
-    libannocheck_test_state before_worst = 0;
+    unsigned int i = 0;
+
+    assert(aj != NULL);
+
+    anno = libannocheck_setup(aj->ri, aj->file, aj->opts, aj->debugpath);
+
+    if (anno == NULL) {
+        return EXIT_FAILURE;
+    }
+
+    annoerr = libannocheck_run_tests(anno, &failed, &maybe);
+
+    if (annoerr != libannocheck_error_none) {
+        warnx(_("libannocheck_run_tests error: %s (%d)"), libannocheck_get_error_message(anno, annoerr), annoerr);
+        libannocheck_finish(anno);
+        return EXIT_FAILURE;
+    }
+
+    annoerr = libannocheck_get_known_tests(anno, &annotests, &numtests);
+
+    if (annoerr != libannocheck_error_none) {
+        warnx(_("libannocheck_get_known_tests error: %s"), libannocheck_get_error_message(anno, annoerr));
+        libannocheck_finish(anno);
+        return EXIT_FAILURE;
+    }
+
+    for (i = 0; i < numtests; i++) {
+        if (!annotests[i].enabled || annotests[i].state == libannocheck_test_state_not_run) {
+            continue;
+        }
+
+        printf("%d\t%s\t%s\t%s\n", (int) annotests[i].state, annotests[i].name,
+               annotests[i].description ? annotests[i].description : "",
+               annotests[i].doc_url ? annotests[i].doc_url : "");
+    }
+
+    annoerr = libannocheck_finish(anno);
+
+    if (annoerr != libannocheck_error_none) {
+        warnx(_("libannocheck_finish error: %s"), libannocheck_get_error_message(anno, annoerr));
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Read the next test result line from libannocheck_job() output.
+ * The line is split in place.  Anything else the child wrote (such as
+ * warnings) is passed on.  Returns false at the end of the output.
+ */
+static bool next_libannocheck_result(char **cursor, libannocheck_test_state *state, char **name, char **desc, char **url)
+{
+    char *line = NULL;
+    char *end = NULL;
+    long s = 0;
+
+    assert(cursor != NULL);
+
+    while ((line = strsep(cursor, "\n")) != NULL) {
+        if (*line == '\0') {
+            continue;
+        }
+
+        s = strtol(line, &end, 10);
+
+        if (end == line || *end != '\t') {
+            warnx("%s", line);
+            continue;
+        }
+
+        *state = (libannocheck_test_state) s;
+        *url = end + 1;
+        *name = strsep(url, "\t");
+        *desc = strsep(url, "\t");
+
+        if (*desc == NULL || *url == NULL) {
+            warnx("%s", line);
+            continue;
+        }
+
+        return true;
+    }
+
+    return false;
+}
+#endif
+
+/*
+ * Find the queued run of the named test on a file.
+ */
+static annocheck_job_t *find_job(const char *test, const rpmfile_entry_t *file)
+{
+    char *key = NULL;
+    annocheck_job_t *aj = NULL;
+
+    assert(test != NULL);
+    assert(file != NULL);
+
+    xasprintf(&key, "%s:%s", test, file->fullpath);
+    assert(key != NULL);
+    HASH_FIND_STR(job_table, key, aj);
+    free(key);
+
+    return aj;
+}
+
+/*
+ * Queue one run of an annocheck test on a file.
+ */
+static void queue_job(struct rpminspect *ri, const rpmfile_entry_t *file, const string_map_t *test, int build, const char *workdir)
+{
+    annocheck_job_t *aj = NULL;
+    job_entry_t *job = NULL;
+
+    assert(ri != NULL);
+    assert(file != NULL);
+    assert(test != NULL);
+
+    aj = calloc(1, sizeof(*aj));
+    assert(aj != NULL);
+    xasprintf(&aj->key, "%s:%s", test->key, file->fullpath);
+    assert(aj->key != NULL);
+    aj->ri = ri;
+    aj->file = file;
+    aj->opts = test->value;
+
+    /* resolved here so the debuginfo index is only built once */
+    aj->debugpath = get_debuginfo_path(ri, file, get_rpm_header_arch(file->rpm_header), build);
+
+    job = calloc(1, sizeof(*job));
+    assert(job != NULL);
+    job->workdir = workdir;
+#ifdef _WITH_LIBANNOCHECK
+    job->fn = libannocheck_job;
+    job->data = aj;
 #else
-    char **argv = NULL;
-    char *before_cmd = NULL;
-    char *after_cmd = NULL;
-    char *after_out = NULL;
-    int after_exit = 0;
-    char *before_out = NULL;
-    int before_exit = 0;
-    char *details = NULL;
-    string_list_t *slist = NULL;
-    string_entry_t *sentry = NULL;
+    aj->cmd = build_annocheck_cmd(ri->commands.annocheck, test->value, annocheck_profile, aj->debugpath, file->fullpath);
+    job->argv = build_argv(aj->cmd);
 #endif
+    aj->job = job;
+
+    TAILQ_INSERT_TAIL(jobs, job, items);
+    HASH_ADD_KEYPTR(hh, job_table, aj->key, strlen(aj->key), aj);
+    return;
+}
+
+/*
+ * Queue every annocheck run the driver will need for this file.
+ */
+static bool queue_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    string_map_t *hentry = NULL;
+    string_map_t *tmp_hentry = NULL;
+    bool ignore = false;
 
     assert(ri != NULL);
     assert(file != NULL);
@@ -334,10 +477,60 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* Only run this check on ELF files */
-    if (!is_elf_file(file->fullpath) || (!is_elf_file(file->fullpath) && file->peer_file && !is_elf_file(file->peer_file->fullpath))) {
+    if (!is_elf_file(file->fullpath)) {
         return true;
     }
 
+    /* The before build is only needed when reporting */
+    ignore = ignore_rpmfile_entry(ri, NAME_ANNOCHECK, file);
+
+    HASH_ITER(hh, ri->annocheck, hentry, tmp_hentry) {
+        queue_job(ri, file, hentry, AFTER_BUILD, ri->worksubdir);
+
+        if (!ignore && file->peer_file) {
+            queue_job(ri, file->peer_file, hentry, BEFORE_BUILD, ri->workdir);
+        }
+    }
+
+    return true;
+}
+
+static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    bool result = true;
+    bool ignore = false;
+    const char *arch = NULL;
+    string_map_t *hentry = NULL;
+    string_map_t *tmp_hentry = NULL;
+    annocheck_job_t *after = NULL;
+    annocheck_job_t *before = NULL;
+    struct result_params params;
+#ifdef _WITH_LIBANNOCHECK
+    char *output = NULL;
+    char *cursor = NULL;
+    char *name = NULL;
+    char *desc = NULL;
+    char *url = NULL;
+    char *tmp = NULL;
+    string_list_t *details = NULL;
+    libannocheck_test_state state = 0;
+    libannocheck_test_state after_worst = 0;
+    libannocheck_test_state before_worst = 0;
+#else
+    const char *before_cmd = NULL;
+    const char *after_cmd = NULL;
+    const char *after_out = NULL;
+    int after_exit = 0;
+    int before_exit = 0;
+    char *cmd = NULL;
+    char *details = NULL;
+    string_list_t *slist = NULL;
+    string_entry_t *sentry = NULL;
+#endif
+
+    assert(ri != NULL);
+    assert(file != NULL);
+
     /* We will skip checks for ignored files */
     ignore = ignore_rpmfile_entry(ri, NAME_ANNOCHECK, file);
 
@@ -354,107 +547,70 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.arch = arch;
     params.file = file->localpath;
 
-    /* Run each annocheck test and report the results */
+    /* Report the results of each annocheck test */
     HASH_ITER(hh, ri->annocheck, hentry, tmp_hentry) {
-#ifdef _WITH_LIBANNOCHECK
-        /* run libannocheck on the before build (if any) first */
-        if (file->peer_file) {
-            ah = libannocheck_setup(ri, file->peer_file, hentry->value, ah);
-
-            if (ah == NULL) {
-                /* failed to initialize libannocheck so call that a failure */
-                return false;
-            }
-
-            /* run the tests on the before build file (if any) */
-            annoerr = libannocheck_run_tests(ah, &failed, &maybe);
-
-            if (annoerr != libannocheck_error_none) {
-                warnx(_("before libannocheck_run_tests error: %s (%d)"), libannocheck_get_error_message(ah, annoerr), annoerr);
-                libannocheck_finish(ah);
-                continue;
-            }
-
-            /* collect the worst result from the build build now */
-            annoerr = libannocheck_get_known_tests(ah, &annotests, &numtests);
-
-            if (annoerr != libannocheck_error_none) {
-                warnx(_("libannocheck_get_known_tests error: %s"), libannocheck_get_error_message(ah, annoerr));
-                libannocheck_finish(ah);
-                continue;
-            }
-
-            for (i = 0; i < numtests; i++) {
-                if (!annotests[i].enabled || annotests[i].state == libannocheck_test_state_not_run) {
-                    continue;
-                }
-
-                /* capture worst result */
-                before_worst = get_worst(before_worst, annotests[i].state);
-            }
-
-            /* close the handle and prepare to start over */
-            annoerr = libannocheck_finish(ah);
-
-            if (annoerr != libannocheck_error_none) {
-                warnx(_("libannocheck_finish error: %s"), libannocheck_get_error_message(ah, annoerr));
-            }
-
-            ah = NULL;
+        /* files not queued by queue_driver() are not checked */
+        if ((after = find_job(hentry->key, file)) == NULL) {
+            continue;
         }
 
-        /* set up libannocheck for the after build file */
-        ah = libannocheck_setup(ri, file, hentry->value, ah);
+        before = NULL;
 
-        if (ah == NULL) {
-            continue;
+        if (file->peer_file) {
+            before = find_job(hentry->key, file->peer_file);
         }
 
-        /* run the tests on the after build file */
-        annoerr = libannocheck_run_tests(ah, &failed, &maybe);
+#ifdef _WITH_LIBANNOCHECK
+        /* collect the worst result from the before build (if any) first */
+        if (before && before->job->exitcode == 0 && before->job->output) {
+            output = strdup(before->job->output);
+            assert(output != NULL);
+            cursor = output;
+
+            while (next_libannocheck_result(&cursor, &state, &name, &desc, &url)) {
+                before_worst = get_worst(before_worst, state);
+            }
 
-        if (annoerr != libannocheck_error_none) {
-            warnx(_("after libannocheck_run_tests error: %s (%d)"), libannocheck_get_error_message(ah, annoerr), annoerr);
-            libannocheck_finish(ah);
-            continue;
+            free(output);
         }
 
-        /* get the list of known tests */
-        annoerr = libannocheck_get_known_tests(ah, &annotests, &numtests);
+        if (after->job->exitcode != 0) {
+            /* failed to run libannocheck so call that a failure */
+            if (after->job->output) {
+                warnx("%s", after->job->output);
+            }
 
-        if (annoerr != libannocheck_error_none) {
-             warnx(_("libannocheck_get_known_tests error: %s"), libannocheck_get_error_message(ah, annoerr));
-             libannocheck_finish(ah);
-             continue;
+            result = false;
+            continue;
         }
 
         /* build details */
-        for (i = 0; i < numtests; i++) {
-            if (!annotests[i].enabled || annotests[i].state == libannocheck_test_state_not_run) {
-                continue;
-            }
+        output = strdup(after->job->output ? after->job->output : "");
+        assert(output != NULL);
+        cursor = output;
 
+        while (next_libannocheck_result(&cursor, &state, &name, &desc, &url)) {
             /* build the detailed reporting similar to annocheck(1) */
-            xasprintf(&tmp, "Hardened: %s: %.4s: '%s' test", file->localpath, get_state(annotests[i].state), annotests[i].name);
+            xasprintf(&tmp, "Hardened: %s: %.4s: '%s' test", file->localpath, get_state(state), name);
             assert(tmp != NULL);
             details = list_add(details, tmp);
             free(tmp);
 
-            xasprintf(&tmp, "Hardened: %s: %.4s: %s", file->localpath, get_state(annotests[i].state), annotests[i].description);
+            xasprintf(&tmp, "Hardened: %s: %.4s: %s", file->localpath, get_state(state), desc);
             assert(tmp != NULL);
             details = list_add(details, tmp);
             free(tmp);
 
-            if (annotests[i].state == libannocheck_test_state_failed || annotests[i].state == libannocheck_test_state_maybe) {
-                xasprintf(&tmp, "Hardened: %s: %.4s: %s", file->localpath, get_state(annotests[i].state), annotests[i].doc_url);
+            if (state == libannocheck_test_state_failed || state == libannocheck_test_state_maybe) {
+                xasprintf(&tmp, "Hardened: %s: %.4s: %s", file->localpath, get_state(state), url);
                 assert(tmp != NULL);
                 details = list_add(details, tmp);
                 free(tmp);
             }
 
             /* handle loss of -O2 -D_FORTIFY_SOURCE for reporting */
-            if ((!strcmp(annotests[i].name, "fortify") || !strcmp(annotests[i].name, "optimization")) &&
-                (annotests[i].state == libannocheck_test_state_maybe || annotests[i].state == libannocheck_test_state_failed)) {
+            if ((!strcmp(name, "fortify") || !strcmp(name, "optimization")) &&
+                (state == libannocheck_test_state_maybe || state == libannocheck_test_state_failed)) {
                 params.waiverauth = WAIVABLE_BY_SECURITY;
                 params.remedy = REMEDY_ANNOCHECK_FORTIFY_SOURCE;
                 params.verb = VERB_REMOVED;
@@ -474,9 +630,11 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             }
 
             /* capture worst result */
-            after_worst = get_worst(after_worst, annotests[i].state);
+            after_worst = get_worst(after_worst, state);
         }
 
+        free(output);
+
         /* report the results */
         if (!ignore) {
             if (after_worst == libannocheck_test_state_maybe || after_worst == libannocheck_test_state_failed) {
@@ -512,8 +670,11 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             reported = true;
             free(params.details);
             free(params.msg);
-            list_free(details, free);
+            params.msg = NULL;
         }
+
+        list_free(details, free);
+        details = NULL;
     }
 
     /* set result based on worst result encountered */
@@ -521,30 +682,17 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         result = !(ri->annocheck_failure_severity >= RESULT_VERIFY);
     }
 
-    /* close out */
-    if (ah != NULL) {
-        annoerr = libannocheck_finish(ah);
-    }
-
-    if (annoerr != libannocheck_error_none) {
-        warnx(_("libannocheck_finish error: %s"), libannocheck_get_error_message(ah, annoerr));
-    }
-
     return result;
 #else
-        /* Run the test on the file */
-        after_cmd = build_annocheck_cmd(ri->commands.annocheck, hentry->value, annocheck_profile, get_debuginfo_path(ri, file, arch, AFTER_BUILD), file->fullpath);
-        argv = build_argv(after_cmd);
-        after_out = run_cmd_vpe(&after_exit, ri->worksubdir, argv);
-        free_argv(argv);
+        after_cmd = after->cmd;
+        after_out = after->job->output;
+        after_exit = after->job->exitcode;
 
-        /* If we have a before build, run the command on that */
         if (!ignore) {
-            if (file->peer_file) {
-                before_cmd = build_annocheck_cmd(ri->commands.annocheck, hentry->value, annocheck_profile, get_debuginfo_path(ri, file, arch, BEFORE_BUILD), file->peer_file->fullpath);
-                argv = build_argv(before_cmd);
-                before_out = run_cmd_vpe(&before_exit, ri->workdir, argv);
-                free_argv(argv);
+            /* If we have a before build, compare with that */
+            if (before) {
+                before_cmd = before->cmd;
+                before_exit = before->job->exitcode;
 
                 /* Build a reporting message if we need to */
                 if (before_exit == 0 && after_exit == 0) {
@@ -580,10 +728,11 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             if (params.msg) {
                 /* trim the before build working directory and generate details */
                 if (before_cmd) {
-                    before_cmd = trim_workdir(file->peer_file, before_cmd);
-                    xasprintf(&details, "Command: %s\nExit Code: %d\n    compared with the output of:\nCommand: %s\nExit Code: %d\n\n%s", before_cmd, before_exit, after_cmd, after_exit, after_out);
+                    cmd = trim_workdir(file->peer_file, strdup(before_cmd));
+                    xasprintf(&details, "Command: %s\nExit Code: %d\n    compared with the output of:\nCommand: %s\nExit Code: %d\n\n%s", cmd, before_exit, after_cmd, after_exit, after_out ? after_out : "");
+                    free(cmd);
                 } else {
-                    xasprintf(&details, "Command: %s\nExit Code: %d\n\n%s", after_cmd, after_exit, after_out);
+                    xasprintf(&details, "Command: %s\nExit Code: %d\n\n%s", after_cmd, after_exit, after_out ? after_out : "");
                 }
 
                 /* trim the after build working directory */
@@ -593,6 +742,7 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
                 add_result(ri, &params);
                 reported = true;
                 free(params.msg);
+                params.msg = NULL;
             }
         }
 
@@ -622,6 +772,8 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
                         result = !(params.severity >= RESULT_VERIFY);
                     }
 
+                    free(params.msg);
+                    params.msg = NULL;
                     break;
                 }
             }
@@ -631,14 +783,8 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
         /* Cleanup */
         free(details);
-
-        free(after_out);
-        free(before_out);
-
-        free(after_cmd);
-        free(before_cmd);
-
-        after_exit = 0;
+        details = NULL;
+        before_cmd = NULL;
         before_exit = 0;
     }
 
@@ -652,10 +798,15 @@ static bool annocheck_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_annocheck(struct rpminspect *ri)
 {
     bool result = true;
+    annocheck_job_t *aj = NULL;
+    annocheck_job_t *tmp_aj = NULL;
     struct result_params params;
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
 #ifdef _WITH_ANNOCHECK
     /* skip if we have no annocheck tests defined */
     if (ri->annocheck == NULL) {
@@ -675,9 +826,29 @@ bool inspect_annocheck(struct rpminspect *ri)
     }
 #endif
 
-    /* run the annocheck tests across all ELF files */
+    /* queue the annocheck runs for all ELF files and run them concurrently */
+    jobs = calloc(1, sizeof(*jobs));
+    assert(jobs != NULL);
+    TAILQ_INIT(jobs);
+
+    foreach_peer_file(ri, NAME_ANNOCHECK, queue_driver);
+
+    run_jobs(jobs, inspection_jobs(ri));
+
+    /* report the annocheck results across all ELF files */
     result = foreach_peer_file(ri, NAME_ANNOCHECK, annocheck_driver);
 
+    /* clean up */
+    HASH_ITER(hh, job_table, aj, tmp_aj) {
+        HASH_DEL(job_table, aj);
+        free(aj->key);
+        free(aj->cmd);
+        free(aj);
+    }
+
+    free_jobs(jobs);
+    jobs = NULL;
+
     /* if everything was fine, just say so */
     if (result && !reported) {
         init_result_params(&params);
@@ -14,27 +14,45 @@
 #include <assert.h>
 #include <stdbool.h>
 #include <stdio.h>
+#include <string.h>
 #include <sys/types.h>
 #include <libelf.h>
 
 #include "rpminspect.h"
 
-static bool allowed_symbol(const struct rpminspect *ri, const rpmfile_entry_t *file, const char *symbol)
+/* forbidden function set for the symbol filter */
+static const string_map_t *forbidden = NULL;
+
+/* Symbol filter for get_elf_imported_functions() */
+static bool is_forbidden(const char *symbol)
+{
+    string_map_t *hentry = NULL;
+
+    HASH_FIND_STR(forbidden, symbol, hentry);
+    return (hentry != NULL);
+}
+
+/*
+ * Return the lists of allowed forbidden functions whose path matches
+ * this file.  The lists belong to the configuration, only the
+ * returned array needs to be freed.
+ */
+static string_list_t **get_allowed_symbols(const struct rpminspect *ri, const rpmfile_entry_t *file)
 {
     char *root = NULL;
     size_t lenr = 0;
     size_t lenp = 0;
-    string_entry_t *entry = NULL;
+    size_t n = 0;
+    string_list_t **allowed = NULL;
     string_list_map_t *hentry = NULL;
     string_list_map_t *tmp_hentry = NULL;
 
     assert(ri != NULL);
     assert(file != NULL);
-    assert(symbol != NULL);
 
-    /* no allowed bad functions defined, false */
+    /* no allowed bad functions defined */
     if (ri->bad_functions_allowed == NULL) {
-        return false;
+        return NULL;
     }
 
     /* construct the root path */
@@ -50,17 +68,33 @@ static bool allowed_symbol(const struct rpminspect *ri, const rpmfile_entry_t *f
     /* look for the given path in the bad functions allowed hash */
     HASH_ITER(hh, ri->bad_functions_allowed, hentry, tmp_hentry) {
         if (match_path(hentry->key, root, file->localpath)) {
-            /* we found a matching path */
-            TAILQ_FOREACH(entry, hentry->value, items) {
-                if (!strcmp(symbol, entry->data)) {
-                    free(root);
-                    return true;
-                }
-            }
+            allowed = realloc(allowed, (n + 2) * sizeof(*allowed));
+            assert(allowed != NULL);
+            allowed[n++] = hentry->value;
+            allowed[n] = NULL;
         }
     }
 
     free(root);
+    return allowed;
+}
+
+static bool allowed_symbol(string_list_t **allowed, const char *symbol)
+{
+    size_t i = 0;
+
+    assert(symbol != NULL);
+
+    if (allowed == NULL) {
+        return false;
+    }
+
+    for (i = 0; allowed[i] != NULL; i++) {
+        if (list_contains(allowed[i], symbol)) {
+            return true;
+        }
+    }
+
     return false;
 }
 
@@ -81,10 +115,12 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
     const char *arch;
     Elf *after_elf = NULL;
     int after_elf_fd = -1;
-    string_list_t *after_symbols = NULL;
     string_list_t *used_symbols = NULL;
     string_list_t *sorted_used = NULL;
+    string_list_t **allowed = NULL;
     string_entry_t *iter = NULL;
+    string_entry_t *next = NULL;
+    string_entry_t *prev = NULL;
     struct result_params params;
     FILE *output_stream = NULL;
     char *output_buffer = NULL;
@@ -118,28 +154,36 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
         goto cleanup;
     }
 
-    /* Don't filter the list -- filtering requires knowledge of the
-     * forbidden functions. Since we can't pass custom arguments to
-     * the filter, return them all and filter them locally. */
-    after_symbols = get_elf_imported_functions(after_elf, NULL);
-
-    /* Get a list of forbidden symbols that we used. */
-    used_symbols = list_intersection(ri->bad_functions, after_symbols);
+    /* Only the forbidden symbols the object imports are returned */
+    forbidden = ri->bad_functions_set;
+    used_symbols = get_elf_imported_functions(after_elf, is_forbidden);
 
     if (!used_symbols || TAILQ_EMPTY(used_symbols)) {
         goto cleanup;
     }
 
     /* Filter out any allowed forbidden symbols for this file */
-    TAILQ_FOREACH(iter, used_symbols, items) {
-        if (allowed_symbol(ri, after, iter->data)) {
-            TAILQ_REMOVE(used_symbols, iter, items);
+    allowed = get_allowed_symbols(ri, after);
+    sorted_used = list_sort(used_symbols);
+    assert(sorted_used != NULL);
+
+    /* a symbol may be listed more than once with different versions */
+    iter = TAILQ_FIRST(sorted_used);
+
+    while (iter != NULL) {
+        next = TAILQ_NEXT(iter, items);
+        prev = TAILQ_PREV(iter, string_entry_s, items);
+
+        if (allowed_symbol(allowed, iter->data) || (prev && !strcmp(prev->data, iter->data))) {
+            TAILQ_REMOVE(sorted_used, iter, items);
             free(iter->data);
             free(iter);
         }
+
+        iter = next;
     }
 
-    if (TAILQ_EMPTY(used_symbols)) {
+    if (TAILQ_EMPTY(sorted_used)) {
         goto cleanup;
     }
 
@@ -152,9 +196,6 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
     output_result = fprintf(output_stream, _("Forbidden function symbols found:\n"));
     assert(output_result > 0);
 
-    sorted_used = list_sort(used_symbols);
-    assert(sorted_used != NULL);
-
     TAILQ_FOREACH(iter, sorted_used, items) {
         output_result = fprintf(output_stream, "\t%s\n", iter->data);
         assert(output_result > 0);
@@ -180,7 +221,7 @@ static bool badfuncs_driver(struct rpminspect *ri, rpmfile_entry_t *after)
     free(output_buffer);
 
 cleanup:
-    list_free(after_symbols, free);
+    free(allowed);
     list_free(used_symbols, free);
     list_free(sorted_used, free);
 
@@ -208,7 +249,7 @@ bool inspect_badfuncs(struct rpminspect *ri)
 
     assert(ri != NULL);
 
-    if (ri->bad_functions != NULL) {
+    if (ri->bad_functions_set != NULL) {
         result = foreach_peer_file(ri, NAME_BADFUNCS, badfuncs_driver);
     }
 
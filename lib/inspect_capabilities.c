@@ -227,6 +227,9 @@ bool inspect_capabilities(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     /* run the capabilities inspection across all RPM files */
     result = foreach_peer_file(ri, NAME_CAPABILITIES, capabilities_driver);
 
@@ -37,41 +37,6 @@ static void add_changedfiles_result(struct rpminspect *ri, struct result_params
     return;
 }
 
-/*
- * Runs a command and redirects standard out to a temporary file created
- * in this function.  Caller is responsible for removing the temporary
- * file.
- */
-static char *run_and_capture(const char *where, char **output, char *cmd, const char *fullpath, int *exitcode)
-{
-    int fd;
-
-    assert(where != NULL);
-    assert(output != NULL);
-    assert(cmd != NULL);
-    assert(fullpath != NULL);
-    assert(exitcode != NULL);
-
-    /* Build a temporary file */
-    xasprintf(output, "%s/output.XXXXXX", where);
-
-    /* Generate them and then close them */
-    fd = mkstemp(*output);
-
-    if (fd == -1) {
-        warn("mkstemp");
-        return false;
-    }
-
-    if (close(fd) == -1) {
-        warn("close");
-        return false;
-    }
-
-    /* Run command and return output */
-    return run_cmd(exitcode, NULL, cmd, "-o", *output, fullpath, NULL);
-}
-
 /*
  * Performs all of the tests associated with the changedfiles inspection.
  */
@@ -91,14 +56,17 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     int exitcode = 0;
     bool possible_header = false;
     string_entry_t *entry = NULL;
-    char *before_tmp = NULL;
-    char *after_tmp = NULL;
-    char *before_uncompressed_file = NULL;
-    char *after_uncompressed_file = NULL;
-    rpmfile_entry_t *bun = NULL;
-    rpmfile_entry_t *aun = NULL;
+    char *before_catalog = NULL;
+    char *after_catalog = NULL;
+    char *catalog_errors = NULL;
+    char *msgunfmt[3];
+    char *before_uncompressed = NULL;
+    char *after_uncompressed = NULL;
+    size_t before_len = 0;
+    size_t after_len = 0;
+    char *before_type = NULL;
+    char *after_type = NULL;
     char *comptype = NULL;
-    char *s = NULL;
     int fd;
     char magic[4];
     bool rebase = false;
@@ -242,51 +210,30 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
           (strsuffix(file->localpath, ".gz") || strsuffix(file->localpath, ".bz2") || strsuffix(file->localpath, ".xz")));
 
     if (ct && ((!ignore && (ri->tests & INSPECT_CHANGEDFILES)) || params.waiverauth == WAIVABLE_BY_SECURITY)) {
-        /* uncompress the files to temporary files for comparison */
-        before_uncompressed_file = uncompress_file(ri, file->peer_file->fullpath, NAME_CHANGEDFILES);
-        after_uncompressed_file = uncompress_file(ri, file->fullpath, NAME_CHANGEDFILES);
+        /* uncompress the files in memory for comparison */
+        before_uncompressed = uncompress_to_memory(file->peer_file->fullpath, 0, &before_len);
+        after_uncompressed = uncompress_to_memory(file->fullpath, 0, &after_len);
 
         /* we may not have been able to uncompress */
-        if (before_uncompressed_file == NULL || after_uncompressed_file == NULL) {
+        if (before_uncompressed == NULL || after_uncompressed == NULL) {
             /* perform a byte comparison of the compressed files */
             exitcode = filecmp(file->peer_file->fullpath, file->fullpath);
         } else {
             /* we can use diff on text files, so try that first */
-            bun = calloc(1, sizeof(*bun));
-            assert(bun != NULL);
-            aun = calloc(1, sizeof(*aun));
-            assert(aun != NULL);
-
-            bun->fullpath = strdup(before_uncompressed_file);
-            aun->fullpath = strdup(after_uncompressed_file);
+            before_type = mime_type_buffer(before_uncompressed, before_len);
+            after_type = mime_type_buffer(after_uncompressed, after_len);
 
-            if (is_text_file(bun) && is_text_file(aun)) {
+            if (strprefix(before_type, "text/") && strprefix(after_type, "text/")) {
                 /* uncompressed files are text, use diff */
-                params.details = get_file_delta(before_uncompressed_file, after_uncompressed_file);
-
-                /* clean up the diff headers */
-                if (params.details) {
-                    s = strreplace(params.details, before_uncompressed_file, file->peer_file->localpath);
-                    free(params.details);
-                    params.details = s;
-
-                    s = strreplace(params.details, after_uncompressed_file, file->localpath);
-                    free(params.details);
-                    params.details = s;
-                }
+                params.details = get_buffer_delta(before_uncompressed, before_len, after_uncompressed, after_len, NULL);
             } else {
                 /* perform a byte comparison of the uncompressed files */
-                exitcode = filecmp(before_uncompressed_file, after_uncompressed_file);
+                exitcode = (before_len != after_len) || memcmp(before_uncompressed, after_uncompressed, after_len);
             }
 
             /* clean up */
-            free(bun->fullpath);
-            free(bun->type);
-            free(bun);
-
-            free(aun->fullpath);
-            free(aun->type);
-            free(aun);
+            free(before_type);
+            free(after_type);
         }
 
         if (exitcode) {
@@ -312,8 +259,8 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
 
         /* cleanup */
-        free(before_uncompressed_file);
-        free(after_uncompressed_file);
+        free(before_uncompressed);
+        free(after_uncompressed);
 
         goto done;
     }
@@ -326,20 +273,22 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         && strsuffix(file->localpath, MO_FILENAME_EXTENSION)
         && (ri->tests & INSPECT_CHANGEDFILES)) {
         /*
-         * This one is somewhat complicated.  We run msgunfmt on the mo files,
-         * but first we have to make temporary files for that output.  Then
-         * invoke diff(1) on those files and capture the output for reporting
-         * out.  It's simple, but the fact that we have to use these command
-         * line programs makes it a bit complicated.  Patches welcome that do
-         * this with a library call or two.
+         * Run msgunfmt on the mo files, capturing the output, and
+         * compare the output.  Only standard output is the catalog,
+         * warnings on standard error would show up as changes.
          */
+        msgunfmt[0] = ri->commands.msgunfmt;
+        msgunfmt[2] = NULL;
 
         /* First, unformat the mo files */
-        params.details = run_and_capture(ri->workdir, &after_tmp, ri->commands.msgunfmt, file->fullpath, &exitcode);
+        msgunfmt[1] = file->fullpath;
+        after_catalog = run_cmd_stdout(&exitcode, &catalog_errors, NULL, msgunfmt);
 
         if (exitcode) {
             nvr = get_nevr(file->rpm_header);
             xasprintf(&params.msg, _("Error running msgunfmt on %s in %s on %s; malformed mo file?"), file->localpath, nvr, arch);
+            params.details = catalog_errors;
+            catalog_errors = NULL;
             params.severity = RESULT_BAD;
             params.remedy = REMEDY_CHANGEDFILES;
             params.verb = VERB_FAILED;
@@ -350,11 +299,15 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             goto done;
         }
 
-        params.details = run_and_capture(ri->workdir, &before_tmp, ri->commands.msgunfmt, file->peer_file->fullpath, &exitcode);
+        free(catalog_errors);
+        msgunfmt[1] = file->peer_file->fullpath;
+        before_catalog = run_cmd_stdout(&exitcode, &catalog_errors, NULL, msgunfmt);
 
         if (exitcode) {
             nvr = get_nevr(file->peer_file->rpm_header);
             xasprintf(&params.msg, _("Error running msgunfmt on %s in %s on %s; malformed mo file?"), file->peer_file->localpath, nvr, arch);
+            params.details = catalog_errors;
+            catalog_errors = NULL;
             params.severity = RESULT_BAD;
             params.remedy = REMEDY_CHANGEDFILES;
             params.verb = VERB_FAILED;
@@ -366,16 +319,7 @@ static bool changedfiles_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
 
         /* Now diff the mo content */
-        params.details = get_file_delta(before_tmp, after_tmp);
-
-        /* Remove the temporary files */
-        if (unlink(before_tmp) == -1) {
-            warn("unlink");
-        }
-
-        if (unlink(after_tmp) == -1) {
-            warn("unlink");
-        }
+        params.details = get_buffer_delta(before_catalog, (before_catalog == NULL) ? 0 : strlen(before_catalog), after_catalog, (after_catalog == NULL) ? 0 : strlen(after_catalog), NULL);
 
         if (params.details) {
             nvr = get_nevr(file->rpm_header);
@@ -473,8 +417,9 @@ done:
     free(params.msg);
     free(params.details);
     free(errors);
-    free(before_tmp);
-    free(after_tmp);
+    free(before_catalog);
+    free(after_catalog);
+    free(catalog_errors);
 
     if (params.severity >= RESULT_VERIFY && reported) {
         return false;
@@ -488,6 +433,9 @@ bool inspect_changedfiles(struct rpminspect *ri)
     bool result;
     struct result_params params;
 
+    /* state left over from a previous run */
+    reported = false;
+
     result = foreach_peer_file(ri, NAME_CHANGEDFILES, changedfiles_driver);
 
     if (result && !reported) {
@@ -97,53 +97,24 @@ static string_list_t *get_changelog(const Header hdr)
 }
 
 /*
- * Generate temporary changelog files for use with diff(1).
+ * Join the changelog entries in to a single string for comparison.
  */
-static char *create_changelog(const string_list_t *changelog, const char *where)
+static char *create_changelog(const string_list_t *changelog)
 {
-    int fd;
     char *output = NULL;
-    string_entry_t *entry = NULL;
-    FILE *logfp = NULL;
-
-    assert(where != NULL);
 
-    /* no changelog data means no changelog file */
+    /* no changelog data means no changelog text */
     if (changelog == NULL) {
         return NULL;
     }
 
-    xasprintf(&output, "%s/changelog.XXXXXX", where)
-    fd = mkstemp(output);
-
-    if (fd == -1) {
-        warn("mkstemp");
-        free(output);
-        return NULL;
-    }
-
-    logfp = fdopen(fd, "w");
+    output = list_to_string(changelog, NULL);
 
-    if (logfp == NULL) {
-        warn("fdopen");
-        close(fd);
-        unlink(output);
-        free(output);
-        return NULL;
-    }
-
-    TAILQ_FOREACH(entry, changelog, items) {
-        fprintf(logfp, "%s", entry->data);
-    }
-
-    if (fclose(logfp) != 0) {
-        warn("fclose");
-        close(fd);
-        unlink(output);
-        free(output);
-        return NULL;
+    if (output == NULL) {
+        output = strdup("");
     }
 
+    assert(output != NULL);
     return output;
 }
 
@@ -214,17 +185,17 @@ static bool check_src_rpm_changelog(struct rpminspect *ri, const rpmpeer_entry_t
     /* compare changelog data */
     if (before_changelog) {
         before = TAILQ_FIRST(before_changelog);
-        before_output = create_changelog(before_changelog, ri->workdir);
+        before_output = create_changelog(before_changelog);
     }
 
     if (after_changelog) {
         after = TAILQ_FIRST(after_changelog);
-        after_output = create_changelog(after_changelog, ri->workdir);
+        after_output = create_changelog(after_changelog);
     }
 
     /* Compare the changelogs */
     if (before_output && after_output) {
-        diff_output = get_file_delta(before_output, after_output);
+        diff_output = get_buffer_delta(before_output, strlen(before_output), after_output, strlen(after_output), NULL);
     }
 
     /* Set up result parameters */
@@ -299,18 +270,6 @@ static bool check_src_rpm_changelog(struct rpminspect *ri, const rpmpeer_entry_t
     }
 
     /* cleanup */
-    if (before_output) {
-        if (unlink(before_output) != 0) {
-            warn("unlink");
-        }
-    }
-
-    if (after_output) {
-        if (unlink(after_output) != 0) {
-            warn("unlink");
-        }
-    }
-
     list_free(before_changelog, free);
     list_free(after_changelog, free);
     free(before_nevr);
@@ -351,13 +310,13 @@ static bool check_bin_rpm_changelog(struct rpminspect *ri, const rpmpeer_entry_t
     before_changelog = get_changelog(peer->before_hdr);
     after_changelog = get_changelog(peer->after_hdr);
 
-    /* Generate temporary changelog files */
-    before_output = create_changelog(before_changelog, ri->workdir);
-    after_output = create_changelog(after_changelog, ri->workdir);
+    /* Generate the changelog text */
+    before_output = create_changelog(before_changelog);
+    after_output = create_changelog(after_changelog);
 
     /* Compare the changelogs */
     if (before_output && after_output) {
-        diff_output = get_file_delta(before_output, after_output);
+        diff_output = get_buffer_delta(before_output, strlen(before_output), after_output, strlen(after_output), NULL);
     }
 
     /* Set up result parameters */
@@ -382,7 +341,7 @@ static bool check_bin_rpm_changelog(struct rpminspect *ri, const rpmpeer_entry_t
 
     /* Check for bad words */
     TAILQ_FOREACH(entry, after_changelog, items) {
-        if (has_bad_word(entry->data, ri->badwords)) {
+        if (has_bad_word(entry->data, ri->badwords_matcher)) {
             xasprintf(&params.msg, "%%changelog entry has unprofessional language in the %s build", after_nevr);
             params.severity = RESULT_BAD;
             params.waiverauth = NOT_WAIVABLE;
@@ -397,18 +356,6 @@ static bool check_bin_rpm_changelog(struct rpminspect *ri, const rpmpeer_entry_t
     }
 
     /* cleanup */
-    if (before_output) {
-        if (unlink(before_output) != 0) {
-            warn("unlink");
-        }
-    }
-
-    if (after_output) {
-        if (unlink(after_output) != 0) {
-            warn("unlink");
-        }
-    }
-
     free(before_output);
     free(after_output);
     list_free(before_changelog, free);
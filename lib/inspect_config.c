@@ -186,6 +186,9 @@ bool inspect_config(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     result = foreach_peer_file(ri, NAME_CONFIG, config_driver);
 
     if (result && !reported) {
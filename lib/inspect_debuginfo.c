@@ -11,12 +11,15 @@
 #include <sys/types.h>
 #include "rpminspect.h"
 
-/* Flags used by the inspection */
-#define NEEDS_SYMTAB        (((uint64_t) 1) << 2)
-#define NEEDS_GDB_INDEX     (((uint64_t) 1) << 3)
-#define NEEDS_GNU_DEBUGDATA (((uint64_t) 1) << 4)
-#define NEEDS_GNU_DEBUGLINK (((uint64_t) 1) << 5)
-#define NEEDS_DEBUG_INFO    (((uint64_t) 1) << 6)
+/* Flags used by the inspection, these match the cached ELF section flags */
+#define NEEDS_SYMTAB        ELF_SECTION_SYMTAB
+#define NEEDS_GDB_INDEX     ELF_SECTION_GDB_INDEX
+#define NEEDS_GNU_DEBUGDATA ELF_SECTION_GNU_DEBUGDATA
+#define NEEDS_GNU_DEBUGLINK ELF_SECTION_GNU_DEBUGLINK
+#define NEEDS_DEBUG_INFO    ELF_SECTION_DEBUG_INFO
+
+/* Sections to check for, from the configuration */
+static uint64_t needed = 0;
 
 static uint64_t get_flags(const char *s)
 {
@@ -47,50 +50,32 @@ static uint64_t get_flags(const char *s)
     return r;
 }
 
-static uint64_t _section_helper(const char *fullpath, const uint64_t flags, const bool check)
+/*
+ * The sections from flags the file carries, using the section flags
+ * cached on the file so each file is only scanned once.
+ */
+static uint64_t have_sections(rpmfile_entry_t *file, const uint64_t flags)
 {
-    uint64_t gathered = 0;
-    int fd = 0;
-    Elf *elf = NULL;
-
-    assert(fullpath != NULL);
-
-    elf = get_elf(fullpath, &fd);
-    assert(elf != NULL);
-
-    if ((flags & NEEDS_SYMTAB) && have_elf_section(elf, -1, ELF_SYMTAB) == check) {
-        gathered |= NEEDS_SYMTAB;
-    }
-
-    if ((flags & NEEDS_GDB_INDEX) && have_elf_section(elf, -1, ELF_GDB_INDEX) == check) {
-        gathered |= NEEDS_GDB_INDEX;
-    }
-
-    if ((flags & NEEDS_GNU_DEBUGDATA) && have_elf_section(elf, -1, ELF_GNU_DEBUGDATA) == check) {
-        gathered |= NEEDS_GNU_DEBUGDATA;
-    }
-
-    if ((flags & NEEDS_GNU_DEBUGLINK) && have_elf_section(elf, -1, ELF_GNU_DEBUGLINK) == check) {
-        gathered |= NEEDS_GNU_DEBUGLINK;
-    }
-
-    if ((flags & NEEDS_DEBUG_INFO) && have_elf_section(elf, -1, ELF_DEBUG_INFO) == check) {
-        gathered |= NEEDS_DEBUG_INFO;
-    }
-
-    close(fd);
-    elf_end(elf);
-    return gathered;
+    return get_rpmfile_elf_sections(file) & flags;
 }
 
-static uint64_t have_sections(const char *fullpath, const uint64_t flags)
+/*
+ * The sections from flags the file does not carry.
+ */
+static uint64_t missing_sections(rpmfile_entry_t *file, const uint64_t flags)
 {
-    return _section_helper(fullpath, flags, true);
+    return flags & ~get_rpmfile_elf_sections(file);
 }
 
-static uint64_t missing_sections(const char *fullpath, const uint64_t flags)
+/*
+ * True for ELF shared libraries and executables.  The type is cached
+ * with the section flags, so the file is only opened once.
+ */
+static bool is_elf_binary(rpmfile_entry_t *file)
 {
-    return _section_helper(fullpath, flags, false);
+    GElf_Half type = get_rpmfile_elf_type(file);
+
+    return type == ET_DYN || type == ET_EXEC;
 }
 
 static char *strflags(const uint64_t flags)
@@ -115,46 +100,6 @@ static char *strflags(const uint64_t flags)
     return r;
 }
 
-/*
- * If we see any section headers that begin with ".guile." then assume
- * this is a Guile object file.
- */
-static bool is_guile(const char *path)
-{
-    bool r = false;
-    Elf *elf = NULL;
-    int fd = -1;
-    string_list_t *sections = NULL;
-    string_entry_t *entry = NULL;
-
-    assert(path != NULL);
-
-    elf = get_elf(path, &fd);
-
-    if (elf == NULL) {
-        return false;
-    }
-
-    sections = get_elf_section_names(elf, SHT_PROGBITS);
-
-    if (sections == NULL || TAILQ_EMPTY(sections)) {
-        return false;
-    }
-
-    close(fd);
-    elf_end(elf);
-
-    TAILQ_FOREACH(entry, sections, items) {
-        if (strprefix(entry->data, ".guile.")) {
-            r = true;
-            break;
-        }
-    }
-
-    list_free(sections, free);
-    return r;
-}
-
 static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
@@ -167,8 +112,6 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     uint64_t have = 0;
     uint64_t before_missing = 0;
     uint64_t after_missing = 0;
-    int fd = 0;
-    Elf *elf = NULL;
     struct result_params params;
 
     assert(ri != NULL);
@@ -180,14 +123,12 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* Only deal with ELF shared libraries or executables */
-    if (!is_elf_shared_library(file->fullpath) && !is_elf_executable(file->fullpath)) {
+    if (!is_elf_binary(file)) {
         return true;
     }
 
-    if (file->peer_file) {
-        if (!is_elf_shared_library(file->peer_file->fullpath) && !is_elf_executable(file->peer_file->fullpath)) {
-            return true;
-        }
+    if (file->peer_file && !is_elf_binary(file->peer_file)) {
+        return true;
     }
 
     /* the package nvr and arch is used for reporting */
@@ -200,16 +141,16 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         debugpkg = true;
     }
 
-    /* set the sections to check for */
-    flags |= get_flags(ri->debuginfo_sections);
+    /* the sections to check for */
+    flags = needed;
 
     /* Initialize the result parameters */
     init_result_params(&params);
     params.header = NAME_DEBUGINFO;
 
     /* Check for and report missing or misplaced debuginfo symbols */
-    after_missing = missing_sections(file->fullpath, flags);
-    have = have_sections(file->fullpath, flags);
+    after_missing = missing_sections(file, flags);
+    have = have_sections(file, flags);
 
     if (debugpkg && after_missing) {
         /* debuginfo packages should not be missing debugging symbols */
@@ -232,7 +173,7 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         free(params.details);
 
         result = false;
-    } else if (!debugpkg && !is_guile(file->fullpath) && have) {
+    } else if (!debugpkg && !(get_rpmfile_elf_sections(file) & ELF_SECTION_GUILE) && have) {
         /* non-debuginfo packages should not contain debugging symbols */
         xasprintf(&params.msg, _("%s in %s on %s contains debugging symbols"), file->localpath, nvr, arch);
         params.severity = RESULT_BAD;
@@ -253,9 +194,7 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     /* handle build comparisons */
     if (file->peer_file) {
-        after_missing = missing_sections(file->fullpath, flags);
-        before_missing = missing_sections(file->peer_file->fullpath, flags);
-        have = have_sections(file->fullpath, flags);
+        before_missing = missing_sections(file->peer_file, flags);
 
         if (before_missing && !after_missing && have) {
             /* stripped in the before file but not the after file */
@@ -314,9 +253,9 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     /* Final non-debuginfo package checks */
     if (!debugpkg) {
-        elf = get_elf(file->fullpath, &fd);
+        have = get_rpmfile_elf_sections(file);
 
-        if (elf && have_elf_section(elf, -1, ELF_GOSYMTAB) && have_elf_section(elf, -1, ELF_GNU_DEBUGDATA)) {
+        if ((have & ELF_SECTION_GOSYMTAB) && (have & ELF_SECTION_GNU_DEBUGDATA)) {
             xasprintf(&params.msg, _("%s in %s on %s carries .gosymtab but should not have the .gnu_debugdata symbol"), file->localpath, nvr, arch);
             params.verb = VERB_FAILED;
             params.noun = _(".gnu_debugdata with .gosymtab");
@@ -330,9 +269,6 @@ static bool debuginfo_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             add_result(ri, &params);
             free(params.msg);
         }
-
-        close(fd);
-        elf_end(elf);
     }
 
     free(nvr);
@@ -346,6 +282,9 @@ bool inspect_debuginfo(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* set the sections to check for */
+    needed = get_flags(ri->debuginfo_sections);
+
     result = foreach_peer_file(ri, NAME_DEBUGINFO, debuginfo_driver);
 
     if (result) {
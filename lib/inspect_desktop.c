@@ -367,7 +367,7 @@ static bool validate_desktop_contents(struct rpminspect *ri, const rpmfile_entry
         }
 
         /* check standard system icons as a failsafe */
-        if (!found && init_icons(ri) && list_contains(ri->icons, key_icon)) {
+        if (!found && init_icons(ri) && set_contains(ri->icons_set, key_icon)) {
             found = true;
         }
 
@@ -55,16 +55,17 @@ static void append_macros(string_list_t **macros, const char *s)
     return;
 }
 
-static bool check_release_macros(const int macrocount, const pair_list_t *macros, const char *release, const char *disttag)
+static bool check_release_macros(const spec_model_t *spec, const char *release, const char *disttag)
 {
     bool ret = false;
     string_list_t *tag_macros = NULL;
     string_entry_t *macro = NULL;
-    pair_entry_t *pair = NULL;
+    string_entry_t *value = NULL;
+    spec_macro_t *specmacro = NULL;
     int found = 0;
     int valid = 0;
 
-    if (macrocount == 0 || release == NULL || disttag == NULL) {
+    if (spec->macros == NULL || release == NULL || disttag == NULL) {
         return false;
     }
 
@@ -87,14 +88,16 @@ static bool check_release_macros(const int macrocount, const pair_list_t *macros
         /* check this macro value for the dist tag */
         found = valid = 0;
 
-        TAILQ_FOREACH(pair, macros, items) {
-            if (!strcmp(pair->key, macro->data)) {
+        specmacro = get_spec_macro(spec, macro->data);
+
+        if (specmacro != NULL) {
+            TAILQ_FOREACH(value, specmacro->values, items) {
                 found++;
 
                 /* collect any new macros in this macro value */
-                append_macros(&tag_macros, pair->value);
+                append_macros(&tag_macros, value->data);
 
-                if (strstr(pair->value, SPEC_DISTTAG)) {
+                if (strstr(value->data, SPEC_DISTTAG)) {
                     valid++;
                 }
             }
@@ -120,54 +123,41 @@ static bool check_release_macros(const int macrocount, const pair_list_t *macros
 static bool disttag_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
-    string_list_t *contents = NULL;
-    string_entry_t *entry = NULL;
-    char *buf = NULL;
+    size_t i = 0;
+    spec_model_t *spec = NULL;
     char *release = NULL;
     char *expanded_release = NULL;
-    int macrocount = 0;
     struct result_params params;
 
     assert(ri != NULL);
     assert(file != NULL);
 
-    /* Read in spec file macros */
-    macrocount = get_specfile_macros(ri, file->fullpath);
-
     /* Check for the %{?dist} macro in the Release value */
-    contents = read_file(file->fullpath);
+    spec = get_spec_model(ri, file->fullpath);
 
-    if (contents == NULL) {
+    if (spec->nlines == 0) {
         return true;
     }
 
-    TAILQ_FOREACH(entry, contents, items) {
-        buf = entry->data;
-
-        /* trim line endings */
-        buf[strcspn(buf, "\r\n")] = 0;
-
-        /* we made it to the changelog, nothing left of value */
-        if (strprefix(buf, SPEC_SECTION_CHANGELOG)) {
-            break;
-        }
-
-        /* found the line to check */
-        if (strprefix(buf, SPEC_TAG_RELEASE)) {
+    /* nothing from the changelog on is of value */
+    for (i = 0; i < spec->changelog; i++) {
+        if (strprefix(spec->lines[i], SPEC_TAG_RELEASE)) {
+            release = spec->lines[i];
             break;
         }
     }
 
     /* Only look at the value on the Release: line */
-    release = buf + strlen(SPEC_TAG_RELEASE);
-    assert(release != NULL);
+    if (release != NULL) {
+        release += strlen(SPEC_TAG_RELEASE);
 
-    while (isspace(*release) && *release != '\0') {
-        release++;
-    }
+        while (isspace(*release) && *release != '\0') {
+            release++;
+        }
 
-    /* Expand macros in the release value */
-    expanded_release = rpmExpand(release, NULL);
+        /* Expand macros in the release value */
+        expanded_release = rpmExpand(release, NULL);
+    }
 
     /* Set up the result parameters */
     init_result_params(&params);
@@ -188,7 +178,7 @@ static bool disttag_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         result = false;
     } else if (strstr(release, SPEC_DISTTAG) || strstr(expanded_release, DIST_TAG_MARKER)) {
         result = true;
-    } else if (!check_release_macros(macrocount, ri->macros, release, SPEC_DISTTAG)) {
+    } else if (!check_release_macros(spec, release, SPEC_DISTTAG)) {
         xasprintf(&params.msg, _("The %s tag value is missing the dist tag in the proper form. The dist tag should be of the form '%s' in the %s tag or in a macro used in the %s tag. After RPM macro expansion, no dist tag was found in this %s tag value."), SPEC_TAG_RELEASE, SPEC_DISTTAG, SPEC_TAG_RELEASE, SPEC_TAG_RELEASE, SPEC_TAG_RELEASE);
         params.verb = VERB_FAILED;
         params.noun = _("${FILE} does not use '%%{?dist}' in Release");
@@ -198,7 +188,6 @@ static bool disttag_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     free(expanded_release);
     free(params.msg);
-    list_free(contents, free);
     return result;
 }
 
@@ -131,6 +131,9 @@ bool inspect_doc(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     result = foreach_peer_file(ri, NAME_DOC, doc_driver);
 
     if (result && !reported) {
@@ -34,16 +34,17 @@ static const char *files_macros[] = { "%artifact",
 static bool files_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
-    bool in_files = false;
-    bool valid_macro = false;
-    long line = 1;
-    int i = 0;
+    bool ignore = false;
+    size_t i = 0;
+    size_t n = 0;
+    int j = 0;
     struct result_params params;
-    string_list_t *spec = NULL;
-    string_entry_t *specline = NULL;
+    spec_model_t *spec = NULL;
+    const spec_section_t *section = NULL;
+    char *specline = NULL;
     string_entry_t *path = NULL;
     string_list_map_t *mapentry = NULL;
-    bool ignore = false;
+    bool valid_macro = false;
     char *noun = NULL;
 
     assert(ri != NULL);
@@ -64,71 +65,76 @@ static bool files_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.arch = get_rpm_header_arch(file->rpm_header);
     params.verb = VERB_FAILED;
 
-    /* read in the spec file */
-    spec = read_file(file->fullpath);
-    assert(spec != NULL);
+    /* paths to ignore in the spec file */
+    if (ri->inspection_ignores != NULL) {
+        HASH_FIND_STR(ri->inspection_ignores, NAME_FILES, mapentry);
+    }
 
     /* scan all %files sections for any forbidden path references */
-    TAILQ_FOREACH(specline, spec, items) {
-        /* determine when we enter and leave %files sections */
-        if (*specline->data == '%') {
-            if (strprefix(specline->data, SPEC_SECTION_FILES)) {
-                in_files = true;
-            } else if (in_files) {
-                /* look for valid macros in the %files section */
-                for (i = 0; files_macros[i] != NULL; i++) {
-                    if (strprefix(specline->data, files_macros[i])) {
+    spec = get_spec_model(ri, file->fullpath);
+
+    for (i = 0; i < spec->nsections; i++) {
+        section = &spec->sections[i];
+
+        if (!spec_section_is(section, SPEC_SECTION_FILES)) {
+            continue;
+        }
+
+        for (n = section->start + 1; n < section->end; n++) {
+            specline = spec->lines[n];
+
+            /* anything other than a valid macro ends the file list */
+            if (*specline == '%') {
+                valid_macro = false;
+
+                for (j = 0; files_macros[j] != NULL; j++) {
+                    if (strprefix(specline, files_macros[j])) {
                         valid_macro = true;
                         break;
                     }
                 }
 
-                if (!valid_macro && !strprefix(specline->data, "%{")) {
-                    in_files = false;
+                if (!valid_macro && !strprefix(specline, "%{")) {
+                    break;
                 }
             }
-        }
 
-        /* check for forbidden references */
-        if (in_files && *specline->data != '#') {
+            /* check for forbidden references */
+            if (*specline == '#') {
+                continue;
+            }
+
             /* skip if this path is something we should ignore */
-            if (ri->inspection_ignores != NULL) {
-                HASH_FIND_STR(ri->inspection_ignores, NAME_FILES, mapentry);
-
-                if (mapentry != NULL && mapentry->value != NULL && !TAILQ_EMPTY(mapentry->value)) {
-                    TAILQ_FOREACH(path, mapentry->value, items) {
-                        if (strprefix(specline->data, path->data)) {
-                            ignore = true;
-                            break;
-                        }
+            ignore = false;
+
+            if (mapentry != NULL && mapentry->value != NULL && !TAILQ_EMPTY(mapentry->value)) {
+                TAILQ_FOREACH(path, mapentry->value, items) {
+                    if (strprefix(specline, path->data)) {
+                        ignore = true;
+                        break;
                     }
                 }
             }
 
-            if (!ignore) {
-                TAILQ_FOREACH(path, ri->forbidden_paths, items) {
-                    if (strprefix(specline->data, path->data)) {
-                        xasprintf(&params.msg, _("Forbidden path reference (%s) on line %ld of %s"), path->data, line, file->localpath);
-                        params.details = specline->data;
-                        xasprintf(&noun, _("invalid spec line: %s"), specline->data);
-                        params.noun = noun;
-                        add_result(ri, &params);
-                        free(params.msg);
-                        free(noun);
-                        result = false;
-                    }
+            if (ignore) {
+                continue;
+            }
+
+            TAILQ_FOREACH(path, ri->forbidden_paths, items) {
+                if (strprefix(specline, path->data)) {
+                    xasprintf(&params.msg, _("Forbidden path reference (%s) on line %ld of %s"), path->data, (long) (n + 1), file->localpath);
+                    params.details = specline;
+                    xasprintf(&noun, _("invalid spec line: %s"), specline);
+                    params.noun = noun;
+                    add_result(ri, &params);
+                    free(params.msg);
+                    free(noun);
+                    result = false;
                 }
             }
         }
-
-        /* increment spec file line counter */
-        line++;
-
-        /* reset for next loop iteration--only valid for current line */
-        valid_macro = false;
     }
 
-    list_free(spec, free);
     return result;
 }
 
@@ -134,6 +134,9 @@ bool inspect_filesize(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     /* run the size inspection across all RPM files */
     result = foreach_peer_file(ri, NAME_FILESIZE, filesize_driver);
 
@@ -190,7 +190,7 @@ static bool javabytecode_driver(struct rpminspect *ri, rpmfile_entry_t *file, co
         /* if we have a possible jar file, try to unpack and walk it */
 
         /* create a temporary directory to unpack this file */
-        xasprintf(&tmppath, "%s/jar.XXXXXX", ri->workdir);
+        xasprintf(&tmppath, "%s/jar.XXXXXX", ri->worksubdir);
         tmppath = mkdtemp(tmppath);
 
         if (tmppath == NULL) {
@@ -248,6 +248,9 @@ bool inspect_javabytecode(struct rpminspect *ri)
     assert(ri != NULL);
     assert(ri->peers != NULL);
 
+    /* state left over from a previous run */
+    jar_result = true;
+
     /*
      * Get the major JVM version for this product release.
      */
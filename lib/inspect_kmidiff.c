@@ -300,6 +300,9 @@ bool inspect_kmidiff(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    found_kernel_image = false;
+
     /* get the kabi path if that exists in this build */
     get_kabi_dir(ri);
 
@@ -347,6 +350,9 @@ bool inspect_kmidiff(struct rpminspect *ri)
     free(cmdprefix);
     list_free(suppressions, free);
     free(kabi_dir);
+    cmdprefix = NULL;
+    suppressions = NULL;
+    kabi_dir = NULL;
 
     /* report the inspection results */
     if (result) {
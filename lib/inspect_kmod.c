@@ -15,63 +15,201 @@
 static bool reported = false;
 static struct result_params params;
 
+/* libkmod context shared by every module comparison */
+static struct kmod_ctx *kctx = NULL;
+
+/* modinfo of each kernel module read so far */
+static kmod_info_t *modinfo = NULL;
+
+/* kernel modules collected for comparison */
+static file_check_t *checks = NULL;
+static size_t nchecks = 0;
+
+/*
+ * The comparison of a module pair is written as one record per line
+ * of the form "<kind>\t<value>" or, for aliases,
+ * "<kind>\t<alias>\t<module>".  Backslashes, tabs, and newlines in
+ * the fields are escaped as \\, \t, and \n since modinfo values can
+ * contain them.
+ */
+#define KMOD_PARM_LOST  "parm-"
+#define KMOD_PARM_GAIN  "parm+"
+#define KMOD_DEPS_LOST  "deps-"
+#define KMOD_DEPS_GAIN  "deps+"
+#define KMOD_ALIAS_LOST "alias-"
+#define KMOD_ALIAS_GAIN "alias+"
+
+/* Append one field of a record, escaped */
+static void add_field(strbuf_t *record, const char *field)
+{
+    const char *p = NULL;
+
+    strbuf_append(record, "\t");
+
+    for (p = field; *p != '\0'; p++) {
+        if (*p == '\\') {
+            strbuf_append(record, "\\\\");
+        } else if (*p == '\t') {
+            strbuf_append(record, "\\t");
+        } else if (*p == '\n') {
+            strbuf_append(record, "\\n");
+        } else {
+            strbuf_append_len(record, p, 1);
+        }
+    }
+
+    return;
+}
+
+/* Append a record, module is NULL for all but the alias records */
+static void add_record(strbuf_t *output, const char *kind, const char *value, const char *module)
+{
+    strbuf_append(output, kind);
+    add_field(output, value);
+
+    if (module != NULL) {
+        add_field(output, module);
+    }
+
+    strbuf_append(output, "\n");
+    return;
+}
+
+/* Undo the escaping of add_field() in place */
+static void unescape_field(char *field)
+{
+    char *in = field;
+    char *out = field;
+
+    if (field == NULL) {
+        return;
+    }
+
+    while (*in != '\0') {
+        if (*in == '\\' && in[1] != '\0') {
+            in++;
+            *out++ = (*in == 't') ? '\t' : (*in == 'n') ? '\n' : *in;
+            in++;
+        } else {
+            *out++ = *in++;
+        }
+    }
+
+    *out = '\0';
+    return;
+}
+
+static void add_records(strbuf_t *output, const char *kind, const string_list_t *list)
+{
+    string_entry_t *entry = NULL;
+
+    if (list == NULL) {
+        return;
+    }
+
+    TAILQ_FOREACH(entry, list, items) {
+        add_record(output, kind, entry->data, NULL);
+    }
+
+    return;
+}
+
 static void lost_alias(const char *alias, const string_list_t *before_modules, const string_list_t *after_modules, void *user_data)
 {
-    struct rpminspect *ri = (struct rpminspect *) user_data;
+    strbuf_t *output = (strbuf_t *) user_data;
     string_entry_t *entry = NULL;
 
     assert(alias != NULL);
     assert(before_modules != NULL);
-    assert(ri != NULL);
-
-    params.remedy = REMEDY_KMOD_ALIAS;
-    params.noun = _("${FILE} kernel module alias on ${ARCH}");
+    assert(output != NULL);
 
     TAILQ_FOREACH(entry, before_modules, items) {
-        xasprintf(&params.msg, _("Kernel module '%s' lost alias '%s'"), entry->data, alias);
-        params.verb = VERB_REMOVED;
-        params.file = entry->data;
-        add_result(ri, &params);
-        free(params.msg);
-        reported = true;
+        add_record(output, KMOD_ALIAS_LOST, alias, entry->data);
     }
 
     if (after_modules && !TAILQ_EMPTY(after_modules)) {
         TAILQ_FOREACH(entry, after_modules, items) {
-            xasprintf(&params.msg, _("Kernel module '%s' gained alias '%s'"), entry->data, alias);
-            params.verb = VERB_ADDED;
-            params.file = entry->data;
-            add_result(ri, &params);
-            free(params.msg);
-            reported = true;
+            add_record(output, KMOD_ALIAS_GAIN, alias, entry->data);
         }
     }
 
     return;
 }
 
-static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Check function for run_checks().  Compares the modinfo of a kernel
+ * module with its peer and writes the differences as records.
+ */
+static int kmod_check(rpmfile_entry_t *file, char **output)
 {
-    int err = -1;
     bool result_parm = true;
     bool result_deps = true;
     bool result_aliases = true;
-    struct kmod_ctx *kctx = NULL;
-    struct kmod_module *beforekmod = NULL;
-    struct kmod_module *afterkmod = NULL;
-    struct kmod_list *beforeinfo = NULL;
-    struct kmod_list *afterinfo = NULL;
-    const char *before_kmod_name = NULL;
-    const char *after_kmod_name = NULL;
-    kernel_alias_data_t *beforealiases = NULL;
-    kernel_alias_data_t *afteraliases = NULL;
+    kmod_info_t *before = NULL;
+    kmod_info_t *after = NULL;
     string_list_t *lost = NULL;
     string_list_t *gain = NULL;
-    string_entry_t *entry = NULL;
-    const char *beforename = NULL;
-    const char *aftername = NULL;
-    const char *beforever = NULL;
-    const char *afterver = NULL;
+    strbuf_t records;
+
+    assert(file != NULL);
+    assert(file->peer_file != NULL);
+    assert(output != NULL);
+
+    /* Read in the kernel modules */
+    before = get_kmod_info(kctx, &modinfo, file->peer_file->fullpath);
+    after = get_kmod_info(kctx, &modinfo, file->fullpath);
+
+    if (before == NULL || after == NULL) {
+        /* not a kernel module */
+        return 0;
+    }
+
+    /* all of the records are built up here and copied out once */
+    memset(&records, 0, sizeof(records));
+
+    /* Compute lost and gained module parameters */
+    result_parm = compare_module_parameters(before, after, &lost, &gain);
+
+    if (!result_parm) {
+        add_records(&records, KMOD_PARM_LOST, lost);
+    }
+
+    add_records(&records, KMOD_PARM_GAIN, gain);
+    list_free(lost, free);
+    list_free(gain, free);
+    lost = NULL;
+    gain = NULL;
+
+    /* Compute lost and gained module dependencies */
+    result_deps = compare_module_dependencies(before, after, &lost, &gain);
+
+    if (!result_deps) {
+        add_records(&records, KMOD_DEPS_LOST, lost);
+    }
+
+    add_records(&records, KMOD_DEPS_GAIN, gain);
+    list_free(lost, free);
+    list_free(gain, free);
+
+    /* Compute lost PCI device IDs in kernel modules */
+    result_aliases = compare_module_aliases(before->aliases, after->aliases, lost_alias, &records);
+
+    DEBUG_PRINT("result_parm=%d, result_deps=%d, result_aliases=%d\n", result_parm, result_deps, result_aliases);
+
+    if (records.len > 0) {
+        *output = strbuf_finish(&records);
+    }
+
+    return 0;
+}
+
+/*
+ * Collect the kernel modules to compare.  They are all compared at
+ * once after this.
+ */
+static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
+    const char *name = NULL;
 
     assert(ri != NULL);
     assert(file != NULL);
@@ -82,9 +220,9 @@ static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* Skip debuginfo and debugsource packages */
-    aftername = headerGetString(file->rpm_header, RPMTAG_NAME);
+    name = headerGetString(file->rpm_header, RPMTAG_NAME);
 
-    if (strsuffix(aftername, DEBUGINFO_SUFFIX) || strsuffix(aftername, DEBUGSOURCE_SUFFIX)) {
+    if (strsuffix(name, DEBUGINFO_SUFFIX) || strsuffix(name, DEBUGSOURCE_SUFFIX)) {
         return true;
     }
 
@@ -112,168 +250,90 @@ static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
-    /* Set reporting conditions based on the package name and version */
-    beforename = headerGetString(file->peer_file->rpm_header, RPMTAG_NAME);
-    aftername = headerGetString(file->rpm_header, RPMTAG_NAME);
-    beforever = headerGetString(file->peer_file->rpm_header, RPMTAG_VERSION);
-    afterver = headerGetString(file->rpm_header, RPMTAG_VERSION);
-    assert(beforename != NULL);
-    assert(aftername != NULL);
-    assert(beforever != NULL);
-    assert(afterver != NULL);
-
-    /* Read in the kernel modules */
-    kctx = kmod_new(NULL, NULL);
-
-    if (kctx == NULL) {
-        warn("kmod_new");
-        return true;
-    }
-
-    err = kmod_module_new_from_path(kctx, file->peer_file->fullpath, &beforekmod);
-
-    if (err < 0) {
-        /* not a kernel module */
-        kmod_unref(kctx);
-        return true;
-    } else {
-        before_kmod_name = kmod_module_get_name(beforekmod);
-    }
-
-    kmod_unref(kctx);
-    kctx = kmod_new(NULL, NULL);
+    checks = realloc(checks, (nchecks + 1) * sizeof(*checks));
+    assert(checks != NULL);
+    memset(&checks[nchecks], 0, sizeof(*checks));
+    checks[nchecks].file = file;
+    nchecks++;
 
-    if (kctx == NULL) {
-        warn("kmod_new");
-        return true;
-    }
-
-    err = kmod_module_new_from_path(kctx, file->fullpath, &afterkmod);
-
-    if (err < 0) {
-        /* not a kernel module */
-        kmod_module_unref(beforekmod);
-        kmod_unref(kctx);
-        return true;
-    } else {
-        after_kmod_name = kmod_module_get_name(afterkmod);
-    }
+    return true;
+}
 
-    /* Gather module parameters */
-    err = kmod_module_get_info(beforekmod, &beforeinfo);
+/*
+ * Report the differences found between a kernel module and its peer.
+ */
+static void kmod_report(struct rpminspect *ri, rpmfile_entry_t *file, char *output)
+{
+    char *line = NULL;
+    char *kind = NULL;
+    char *value = NULL;
+    char *module = NULL;
 
-    if (err < 0) {
-        warn("kmod_module_get_info");
-        kmod_module_unref(beforekmod);
-        kmod_module_unref(afterkmod);
-        kmod_unref(kctx);
-        return true;
-    }
+    assert(ri != NULL);
+    assert(file != NULL);
 
-    err = kmod_module_get_info(afterkmod, &afterinfo);
+    while ((line = strsep(&output, "\n")) != NULL) {
+        kind = strsep(&line, "\t");
+        value = strsep(&line, "\t");
+        module = line;
 
-    if (err < 0) {
-        warn("kmod_module_get_info");
-        kmod_module_info_free_list(beforeinfo);
-        kmod_module_unref(beforekmod);
-        kmod_module_unref(afterkmod);
-        kmod_unref(kctx);
-        return true;
-    }
+        if (value == NULL) {
+            continue;
+        }
 
-    /* Compute lost and gained module parameters */
-    result_parm = compare_module_parameters(beforeinfo, afterinfo, &lost, &gain);
+        unescape_field(value);
+        unescape_field(module);
 
-    /* Report parameters */
-    if (!result_parm && lost != NULL && !TAILQ_EMPTY(lost)) {
-        TAILQ_FOREACH(entry, lost, items) {
-            xasprintf(&params.msg, _("Kernel module %s removes parameter '%s' (was present in %s)."), file->localpath, entry->data, file->peer_file->localpath);
+        if (!strcmp(kind, KMOD_PARM_LOST)) {
+            xasprintf(&params.msg, _("Kernel module %s removes parameter '%s' (was present in %s)."), file->localpath, value, file->peer_file->localpath);
             params.remedy = REMEDY_KMOD_PARM;
             params.verb = VERB_REMOVED;
             params.noun = _("${FILE} kernel module parameter on ${ARCH}");
             params.file = file->localpath;
             params.arch = get_rpm_header_arch(file->rpm_header);
-            add_result(ri, &params);
-            free(params.msg);
-            reported = true;
-        }
-
-        list_free(lost, free);
-        lost = NULL;
-    }
-
-    if (gain != NULL && !TAILQ_EMPTY(gain)) {
-        TAILQ_FOREACH(entry, gain, items) {
-            xasprintf(&params.msg, _("Kernel module %s adds parameter '%s' (was not present in %s)."), file->localpath, entry->data, file->peer_file->localpath);
+        } else if (!strcmp(kind, KMOD_PARM_GAIN)) {
+            xasprintf(&params.msg, _("Kernel module %s adds parameter '%s' (was not present in %s)."), file->localpath, value, file->peer_file->localpath);
             params.remedy = NULL;
             params.verb = VERB_ADDED;
             params.noun = _("${FILE} kernel module parameter on ${ARCH}");
             params.file = file->localpath;
             params.arch = get_rpm_header_arch(file->rpm_header);
-            add_result(ri, &params);
-            free(params.msg);
-            reported = true;
-        }
-
-        list_free(gain, free);
-        gain = NULL;
-    }
-
-    /* Compute lost and gained module dependencies */
-    result_deps = compare_module_dependencies(beforeinfo, afterinfo, &lost, &gain);
-
-    /* Report dependencies */
-    if (!result_deps && lost != NULL && !TAILQ_EMPTY(lost)) {
-        TAILQ_FOREACH(entry, lost, items) {
-            xasprintf(&params.msg, _("Kernel module %s removes dependency '%s' (was present in %s)."), file->localpath, entry->data, file->peer_file->localpath);
+        } else if (!strcmp(kind, KMOD_DEPS_LOST)) {
+            xasprintf(&params.msg, _("Kernel module %s removes dependency '%s' (was present in %s)."), file->localpath, value, file->peer_file->localpath);
             params.remedy = REMEDY_KMOD_DEPS;
             params.verb = VERB_REMOVED;
             params.noun = _("${FILE} kernel module dependency on ${ARCH}");
             params.file = file->localpath;
             params.arch = get_rpm_header_arch(file->rpm_header);
-            add_result(ri, &params);
-            free(params.msg);
-            reported = true;
-        }
-
-        list_free(lost, free);
-        lost = NULL;
-    }
-
-    if (gain != NULL && !TAILQ_EMPTY(gain)) {
-        TAILQ_FOREACH(entry, gain, items) {
-            xasprintf(&params.msg, _("Kernel module %s adds dependency '%s' (was not present in %s)."), file->localpath, entry->data, file->peer_file->localpath);
+        } else if (!strcmp(kind, KMOD_DEPS_GAIN)) {
+            xasprintf(&params.msg, _("Kernel module %s adds dependency '%s' (was not present in %s)."), file->localpath, value, file->peer_file->localpath);
             params.remedy = REMEDY_KMOD_DEPS;
             params.verb = VERB_ADDED;
             params.noun = _("${FILE} kernel module parameter");
             params.file = file->localpath;
-            add_result(ri, &params);
-            free(params.msg);
-            reported = true;
+        } else if (module != NULL && !strcmp(kind, KMOD_ALIAS_LOST)) {
+            xasprintf(&params.msg, _("Kernel module '%s' lost alias '%s'"), module, value);
+            params.remedy = REMEDY_KMOD_ALIAS;
+            params.verb = VERB_REMOVED;
+            params.noun = _("${FILE} kernel module alias on ${ARCH}");
+            params.file = module;
+        } else if (module != NULL && !strcmp(kind, KMOD_ALIAS_GAIN)) {
+            xasprintf(&params.msg, _("Kernel module '%s' gained alias '%s'"), module, value);
+            params.remedy = REMEDY_KMOD_ALIAS;
+            params.verb = VERB_ADDED;
+            params.noun = _("${FILE} kernel module alias on ${ARCH}");
+            params.file = module;
+        } else {
+            continue;
         }
 
-        list_free(gain, free);
-        gain = NULL;
+        add_result(ri, &params);
+        free(params.msg);
+        params.msg = NULL;
+        reported = true;
     }
 
-    /* Compute lost PCI device IDs in kernel modules */
-    beforealiases = gather_module_aliases(before_kmod_name, beforeinfo);
-    afteraliases = gather_module_aliases(after_kmod_name, afterinfo);
-    result_aliases = compare_module_aliases(beforealiases, afteraliases, lost_alias, ri);
-
-    /* Clean up libkmod usage */
-    kmod_module_info_free_list(beforeinfo);
-    kmod_module_info_free_list(afterinfo);
-    kmod_module_unref(beforekmod);
-    kmod_module_unref(afterkmod);
-    kmod_unref(kctx);
-
-    /* Our own stuff */
-    free_module_aliases(beforealiases);
-    free_module_aliases(afteraliases);
-
-    DEBUG_PRINT("result_parm=%d, result_deps=%d, result_aliases=%d\n", result_parm, result_deps, result_aliases);
-    return true;
+    return;
 }
 
 /*
@@ -282,9 +342,13 @@ static bool kmod_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_kmod(struct rpminspect *ri)
 {
     bool result;
+    size_t i = 0;
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     /* run the kmod inspection across all RPM files */
     init_result_params(&params);
     params.severity = RESULT_INFO;
@@ -293,6 +357,31 @@ bool inspect_kmod(struct rpminspect *ri)
     params.verb = VERB_OK;
     result = foreach_peer_file(ri, NAME_KMOD, kmod_driver);
 
+    /* compare the collected modules concurrently with one libkmod context */
+    if (nchecks > 0) {
+        kctx = kmod_new(NULL, NULL);
+
+        if (kctx == NULL) {
+            warn("kmod_new");
+        } else {
+            run_checks(checks, nchecks, kmod_check, inspection_jobs(ri));
+            kmod_unref(kctx);
+            kctx = NULL;
+        }
+    }
+
+    /* report in the order the modules were found */
+    for (i = 0; i < nchecks; i++) {
+        kmod_report(ri, checks[i].file, checks[i].output);
+        free(checks[i].output);
+    }
+
+    free(checks);
+    checks = NULL;
+    nchecks = 0;
+    free_kmod_info(modinfo);
+    modinfo = NULL;
+
     /* if everything was fine, just say so */
     if (result && !reported) {
         params.severity = RESULT_OK;
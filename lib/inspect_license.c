@@ -528,7 +528,7 @@ static int check_peer_license(struct rpminspect *ri, struct result_params *param
         }
 
         /* does the license tag contain bad words? */
-        if (has_bad_word(license, ri->badwords)) {
+        if (has_bad_word(license, ri->badwords_matcher)) {
             xasprintf(&params->msg, _("License Tag contains unprofessional language in %s: %s"), nevra, license);
             params->severity = RESULT_BAD;
             params->remedy = REMEDY_LICENSE;
@@ -19,7 +19,28 @@
 #include "queue.h"
 #include "rpminspect.h"
 
-static string_list_t *lto_symbol_name_prefixes = NULL;
+/* The configured LTO symbol name prefixes, compiled for matching */
+static const matcher_t *lto_prefixes = NULL;
+
+/* Symbols already found in the current archive */
+static string_set_t *found = NULL;
+
+/*
+ * Return the configured LTO prefix the name starts with, or NULL.
+ */
+static const char *match_lto_prefix(const char *name)
+{
+    const matcher_pattern_t *match = NULL;
+
+    assert(name != NULL);
+
+    if ((match = match_first(lto_prefixes, name)) == NULL) {
+        return NULL;
+    }
+
+    DEBUG_PRINT("lto_symbol_name_prefix=|%s|\n", match->pattern);
+    return match->pattern;
+}
 
 /**
  * @brief Callback for lto_driver() for inspecting ELF .a files.
@@ -36,49 +57,31 @@ static string_list_t *lto_symbol_name_prefixes = NULL;
  */
 static bool find_lto_symbols(Elf *elf, string_list_t **user_data)
 {
-    string_list_t *specifics = *user_data;
     string_list_t *names = NULL;
     string_entry_t *entry = NULL;
-    string_entry_t *prefix = NULL;
     Elf_Arhdr *arhdr;
 
     assert(elf != NULL);
+    assert(user_data != NULL);
 
     if ((arhdr = elf_getarhdr(elf)) == NULL) {
         return true;
     }
 
-    specifics = calloc(1, sizeof(*specifics));
-    TAILQ_INIT(specifics);
-
     names = get_elf_section_names(elf, SHT_PROGBITS);
 
     if (names != NULL) {
         TAILQ_FOREACH(entry, names, items) {
             DEBUG_PRINT("entry->data=|%s|\n", entry->data);
 
-            TAILQ_FOREACH(prefix, lto_symbol_name_prefixes, items) {
-                DEBUG_PRINT("lto_symbol_name_prefix=|%s|\n", prefix->data);
-
-                if (strprefix(entry->data, prefix->data)) {
-                    /* don't add the symbol if we already have it */
-                    if (list_contains(specifics, entry->data)) {
-                        break;
-                    }
-
-                    /* add this symbol to the list */
-                    specifics = list_add(specifics, entry->data);
-                    break;
-                }
+            /* don't add the symbol if we already have it */
+            if (match_lto_prefix(entry->data) && !set_contains(found, entry->data)) {
+                *user_data = list_add(*user_data, entry->data);
+                found = set_add(found, TAILQ_LAST(*user_data, string_entry_s)->data);
             }
         }
     }
 
-    if (TAILQ_EMPTY(specifics)) {
-        list_free(specifics, free);
-        specifics = NULL;
-    }
-
     list_free(names, free);
 
     return true;
@@ -105,7 +108,6 @@ static bool lto_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     int fd = -1;
     string_list_t *names = NULL;
     string_entry_t *entry = NULL;
-    string_entry_t *prefix = NULL;
     const char *arch = NULL;
     char *badsyms = NULL;
     struct result_params params;
@@ -125,11 +127,6 @@ static bool lto_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
-    /* Only valid for ELF files */
-    if (!is_elf_file(file->fullpath)) {
-        return true;
-    }
-
     /* architecture is used in reporting */
     arch = get_rpm_header_arch(file->rpm_header);
 
@@ -147,9 +144,10 @@ static bool lto_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     if ((elf = get_elf_archive(file->fullpath, &fd)) != NULL) {
         /* we found an ELF static library */
         elf_archive_iterate(fd, elf, find_lto_symbols, &names);
+        free_string_set(found);
+        found = NULL;
 
         if (names != NULL) {
-            params.noun = entry->data;
             badsyms = list_to_string(names, ", ");
             xasprintf(&params.msg, _("%s contains symbols [%s] on %s; this is not portable across compiler versions"), file->localpath, badsyms, arch);
             add_result(ri, &params);
@@ -163,15 +161,12 @@ static bool lto_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
         if (names != NULL) {
             TAILQ_FOREACH(entry, names, items) {
-                TAILQ_FOREACH(prefix, ri->lto_symbol_name_prefixes, items) {
-                    if (strprefix(entry->data, prefix->data)) {
-                        params.noun = entry->data;
-                        xasprintf(&params.msg, _("%s contains symbol [%s] on %s; this is not portable across compiler versions"), file->localpath, entry->data, arch);
-                        add_result(ri, &params);
-                        free(params.msg);
-                        result = false;
-                        break;
-                    }
+                if (match_lto_prefix(entry->data)) {
+                    params.noun = entry->data;
+                    xasprintf(&params.msg, _("%s contains symbol [%s] on %s; this is not portable across compiler versions"), file->localpath, entry->data, arch);
+                    add_result(ri, &params);
+                    free(params.msg);
+                    result = false;
                 }
             }
         }
@@ -204,8 +199,8 @@ bool inspect_lto(struct rpminspect *ri)
 
     assert(ri != NULL);
 
-    if (ri->lto_symbol_name_prefixes != NULL) {
-        lto_symbol_name_prefixes = ri->lto_symbol_name_prefixes;
+    if (ri->lto_symbol_name_prefixes_matcher != NULL) {
+        lto_prefixes = ri->lto_symbol_name_prefixes_matcher;
         result = foreach_peer_file(ri, NAME_LTO, lto_driver);
     }
 
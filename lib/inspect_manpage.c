@@ -43,6 +43,11 @@
 
 static FILE *error_stream = NULL;
 static regex_t sections_regex;
+static struct mparse *parser = NULL;
+
+/* man pages collected for validation */
+static file_check_t *checks = NULL;
+static size_t nchecks = 0;
 
 /* Old API used an error message callback */
 #ifndef NEWLIBMANDOC
@@ -56,6 +61,21 @@ static void error_handler(enum mandocerr errtype, enum mandoclevel level,
 /* Free the memory used by mandoc */
 static void inspect_manpage_free(void)
 {
+    size_t i = 0;
+
+    if (parser != NULL) {
+        mparse_free(parser);
+        parser = NULL;
+    }
+
+    for (i = 0; i < nchecks; i++) {
+        free(checks[i].output);
+    }
+
+    free(checks);
+    checks = NULL;
+    nchecks = 0;
+
     mchars_free();
     regfree(&sections_regex);
 }
@@ -67,8 +87,21 @@ static bool inspect_manpage_alloc(void)
     char reg_error[BUFSIZ];
     char *tmp = NULL;
 
+    int parseopts = MPARSE_UTF8 | MPARSE_LATIN1;
+
     mchars_alloc();
 
+    /*
+     * One parser is reset and reused for every man page.  Worker
+     * processes each get their own copy of it.
+     */
+#ifdef NEWLIBMANDOC
+    parser = mparse_alloc(parseopts | MPARSE_VALIDATE, MANDOC_OS_OTHER, NULL);
+#else
+    parser = mparse_alloc(parseopts, MANDOCERR_ERROR, error_handler, MANDOC_OS_OTHER, NULL);
+#endif
+    assert(parser != NULL);
+
     /* extract the directory section to match 1, and the filename section to match 2.
      * For the directory section, look for /man<section>
      * For the filename section, look for <name>.<section>.gz
@@ -143,10 +176,8 @@ static bool inspect_manpage_path(const char *path)
  */
 static char *inspect_manpage_validity(const char *path, const char *localpath)
 {
-    struct mparse *parser = NULL;
     int fd = -1;
     char magic[2];
-    int parseopts = MPARSE_UTF8 | MPARSE_LATIN1;
 #ifndef NEWLIBMANDOC
     struct roff_man *man = NULL;
     enum mandoclevel result_tmp;
@@ -164,14 +195,11 @@ static char *inspect_manpage_validity(const char *path, const char *localpath)
     assert(error_stream != NULL);
 #ifdef NEWLIBMANDOC
     mandoc_msg_setoutfile(error_stream);
-#endif
 
-    /* Allocate a new manpage parsing context */
-#ifdef NEWLIBMANDOC
-    parser = mparse_alloc(parseopts | MPARSE_VALIDATE, MANDOC_OS_OTHER, NULL);
-#else
-    parser = mparse_alloc(parseopts, MANDOCERR_ERROR, error_handler, MANDOC_OS_OTHER, NULL);
+    /* the message level is global, start each man page over */
+    mandoc_msg_setrc(MANDOCLEVEL_OK);
 #endif
+
     assert(parser != NULL);
 
     /* Open the file */
@@ -237,8 +265,6 @@ static char *inspect_manpage_validity(const char *path, const char *localpath)
     }
 
 end:
-    mparse_free(parser);
-
     if (fd != -1) {
         close(fd);
     }
@@ -254,16 +280,24 @@ end:
     return error_buffer;
 }
 
-static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+/*
+ * Check function for run_checks().  Validates a single man page.
+ */
+static int manpage_check(rpmfile_entry_t *file, char **output)
 {
-    int r = 0;
-    char *uncompressed_man_page = NULL;
-    struct stat sb;
-    char *manpage_errors;
-    bool result = true;
-    const char *pkg = NULL;
-    struct result_params params;
+    assert(file != NULL);
+    assert(output != NULL);
+
+    *output = inspect_manpage_validity(file->fullpath, file->localpath);
+    return (*output == NULL) ? 0 : 1;
+}
 
+/*
+ * Collect the man pages to check.  Validation runs over all of them
+ * at once after this.
+ */
+static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
+{
     /* Skip source packages */
     if (headerIsSource(file->rpm_header)) {
         return true;
@@ -278,6 +312,26 @@ static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
+    checks = realloc(checks, (nchecks + 1) * sizeof(*checks));
+    assert(checks != NULL);
+    memset(&checks[nchecks], 0, sizeof(*checks));
+    checks[nchecks].file = file;
+    nchecks++;
+
+    return true;
+}
+
+/*
+ * Report the results for one man page.
+ */
+static bool manpage_report(struct rpminspect *ri, rpmfile_entry_t *file, const char *manpage_errors)
+{
+    char *uncompressed = NULL;
+    size_t len = 0;
+    bool result = true;
+    const char *pkg = NULL;
+    struct result_params params;
+
     /* the package name is used for reporting */
     pkg = headerGetString(file->rpm_header, RPMTAG_NAME);
 
@@ -290,35 +344,29 @@ static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.file = file->localpath;
     params.verb = VERB_FAILED;
 
-    /* check for empty man pages */
-    uncompressed_man_page = uncompress_file(ri, file->fullpath, NAME_MANPAGE);
-    if (uncompressed_man_page != NULL) {
-        r = stat(uncompressed_man_page, &sb);
-
-        if (r == 0 && sb.st_size == 0) {
-            xasprintf(&params.msg, _("Man page %s is possibly empty on %s in %s"), file->localpath, params.arch, pkg);
-            params.remedy = REMEDY_MAN_ERRORS;
-            params.details = NULL;
-            params.noun = _("empty man page ${FILE} on ${ARCH}");
-            add_result(ri, &params);
-            result = false;
-            free(params.msg);
-        } else if (r == -1) {
-            warn("stat");
-        }
+    /* check for empty man pages, only the first byte is needed */
+    uncompressed = uncompress_to_memory(file->fullpath, 1, &len);
 
-        free(uncompressed_man_page);
+    if (uncompressed != NULL && len == 0) {
+        xasprintf(&params.msg, _("Man page %s is possibly empty on %s in %s"), file->localpath, params.arch, pkg);
+        params.remedy = REMEDY_MAN_ERRORS;
+        params.details = NULL;
+        params.noun = _("empty man page ${FILE} on ${ARCH}");
+        add_result(ri, &params);
+        result = false;
+        free(params.msg);
     }
 
+    free(uncompressed);
+
     /* check man page validity */
-    if ((manpage_errors = inspect_manpage_validity(file->fullpath, file->localpath)) != NULL) {
+    if (manpage_errors != NULL) {
         xasprintf(&params.msg, _("Man page checker reported problems with %s on %s in %s"), file->localpath, params.arch, pkg);
         params.remedy = REMEDY_MAN_ERRORS;
-        params.details = manpage_errors;
+        params.details = (char *) manpage_errors;
         params.noun = _("man page ${FILE} on ${ARCH} has errors");
         add_result(ri, &params);
         free(params.msg);
-        free(manpage_errors);
         result = false;
     }
 
@@ -339,10 +387,24 @@ static bool manpage_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_manpage(struct rpminspect *ri)
 {
     bool result;
+    size_t i = 0;
     struct result_params params;
 
-    inspect_manpage_alloc();
+    if (!inspect_manpage_alloc()) {
+        return false;
+    }
+
+    /* collect the man pages and validate them concurrently */
     result = foreach_peer_file(ri, NAME_MANPAGE, manpage_driver);
+    run_checks(checks, nchecks, manpage_check, inspection_jobs(ri));
+
+    /* report in the order the man pages were found */
+    for (i = 0; i < nchecks; i++) {
+        if (!manpage_report(ri, checks[i].file, checks[i].output)) {
+            result = false;
+        }
+    }
+
     inspect_manpage_free();
 
     if (result) {
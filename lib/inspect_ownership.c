@@ -295,6 +295,10 @@ bool inspect_ownership(struct rpminspect *ri)
     struct result_params params;
 
     assert(ri != NULL);
+
+    /* state left over from a previous run */
+    reported = false;
+
     result = foreach_peer_file(ri, NAME_OWNERSHIP, ownership_driver);
 
     if (result && !reported) {
@@ -78,95 +78,60 @@ static void free_applied_patches(applied_patches_t *table)
  * Returns true if the %autopatch or %autosetup macros are in use in
  * the spec file.
  */
-static bool have_automacro(const struct rpminspect *ri, const rpmfile_entry_t *specfile)
+static bool have_automacro(struct rpminspect *ri, const spec_model_t *spec)
 {
-    bool r = false;
-    bool in_valid_section = false;
-    string_list_t *contents = NULL;
-    string_entry_t *entry = NULL;
+    size_t i = 0;
+    size_t n = 0;
+    size_t len = 0;
+    const spec_section_t *section = NULL;
+    const char *buf = NULL;
     string_entry_t *macro = NULL;
-    char *buf = NULL;
-    char *automacro = NULL;
-    char *autospace = NULL;
 
     assert(ri != NULL);
 
-    /* No spec file, we know nothing. */
-    if (specfile == NULL) {
-        return false;
-    }
-
-    /* Read in the spec file */
-    contents = read_file(specfile->fullpath);
-
-    if (contents == NULL) {
+    /* No spec file or no auto macros, we know nothing. */
+    if (spec == NULL || ri->automacros == NULL || TAILQ_EMPTY(ri->automacros)) {
         return false;
     }
 
     /* Look for %autopatch or %autosetup in valid sections */
-    TAILQ_FOREACH(entry, contents, items) {
-        if (entry->data == NULL) {
+    for (i = 0; i < spec->nsections; i++) {
+        section = &spec->sections[i];
+
+        if (!spec_section_is(section, SPEC_SECTION_PREP)
+            && !spec_section_is(section, SPEC_SECTION_BUILD)
+            && !spec_section_is(section, SPEC_SECTION_INSTALL)
+            && !spec_section_is(section, SPEC_SECTION_CHECK)) {
             continue;
         }
 
-        buf = entry->data;
-
-        /* trim line endings */
-        buf[strcspn(buf, "\r\n")] = 0;
+        for (n = section->start + 1; n < section->end; n++) {
+            buf = spec->lines[n];
 
-        /* we made it to the changelog, nothing left of value */
-        if (strprefix(buf, SPEC_SECTION_CHANGELOG)) {
-            break;
-        }
+            while (isspace(*buf)) {
+                buf++;
+            }
 
-        /* section marker check */
-        /*
-         * not sure if leading whitespace is allowed by RPM, but I
-         * have seen stranger things
-         */
-        buf = strtrim(buf);
-
-        if (buf && *buf == '%') {
-            if (strprefix(buf, SPEC_SECTION_PREP)
-                || strprefix(buf, SPEC_SECTION_BUILD)
-                || strprefix(buf, SPEC_SECTION_INSTALL)
-                || strprefix(buf, SPEC_SECTION_CHECK)) {
-                in_valid_section = true;
-            } else if (!strcmp(buf, SPEC_SECTION_CHANGELOG)) {
-                in_valid_section = false;
-                break;
+            if (*buf != '%') {
+                continue;
             }
-        }
 
-        /* look for the auto macros */
-        /*
-         * this matches lines that are either the macro itself, or the
-         * macro followed by one or more options
-         */
-        if (in_valid_section && buf && (ri->automacros != NULL && !TAILQ_EMPTY(ri->automacros))) {
+            /*
+             * this matches lines that are either the macro itself, or
+             * the macro followed by one or more options
+             */
             TAILQ_FOREACH(macro, ri->automacros, items) {
-                xasprintf(&automacro, "%%%s", macro->data);
-                assert(automacro != NULL);
-                xasprintf(&autospace, "%s ", automacro);
-                assert(autospace != NULL);
-
-                if (!strcmp(buf, automacro) || strprefix(buf, autospace)) {
-                    DEBUG_PRINT("found %s macro on this line:\n    %s\n", automacro, buf);
-                    r = true;
-                }
+                len = strlen(macro->data);
 
-                free(automacro);
-                free(autospace);
-
-                if (r) {
-                    break;
+                if (!strncmp(buf + 1, macro->data, len) && (buf[len + 1] == '\0' || isspace(buf[len + 1]))) {
+                    DEBUG_PRINT("found %%%s macro on this line:\n    %s\n", macro->data, buf);
+                    return true;
                 }
             }
         }
     }
 
-    list_free(contents, free);
-    return r;
+    return false;
 }
 
 /* Returns true if this file is a Patch file */
@@ -196,18 +161,17 @@ static bool is_patch(const rpmfile_entry_t *file)
  * name.  Function returns a newly allocated string that the caller
  * must free.
  */
-static char *expand_patchname_macros(struct rpminspect *ri, const rpmfile_entry_t *specfile, const char *patchname)
+static char *expand_patchname_macros(const spec_model_t *spec, const rpmfile_entry_t *specfile, const char *patchname)
 {
     char *r = NULL;
     char *tmp = NULL;
     Header hdr;
-    int nmacros = 0;
-    pair_entry_t *pair = NULL;
+    spec_macro_t *specmacro = NULL;
     char *macro = NULL;
     string_list_t *macros = NULL;
     string_entry_t *entry = NULL;
 
-    assert(ri != NULL);
+    assert(spec != NULL);
     assert(specfile != NULL);
     assert(patchname != NULL);
 
@@ -234,21 +198,15 @@ static char *expand_patchname_macros(struct rpminspect *ri, const rpmfile_entry_
             tmp = strreplace(r, "%{name}", headerGetString(hdr, RPMTAG_NAME));
             assert(tmp != NULL);
         } else {
-            /* read in spec file macros */
-            nmacros = get_specfile_macros(ri, specfile->fullpath);
-
             /* try to sub in any spec file defined macros */
-            if (nmacros > 0) {
-                TAILQ_FOREACH(pair, ri->macros, items) {
-                    if (!strcmp(entry->data, pair->key)) {
-                        xasprintf(&macro, "%%{%s}", pair->key);
-                        assert(macro != NULL);
-                        tmp = strreplace(r, macro, pair->value);
-                        assert(tmp != NULL);
-                        free(macro);
-                        break;
-                    }
-                }
+            specmacro = get_spec_macro(spec, entry->data);
+
+            if (specmacro != NULL) {
+                xasprintf(&macro, "%%{%s}", specmacro->name);
+                assert(macro != NULL);
+                tmp = strreplace(r, macro, TAILQ_FIRST(specmacro->values)->data);
+                assert(tmp != NULL);
+                free(macro);
             }
         }
 
@@ -282,8 +240,8 @@ static patchstat_t get_patch_stats(const char *patch)
     r.files = 0;
     r.lines = 0;
 
-    /* read in the patch file */
-    lines = read_file(patch);
+    /* split the patch in to lines */
+    lines = strsplit(patch, "\n");
 
     if (lines == NULL || TAILQ_EMPTY(lines)) {
         return r;
@@ -352,9 +310,7 @@ static bool patches_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     char *buf = NULL;
     char *before_patch = NULL;
     char *after_patch = NULL;
-    char *details = NULL;
     patchstat_t ps;
-    struct stat sb;
     size_t apsz = 0;
     size_t bpsz = 0;
     long unsigned int oldsize = 0;
@@ -429,9 +385,9 @@ static bool patches_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
     }
 
-    /* patches may be compressed, so uncompress them here for diff(1) */
+    /* patches may be compressed, so uncompress them here for comparison */
     if (file->peer_file) {
-        before_patch = uncompress_file(ri, file->peer_file->fullpath, NAME_PATCHES);
+        before_patch = uncompress_to_memory(file->peer_file->fullpath, 0, &bpsz);
 
         if (before_patch == NULL) {
             warnx(_("unable to uncompress patch: %s"), file->peer_file->localpath);
@@ -439,7 +395,7 @@ static bool patches_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
     }
 
-    after_patch = uncompress_file(ri, file->fullpath, NAME_PATCHES);
+    after_patch = uncompress_to_memory(file->fullpath, 0, &apsz);
 
     if (after_patch == NULL) {
         warnx(_("unable to uncompress patch: %s"), file->localpath);
@@ -451,21 +407,7 @@ static bool patches_driver(struct rpminspect *ri, rpmfile_entry_t *file)
      * "empty patch" mistakes that have occurred when people are
      * generating multiple patches against multiple branches.
      */
-    if (stat(after_patch, &sb) != 0) {
-        warn("stat");
-        return false;
-    }
-
-    apsz = sb.st_size;
-
-    if (file->peer_file && before_patch && stat(before_patch, &sb) != 0) {
-        warn("stat");
-        return false;
-    }
-
-    bpsz = sb.st_size;
-
-    if ((apsz < 4) || (bpsz < 4)) {
+    if ((apsz < 4) || (file->peer_file && bpsz < 4)) {
         params.severity = RESULT_BAD;
         params.waiverauth = WAIVABLE_BY_ANYONE;
         params.details = NULL;
@@ -498,7 +440,7 @@ static bool patches_driver(struct rpminspect *ri, rpmfile_entry_t *file)
      * This just reports patches that change content.  It uses the INFO reporting level.
      */
     if (comparison && file->peer_file) {
-        params.details = get_file_delta(before_patch, after_patch);
+        params.details = get_buffer_delta(before_patch, bpsz, after_patch, apsz, NULL);
 
         if (params.details) {
             /* more than whitespace changed */
@@ -511,14 +453,6 @@ static bool patches_driver(struct rpminspect *ri, rpmfile_entry_t *file)
             params.noun = _("patch file ${FILE}");
             params.file = file->localpath;
 
-            /* use friendly names for the files in the diff(1) details */
-            details = strreplace(params.details, before_patch, file->peer_file->localpath);
-            assert(details != NULL);
-            free(params.details);
-            params.details = strreplace(details, after_patch, file->localpath);
-            free(details);
-            assert(params.details != NULL);
-
             /* report the findings */
             add_result(ri, &params);
             free(params.details);
@@ -587,23 +521,21 @@ bool inspect_patches(struct rpminspect *ri)
     string_list_t *before_patchfiles = NULL;
     string_list_t *removed = NULL;
     string_entry_t *patch = NULL;
-    string_list_t *speclines = NULL;
-    string_entry_t *specentry = NULL;
-    string_list_t *fields = NULL;
     string_entry_t *entry = NULL;
+    spec_model_t *spec = NULL;
+    string_set_t *patchset = NULL;
     patches_t *hentry = NULL;
     applied_patches_t *aentry = NULL;
     char *patchfile = NULL;
-    char *patchhead = NULL;
-    char *buf = NULL;
-    size_t len = 0;
-    size_t tl = 0;
-    size_t ml = 0;
-    bool numarg = false;
+    size_t i = 0;
     struct result_params params;
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+    comparison = false;
+
     init_result_params(&params);
     params.header = NAME_PATCHES;
 
@@ -657,7 +589,8 @@ bool inspect_patches(struct rpminspect *ri)
         }
 
         /* Determine if %autopatch or %autosetup is used */
-        automacro = have_automacro(ri, specfile);
+        spec = (specfile == NULL) ? NULL : get_spec_model(ri, specfile->fullpath);
+        automacro = have_automacro(ri, spec);
 
         /* Initialize the patches hash table */
         patchfiles = get_rpm_header_string_array(specfile->rpm_header, RPMTAG_PATCH);
@@ -673,192 +606,51 @@ bool inspect_patches(struct rpminspect *ri)
                     HASH_ADD_KEYPTR(hh, patches, hentry->patch, strlen(hentry->patch), hentry);
                 }
             } else {
-                /* read in the spec file */
-                speclines = read_file(file->fullpath);
+                patchset = list_to_set(patchfiles);
+
+                /* the PatchN: lines */
+                for (i = 0; i < spec->npatches; i++) {
+                    /* the patch file may contain macros, so try to replace those */
+                    patchfile = expand_patchname_macros(spec, specfile, spec->patches[i].value);
+                    assert(patchfile != NULL);
+
+                    /* see if we have this patch */
+                    if (!set_contains(patchset, patchfile)) {
+                        params.severity = RESULT_VERIFY;
+                        params.waiverauth = WAIVABLE_BY_ANYONE;
+                        params.remedy = REMEDY_PATCHES_UNHANDLED_PATCH;
+                        xasprintf(&params.msg, _("Unhandled patch file `%s` defined in spec file"), patchfile);
+                        add_result(ri, &params);
+                        free(params.msg);
+                        reported = true;
+                        result = !(params.severity >= RESULT_VERIFY);
+                        free(patchfile);
+                        continue;
+                    }
 
-                if (speclines == NULL) {
-                    err(RI_PROGRAM_ERROR, "read_file");
+                    /* add a new patch entry to the hash table */
+                    hentry = calloc(1, sizeof(*hentry));
+                    assert(hentry != NULL);
+                    hentry->patch = patchfile;
+                    hentry->num = spec->patches[i].num;
+                    HASH_ADD_KEYPTR(hh, patches, hentry->patch, strlen(hentry->patch), hentry);
                 }
 
-                TAILQ_FOREACH(specentry, speclines, items) {
-                    fields = NULL;
+                free_string_set(patchset);
 
-                    /* no more patch files to check */
-                    if (patchfiles == NULL || TAILQ_EMPTY(patchfiles)) {
-                        break;
-                    }
-
-                    /* trim the spec file line of leading and trailing whitespace */
-                    specentry->data = strtrim(specentry->data);
-                    assert(specentry->data != NULL);
+                /* the %patch lines in %prep */
+                for (i = 0; i < spec->napplied; i++) {
+                    aentry = calloc(1, sizeof(*aentry));
+                    assert(aentry != NULL);
+                    aentry->num = spec->applied[i].num;
 
-                    /* nothing from the changelog on */
-                    if (strprefix(specentry->data, SPEC_SECTION_CHANGELOG)) {
-                        break;
+                    if (spec->applied[i].value != NULL) {
+                        aentry->opts = strdup(spec->applied[i].value);
+                        assert(aentry->opts != NULL);
                     }
 
-                    /* read patch lines */
-                    if (strprefix(specentry->data, SPEC_TAG_PATCH) && strstr(specentry->data, ":")) {
-                        /* split the line - first field is PatchN:, second is the patch */
-                        fields = strsplit(specentry->data, ": \t");
-                        len = list_len(fields);
-
-                        if (len < 2) {
-                            errx(RI_PROGRAM_ERROR, "*** unable to parse line `%s'\n", specentry->data);
-                        }
-
-                        patch = TAILQ_FIRST(fields);
-                        assert(patch != NULL);
-                        entry = TAILQ_NEXT(patch, items);
-                        assert(entry != NULL);
-
-                        /* the patch file may contain macros, so try to replace those */
-                        patchhead = patchfile = expand_patchname_macros(ri, specfile, entry->data);
-                        assert(patchfile != NULL);
-
-                        /* see if we have this patch */
-                        if (!list_contains(patchfiles, patchfile)) {
-                            params.severity = RESULT_VERIFY;
-                            params.waiverauth = WAIVABLE_BY_ANYONE;
-                            params.remedy = REMEDY_PATCHES_UNHANDLED_PATCH;
-                            xasprintf(&params.msg, _("Unhandled patch file `%s` defined in spec file"), patchfile);
-                            add_result(ri, &params);
-                            free(params.msg);
-                            reported = true;
-                            result = !(params.severity >= RESULT_VERIFY);
-
-                            list_free(fields, free);
-                            continue;
-                        }
-
-                        /* extract just the number from the tag */
-                        buf = patch->data;
-                        buf += strlen(SPEC_TAG_PATCH);
-
-                        /* patch entry may have leading whitespace */
-                        while (isspace(*patchfile) && *patchfile != '\0') {
-                            patchfile++;
-                        }
-
-                        /* add a new patch entry to the hash table */
-                        hentry = calloc(1, sizeof(*hentry));
-                        assert(hentry != NULL);
-                        hentry->patch = strdup(patchfile);
-                        hentry->num = strtoll(buf, NULL, 10);
-
-                        if (errno == ERANGE || errno == EINVAL) {
-                            warn("strtoll");
-                            hentry->num = -1;
-                        }
-
-                        HASH_ADD_KEYPTR(hh, patches, hentry->patch, strlen(hentry->patch), hentry);
-                        free(patchhead);
-                    } else if (strprefix(specentry->data, SPEC_MACRO_PATCH)) {
-                        /* split the line - first field is %patch, second and beyond (optional) is opts */
-                        fields = strsplit(specentry->data, " \t");
-                        patch = TAILQ_FIRST(fields);
-                        assert(patch != NULL);
-                        entry = TAILQ_NEXT(patch, items);
-                        buf = NULL;
-
-                        /* extract just the number from the macro */
-                        tl = strlen(patch->data);
-                        ml = strlen(SPEC_MACRO_PATCH);
-
-                        if (!strcmp(patch->data, SPEC_MACRO_PATCH) && (tl == ml)) {
-                            /* either '%patch n' or '%patch -Pn' */
-                            TAILQ_FOREACH(entry, fields, items) {
-                                if (entry == patch) {
-                                    /* the first field is %patch, skip it in this loop */
-                                    continue;
-                                }
-
-                                buf = entry->data;
-
-                                if (strprefix(entry->data, SPEC_MACRO_PATCH_P_ARG)) {
-                                    /* patch number specified with -P, take it */
-                                    if (!strcmp(entry->data, SPEC_MACRO_PATCH_P_ARG)) {
-                                        /* user specified something like '-P 1' */
-                                        entry = TAILQ_NEXT(entry, items);
-                                        buf = entry->data;
-                                    } else {
-                                        /* user specified something like '-P1' */
-                                        buf += strlen(SPEC_MACRO_PATCH_P_ARG);
-
-                                        while (isspace(*buf) && *buf != '\0') {
-                                            buf++;
-                                        }
-                                    }
-
-                                    numarg = true;
-                                    buf[strcspn(buf, " \t")] = '\0';
-                                    break;
-                                } else {
-                                    /* check to see if the patch number is just specified as-is */
-                                    numarg = true;
-
-                                    while (*buf != '\0') {
-                                        if (!isdigit(*buf)) {
-                                            numarg = false;
-                                            break;
-                                        }
-
-                                        buf++;
-                                    }
-
-                                    if (numarg) {
-                                        buf = entry->data;
-                                        break;
-                                    }
-                                }
-                            }
-                        } else if (strprefix(patch->data, SPEC_MACRO_PATCH) && (tl > ml)) {
-                            /* '%patchN' */
-                            buf = patch->data;
-                            len = strlen(buf);
-                            buf += strlen(SPEC_MACRO_PATCH);
-                            buf[strcspn(buf, " \t")] = '\0';
-                        } else {
-                            warnx("*** Unrecognized %%patch line: %s", specentry->data);
-                            continue;
-                        }
-
-                        /* add a new patch entry to the hash table */
-                        if (buf == NULL) {
-                            warnx("*** Unable to read spec file line: %s", specentry->data);
-                            continue;
-                        }
-
-                        aentry = calloc(1, sizeof(*aentry));
-                        assert(aentry != NULL);
-                        aentry->num = strtoll(buf, NULL, 10);
-
-                        if (errno == ERANGE || errno == EINVAL) {
-                            warn("strtoll");
-                            aentry->num = -1;
-                        }
-
-                        /* collect any options to the patch macro if present */
-                        if (entry && entry->data && (strlen(specentry->data) > strlen(patch->data))) {
-                            buf = specentry->data;
-                            buf += len;                  /* advance past the first token */
-
-                            while (isspace(*buf) && *buf != '\0') {
-                                buf++;
-                            }
-
-                            aentry->opts = strdup(buf);
-                        }
-
-                        HASH_ADD_INT(applied, num, aentry);
-                    }
-
-                    /* clean up */
-                    list_free(fields, free);
+                    HASH_ADD_INT(applied, num, aentry);
                 }
-
-                /* clean up the spec file we read in */
-                list_free(speclines, free);
             }
         }
 
@@ -898,6 +690,8 @@ bool inspect_patches(struct rpminspect *ri)
     /* Clean up the patches and applied hash tables */
     free_applied_patches(applied);
     free_patches(patches);
+    applied = NULL;
+    patches = NULL;
 
     /* Sound the everything-is-ok alarm if everything is, in fact, ok */
     if (result && !reported) {
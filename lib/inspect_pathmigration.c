@@ -12,10 +12,8 @@
 static bool pathmigration_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
     bool result = true;
-    string_map_t *hentry = NULL;
-    string_map_t *tmp_hentry = NULL;
-    string_entry_t *entry = NULL;
-    char *old = NULL;
+    const string_map_t *hentry = NULL;
+    const matcher_pattern_t *match = NULL;
     const char *arch = NULL;
     char *noun = NULL;
     struct result_params params;
@@ -26,28 +24,8 @@ static bool pathmigration_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     }
 
     /* Skip files beginning with an excluded path */
-    if (ri->pathmigration_excluded_paths && !TAILQ_EMPTY(ri->pathmigration_excluded_paths)) {
-        /* check in case of an exact match */
-        if (list_contains(ri->pathmigration_excluded_paths, file->localpath)) {
-            return true;
-        }
-
-        TAILQ_FOREACH(entry, ri->pathmigration_excluded_paths, items) {
-            /* ensure the path prefixes end with '/' */
-            if (strsuffix(entry->data, "/")) {
-                old = strdup(entry->data);
-            } else {
-                xasprintf(&old, "%s/", entry->data);
-            }
-
-            /* if matched, return */
-            if (strprefix(file->localpath, entry->data)) {
-                free(old);
-                return true;
-            }
-
-            free(old);
-        }
+    if (match_first(ri->pathmigration_excluded_matcher, file->localpath)) {
+        return true;
     }
 
     /* Used for reporting */
@@ -63,35 +41,18 @@ static bool pathmigration_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.file = file->localpath;
     params.arch = arch;
 
-    /* Check for each path migration, break early if we find a match */
-    HASH_ITER(hh, ri->pathmigration, hentry, tmp_hentry) {
-        /*
-         * Make sure the old path name ends with a slash.
-         */
-        if (strsuffix(hentry->key, "/")) {
-            old = strdup(hentry->key);
-        } else {
-            xasprintf(&old, "%s/", hentry->key);
-        }
+    /* Check for a path that should be migrated */
+    if ((match = match_first(ri->pathmigration_matcher, file->localpath)) != NULL) {
+        hentry = (const string_map_t *) match->data;
+        DEBUG_PRINT("hentry->key=|%s|, hentry->value=|%s|, old=|%s|, file->localpath=|%s|\n", hentry->key, hentry->value, match->pattern, file->localpath);
 
-        DEBUG_PRINT("hentry->key=|%s|, hentry->value=|%s|, old=|%s|, file->localpath=|%s|\n", hentry->key, hentry->value, old, file->localpath);
-
-        /* Check to see if we found a path that should be migrated */
-        if (strprefix(file->localpath, old)) {
-            xasprintf(&params.msg, _("File %s found should be in %s on %s"), file->localpath, hentry->value, arch);
-            xasprintf(&noun, _("${FILE} should be in %s on ${ARCH}"), hentry->value);
-            params.noun = noun;
-            add_result(ri, &params);
-            free(params.msg);
-            free(noun);
-            result = false;
-        }
-
-        free(old);
-
-        if (!result) {
-            break;
-        }
+        xasprintf(&params.msg, _("File %s found should be in %s on %s"), file->localpath, hentry->value, arch);
+        xasprintf(&noun, _("${FILE} should be in %s on ${ARCH}"), hentry->value);
+        params.noun = noun;
+        add_result(ri, &params);
+        free(params.msg);
+        free(noun);
+        result = false;
     }
 
     return result;
@@ -108,7 +69,7 @@ bool inspect_pathmigration(struct rpminspect *ri)
     assert(ri != NULL);
 
     /* Only run the inspection if path migrations are specified */
-    if (ri->pathmigration) {
+    if (ri->pathmigration_matcher) {
         result = foreach_peer_file(ri, NAME_PATHMIGRATION, pathmigration_driver);
     }
 
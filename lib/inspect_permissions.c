@@ -171,6 +171,9 @@ bool inspect_permissions(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     /* run the permissions inspection across all RPM files */
     result = foreach_peer_file(ri, NAME_PERMISSIONS, permissions_driver);
 
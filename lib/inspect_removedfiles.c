@@ -159,6 +159,9 @@ bool inspect_removedfiles(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     /* is this a rebase comparison? */
     rebase = is_rebase(ri);
 
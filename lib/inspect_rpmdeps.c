@@ -714,6 +714,9 @@ bool inspect_rpmdeps(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    specfile = NULL;
+
     /* are these builds a rebase? */
     rebase = is_rebase(ri);
 
@@ -929,6 +932,8 @@ bool inspect_rpmdeps(struct rpminspect *ri)
 
     free(pkg_vr);
     free(pkg_evr);
+    pkg_vr = NULL;
+    pkg_evr = NULL;
 
     return result;
 }
@@ -12,13 +12,29 @@
 
 #include "rpminspect.h"
 
+/* a shell script and the syntax checks queued for it */
+typedef struct _script_t {
+    rpmfile_entry_t *file;
+    const char *shell;
+    const char *before_shell;
+    job_entry_t *after;
+    job_entry_t *before;       /* NULL if the after result is reused */
+    job_entry_t *extglob;
+} script_t;
+
+static script_t *scripts = NULL;
+static size_t nscripts = 0;
+static job_list_t *jobs = NULL;
+
+/* shell found on the #! line of each file read, keyed by fullpath */
+static string_map_t *shells = NULL;
+
 /*
  * Get the basename of the shell from the #! line of a script.
  * Return the name if it's in our list of shells to use.
  * Return if invalid or not found.
- * Caller is responsible for freeing the returned string.
  */
-static char *get_shell(const struct rpminspect *ri, const char *fullpath)
+static char *read_shell(const struct rpminspect *ri, const char *fullpath)
 {
     char *shell = NULL;
     FILE *fp = NULL;
@@ -77,20 +93,71 @@ static char *get_shell(const struct rpminspect *ri, const char *fullpath)
     return shell;
 }
 
+/*
+ * Cached read_shell().  The returned string belongs to the cache.
+ */
+static const char *get_shell(const struct rpminspect *ri, const char *fullpath)
+{
+    string_map_t *entry = NULL;
+
+    assert(fullpath != NULL);
+
+    HASH_FIND_STR(shells, fullpath, entry);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        assert(entry != NULL);
+        entry->key = strdup(fullpath);
+        assert(entry->key != NULL);
+        entry->value = read_shell(ri, fullpath);
+        HASH_ADD_KEYPTR(hh, shells, entry->key, strlen(entry->key), entry);
+    }
+
+    return entry->value;
+}
+
+/*
+ * Queue a syntax check of a script with the given shell.
+ */
+static job_entry_t *queue_check(const struct rpminspect *ri, job_list_t *list, const char *shell, const char *fullpath, bool extglob)
+{
+    job_entry_t *job = NULL;
+    int i = 0;
+
+    assert(ri != NULL);
+    assert(list != NULL);
+    assert(shell != NULL);
+    assert(fullpath != NULL);
+
+    job = calloc(1, sizeof(*job));
+    assert(job != NULL);
+    job->workdir = ri->worksubdir;
+    job->argv = calloc(6, sizeof(*job->argv));
+    assert(job->argv != NULL);
+    job->argv[i++] = strdup(shell);
+    job->argv[i++] = strdup("-n");
+
+    if (extglob) {
+        job->argv[i++] = strdup("-O");
+        job->argv[i++] = strdup("extglob");
+    }
+
+    job->argv[i++] = strdup(fullpath);
+    TAILQ_INSERT_TAIL(list, job, items);
+
+    return job;
+}
+
+/*
+ * Collect the shell scripts and queue their syntax checks.  They are
+ * all checked at once after this.
+ */
 static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
-    bool result = true;
-    const char *arch = NULL;
     char *type = NULL;
-    char *shell = NULL;
-    char *before_shell = NULL;
-    int exitcode = -1;
-    char *before_errors = NULL;
-    int before_exitcode = -1;
-    char *errors = NULL;
-    char *tmp = NULL;
-    bool extglob = false;
-    struct result_params params;
+    const char *shell = NULL;
+    const char *before_shell = NULL;
+    script_t *script = NULL;
 
     /* Ignore files in the SRPM */
     if (headerIsSource(file->rpm_header)) {
@@ -104,9 +171,6 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
-    /* We need the architecture for reporting */
-    arch = get_rpm_header_arch(file->rpm_header);
-
     /* Get the shell from the #! line */
     shell = get_shell(ri, file->fullpath);
 
@@ -116,6 +180,50 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 
     DEBUG_PRINT("shell=|%s|\n", shell);
 
+    if (file->peer_file) {
+        before_shell = get_shell(ri, file->peer_file->fullpath);
+        DEBUG_PRINT("before_shell=|%s|\n", before_shell);
+    }
+
+    scripts = realloc(scripts, (nscripts + 1) * sizeof(*scripts));
+    assert(scripts != NULL);
+    script = &scripts[nscripts++];
+    memset(script, 0, sizeof(*script));
+    script->file = file;
+    script->shell = shell;
+    script->before_shell = before_shell;
+
+    /* Run with -n and capture results */
+    script->after = queue_check(ri, jobs, shell, file->fullpath, false);
+
+    /* An unchanged script gives the same result, only check it once */
+    if (before_shell && (strcmp(shell, before_shell) || strcmp(checksum(file), checksum(file->peer_file)))) {
+        script->before = queue_check(ri, jobs, before_shell, file->peer_file->fullpath, false);
+    }
+
+    return true;
+}
+
+/*
+ * Report the syntax check results for one script.
+ */
+static bool shellsyntax_report(struct rpminspect *ri, const script_t *script)
+{
+    bool result = true;
+    rpmfile_entry_t *file = script->file;
+    const char *arch = NULL;
+    const char *shell = script->shell;
+    const char *before_shell = script->before_shell;
+    int exitcode = -1;
+    char *before_errors = NULL;
+    int before_exitcode = -1;
+    char *errors = NULL;
+    bool extglob = false;
+    struct result_params params;
+
+    /* We need the architecture for reporting */
+    arch = get_rpm_header_arch(file->rpm_header);
+
     /* Set up the result parameters */
     init_result_params(&params);
     params.header = NAME_SHELLSYNTAX;
@@ -125,9 +233,6 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.noun = _("invalid shell script ${FILE} on ${ARCH}");
 
     if (file->peer_file) {
-        before_shell = get_shell(ri, file->peer_file->fullpath);
-        DEBUG_PRINT("before_shell=|%s|\n", before_shell);
-
         if (!before_shell) {
             xasprintf(&params.msg, _("%s is a shell script but was not before on %s"), file->localpath, arch);
         } else if (strcmp(shell, before_shell)) {
@@ -144,36 +249,37 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
     }
 
-    /* Run with -n and capture results */
-    errors = run_cmd(&exitcode, ri->worksubdir, shell, "-n", file->fullpath, NULL);
-    DEBUG_PRINT("exitcode=%d, errors=|%s|\n", exitcode, errors);
+    exitcode = script->after->exitcode;
+    DEBUG_PRINT("exitcode=%d, errors=|%s|\n", exitcode, script->after->output);
 
     if (before_shell) {
-        before_errors = run_cmd(&before_exitcode, ri->worksubdir, before_shell, "-n", file->peer_file->fullpath, NULL);
-        DEBUG_PRINT("before_exitcode=%d, before_errors=|%s|\n", before_exitcode, before_errors);
-
         /* remove the working directory prefix */
-        tmp = strreplace(before_errors, file->peer_file->fullpath, file->peer_file->localpath);
-        free(before_errors);
-        before_errors = tmp;
+        if (script->before) {
+            before_exitcode = script->before->exitcode;
+            before_errors = strreplace(script->before->output, file->peer_file->fullpath, file->peer_file->localpath);
+        } else {
+            before_exitcode = script->after->exitcode;
+            before_errors = strreplace(script->after->output, file->fullpath, file->peer_file->localpath);
+        }
+
+        DEBUG_PRINT("before_exitcode=%d, before_errors=|%s|\n", before_exitcode, before_errors);
     }
 
     /* Special check for GNU bash, try with extglob */
-    if (exitcode && !strcmp(shell, "bash")) {
-        free(errors);
-        errors = run_cmd(&exitcode, ri->worksubdir, shell, "-n", "-O", "extglob", file->fullpath, NULL);
-        DEBUG_PRINT("exitcode=%d, errors=|%s|\n", exitcode, errors);
+    if (script->extglob) {
+        exitcode = script->extglob->exitcode;
+        DEBUG_PRINT("exitcode=%d, errors=|%s|\n", exitcode, script->extglob->output);
 
         if (!exitcode) {
             extglob = true;
             result = false;
         }
-    }
 
-    /* remove the working directory prefix */
-    tmp = strreplace(errors, file->fullpath, file->localpath);
-    free(errors);
-    errors = tmp;
+        /* remove the working directory prefix */
+        errors = strreplace(script->extglob->output, file->fullpath, file->localpath);
+    } else {
+        errors = strreplace(script->after->output, file->fullpath, file->localpath);
+    }
 
     /* Report */
     if (before_shell) {
@@ -232,8 +338,8 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         }
     }
 
-    free(shell);
-    free(before_shell);
+    free(errors);
+    free(before_errors);
     return result;
 }
 
@@ -243,11 +349,48 @@ static bool shellsyntax_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_shellsyntax(struct rpminspect *ri)
 {
     bool result;
+    size_t i = 0;
+    job_list_t *retry = NULL;
     struct result_params params;
 
     assert(ri != NULL);
 
+    /* queue the syntax checks for all scripts and run them concurrently */
+    jobs = calloc(1, sizeof(*jobs));
+    assert(jobs != NULL);
+    TAILQ_INIT(jobs);
+
     result = foreach_peer_file(ri, NAME_SHELLSYNTAX, shellsyntax_driver);
+    run_jobs(jobs, inspection_jobs(ri));
+
+    /* bash scripts that failed get a second try with extglob */
+    retry = calloc(1, sizeof(*retry));
+    assert(retry != NULL);
+    TAILQ_INIT(retry);
+
+    for (i = 0; i < nscripts; i++) {
+        if (scripts[i].after->exitcode && !strcmp(scripts[i].shell, "bash")) {
+            scripts[i].extglob = queue_check(ri, retry, scripts[i].shell, scripts[i].file->fullpath, true);
+        }
+    }
+
+    run_jobs(retry, inspection_jobs(ri));
+
+    /* report in the order the scripts were found */
+    for (i = 0; i < nscripts; i++) {
+        if (!shellsyntax_report(ri, &scripts[i])) {
+            result = false;
+        }
+    }
+
+    free_jobs(retry);
+    free_jobs(jobs);
+    jobs = NULL;
+    free(scripts);
+    scripts = NULL;
+    nscripts = 0;
+    free_string_map(shells);
+    shells = NULL;
 
     if (result) {
         init_result_params(&params);
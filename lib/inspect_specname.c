@@ -94,6 +94,11 @@ bool inspect_specname(struct rpminspect *ri)
     struct result_params params;
 
     assert(ri != NULL);
+
+    /* state left over from a previous run */
+    specgood = false;
+    seen = false;
+
     foreach_peer_file(ri, NAME_SPECNAME, specname_driver);
 
     init_result_params(&params);
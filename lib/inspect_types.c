@@ -135,6 +135,9 @@ bool inspect_types(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     /* run the types inspection across all RPM files */
     result = foreach_peer_file(ri, NAME_TYPES, types_driver);
 
@@ -683,6 +683,10 @@ bool inspect_unicode(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    seen = false;
+    globalresult = true;
+
     /* only run if there are forbidden code points */
     if (ri->unicode_forbidden_codepoints != NULL && !TAILQ_EMPTY(ri->unicode_forbidden_codepoints)) {
         /* convert code points to UChar values */
@@ -121,6 +121,9 @@ bool inspect_upstream(struct rpminspect *ri)
 
     assert(ri != NULL);
 
+    /* state left over from a previous run */
+    reported = false;
+
     init_result_params(&params);
     params.header = NAME_UPSTREAM;
 
@@ -204,6 +207,7 @@ bool inspect_upstream(struct rpminspect *ri)
         list_free(removed, free);
         list_free(before_source, free);
         list_free(source, free);
+        source = NULL;
     }
 
     free(params.remedy);
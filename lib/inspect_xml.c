@@ -17,6 +17,13 @@
 #include "inspect.h"
 #include "rpminspect.h"
 
+/* Parser context reused for every file */
+static xmlParserCtxtPtr ctxt = NULL;
+
+/* XML files collected for checking */
+static file_check_t *checks = NULL;
+static size_t nchecks = 0;
+
 /*
  * By default, libxml will send error messages to stderr.  Turn that off for
  * our purposes.
@@ -35,7 +42,6 @@ static bool is_xml_well_formed(const char *path, char **errors)
 {
     static bool initialized = false;
     static xmlGenericErrorFunc silence = xml_silence_errors;
-    xmlParserCtxtPtr ctxt;
     xmlDocPtr doc;
     bool result = true;
 
@@ -45,12 +51,26 @@ static bool is_xml_well_formed(const char *path, char **errors)
         initialized = true;
     }
 
-    ctxt = xmlNewParserCtxt();
-    assert(ctxt != NULL);
+    /* xmlCtxtReadFile() resets the context for each document */
+    if (ctxt == NULL) {
+        ctxt = xmlNewParserCtxt();
+        assert(ctxt != NULL);
+    }
+
     doc = xmlCtxtReadFile(ctxt, path, NULL, XML_PARSE_RECOVER | XML_PARSE_NONET | XML_PARSE_DTDVALID);
 
-    /* try again if no DTD specified */
+    /*
+     * If the only problem is the lack of a DTD, the document was
+     * already parsed all the way through and is well-formed, so there
+     * is no need to parse it again.  Otherwise try again without DTD
+     * validation so the reported error is about the XML itself.
+     */
     if (!ctxt->valid && ctxt->errNo == XML_DTD_NO_DTD) {
+        if (ctxt->wellFormed) {
+            xmlFreeDoc(doc);
+            return true;
+        }
+
         xmlFreeDoc(doc);
         doc = xmlCtxtReadFile(ctxt, path, NULL, XML_PARSE_RECOVER | XML_PARSE_NONET);
     }
@@ -75,10 +95,20 @@ static bool is_xml_well_formed(const char *path, char **errors)
         xmlFreeDoc(doc);
     }
 
-    xmlFreeParserCtxt(ctxt);
     return result;
 }
 
+/*
+ * Check function for run_checks().
+ */
+static int xml_check(rpmfile_entry_t *file, char **output)
+{
+    assert(file != NULL);
+    assert(output != NULL);
+
+    return is_xml_well_formed(file->fullpath, output) ? 0 : 1;
+}
+
 static bool is_xml(const char *path)
 {
     FILE *input;
@@ -138,12 +168,12 @@ static bool is_xml(const char *path)
     return (bytes_read >= min_size) && (memcmp(xml_data, xml_prelude, min_size) == 0);
 }
 
+/*
+ * Collect the XML files to check.  They are all checked at once
+ * after this.
+ */
 static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 {
-    bool result = true;
-    const char *pkg = NULL;
-    struct result_params params;
-
     /* Skip source packages */
     if (headerIsSource(file->rpm_header)) {
         return true;
@@ -171,6 +201,24 @@ static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         return true;
     }
 
+    checks = realloc(checks, (nchecks + 1) * sizeof(*checks));
+    assert(checks != NULL);
+    memset(&checks[nchecks], 0, sizeof(*checks));
+    checks[nchecks].file = file;
+    nchecks++;
+
+    return true;
+}
+
+/*
+ * Report the result of checking one XML file.
+ */
+static bool xml_report(struct rpminspect *ri, rpmfile_entry_t *file, const file_check_t *check)
+{
+    bool result = true;
+    const char *pkg = NULL;
+    struct result_params params;
+
     /* package name is used for reporting */
     pkg = headerGetString(file->rpm_header, RPMTAG_NAME);
 
@@ -181,7 +229,8 @@ static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
     params.arch = get_rpm_header_arch(file->rpm_header);
     params.file = file->localpath;
 
-    result = is_xml_well_formed(file->fullpath, &params.details);
+    result = (check->status == 0);
+    params.details = check->output;
 
     if (result && params.details) {
         xasprintf(&params.msg, _("%s is a well-formed XML file in %s on %s, but is not a valid XML file"), file->localpath, pkg, params.arch);
@@ -190,7 +239,6 @@ static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         params.verb = VERB_OK;
         add_result(ri, &params);
         free(params.msg);
-        free(params.details);
     } else if (!result) {
         xasprintf(&params.msg, _("%s is not a well-formed XML file in %s on %s"), file->localpath, pkg, params.arch);
         params.severity = RESULT_VERIFY;
@@ -199,7 +247,6 @@ static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
         params.noun = _("${FILE} is not well-formed XML on ${ARCH}");
         add_result(ri, &params);
         free(params.msg);
-        free(params.details);
     }
 
     return result;
@@ -208,10 +255,32 @@ static bool xml_driver(struct rpminspect *ri, rpmfile_entry_t *file)
 bool inspect_xml(struct rpminspect *ri)
 {
     bool result;
+    size_t i = 0;
     struct result_params params;
 
     assert(ri != NULL);
+
+    /* collect the XML files and check them concurrently */
     result = foreach_peer_file(ri, NAME_XML, xml_driver);
+    run_checks(checks, nchecks, xml_check, inspection_jobs(ri));
+
+    /* report in the order the files were found */
+    for (i = 0; i < nchecks; i++) {
+        if (!xml_report(ri, checks[i].file, &checks[i])) {
+            result = false;
+        }
+
+        free(checks[i].output);
+    }
+
+    free(checks);
+    checks = NULL;
+    nchecks = 0;
+
+    if (ctxt != NULL) {
+        xmlFreeParserCtxt(ctxt);
+        ctxt = NULL;
+    }
 
     if (result) {
         init_result_params(&params);
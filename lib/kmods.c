@@ -4,6 +4,7 @@
  */
 
 #include <assert.h>
+#include <err.h>
 #include <fnmatch.h>
 #include <stdbool.h>
 #include <stdlib.h>
@@ -106,12 +107,98 @@ static void convert_module_dependencies(string_list_t *list, const struct kmod_l
     return;
 }
 
+/*
+ * Return the modinfo of the kernel module at path.  The module is
+ * read through the given libkmod context the first time and the
+ * parsed parameters, dependencies, and aliases are kept in the cache
+ * for later calls.  Returns NULL if the file is not a kernel module.
+ */
+kmod_info_t *get_kmod_info(struct kmod_ctx *ctx, kmod_info_t **cache, const char *path)
+{
+    int err = 0;
+    kmod_info_t *info = NULL;
+    struct kmod_module *mod = NULL;
+    struct kmod_list *modinfo = NULL;
+
+    assert(ctx != NULL);
+    assert(cache != NULL);
+    assert(path != NULL);
+
+    HASH_FIND_STR(*cache, path, info);
+
+    if (info != NULL) {
+        return (info->name == NULL) ? NULL : info;
+    }
+
+    info = calloc(1, sizeof(*info));
+    assert(info != NULL);
+    info->path = strdup(path);
+    assert(info->path != NULL);
+    HASH_ADD_KEYPTR(hh, *cache, info->path, strlen(info->path), info);
+
+    err = kmod_module_new_from_path(ctx, path, &mod);
+
+    if (err < 0) {
+        /* not a kernel module */
+        return NULL;
+    }
+
+    err = kmod_module_get_info(mod, &modinfo);
+
+    if (err < 0) {
+        warn("kmod_module_get_info");
+        kmod_module_unref(mod);
+        return NULL;
+    }
+
+    info->name = strdup(kmod_module_get_name(mod));
+    assert(info->name != NULL);
+
+    DEBUG_PRINT("reading modinfo from %s\n", path);
+    info->parameters = modinfo_to_list(modinfo, convert_module_parameters);
+    info->dependencies = modinfo_to_list(modinfo, convert_module_dependencies);
+    info->aliases = gather_module_aliases(info->name, modinfo);
+
+    /*
+     * Dropping the module here removes it from the context's module
+     * pool, so modules with the same name from different builds can
+     * share one context.
+     */
+    kmod_module_info_free_list(modinfo);
+    kmod_module_unref(mod);
+
+    return info;
+}
+
+/* Free the cache of kernel module information */
+void free_kmod_info(kmod_info_t *cache)
+{
+    kmod_info_t *entry = NULL;
+    kmod_info_t *tmp_entry = NULL;
+
+    if (cache == NULL) {
+        return;
+    }
+
+    HASH_ITER(hh, cache, entry, tmp_entry) {
+        HASH_DEL(cache, entry);
+        free(entry->path);
+        free(entry->name);
+        list_free(entry->parameters, free);
+        list_free(entry->dependencies, free);
+        free_module_aliases(entry->aliases);
+        free(entry);
+    }
+
+    return;
+}
+
 /*
  * Compare two kernel modules to see if the after module lost
  * parameters.
  *
- * The before and after lists must be module info lists returned by
- * kmod_module_get_info.
+ * The before and after modules must be module information returned
+ * by get_kmod_info.
  *
  * If after did not lose any parameters, returns true. If after lost
  * parameters, returns false, and populates "lost" with a list of the
@@ -119,10 +206,8 @@ static void convert_module_dependencies(string_list_t *list, const struct kmod_l
  * purposes and will never trigger a false return.  Only lost params
  * cause a false return.
  */
-bool compare_module_parameters(const struct kmod_list *before, const struct kmod_list *after, string_list_t **lost, string_list_t **gain)
+bool compare_module_parameters(const kmod_info_t *before, const kmod_info_t *after, string_list_t **lost, string_list_t **gain)
 {
-    string_list_t *before_parm_list = NULL;
-    string_list_t *after_parm_list = NULL;
     string_list_t *difference = NULL;
     string_list_t *added = NULL;
     string_list_t *combined = NULL;
@@ -132,20 +217,14 @@ bool compare_module_parameters(const struct kmod_list *before, const struct kmod
     assert(after);
     assert(lost);
 
-    /* Get the parameter list for each module */
-    DEBUG_PRINT("before module\n");
-    before_parm_list = modinfo_to_list(before, convert_module_parameters);
-    DEBUG_PRINT("after module\n");
-    after_parm_list = modinfo_to_list(after, convert_module_parameters);
-
     /* parameters present in both modules */
-    combined = list_intersection(before_parm_list, after_parm_list);
+    combined = list_intersection(before->parameters, after->parameters);
 
     /* diff the parameter lists to get lost parameters */
-    difference = list_difference(before_parm_list, after_parm_list);
+    difference = list_difference(before->parameters, after->parameters);
 
     /* gather any new parameters */
-    added = list_difference(after_parm_list, combined);
+    added = list_difference(after->parameters, combined);
 
     /* If the lists are empty, everything is fine.
      * Otherwise, make a copy of difference so we can clean everything up
@@ -164,10 +243,8 @@ bool compare_module_parameters(const struct kmod_list *before, const struct kmod
         *gain = list_copy(added);
     }
 
-    list_free(added, NULL);
-    list_free(difference, NULL);
-    list_free(before_parm_list, free);
-    list_free(after_parm_list, free);
+    list_free(added, free);
+    list_free(difference, free);
     list_free(combined, free);
 
     return result;
@@ -178,13 +255,11 @@ bool compare_module_parameters(const struct kmod_list *before, const struct kmod
  *
  * Any change in dependencies is considered bad. If dependencies
  * changed, the function will return false, and the "before_deps" and
- * "after_deps" parameters will be populated with the dependencies
- * found for the given modules.
+ * "after_deps" parameters will be populated with copies of the
+ * dependencies found for the given modules.
  */
-bool compare_module_dependencies(const struct kmod_list *before, const struct kmod_list *after, string_list_t **before_deps, string_list_t **after_deps)
+bool compare_module_dependencies(const kmod_info_t *before, const kmod_info_t *after, string_list_t **before_deps, string_list_t **after_deps)
 {
-    string_list_t *before_depends_list;
-    string_list_t *after_depends_list;
     string_list_t *difference;
 
     assert(before);
@@ -192,30 +267,21 @@ bool compare_module_dependencies(const struct kmod_list *before, const struct km
     assert(before_deps);
     assert(after_deps);
 
-    DEBUG_PRINT("before module\n");
-    before_depends_list = modinfo_to_list(before, convert_module_dependencies);
-    DEBUG_PRINT("after module\n");
-    after_depends_list = modinfo_to_list(after, convert_module_dependencies);
+    difference = list_symmetric_difference(before->dependencies, after->dependencies);
 
-    difference = list_symmetric_difference(before_depends_list, after_depends_list);
-
-    /* If the list is empty, everything is fine, free everything. */
+    /* If the list is empty, everything is fine. */
     if (difference == NULL || TAILQ_EMPTY(difference)) {
         DEBUG_PRINT("no kernel module deps differences\n");
-
-        list_free(difference, NULL);
-        list_free(before_depends_list, free);
-        list_free(after_depends_list, free);
-
+        list_free(difference, free);
         return true;
     }
 
-    /* Otherwise, just free the difference, and return the before and after dependencies */
+    /* Otherwise, return the before and after dependencies */
     DEBUG_PRINT("there are kernel module deps differences\n");
-    list_free(difference, NULL);
+    list_free(difference, free);
 
-    *before_deps = before_depends_list;
-    *after_deps = after_depends_list;
+    *before_deps = list_copy(before->dependencies);
+    *after_deps = list_copy(after->dependencies);
 
     return false;
 }
@@ -290,20 +356,124 @@ void free_module_aliases(kernel_alias_data_t *data)
     return;
 }
 
-static string_list_t *wildcard_alias_search(const char *alias, kernel_alias_data_t *data)
+/*
+ * Index of the aliases in a kernel_alias_data_t.  Each alias pattern
+ * is filed under its literal prefix, which is the text before the
+ * first glob character.  For modaliases that is the bus prefix and
+ * whatever vendor and device fields are spelled out, such as
+ * "pci:v00008086d000010D3sv" or "usb:v*".  A string can only match
+ * patterns whose literal prefix it starts with, so a search looks up
+ * each distinct prefix length and only runs fnmatch() on the few
+ * candidates found.
+ */
+struct alias_bucket {
+    char *prefix;
+    kernel_alias_data_t **aliases;
+    size_t count;
+    UT_hash_handle hh;
+};
+
+struct alias_index {
+    struct alias_bucket *buckets;
+    size_t *lengths;
+    size_t nlengths;
+};
+
+static struct alias_index *index_module_aliases(kernel_alias_data_t *data)
 {
-    string_list_t *r = NULL;
-    string_entry_t *iter = NULL;
+    struct alias_index *index = NULL;
+    struct alias_bucket *bucket = NULL;
     kernel_alias_data_t *kentry = NULL;
     kernel_alias_data_t *tmp_kentry = NULL;
+    size_t len = 0;
+    size_t i = 0;
 
-    assert(alias != NULL);
-    assert(data != NULL);
+    index = calloc(1, sizeof(*index));
+    assert(index != NULL);
 
     HASH_ITER(hh, data, kentry, tmp_kentry) {
-        if (fnmatch(kentry->alias, alias, 0) == 0) {
-            TAILQ_FOREACH(iter, kentry->modules, items) {
-                r = list_add(r, iter->data);
+        len = strcspn(kentry->alias, "*?[\\");
+        HASH_FIND(hh, index->buckets, kentry->alias, len, bucket);
+
+        if (bucket == NULL) {
+            bucket = calloc(1, sizeof(*bucket));
+            assert(bucket != NULL);
+            bucket->prefix = strndup(kentry->alias, len);
+            assert(bucket->prefix != NULL);
+            HASH_ADD_KEYPTR(hh, index->buckets, bucket->prefix, len, bucket);
+
+            for (i = 0; i < index->nlengths; i++) {
+                if (index->lengths[i] == len) {
+                    break;
+                }
+            }
+
+            if (i == index->nlengths) {
+                index->lengths = realloc(index->lengths, (index->nlengths + 1) * sizeof(*index->lengths));
+                assert(index->lengths != NULL);
+                index->lengths[index->nlengths++] = len;
+            }
+        }
+
+        bucket->aliases = realloc(bucket->aliases, (bucket->count + 1) * sizeof(*bucket->aliases));
+        assert(bucket->aliases != NULL);
+        bucket->aliases[bucket->count++] = kentry;
+    }
+
+    return index;
+}
+
+static void free_alias_index(struct alias_index *index)
+{
+    struct alias_bucket *bucket = NULL;
+    struct alias_bucket *tmp_bucket = NULL;
+
+    if (index == NULL) {
+        return;
+    }
+
+    HASH_ITER(hh, index->buckets, bucket, tmp_bucket) {
+        HASH_DEL(index->buckets, bucket);
+        free(bucket->prefix);
+        free(bucket->aliases);
+        free(bucket);
+    }
+
+    free(index->lengths);
+    free(index);
+    return;
+}
+
+static string_list_t *wildcard_alias_search(const char *alias, const struct alias_index *index)
+{
+    string_list_t *r = NULL;
+    string_entry_t *iter = NULL;
+    struct alias_bucket *bucket = NULL;
+    size_t len = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    assert(alias != NULL);
+    assert(index != NULL);
+
+    len = strlen(alias);
+
+    for (i = 0; i < index->nlengths; i++) {
+        if (index->lengths[i] > len) {
+            continue;
+        }
+
+        HASH_FIND(hh, index->buckets, alias, index->lengths[i], bucket);
+
+        if (bucket == NULL) {
+            continue;
+        }
+
+        for (j = 0; j < bucket->count; j++) {
+            if (fnmatch(bucket->aliases[j]->alias, alias, 0) == 0) {
+                TAILQ_FOREACH(iter, bucket->aliases[j]->modules, items) {
+                    r = list_add(r, iter->data);
+                }
             }
         }
     }
@@ -324,13 +494,12 @@ static string_list_t *wildcard_alias_search(const char *alias, kernel_alias_data
  * "pci:v00001425d00000020sv*sd*bc*sc*i*". The after string still
  * matches the before string, so this is not a regression.
  *
- * However, since matching up module aliases does involve
- * arbitrary-length wildcards, this function effectively needs to run
- * fnmatch() between every combination of before and after aliases,
- * resulting in a complexity of O(n^2).  To speed things up in the
- * (hopefully) usual case, the wildcard search is only run when an
- * exact string match of an alias (using hash tables) results in an
- * apparent regression.
+ * Matching up module aliases involves arbitrary-length wildcards, so
+ * the wildcard search is only run when an exact string match of an
+ * alias (using hash tables) results in an apparent regression.  The
+ * after aliases are indexed by their literal prefix the first time a
+ * wildcard search is needed, so fnmatch() is only run against the
+ * patterns that could possibly match rather than every after alias.
  */
 bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *after, module_alias_callback callback, void *user_data)
 {
@@ -341,6 +510,7 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
     string_list_t *after_modules = NULL;
     string_list_t *difference = NULL;
     string_list_t empty;
+    struct alias_index *index = NULL;
     bool wildcard_search = false;
     bool result = true;
 
@@ -374,7 +544,11 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
 
         /* No match found, do a wildcard search */
         if (after_entry == NULL) {
-            after_modules = wildcard_alias_search(iter->alias, after);
+            if (index == NULL) {
+                index = index_module_aliases(after);
+            }
+
+            after_modules = wildcard_alias_search(iter->alias, index);
             wildcard_search = true;
         } else {
             after_modules = after_entry->modules;
@@ -382,11 +556,15 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
 
             /* If the lists differ, do a wildcard search */
             if (difference != NULL && !TAILQ_EMPTY(difference)) {
-                after_modules = wildcard_alias_search(iter->alias, after);
+                if (index == NULL) {
+                    index = index_module_aliases(after);
+                }
+
+                after_modules = wildcard_alias_search(iter->alias, index);
                 wildcard_search = true;
             }
 
-            list_free(difference, NULL);
+            list_free(difference, free);
         }
 
         /* Compare the results */
@@ -397,11 +575,14 @@ bool compare_module_aliases(kernel_alias_data_t *before, kernel_alias_data_t *af
             result = false;
         }
 
+        list_free(difference, free);
+
         /* If after_modules was created from a wildcard search, free it */
         if (wildcard_search) {
-            list_free(after_modules, NULL);
+            list_free(after_modules, free);
         }
     }
 
+    free_alias_index(index);
     return result;
 }
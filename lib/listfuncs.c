@@ -30,27 +30,24 @@ string_list_t *sorted_list = NULL;
  */
 char *list_to_string(const string_list_t *list, const char *delimiter)
 {
-    size_t pos = 0;
-    char *s = NULL;
+    strbuf_t s;
     string_entry_t *entry = NULL;
 
     if (list == NULL || TAILQ_EMPTY(list)) {
         return NULL;
     }
 
-    s = strdup("");
-    assert(s != NULL);
+    memset(&s, 0, sizeof(s));
 
     TAILQ_FOREACH(entry, list, items) {
-        if (pos > 0 && delimiter != NULL) {
-            s = strappend(s, delimiter, NULL);
+        if (entry != TAILQ_FIRST(list)) {
+            strbuf_append(&s, delimiter);
         }
 
-        s = strappend(s, entry->data, NULL);
-        pos++;
+        strbuf_append(&s, entry->data);
     }
 
-    return s;
+    return strbuf_finish(&s);
 }
 
 /*
@@ -103,115 +100,127 @@ string_map_t *list_to_table(const string_list_t *list)
     return table;
 }
 
+/*
+ * Lists at most this long are searched directly by the set operations
+ * below, longer ones are hashed first.
+ */
+#define SMALL_LIST 8
+
+/* Membership test used by the set operations */
+struct list_lookup {
+    const string_list_t *list;
+    string_set_t *set;
+};
+
+static void lookup_init(struct list_lookup *lookup, const string_list_t *list)
+{
+    const string_entry_t *iter = NULL;
+    size_t n = 0;
+
+    lookup->list = list;
+    lookup->set = NULL;
+
+    if (list == NULL) {
+        return;
+    }
+
+    TAILQ_FOREACH(iter, list, items) {
+        if (++n > SMALL_LIST) {
+            lookup->set = list_to_set(list);
+            break;
+        }
+    }
+
+    return;
+}
+
+static bool lookup_contains(const struct list_lookup *lookup, const char *s)
+{
+    if (lookup->set != NULL) {
+        return set_contains(lookup->set, s);
+    }
+
+    return list_contains(lookup->list, s);
+}
+
 /* Return a new list of entries that are in list a but are not in list b */
 string_list_t *list_difference(const string_list_t *a, const string_list_t *b)
 {
-    string_map_t *b_table = NULL;
-    string_map_t *hentry = NULL;
+    struct list_lookup lookup;
     const string_entry_t *iter = NULL;
     string_list_t *ret = NULL;
 
     /* Simple cases */
-    if ((a == NULL || TAILQ_EMPTY(a)) && (b == NULL || TAILQ_EMPTY(b))) {
+    if (a == NULL || TAILQ_EMPTY(a)) {
         return NULL;
-    } else if ((a == NULL || TAILQ_EMPTY(a)) && (b != NULL && !TAILQ_EMPTY(b))) {
-        return list_copy(b);
-    } else if ((a != NULL && !TAILQ_EMPTY(a)) && (b == NULL || TAILQ_EMPTY(b))) {
+    } else if (b == NULL || TAILQ_EMPTY(b)) {
         return list_copy(a);
     }
 
-    /* Copy list b into a hash table */
-    b_table = list_to_table(b);
-
-    if (b_table == NULL) {
-        return NULL;
-    }
-
     /* Iterate through list a looking for things not in list b */
-    TAILQ_FOREACH(iter, a, items) {
-        HASH_FIND_STR(b_table, iter->data, hentry);
+    lookup_init(&lookup, b);
 
-        if (hentry == NULL) {
+    TAILQ_FOREACH(iter, a, items) {
+        if (!lookup_contains(&lookup, iter->data)) {
             ret = list_add(ret, iter->data);
         }
     }
 
-    /* Free the hash table */
-    free_string_map(b_table);
-
+    free_string_set(lookup.set);
     return ret;
 }
 
 /* Return a new list of entries that are both in list a and list b */
 string_list_t *list_intersection(const string_list_t *a, const string_list_t *b)
 {
-    string_map_t *b_table = NULL;
-    string_map_t *hentry = NULL;
+    struct list_lookup lookup;
     const string_entry_t *iter = NULL;
     string_list_t *ret = NULL;
 
-    /* Copy list b into a hash table */
-    b_table = list_to_table(b);
-
-    if (b_table == NULL) {
+    if (a == NULL || b == NULL || TAILQ_EMPTY(b)) {
         return NULL;
     }
 
     /* Iterate through list a looking for things in list b */
-    TAILQ_FOREACH(iter, a, items) {
-        HASH_FIND_STR(b_table, iter->data, hentry);
+    lookup_init(&lookup, b);
 
-        if (hentry != NULL) {
+    TAILQ_FOREACH(iter, a, items) {
+        if (lookup_contains(&lookup, iter->data)) {
             ret = list_add(ret, iter->data);
         }
     }
 
-    /* Free the hash table */
-    free_string_map(b_table);
-
+    free_string_set(lookup.set);
     return ret;
 }
 
 /* Return a new list of entries that are in either list a or list b */
 string_list_t *list_union(const string_list_t *a, const string_list_t *b)
 {
-    string_map_t *u_table = NULL;
-    string_map_t *hentry = NULL;
+    string_set_t *seen = NULL;
+    const string_list_t *lists[2] = { a, b };
     const string_entry_t *iter = NULL;
     string_list_t *ret = NULL;
+    int i = 0;
 
     /*
-     * Iterate over both lists, adding each entry to u_table. If it's not already in
-     * u_table, add it to the list to be returned.
+     * Iterate over both lists, adding each entry to the seen set. If
+     * it's not already there, add it to the list to be returned.
      */
-    TAILQ_FOREACH(iter, a, items) {
-        HASH_FIND_STR(u_table, iter->data, hentry);
-
-        if (hentry == NULL) {
-            hentry = calloc(1, sizeof(*hentry));
-            assert(hentry != NULL);
-            hentry->key = strdup(iter->data);
-            HASH_ADD_KEYPTR(hh, u_table, hentry->key, strlen(hentry->key), hentry);
-
-            ret = list_add(ret, iter->data);
+    for (i = 0; i < 2; i++) {
+        if (lists[i] == NULL) {
+            continue;
         }
-    }
-
-    TAILQ_FOREACH(iter, b, items) {
-        HASH_FIND_STR(u_table, iter->data, hentry);
-
-        if (hentry == NULL) {
-            hentry = calloc(1, sizeof(*hentry));
-            assert(hentry != NULL);
-            hentry->key = strdup(iter->data);
-            HASH_ADD_KEYPTR(hh, u_table, hentry->key, strlen(hentry->key), hentry);
 
-            ret = list_add(ret, iter->data);
+        TAILQ_FOREACH(iter, lists[i], items) {
+            if (!set_contains(seen, iter->data)) {
+                seen = set_add(seen, iter->data);
+                ret = list_add(ret, iter->data);
+            }
         }
     }
 
-    free_string_map(u_table);
-
+    free_string_set(seen);
     return ret;
 }
 
@@ -223,24 +232,88 @@ string_list_t * list_symmetric_difference(const string_list_t *a, const string_l
     string_list_t *combination = NULL;
 
     a_minus_b = list_difference(a, b);
+    b_minus_a = list_difference(b, a);
 
-    if (a_minus_b == NULL) {
+    if (a_minus_b == NULL && b_minus_a == NULL) {
         return NULL;
     }
 
-    b_minus_a = list_difference(b, a);
+    combination = list_union(a_minus_b, b_minus_a);
+
+    list_free(a_minus_b, free);
+    list_free(b_minus_a, free);
 
-    if (b_minus_a == NULL) {
-        list_free(a_minus_b, NULL);
+    return combination;
+}
+
+/*
+ * Return a set of the strings in the list.  The set points at the
+ * strings in the list, so the list must outlive the set.  Free the
+ * set with free_string_set().
+ */
+string_set_t *list_to_set(const string_list_t *list)
+{
+    string_set_t *set = NULL;
+    const string_entry_t *iter = NULL;
+
+    if (list == NULL) {
         return NULL;
     }
 
-    combination = list_union(a_minus_b, b_minus_a);
+    TAILQ_FOREACH(iter, list, items) {
+        if (!set_contains(set, iter->data)) {
+            set = set_add(set, iter->data);
+        }
+    }
 
-    list_free(a_minus_b, NULL);
-    list_free(b_minus_a, NULL);
+    return set;
+}
 
-    return combination;
+/*
+ * Add a string to a set and return the set.  The string is not
+ * copied and must outlive the set.  A NULL set starts a new one.
+ */
+string_set_t *set_add(string_set_t *set, const char *s)
+{
+    string_set_t *entry = NULL;
+
+    if (s == NULL) {
+        return set;
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    assert(entry != NULL);
+    entry->key = s;
+    HASH_ADD_KEYPTR(hh, set, entry->key, strlen(entry->key), entry);
+
+    return set;
+}
+
+/* Return true if the set contains the given string */
+bool set_contains(const string_set_t *set, const char *s)
+{
+    string_set_t *entry = NULL;
+
+    if (set == NULL || s == NULL) {
+        return false;
+    }
+
+    HASH_FIND_STR(set, s, entry);
+    return (entry != NULL);
+}
+
+/* Free a string set, the strings themselves are left alone */
+void free_string_set(string_set_t *set)
+{
+    string_set_t *entry = NULL;
+    string_set_t *tmp_entry = NULL;
+
+    HASH_ITER(hh, set, entry, tmp_entry) {
+        HASH_DEL(set, entry);
+        free(entry);
+    }
+
+    return;
 }
 
 /*
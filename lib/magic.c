@@ -12,20 +12,16 @@
 #include "rpminspect.h"
 
 /*
- * Return the MIME type of the specified file by path.  The caller is
- * responsible for freeing the returned string.
+ * Return the MIME type of the file at path, or of the len bytes at buf
+ * if path is NULL.
  */
-char *mime_type(const char *path)
+static char *get_magic_type(const char *path, const void *buf, const size_t len)
 {
     char *type = NULL;
     char *pos = NULL;
     const char *tmp = NULL;
     magic_t cookie;
 
-    if (path == NULL) {
-        return NULL;
-    }
-
     cookie = magic_open(MAGIC_MIME | MAGIC_CHECK);
 
     if (cookie == NULL) {
@@ -39,7 +35,13 @@ char *mime_type(const char *path)
         return NULL;
     }
 
-    if ((tmp = magic_file(cookie, path)) != NULL) {
+    if (path) {
+        tmp = magic_file(cookie, path);
+    } else {
+        tmp = magic_buffer(cookie, buf, len);
+    }
+
+    if (tmp != NULL) {
         type = strdup(tmp);
 
         /*
@@ -56,6 +58,32 @@ char *mime_type(const char *path)
     return type;
 }
 
+/*
+ * Return the MIME type of the specified file by path.  The caller is
+ * responsible for freeing the returned string.
+ */
+char *mime_type(const char *path)
+{
+    if (path == NULL) {
+        return NULL;
+    }
+
+    return get_magic_type(path, NULL, 0);
+}
+
+/*
+ * Return the MIME type of the data in a buffer.  The caller is
+ * responsible for freeing the returned string.
+ */
+char *mime_type_buffer(const void *buf, const size_t len)
+{
+    if (buf == NULL) {
+        return NULL;
+    }
+
+    return get_magic_type(NULL, buf, len);
+}
+
 /*
  * Return the MIME type of the specified file.  The type is cached in the
  * rpmfile_entry_t.  If that is not NULL, this function returns that value.
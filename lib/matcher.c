@@ -0,0 +1,388 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Match a string against many patterns at once.  Configuration lists
+ * of words and path fragments are compiled in to a matcher once so
+ * checking a string costs time proportional to the string and not to
+ * the number of patterns.  Prefix and suffix matchers are tries
+ * walked from the start or the end of the string.  Substring matchers
+ * add Aho-Corasick failure links to the trie.
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <stdbool.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/types.h>
+
+#include "rpminspect.h"
+
+static unsigned char fold(const matcher_t *m, const unsigned char c)
+{
+    return m->icase ? (unsigned char) tolower(c) : c;
+}
+
+static size_t new_node(matcher_t *m)
+{
+    m->nodes = realloc(m->nodes, (m->nnodes + 1) * sizeof(*m->nodes));
+    assert(m->nodes != NULL);
+    memset(&m->nodes[m->nnodes], 0, sizeof(*m->nodes));
+    m->nodes[m->nnodes].dict = -1;
+    m->nodes[m->nnodes].pattern = -1;
+
+    return m->nnodes++;
+}
+
+/* Returns the node reached from node on c, or 0 if there is no edge */
+static size_t next_node(const matcher_t *m, const size_t node, const unsigned char c)
+{
+    size_t i = 0;
+    const matcher_node_t *n = &m->nodes[node];
+
+    for (i = 0; i < n->nedges; i++) {
+        if (n->edges[i].c == c) {
+            return n->edges[i].next;
+        }
+    }
+
+    return 0;
+}
+
+static size_t add_edge(matcher_t *m, const size_t node, const unsigned char c)
+{
+    size_t next = new_node(m);
+    matcher_node_t *n = &m->nodes[node];
+
+    n->edges = realloc(n->edges, (n->nedges + 1) * sizeof(*n->edges));
+    assert(n->edges != NULL);
+    n->edges[n->nedges].c = c;
+    n->edges[n->nedges].next = next;
+    n->nedges++;
+
+    return next;
+}
+
+/**
+ * @brief Allocate a new, empty matcher.
+ *
+ * @param type The kind of match to perform.
+ * @param icase True to ignore case when matching.
+ * @return Newly allocated matcher, free with free_matcher().
+ */
+matcher_t *new_matcher(const matcher_type_t type, const bool icase)
+{
+    matcher_t *m = NULL;
+
+    m = calloc(1, sizeof(*m));
+    assert(m != NULL);
+    m->type = type;
+    m->icase = icase;
+    new_node(m);
+
+    return m;
+}
+
+/**
+ * @brief Add a pattern to a matcher.
+ *
+ * The matcher must be compiled with compile_matcher() after the last
+ * pattern is added.  If the same pattern is added more than once,
+ * only the first one is reported by matches.
+ *
+ * @param m The matcher.
+ * @param pattern The pattern string, which is copied.
+ * @param data Caller data handed back with matches, may be NULL.
+ */
+void add_matcher_pattern(matcher_t *m, const char *pattern, const void *data)
+{
+    size_t i = 0;
+    size_t node = 0;
+    size_t next = 0;
+    size_t len = 0;
+    unsigned char c = 0;
+
+    assert(m != NULL);
+    assert(pattern != NULL);
+
+    len = strlen(pattern);
+    m->patterns = realloc(m->patterns, (m->npatterns + 1) * sizeof(*m->patterns));
+    assert(m->patterns != NULL);
+    m->patterns[m->npatterns].pattern = strdup(pattern);
+    assert(m->patterns[m->npatterns].pattern != NULL);
+    m->patterns[m->npatterns].len = len;
+    m->patterns[m->npatterns].data = data;
+
+    /* suffix patterns are stored reversed */
+    for (i = 0; i < len; i++) {
+        c = fold(m, (m->type == MATCHER_SUFFIX) ? pattern[len - i - 1] : pattern[i]);
+
+        if ((next = next_node(m, node, c)) == 0) {
+            next = add_edge(m, node, c);
+        }
+
+        node = next;
+    }
+
+    if (m->nodes[node].pattern == -1) {
+        m->nodes[node].pattern = m->npatterns;
+    }
+
+    m->npatterns++;
+    m->compiled = false;
+    return;
+}
+
+/**
+ * @brief Prepare a matcher for matching.
+ *
+ * For substring matchers this computes the failure and dictionary
+ * links with a breadth-first walk of the trie.
+ *
+ * @param m The matcher.
+ */
+void compile_matcher(matcher_t *m)
+{
+    size_t *queue = NULL;
+    size_t head = 0;
+    size_t tail = 0;
+    size_t i = 0;
+    size_t node = 0;
+    size_t child = 0;
+    size_t fail = 0;
+    unsigned char c = 0;
+
+    assert(m != NULL);
+
+    if (m->type != MATCHER_SUBSTRING || m->compiled) {
+        m->compiled = true;
+        return;
+    }
+
+    queue = calloc(m->nnodes, sizeof(*queue));
+    assert(queue != NULL);
+
+    /* children of the root fail back to the root */
+    for (i = 0; i < m->nodes[0].nedges; i++) {
+        child = m->nodes[0].edges[i].next;
+        m->nodes[child].fail = 0;
+        m->nodes[child].dict = (m->nodes[0].pattern != -1) ? 0 : -1;
+        queue[tail++] = child;
+    }
+
+    while (head < tail) {
+        node = queue[head++];
+
+        for (i = 0; i < m->nodes[node].nedges; i++) {
+            c = m->nodes[node].edges[i].c;
+            child = m->nodes[node].edges[i].next;
+
+            /* longest proper suffix of this path that is also in the trie */
+            fail = m->nodes[node].fail;
+
+            while (fail != 0 && next_node(m, fail, c) == 0) {
+                fail = m->nodes[fail].fail;
+            }
+
+            fail = next_node(m, fail, c);
+            m->nodes[child].fail = fail;
+
+            if (m->nodes[fail].pattern != -1) {
+                m->nodes[child].dict = fail;
+            } else {
+                m->nodes[child].dict = m->nodes[fail].dict;
+            }
+
+            queue[tail++] = child;
+        }
+    }
+
+    free(queue);
+    m->compiled = true;
+    return;
+}
+
+/**
+ * @brief Compile a string_list_t in to a matcher.
+ *
+ * The data for each pattern is the list entry's string.  NULL or
+ * empty lists give a NULL matcher.
+ *
+ * @param list The list of patterns.
+ * @param type The kind of match to perform.
+ * @param icase True to ignore case when matching.
+ * @return Compiled matcher or NULL, free with free_matcher().
+ */
+matcher_t *list_to_matcher(const string_list_t *list, const matcher_type_t type, const bool icase)
+{
+    matcher_t *m = NULL;
+    string_entry_t *entry = NULL;
+
+    if (list == NULL || TAILQ_EMPTY(list)) {
+        return NULL;
+    }
+
+    m = new_matcher(type, icase);
+
+    TAILQ_FOREACH(entry, list, items) {
+        add_matcher_pattern(m, entry->data, entry->data);
+    }
+
+    compile_matcher(m);
+    return m;
+}
+
+/* Report the pattern ending at node, if any; returns true to stop */
+static bool report(const matcher_t *m, const size_t node, const size_t end, matcher_cb cb, void *user_data)
+{
+    const matcher_pattern_t *p = NULL;
+
+    if (m->nodes[node].pattern == -1) {
+        return false;
+    }
+
+    p = &m->patterns[m->nodes[node].pattern];
+    return cb(p, end - p->len, user_data);
+}
+
+/**
+ * @brief Find the patterns in a matcher that match a string.
+ *
+ * The callback is called for each match with the pattern and the
+ * offset in the string where the match begins.  Substring matchers
+ * report every occurrence of every pattern.  Prefix and suffix
+ * matchers report shorter patterns first.
+ *
+ * @param m The compiled matcher.
+ * @param s The string to check.
+ * @param cb Callback for each match, returns true to stop.
+ * @param user_data Passed through to the callback.
+ * @return True if the callback stopped the search, false otherwise.
+ */
+bool match_patterns(const matcher_t *m, const char *s, matcher_cb cb, void *user_data)
+{
+    size_t i = 0;
+    size_t len = 0;
+    size_t node = 0;
+    size_t next = 0;
+    ssize_t dict = 0;
+    unsigned char c = 0;
+
+    assert(cb != NULL);
+
+    if (m == NULL || s == NULL) {
+        return false;
+    }
+
+    assert(m->compiled);
+    len = strlen(s);
+
+    if (m->type == MATCHER_PREFIX) {
+        for (i = 0; ; i++) {
+            if (report(m, node, i, cb, user_data)) {
+                return true;
+            }
+
+            if (i == len || (node = next_node(m, node, fold(m, s[i]))) == 0) {
+                break;
+            }
+        }
+    } else if (m->type == MATCHER_SUFFIX) {
+        for (i = 0; ; i++) {
+            if (report(m, node, len, cb, user_data)) {
+                return true;
+            }
+
+            if (i == len || (node = next_node(m, node, fold(m, s[len - i - 1]))) == 0) {
+                break;
+            }
+        }
+    } else {
+        if (report(m, 0, 0, cb, user_data)) {
+            return true;
+        }
+
+        for (i = 0; i < len; i++) {
+            c = fold(m, s[i]);
+
+            while ((next = next_node(m, node, c)) == 0 && node != 0) {
+                node = m->nodes[node].fail;
+            }
+
+            node = next;
+
+            if (report(m, node, i + 1, cb, user_data)) {
+                return true;
+            }
+
+            for (dict = m->nodes[node].dict; dict != -1; dict = m->nodes[dict].dict) {
+                if (report(m, dict, i + 1, cb, user_data)) {
+                    return true;
+                }
+            }
+        }
+    }
+
+    return false;
+}
+
+/* Callback for match_first() */
+static bool lowest_match(const matcher_pattern_t *pattern, size_t start __attribute__((unused)), void *user_data)
+{
+    const matcher_pattern_t **first = user_data;
+
+    if (*first == NULL || pattern < *first) {
+        *first = pattern;
+    }
+
+    return false;
+}
+
+/**
+ * @brief Return the first pattern added to a matcher that matches a
+ * string.
+ *
+ * This gives the same answer as walking the original list in order
+ * and stopping at the first match.
+ *
+ * @param m The compiled matcher, may be NULL.
+ * @param s The string to check.
+ * @return The matching pattern or NULL if nothing matched.
+ */
+const matcher_pattern_t *match_first(const matcher_t *m, const char *s)
+{
+    const matcher_pattern_t *first = NULL;
+
+    match_patterns(m, s, lowest_match, &first);
+    return first;
+}
+
+/**
+ * @brief Free a matcher.
+ *
+ * @param m The matcher to free, may be NULL.
+ */
+void free_matcher(matcher_t *m)
+{
+    size_t i = 0;
+
+    if (m == NULL) {
+        return;
+    }
+
+    for (i = 0; i < m->npatterns; i++) {
+        free(m->patterns[i].pattern);
+    }
+
+    for (i = 0; i < m->nnodes; i++) {
+        free(m->nodes[i].edges);
+    }
+
+    free(m->patterns);
+    free(m->nodes);
+    free(m);
+    return;
+}
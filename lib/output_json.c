@@ -61,6 +61,10 @@ void output_json(const results_t *results, const char *dest, __attribute__((unus
         jr = json_object_new_object();
         json_object_object_add(jr, "result", json_object_new_string(strseverity(result->severity)));
 
+        if (result->baseline != NULL) {
+            json_object_object_add(jr, "baseline", json_object_new_string(result->baseline));
+        }
+
         if (result->waiverauth > NULL_WAIVERAUTH) {
             json_object_object_add(jr, "waiver authorization", json_object_new_string(strwaiverauth(result->waiverauth)));
         }
@@ -77,6 +81,27 @@ void output_json(const results_t *results, const char *dest, __attribute__((unus
             json_object_object_add(jr, "remedy", json_object_new_string(result->remedy));
         }
 
+        /* so the result can be read back in by add_json_result() */
+        if (result->verb != VERB_NIL) {
+            json_object_object_add(jr, "verb", json_object_new_string(strverb(result->verb)));
+        }
+
+        if (result->noun != NULL) {
+            json_object_object_add(jr, "noun", json_object_new_string(result->noun));
+        }
+
+        if (result->arch != NULL) {
+            json_object_object_add(jr, "arch", json_object_new_string(result->arch));
+        }
+
+        if (result->file != NULL) {
+            json_object_object_add(jr, "file", json_object_new_string(result->file));
+        }
+
+        if (result->fingerprint != NULL) {
+            json_object_object_add(jr, "fingerprint", json_object_new_string(result->fingerprint));
+        }
+
         /* add this result data to the inspection array */
         json_object_array_add(ji, jr);
     }
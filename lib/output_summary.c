@@ -59,12 +59,18 @@ void output_summary(const results_t *results, const char *dest, __attribute__((u
             verb = _("FAILED");
         } else if (result->verb == VERB_OK) {
             verb = _("ok");
+        } else if (result->verb == VERB_TIMEOUT) {
+            verb = _("TIMEOUT");
         } else {
             verb = _("unknown");
         }
 
         /* construct the basic message */
-        xasprintf(&msg, "%-12s %s (%s)\n", verb, result->noun, result->header);
+        if (result->baseline != NULL) {
+            xasprintf(&msg, "%-12s %s (%s, %s)\n", verb, result->noun, result->header, result->baseline);
+        } else {
+            xasprintf(&msg, "%-12s %s (%s)\n", verb, result->noun, result->header);
+        }
 
         /* replace ${FILE} */
         if (strstr(msg, "${FILE}") && result->file != NULL) {
@@ -91,6 +91,10 @@ void output_text(const results_t *results, const char *dest, __attribute__((unus
 
             fprintf(fp, _("Result: %s\n"), strseverity(result->severity));
 
+            if (result->baseline != NULL) {
+                fprintf(fp, _("Baseline: %s\n"), result->baseline);
+            }
+
             if (result->waiverauth > NULL_WAIVERAUTH) {
                 fprintf(fp, _("Waiver Authorization: %s\n\n"), strwaiverauth(result->waiverauth));
             }
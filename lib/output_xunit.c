@@ -80,7 +80,12 @@ void output_xunit(const results_t *results, const char *dest, const severity_t t
             assert(msg != NULL);
         }
 
-        xasprintf(&rawcdata, _("Result: %s\n"), strseverity(result->severity));
+        if (result->baseline != NULL) {
+            xasprintf(&rawcdata, _("Result: %s\nBaseline: %s\n"), strseverity(result->severity), result->baseline);
+        } else {
+            xasprintf(&rawcdata, _("Result: %s\n"), strseverity(result->severity));
+        }
+
         assert(rawcdata != NULL);
 
         if (msg) {
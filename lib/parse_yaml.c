@@ -159,6 +159,25 @@ static void wait_for(context *c, yaml_token_t *token, yaml_token_type_t target)
     }
 }
 
+/* Add keys[pos] to the dict's index unless the key is already there. */
+static void index_key(y_value *dict, size_t pos)
+{
+    y_index *entry = NULL;
+    const char *key = dict->v.dict.keys[pos];
+
+    HASH_FIND_STR(dict->v.dict.index, key, entry);
+
+    if (entry != NULL) {
+        return;
+    }
+
+    entry = xalloc(sizeof(*entry));
+    entry->key = key;
+    entry->pos = pos;
+    HASH_ADD_KEYPTR(hh, dict->v.dict.index, entry->key, strlen(entry->key), entry);
+    return;
+}
+
 /*
  * Terminology:
  * - "block" is the weird yaml-y way of writing things; "flow" is json
@@ -226,6 +245,7 @@ static y_value *p_value(context *context)
                 ret->v.dict.values[i + 1] = NULL;
                 ret->v.dict.keys[i] = strndup((char *)token.data.scalar.value, token.data.scalar.length);
                 assert(ret->v.dict.keys[i]);
+                index_key(ret, i);
                 yaml_token_delete(&token);
                 wait_for(context, &token, YAML_VALUE_TOKEN);
 
@@ -361,6 +381,8 @@ static bool yaml_parse_file(parser_context **context_out, const char *filename)
 static void y_free_tree(y_value *v)
 {
     size_t i = 0;
+    y_index *entry = NULL;
+    y_index *tmp_entry = NULL;
 
     if (v == NULL || v->type == Y_UNINITIALIZED) {
         return;
@@ -373,6 +395,11 @@ static void y_free_tree(y_value *v)
 
         free(v->v.array);
     } else if (v->type == Y_DICT) {
+        HASH_ITER(hh, v->v.dict.index, entry, tmp_entry) {
+            HASH_DEL(v->v.dict.index, entry);
+            free(entry);
+        }
+
         for (i = 0; v->v.dict.keys[i] != NULL; i++) {
             free(v->v.dict.keys[i]);
             y_free_tree(v->v.dict.values[i]);
@@ -398,7 +425,8 @@ static void yaml_fini(parser_context *context)
 
 static y_value *getobj(y_value *y, const char *key1, const char *key2)
 {
-    size_t i = 0;
+    y_index *entry = NULL;
+
     if (key1 == NULL) {
         assert(key2 == NULL);
         return y;
@@ -406,13 +434,13 @@ static y_value *getobj(y_value *y, const char *key1, const char *key2)
         return NULL;
     }
 
-    for (i = 0; y->v.dict.keys[i] != NULL; i++) {
-        if (!strcmp(key1, y->v.dict.keys[i])) {
-            return getobj(y->v.dict.values[i], key2, NULL);
-        }
+    HASH_FIND_STR(y->v.dict.index, key1, entry);
+
+    if (entry == NULL) {
+        return NULL;
     }
 
-    return NULL;
+    return getobj(y->v.dict.values[entry->pos], key2, NULL);
 }
 
 static char *yaml_getstr(parser_context *context, const char *key1, const char *key2)
@@ -17,145 +17,228 @@
 #include "queue.h"
 #include "rpminspect.h"
 
-/**
- * @brief Return the selected build debuginfo package path where the
- * package was extracted for rpminspect.  The path must match the
- * architecture provided.
- *
- * IMPORTANT: Do not free the returned string.
- *
- * @param ri The struct rpminspect for the program.
- * @param file The file we are looking for debuginfo for.
- * @param binarch The required debuginfo architecture.
- * @return Full path to the extracted debuginfo package, or
- *         NULL if not found.
+/*
+ * Add a key to a debuginfo index.  The first root recorded for a key
+ * wins.  Every call increments the count for the key.
  */
-const char *get_debuginfo_path(struct rpminspect *ri, const rpmfile_entry_t *file, const char *binarch, int build)
+static void add_debuginfo_index(debuginfo_index_t **index, char *key, const char *root)
+{
+    debuginfo_index_t *entry = NULL;
+
+    assert(index != NULL);
+    assert(key != NULL);
+
+    HASH_FIND_STR(*index, key, entry);
+
+    if (entry == NULL) {
+        entry = calloc(1, sizeof(*entry));
+        assert(entry != NULL);
+        entry->key = key;
+        entry->root = root;
+        HASH_ADD_KEYPTR(hh, *index, entry->key, strlen(entry->key), entry);
+    } else {
+        free(key);
+    }
+
+    entry->count++;
+    return;
+}
+
+/*
+ * Walk the debuginfo packages in the specified build once and index
+ * every debug file they carry by architecture and path.  This
+ * includes the .build-id links which resolve to regular files in the
+ * extracted package.
+ */
+static void index_debuginfo(struct rpminspect *ri, int build)
 {
-    char *r = NULL;
     rpmpeer_entry_t *peer = NULL;
-    rpmpeer_entry_t *safety = NULL;
+    Header hdr = NULL;
     const char *name = NULL;
     const char *arch = NULL;
-    char *root = NULL;
-    char *pattern = NULL;
-    char *check = NULL;
-    char *tmp = NULL;
+    const char *root = NULL;
     rpmfile_t *files = NULL;
     rpmfile_entry_t *pfile = NULL;
-    unsigned int count = 0;
+    char *key = NULL;
     struct stat sb;
 
     assert(ri != NULL);
-    assert(file != NULL);
-    assert(binarch != NULL);
-    assert(build == BEFORE_BUILD || build == AFTER_BUILD);
 
-    /* debuginfo base pattern */
-    arch = get_rpm_header_arch(file->rpm_header);
+    ri->debuginfo_indexed[build] = true;
 
-    if (!fnmatch(RPM_X86_ARCH_PATTERN, arch, 0)) {
-        arch = RPM_X86_ARCH_PATTERN;
+    if (ri->peers == NULL) {
+        return;
     }
 
-    xasprintf(&pattern, "%s-%s-%s.%s%s", file->localpath,
-                                         headerGetString(file->rpm_header, RPMTAG_VERSION),
-                                         headerGetString(file->rpm_header, RPMTAG_RELEASE),
-                                         arch,
-                                         DEBUG_FILE_SUFFIX);
-    assert(pattern != NULL);
-
-    /* try to find a debuginfo package */
     TAILQ_FOREACH(peer, ri->peers, items) {
-        if ((build == BEFORE_BUILD && peer->before_hdr == NULL) || (build == AFTER_BUILD && peer->after_hdr == NULL)) {
-            continue;
-        }
-
         if (build == BEFORE_BUILD) {
-            arch = get_rpm_header_arch(peer->before_hdr);
+            hdr = peer->before_hdr;
             root = peer->before_root;
             files = peer->before_files;
         } else {
-            arch = get_rpm_header_arch(peer->after_hdr);
+            hdr = peer->after_hdr;
             root = peer->after_root;
             files = peer->after_files;
         }
 
+        if (hdr == NULL) {
+            continue;
+        }
+
+        name = headerGetString(hdr, RPMTAG_NAME);
+        assert(name != NULL);
+
+        if (!strsuffix(name, DEBUGINFO_SUFFIX)) {
+            continue;
+        }
+
+        arch = get_rpm_header_arch(hdr);
         assert(arch != NULL);
 
-        if (strcmp(arch, binarch)) {
-            /* not the same architecture */
+        /* count the debuginfo packages per architecture */
+        key = strdup(arch);
+        assert(key != NULL);
+        add_debuginfo_index(&ri->debuginfo_index[build], key, root);
+
+        if (files == NULL) {
             continue;
         }
 
-        if (build == BEFORE_BUILD) {
-            name = headerGetString(peer->before_hdr, RPMTAG_NAME);
-        } else {
-            name = headerGetString(peer->after_hdr, RPMTAG_NAME);
+        TAILQ_FOREACH(pfile, files, items) {
+            if (pfile->fullpath == NULL || !strprefix(pfile->localpath, DEBUG_PATH) || !strsuffix(pfile->localpath, DEBUG_FILE_SUFFIX)) {
+                continue;
+            }
+
+            if (stat(pfile->fullpath, &sb) != 0 || !S_ISREG(sb.st_mode)) {
+                continue;
+            }
+
+            xasprintf(&key, "%s:%s", arch, pfile->localpath);
+            assert(key != NULL);
+            add_debuginfo_index(&ri->debuginfo_index[build], key, root);
         }
+    }
 
-        assert(name != NULL);
+    return;
+}
+
+/*
+ * Look up a debug file path for the given architecture in the
+ * debuginfo index and return the package root, or NULL.
+ */
+static const char *find_debuginfo_index(struct rpminspect *ri, int build, const char *binarch, const char *path)
+{
+    char *key = NULL;
+    debuginfo_index_t *entry = NULL;
 
-        /* found debuginfo package */
-        if (strsuffix(name, DEBUGINFO_SUFFIX)) {
-            count++;
+    xasprintf(&key, "%s:%s", binarch, path);
+    assert(key != NULL);
+    HASH_FIND_STR(ri->debuginfo_index[build], key, entry);
+    free(key);
 
-            /* used for older systems that generate single debuginfo packages */
-            if (safety == NULL) {
-                safety = peer;
-            }
+    if (entry == NULL) {
+        return NULL;
+    }
 
-            /* create a full pattern for matching */
-            tmp = pattern;
+    return entry->root;
+}
 
-            if (strsuffix(DEBUG_PATH, "/")) {
-                while (*tmp == '/' && *tmp != '\0') {
-                    tmp++;
-                }
-            }
+/**
+ * @brief Return the selected build debuginfo package path where the
+ * package was extracted for rpminspect.  The path must match the
+ * architecture provided.
+ *
+ * The debuginfo packages of each build are indexed on first use so
+ * repeated lookups do not walk every package and file.  The file's
+ * build-id is tried first, then the conventional debug file name.
+ *
+ * IMPORTANT: Do not free the returned string.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param file The file we are looking for debuginfo for.
+ * @param binarch The required debuginfo architecture.
+ * @return Full path to the extracted debuginfo package, or
+ *         NULL if not found.
+ */
+const char *get_debuginfo_path(struct rpminspect *ri, const rpmfile_entry_t *file, const char *binarch, int build)
+{
+    const char *r = NULL;
+    const char *arch = NULL;
+    const char *localpath = NULL;
+    char *build_id = NULL;
+    char *path = NULL;
+    debuginfo_index_t *entry = NULL;
+    unsigned int i = 0;
+    static const char *x86_arches[] = { "i386", "i486", "i586", "i686", NULL };
 
-            xasprintf(&check, "%s%s%s", root, DEBUG_PATH, tmp);
-            assert(check != NULL);
-
-            TAILQ_FOREACH(pfile, files, items) {
-                if (fnmatch(check, pfile->fullpath, 0)) {
-                    continue;
-                } else {
-                    if (stat(pfile->fullpath, &sb) == 0 && S_ISREG(sb.st_mode)) {
-                        /* just copy the pointer, no need to dupe it */
-                        if (build == BEFORE_BUILD) {
-                            r = peer->before_root;
-                        } else {
-                            r = peer->after_root;
-                        }
-
-                        break;
-                    }
-                }
-            }
+    assert(ri != NULL);
+    assert(file != NULL);
+    assert(binarch != NULL);
+    assert(build == BEFORE_BUILD || build == AFTER_BUILD);
 
-            free(check);
+    if (!ri->debuginfo_indexed[build]) {
+        index_debuginfo(ri, build);
+    }
 
-            if (r) {
-                break;
-            }
-        }
+    if (ri->debuginfo_index[build] == NULL) {
+        return NULL;
+    }
 
-        if (r) {
-            break;
-        }
+    /* first try by build-id */
+    build_id = get_elf_build_id(file->fullpath);
+
+    if (build_id != NULL && strlen(build_id) > 2) {
+        xasprintf(&path, "%s%s%.2s/%s%s", DEBUG_PATH, BUILD_ID_DIR + 1, build_id, build_id + 2, DEBUG_FILE_SUFFIX);
+        assert(path != NULL);
+        r = find_debuginfo_index(ri, build, binarch, path);
+        free(path);
     }
 
-    /* older systems used to generate a single debuginfo package */
-    if (count == 1 && r == NULL) {
-        if (build == BEFORE_BUILD) {
-            r = safety->before_root;
+    free(build_id);
+
+    if (r) {
+        return r;
+    }
+
+    /* then by debug file name */
+    localpath = file->localpath;
+
+    while (*localpath == '/') {
+        localpath++;
+    }
+
+    arch = get_rpm_header_arch(file->rpm_header);
+    i = 0;
+
+    do {
+        xasprintf(&path, "%s%s-%s-%s.%s%s", DEBUG_PATH, localpath,
+                                            headerGetString(file->rpm_header, RPMTAG_VERSION),
+                                            headerGetString(file->rpm_header, RPMTAG_RELEASE),
+                                            arch,
+                                            DEBUG_FILE_SUFFIX);
+        assert(path != NULL);
+        r = find_debuginfo_index(ri, build, binarch, path);
+        free(path);
+
+        /* 32-bit x86 debug files may carry any i?86 architecture */
+        if (r == NULL && !fnmatch(RPM_X86_ARCH_PATTERN, get_rpm_header_arch(file->rpm_header), 0)) {
+            arch = x86_arches[i++];
         } else {
-            r = safety->after_root;
+            arch = NULL;
         }
+    } while (r == NULL && arch != NULL);
+
+    if (r) {
+        return r;
+    }
+
+    /* older systems used to generate a single debuginfo package */
+    HASH_FIND_STR(ri->debuginfo_index[build], binarch, entry);
+
+    if (entry != NULL && entry->count == 1) {
+        r = entry->root;
     }
 
-    free(pattern);
     return r;
 }
 
@@ -22,6 +22,25 @@ rpmpeer_t *init_peers(void)
     return peers;
 }
 
+/*
+ * Free the before side of a peer and clear it.  The header belongs to
+ * the header cache.
+ */
+static void free_before_peer(rpmpeer_entry_t *peer)
+{
+    free(peer->before_rpm);
+    free(peer->before_root);
+    free_files(peer->before_files);
+    free_deprules(peer->before_deprules);
+    peer->before_hdr = NULL;
+    peer->before_rpm = NULL;
+    peer->before_root = NULL;
+    peer->before_files = NULL;
+    peer->before_deprules = NULL;
+    peer->before_unpacked_size = 0;
+    return;
+}
+
 /*
  * Free memory associated with an rpmpeer_t list.
  */
@@ -36,13 +55,10 @@ void free_peers(rpmpeer_t *peers)
     while (!TAILQ_EMPTY(peers)) {
         entry = TAILQ_FIRST(peers);
         TAILQ_REMOVE(peers, entry, items);
-        free(entry->before_rpm);
+        free_before_peer(entry);
         free(entry->after_rpm);
-        free(entry->before_root);
         free(entry->after_root);
-        free_files(entry->before_files);
         free_files(entry->after_files);
-        free_deprules(entry->before_deprules);
         free_deprules(entry->after_deprules);
         free(entry);
     }
@@ -149,6 +165,7 @@ void add_peer(rpmpeer_t **peers, deprule_ignore_map_t *ignores, int whichbuild,
 int extract_peers(struct rpminspect *ri, bool fetchonly)
 {
     unsigned long int avail = 0;
+    unsigned long int need = 0;
     char *availh = NULL;
     char *needh = NULL;
     rpmpeer_entry_t *peer = NULL;
@@ -163,15 +180,21 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
 
     /* compute total unpacked size required and see if there's space */
     TAILQ_FOREACH(peer, ri->peers, items) {
-        ri->unpacked_size += peer->before_unpacked_size;
-        ri->unpacked_size += peer->after_unpacked_size;
+        if (peer->before_root == NULL) {
+            need += peer->before_unpacked_size;
+        }
+
+        if (peer->after_root == NULL) {
+            need += peer->after_unpacked_size;
+        }
     }
 
+    ri->unpacked_size += need;
     avail = get_available_space(ri->workdir);
 
-    if (avail < ri->unpacked_size) {
+    if (avail < need) {
         availh = human_size(avail);
-        needh = human_size(ri->unpacked_size);
+        needh = human_size(need);
 
         fprintf(stderr, _("There is not enough available space to unpack all of the RPMs.\n"));
         fprintf(stderr, _("    Need %s in %s, have %s.\n"), needh, ri->workdir, availh);
@@ -182,15 +205,15 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
         return RI_INSUFFICIENT_SPACE;
     }
 
-    /* unpack all RPMs */
+    /* unpack all RPMs not unpacked yet */
     TAILQ_FOREACH(peer, ri->peers, items) {
         /* extract the before peer */
-        if (peer->before_hdr && peer->before_rpm) {
+        if (peer->before_hdr && peer->before_rpm && peer->before_root == NULL) {
             peer->before_files = extract_rpm(ri, peer->before_rpm, peer->before_hdr, BEFORE_SUBDIR, &peer->before_root);
         }
 
         /* extract the after peer */
-        if (peer->after_hdr && peer->after_rpm) {
+        if (peer->after_hdr && peer->after_rpm && peer->after_root == NULL) {
             peer->after_files = extract_rpm(ri, peer->after_rpm, peer->after_hdr, AFTER_SUBDIR, &peer->after_root);
         }
 
@@ -202,3 +225,78 @@ int extract_peers(struct rpminspect *ri, bool fetchonly)
 
     return RI_SUCCESS;
 }
+
+/**
+ * @brief Drop the before build so another one can be gathered.
+ *
+ * The after packages, their extracted files and everything cached
+ * about those files are kept.  Links from the after files and
+ * dependency rules to their before peers are cleared, peers that only
+ * had a before package are removed, and the per-run information
+ * derived from the before build is reset.
+ *
+ * @param ri The struct rpminspect for the program.
+ */
+void reset_before_peers(struct rpminspect *ri)
+{
+    rpmpeer_entry_t *peer = NULL;
+    rpmpeer_entry_t *next = NULL;
+    rpmfile_entry_t *file = NULL;
+    deprule_entry_t *deprule = NULL;
+    debuginfo_index_t *dentry = NULL;
+    debuginfo_index_t *tmp_dentry = NULL;
+
+    assert(ri != NULL);
+
+    if (ri->peers != NULL) {
+        peer = TAILQ_FIRST(ri->peers);
+
+        while (peer != NULL) {
+            next = TAILQ_NEXT(peer, items);
+            free_before_peer(peer);
+
+            if (peer->after_rpm == NULL) {
+                TAILQ_REMOVE(ri->peers, peer, items);
+                free(peer);
+                peer = next;
+                continue;
+            }
+
+            if (peer->after_files != NULL) {
+                TAILQ_FOREACH(file, peer->after_files, items) {
+                    file->peer_file = NULL;
+                    file->moved_path = false;
+                    file->moved_subpackage = false;
+                }
+            }
+
+            if (peer->after_deprules != NULL) {
+                TAILQ_FOREACH(deprule, peer->after_deprules, items) {
+                    deprule->peer_deprule = NULL;
+                }
+            }
+
+            peer = next;
+        }
+    }
+
+    HASH_ITER(hh, ri->debuginfo_index[BEFORE_BUILD], dentry, tmp_dentry) {
+        HASH_DEL(ri->debuginfo_index[BEFORE_BUILD], dentry);
+        free(dentry->key);
+        free(dentry);
+    }
+
+    ri->debuginfo_indexed[BEFORE_BUILD] = false;
+    free(ri->before_rel);
+    ri->before_rel = NULL;
+    ri->rebase_build = 0;
+    ri->before_static_context = false;
+
+    /* spec files are parsed again, the before ones are gone */
+    free_spec_models(ri->specs);
+    ri->specs = NULL;
+
+    free_string_map(ri->fingerprints);
+    ri->fingerprints = NULL;
+    return;
+}
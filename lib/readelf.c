@@ -261,6 +261,105 @@ string_list_t *get_elf_section_names(Elf *elf, size_t start)
     return names;
 }
 
+/*
+ * Map a section name to its ELF_SECTION_* bit.  The known names all
+ * differ in length except .gnu_debugdata and .gnu_debuglink, so the
+ * length picks the candidate and a single comparison confirms it.
+ */
+static uint64_t elf_section_flag(const char *name)
+{
+    size_t len = strlen(name);
+
+    if (len == sizeof(ELF_SYMTAB) - 1 && !strcmp(name, ELF_SYMTAB)) {
+        return ELF_SECTION_SYMTAB;
+    } else if (len == sizeof(ELF_GOSYMTAB) - 1 && !strcmp(name, ELF_GOSYMTAB)) {
+        return ELF_SECTION_GOSYMTAB;
+    } else if (len == sizeof(ELF_GDB_INDEX) - 1 && !strcmp(name, ELF_GDB_INDEX)) {
+        return ELF_SECTION_GDB_INDEX;
+    } else if (len == sizeof(ELF_DEBUG_INFO) - 1 && !strcmp(name, ELF_DEBUG_INFO)) {
+        return ELF_SECTION_DEBUG_INFO;
+    } else if (len == sizeof(ELF_GNU_DEBUGDATA) - 1) {
+        if (!strcmp(name, ELF_GNU_DEBUGDATA)) {
+            return ELF_SECTION_GNU_DEBUGDATA;
+        } else if (!strcmp(name, ELF_GNU_DEBUGLINK)) {
+            return ELF_SECTION_GNU_DEBUGLINK;
+        }
+    }
+
+    return 0;
+}
+
+uint64_t get_elf_section_flags(Elf *elf)
+{
+    size_t shstrndx;
+    Elf_Scn *scn = NULL;
+    GElf_Shdr shdr;
+    const char *name = NULL;
+    uint64_t flags = ELF_SECTIONS_SCANNED;
+
+    assert(elf != NULL);
+
+    if (elf_getshdrstrndx(elf, &shstrndx) != 0) {
+        return flags;
+    }
+
+    while ((scn = elf_nextscn(elf, scn)) != NULL) {
+        if (gelf_getshdr(scn, &shdr) != &shdr) {
+            break;
+        }
+
+        name = elf_strptr(elf, shstrndx, shdr.sh_name);
+
+        if (name == NULL || *name != '.') {
+            continue;
+        }
+
+        flags |= elf_section_flag(name);
+
+        if (shdr.sh_type == SHT_PROGBITS && strprefix(name, ".guile.")) {
+            flags |= ELF_SECTION_GUILE;
+        }
+    }
+
+    return flags;
+}
+
+uint64_t get_rpmfile_elf_sections(rpmfile_entry_t *file)
+{
+    int fd = -1;
+    Elf *elf = NULL;
+
+    assert(file != NULL);
+
+    if (file->elf_sections & ELF_SECTIONS_SCANNED) {
+        return file->elf_sections;
+    }
+
+    file->elf_sections = ELF_SECTIONS_SCANNED;
+    file->elf_type = ET_NONE;
+
+    if (file->fullpath == NULL || !S_ISREG(file->st.st_mode)) {
+        return file->elf_sections;
+    }
+
+    if ((elf = get_elf(file->fullpath, &fd)) != NULL) {
+        file->elf_sections = get_elf_section_flags(elf);
+        file->elf_type = get_elf_type(elf);
+        elf_end(elf);
+        close(fd);
+    }
+
+    return file->elf_sections;
+}
+
+GElf_Half get_rpmfile_elf_type(rpmfile_entry_t *file)
+{
+    assert(file != NULL);
+
+    (void) get_rpmfile_elf_sections(file);
+    return file->elf_type;
+}
+
 /*
  * Look through an ELF object by section for a section by the given ID and
  * the specified name.  At least one parameter is required.  To not specify
@@ -491,6 +590,63 @@ char *get_elf_soname(const char *filepath)
     return soname;
 }
 
+/*
+ * Returns the GNU build-id of the given file as a lowercase hex
+ * string or NULL if the file has no NT_GNU_BUILD_ID note.  Caller
+ * must free the returned string.
+ */
+char *get_elf_build_id(const char *filepath)
+{
+    char *build_id = NULL;
+    Elf *e = NULL;
+    int fd = 0;
+    Elf_Scn *scn = NULL;
+    GElf_Shdr shdr;
+    Elf_Data *data = NULL;
+    GElf_Nhdr nhdr;
+    size_t offset = 0;
+    size_t name_offset = 0;
+    size_t desc_offset = 0;
+    size_t i = 0;
+    const unsigned char *desc = NULL;
+
+    assert(filepath != NULL);
+
+    if ((e = get_elf(filepath, &fd)) == NULL) {
+        close(fd);
+        return NULL;
+    }
+
+    while (build_id == NULL && (scn = get_elf_section(e, SHT_NOTE, NULL, scn, &shdr)) != NULL) {
+        if ((data = elf_getdata(scn, NULL)) == NULL) {
+            continue;
+        }
+
+        offset = 0;
+
+        while ((offset = gelf_getnote(data, offset, &nhdr, &name_offset, &desc_offset)) > 0) {
+            if (nhdr.n_type != NT_GNU_BUILD_ID || nhdr.n_descsz == 0 || nhdr.n_namesz != sizeof(ELF_NOTE_GNU)
+                || memcmp((const char *) data->d_buf + name_offset, ELF_NOTE_GNU, sizeof(ELF_NOTE_GNU))) {
+                continue;
+            }
+
+            desc = (const unsigned char *) data->d_buf + desc_offset;
+            build_id = calloc(1, (nhdr.n_descsz * 2) + 1);
+            assert(build_id != NULL);
+
+            for (i = 0; i < nhdr.n_descsz; i++) {
+                sprintf(&build_id[i * 2], "%02x", (unsigned int) desc[i]);
+            }
+
+            break;
+        }
+    }
+
+    elf_end(e);
+    close(fd);
+    return build_id;
+}
+
 static string_list_t *get_elf_symbol_list(Elf *elf, bool (*filter)(const char *), uint32_t sh_type, const char *table_name)
 {
     Elf_Scn *scn = NULL;
@@ -4,6 +4,11 @@
  */
 
 #include <assert.h>
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <json.h>
 #include "queue.h"
 #include "rpminspect.h"
 
@@ -61,6 +66,8 @@ void free_results(results_t *results)
         free(entry->noun);
         free(entry->arch);
         free(entry->file);
+        free(entry->fingerprint);
+        free(entry->baseline);
 
         /* these are all consts */
         entry->header = NULL;
@@ -134,8 +141,97 @@ void add_result_entry(results_t **results, struct result_params *params)
     return;
 }
 
+/*
+ * Label the inspection results that have no baseline yet with the
+ * before build they came from.  Used when one after build is compared
+ * against several before builds; the diagnostics results belong to
+ * the whole run and stay unlabeled.
+ */
+void set_results_baseline(results_t *results, const char *baseline)
+{
+    results_entry_t *entry = NULL;
+
+    assert(baseline != NULL);
+
+    if (results == NULL) {
+        return;
+    }
+
+    TAILQ_FOREACH(entry, results, items) {
+        if (entry->baseline != NULL || !strcmp(entry->header, NAME_DIAGNOSTICS)) {
+            continue;
+        }
+
+        entry->baseline = strdup(baseline);
+        assert(entry->baseline != NULL);
+    }
+
+    return;
+}
+
+/* A string member of a JSON object, NULL if missing */
+static const char *get_json_string(json_object *jo, const char *key)
+{
+    json_object *val = NULL;
+
+    if (!json_object_object_get_ex(jo, key, &val) || !json_object_is_type(val, json_type_string)) {
+        return NULL;
+    }
+
+    return json_object_get_string(val);
+}
+
+static char *dup_json_string(json_object *jo, const char *key)
+{
+    const char *s = get_json_string(jo, key);
+    char *r = NULL;
+
+    if (s != NULL) {
+        r = strdup(s);
+        assert(r != NULL);
+    }
+
+    return r;
+}
+
+/*
+ * Add a result read back from JSON results written by output_json().
+ * Every member of the results_entry_t is restored, so the result
+ * can be written out again in any output format.  header must be a
+ * string that outlives the results, like an inspections[] name.
+ * Returns the new entry.
+ */
+results_entry_t *add_json_result(results_t **results, const char *header, struct json_object *jr)
+{
+    results_entry_t *entry = NULL;
+    struct result_params params;
+
+    assert(results != NULL);
+    assert(header != NULL);
+    assert(jr != NULL);
+
+    init_result_params(&params);
+    params.header = header;
+    params.severity = getseverity(get_json_string(jr, "result"), RESULT_NULL);
+    params.waiverauth = getwaiverauth(get_json_string(jr, "waiver authorization"), NULL_WAIVERAUTH);
+    params.msg = (char *) get_json_string(jr, "message");
+    params.details = (char *) get_json_string(jr, "details");
+    params.remedy = (char *) get_json_string(jr, "remedy");
+    params.verb = getverb(get_json_string(jr, "verb"), VERB_NIL);
+    params.noun = (char *) get_json_string(jr, "noun");
+    params.arch = (char *) get_json_string(jr, "arch");
+    params.file = (char *) get_json_string(jr, "file");
+    add_result_entry(results, &params);
+
+    entry = TAILQ_LAST(*results, results_s);
+    entry->baseline = dup_json_string(jr, "baseline");
+    entry->fingerprint = dup_json_string(jr, "fingerprint");
+    return entry;
+}
+
 /*
  * Shortcut to call add_result_entry() by giving the struct rpminspect.
+ * If ri->results_stream is set, the result is also written there.
  */
 void add_result(struct rpminspect *ri, struct result_params *params)
 {
@@ -148,9 +244,153 @@ void add_result(struct rpminspect *ri, struct result_params *params)
     }
 
     add_result_entry(&ri->results, params);
+
+    if (ri->results_stream) {
+        write_result(ri->results_stream, TAILQ_LAST(ri->results, results_s));
+    }
+
+    return;
+}
+
+/* Write a string as its length and bytes, -1 for NULL */
+static void write_string(FILE *fp, const char *s)
+{
+    if (s == NULL) {
+        fprintf(fp, "-1\n");
+    } else {
+        fprintf(fp, "%zu\n%s\n", strlen(s), s);
+    }
+
+    return;
+}
+
+/*
+ * Write a result so another process can read it back with
+ * read_results().  The stream is flushed so the result survives the
+ * writer being killed.
+ */
+void write_result(FILE *fp, const results_entry_t *entry)
+{
+    assert(fp != NULL);
+    assert(entry != NULL);
+
+    fprintf(fp, "%d %d %d\n", entry->severity, entry->waiverauth, entry->verb);
+    write_string(fp, entry->header);
+    write_string(fp, entry->msg);
+    write_string(fp, entry->details);
+    write_string(fp, entry->remedy);
+    write_string(fp, entry->noun);
+    write_string(fp, entry->arch);
+    write_string(fp, entry->file);
+
+    if (fflush(fp) != 0) {
+        warn("fflush");
+    }
+
     return;
 }
 
+/* Read a string written by write_string(), false on a short read */
+static bool read_string(FILE *fp, char **s)
+{
+    long len = 0;
+
+    *s = NULL;
+
+    if (fscanf(fp, "%ld", &len) != 1 || fgetc(fp) != '\n') {
+        return false;
+    }
+
+    if (len < 0) {
+        return true;
+    }
+
+    *s = calloc(1, len + 1);
+    assert(*s != NULL);
+
+    if (fread(*s, 1, len, fp) != (size_t) len || fgetc(fp) != '\n') {
+        free(*s);
+        *s = NULL;
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Read results written by write_result() until the end of the file,
+ * a line starting with a period, or a result cut short.  Results
+ * carry the static inspection name as their header, so names read
+ * back are mapped to the one in inspections[] and the given header is
+ * used for anything else.  Returns the results read, possibly NULL.
+ * On return the stream is positioned after the period if there was
+ * one.
+ */
+results_t *read_results(FILE *fp, const char *header)
+{
+    int c = 0;
+    int i = 0;
+    int severity = 0;
+    int waiverauth = 0;
+    int verb = 0;
+    bool ok = true;
+    char *strings[7];
+    struct result_params params;
+    results_t *results = NULL;
+
+    assert(fp != NULL);
+    assert(header != NULL);
+
+    while (ok) {
+        c = fgetc(fp);
+
+        if (c == '.' || c == EOF) {
+            break;
+        }
+
+        ungetc(c, fp);
+
+        if (fscanf(fp, "%d %d %d", &severity, &waiverauth, &verb) != 3 || fgetc(fp) != '\n') {
+            break;
+        }
+
+        memset(strings, 0, sizeof(strings));
+
+        for (i = 0; i < 7 && ok; i++) {
+            ok = read_string(fp, &strings[i]);
+        }
+
+        if (ok && strings[0] != NULL) {
+            init_result_params(&params);
+            params.severity = severity;
+            params.waiverauth = waiverauth;
+            params.verb = verb;
+            params.header = header;
+
+            for (c = 0; inspections[c].name != NULL; c++) {
+                if (!strcmp(inspections[c].name, strings[0])) {
+                    params.header = inspections[c].name;
+                    break;
+                }
+            }
+
+            params.msg = strings[1];
+            params.details = strings[2];
+            params.remedy = strings[3];
+            params.noun = strings[4];
+            params.arch = strings[5];
+            params.file = strings[6];
+            add_result_entry(&results, &params);
+        }
+
+        for (i = 0; i < 7; i++) {
+            free(strings[i]);
+        }
+    }
+
+    return results;
+}
+
 /*
  * Returns true if all the results for the named inspection are
  * suppressed.
@@ -0,0 +1,521 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Incremental re-inspection.  Each inspection gets a fingerprint of
+ * its inputs: the RPM header digests of the builds, the tool versions
+ * reported in the diagnostics, the configuration sections that apply
+ * to it, and the vendor data files it reads.  The fingerprint is
+ * written with each result in JSON output.  Given the JSON results
+ * of a previous run, inspections whose fingerprint has not changed
+ * have their results copied forward instead of being run again.
+ */
+
+#include <assert.h>
+#include <dirent.h>
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <json.h>
+#include <openssl/sha.h>
+#include <rpm/header.h>
+#include <rpm/rpmtag.h>
+
+#include "rpminspect.h"
+
+/* Vendor data subdirectories read by specific inspections */
+static const struct {
+    const char *inspection;
+    const char *dir;
+} vendor_inputs[] = {
+    { NAME_ABIDIFF,      ABI_DIR },
+    { NAME_CAPABILITIES, CAPABILITIES_DIR },
+    { NAME_DESKTOP,      ICONS_DIR },
+    { NAME_LICENSE,      LICENSES_DIR },
+    { NAME_OWNERSHIP,    FILEINFO_DIR },
+    { NAME_PERMISSIONS,  FILEINFO_DIR },
+    { NAME_POLITICS,     POLITICS_DIR },
+    { NULL, NULL }
+};
+
+/* Configuration sections that do not change inspection results */
+static const char *ignored_sections[] = { "common", "inspections", "timeouts", NULL };
+
+static const struct inspect *find_inspection(const char *name)
+{
+    int i = 0;
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!strcmp(inspections[i].name, name)) {
+            return &inspections[i];
+        }
+    }
+
+    return NULL;
+}
+
+static char *sha256_hex(const strbuf_t *sb)
+{
+    int i = 0;
+    unsigned char md[SHA256_DIGEST_LENGTH];
+    char *r = NULL;
+
+    SHA256((const unsigned char *) ((sb->data == NULL) ? "" : sb->data), sb->len, md);
+
+    r = calloc(1, (SHA256_DIGEST_LENGTH * 2) + 1);
+    assert(r != NULL);
+
+    for (i = 0; i < SHA256_DIGEST_LENGTH; i++) {
+        sprintf(r + (i * 2), "%02x", md[i]);
+    }
+
+    return r;
+}
+
+/*
+ * Break the dump_cfg() output in to its top level sections.  The
+ * section name is the key and the section text is the value.
+ */
+static string_map_t *config_sections(const struct rpminspect *ri)
+{
+    FILE *fp = NULL;
+    char *dump = NULL;
+    size_t len = 0;
+    string_list_t *lines = NULL;
+    string_entry_t *line = NULL;
+    string_map_t *sections = NULL;
+    string_map_t *section = NULL;
+
+    fp = open_memstream(&dump, &len);
+
+    if (fp == NULL) {
+        warn("open_memstream");
+        return NULL;
+    }
+
+    dump_cfg(fp, ri);
+
+    if (fclose(fp) != 0) {
+        warn("fclose");
+    }
+
+    lines = strsplit(dump, "\n");
+    free(dump);
+
+    if (lines == NULL) {
+        return NULL;
+    }
+
+    TAILQ_FOREACH(line, lines, items) {
+        if (*line->data == '#' || !strcmp(line->data, "---")) {
+            continue;
+        }
+
+        /* a new top level section */
+        if (*line->data != ' ' && strsuffix(line->data, ":")) {
+            line->data[strlen(line->data) - 1] = '\0';
+            HASH_FIND_STR(sections, line->data, section);
+
+            if (section == NULL) {
+                section = calloc(1, sizeof(*section));
+                assert(section != NULL);
+                section->key = strdup(line->data);
+                assert(section->key != NULL);
+                HASH_ADD_KEYPTR(hh, sections, section->key, strlen(section->key), section);
+            }
+
+            continue;
+        }
+
+        if (section != NULL) {
+            section->value = strappend(section->value, line->data, "\n", NULL);
+        }
+    }
+
+    list_free(lines, free);
+    return sections;
+}
+
+/* Add the digests of the files in a vendor data subdirectory */
+static void add_vendor_dir(strbuf_t *sb, const struct rpminspect *ri, const char *subdir)
+{
+    int i = 0;
+    int n = 0;
+    char *dir = NULL;
+    char *path = NULL;
+    char *digest = NULL;
+    struct dirent **entries = NULL;
+    struct stat st;
+
+    xasprintf(&dir, "%s/%s", ri->vendor_data_dir, subdir);
+    assert(dir != NULL);
+
+    /* sorted so the fingerprint does not depend on directory order */
+    n = scandir(dir, &entries, NULL, alphasort);
+
+    for (i = 0; i < n; i++) {
+        xasprintf(&path, "%s/%s", dir, entries[i]->d_name);
+        assert(path != NULL);
+
+        if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+            digest = compute_checksum(path, &st.st_mode, SHA256SUM);
+            strbuf_appendf(sb, "%s %s\n", path, (digest == NULL) ? "-" : digest);
+            free(digest);
+        }
+
+        free(path);
+        free(entries[i]);
+    }
+
+    free(entries);
+    free(dir);
+    return;
+}
+
+/* Add the header digest of a package, or its NEVRA if it has none */
+static void add_header(strbuf_t *sb, Header hdr)
+{
+    const char *digest = NULL;
+    char *nevra = NULL;
+
+    if (hdr == NULL) {
+        return;
+    }
+
+    digest = headerGetString(hdr, RPMTAG_SHA256HEADER);
+
+    if (digest == NULL) {
+        digest = headerGetString(hdr, RPMTAG_SHA1HEADER);
+    }
+
+    if (digest == NULL) {
+        nevra = headerGetAsString(hdr, RPMTAG_NEVRA);
+        strbuf_appendf(sb, "%s\n", nevra);
+        free(nevra);
+    } else {
+        strbuf_appendf(sb, "%s\n", digest);
+    }
+
+    return;
+}
+
+/**
+ * @brief Compute the input fingerprint of every inspection.
+ *
+ * Call after the builds are gathered and the product release is
+ * known.  The fingerprints are stored in ri->fingerprints.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param diags Version information for the programs and libraries
+ * used, from gather_diags().
+ */
+void compute_fingerprints(struct rpminspect *ri, const string_list_t *diags)
+{
+    int i = 0;
+    int j = 0;
+    strbuf_t common;
+    strbuf_t sb;
+    char *s = NULL;
+    string_entry_t *entry = NULL;
+    rpmpeer_entry_t *peer = NULL;
+    string_map_t *sections = NULL;
+    string_map_t *section = NULL;
+    string_map_t *tmp_section = NULL;
+    string_map_t *fp = NULL;
+
+    assert(ri != NULL);
+
+    memset(&common, 0, sizeof(common));
+    memset(&sb, 0, sizeof(sb));
+
+    /* inputs shared by all inspections */
+    if (diags != NULL) {
+        TAILQ_FOREACH(entry, diags, items) {
+            strbuf_appendf(&common, "%s\n", entry->data);
+        }
+    }
+
+    strbuf_appendf(&common, "before=%s\nafter=%s\nrelease=%s\nbuildtype=%d\nrebase=%d,%d\n",
+                   (ri->before == NULL) ? "" : ri->before,
+                   (ri->after == NULL) ? "" : ri->after,
+                   (ri->product_release == NULL) ? "" : ri->product_release,
+                   ri->buildtype, ri->rebase_detection, ri->rebase_build);
+
+    if (ri->arches != NULL) {
+        s = list_to_string(ri->arches, ",");
+        strbuf_appendf(&common, "arches=%s\n", s);
+        free(s);
+    }
+
+    if (ri->peers != NULL) {
+        TAILQ_FOREACH(peer, ri->peers, items) {
+            add_header(&common, peer->before_hdr);
+            add_header(&common, peer->after_hdr);
+        }
+    }
+
+    /* rebase detection applies to every inspection */
+    add_vendor_dir(&common, ri, REBASEABLE_DIR);
+
+    /* configuration sections not specific to an inspection */
+    sections = config_sections(ri);
+
+    HASH_ITER(hh, sections, section, tmp_section) {
+        for (j = 0; ignored_sections[j] != NULL; j++) {
+            if (!strcmp(section->key, ignored_sections[j])) {
+                break;
+            }
+        }
+
+        if (ignored_sections[j] == NULL && find_inspection(section->key) == NULL) {
+            strbuf_appendf(&common, "%s:\n%s", section->key, (section->value == NULL) ? "" : section->value);
+        }
+    }
+
+    /* inputs for each inspection */
+    for (i = 0; inspections[i].name != NULL; i++) {
+        strbuf_append_len(&sb, common.data, common.len);
+        strbuf_appendf(&sb, "inspection=%s\n", inspections[i].name);
+
+        HASH_FIND_STR(sections, inspections[i].name, section);
+
+        if (section != NULL && section->value != NULL) {
+            strbuf_append(&sb, section->value);
+        }
+
+        for (j = 0; vendor_inputs[j].inspection != NULL; j++) {
+            if (!strcmp(vendor_inputs[j].inspection, inspections[i].name)) {
+                add_vendor_dir(&sb, ri, vendor_inputs[j].dir);
+            }
+        }
+
+        if (inspections[i].security_checks) {
+            add_vendor_dir(&sb, ri, SECURITY_DIR);
+        }
+
+        fp = calloc(1, sizeof(*fp));
+        assert(fp != NULL);
+        fp->key = strdup(inspections[i].name);
+        assert(fp->key != NULL);
+        fp->value = sha256_hex(&sb);
+        HASH_ADD_KEYPTR(hh, ri->fingerprints, fp->key, strlen(fp->key), fp);
+        strbuf_free(&sb);
+    }
+
+    strbuf_free(&common);
+    free_string_map(sections);
+    return;
+}
+
+/* Return the fingerprint of an inspection or NULL if not computed */
+static const char *get_fingerprint(const struct rpminspect *ri, const char *inspection)
+{
+    string_map_t *fp = NULL;
+
+    HASH_FIND_STR(ri->fingerprints, inspection, fp);
+    return (fp == NULL) ? NULL : fp->value;
+}
+
+/* Read the results of one inspection from a previous JSON file */
+static previous_results_t *read_inspection(const struct inspect *inspection, json_object *array)
+{
+    size_t i = 0;
+    size_t len = 0;
+    json_object *jr = NULL;
+    results_entry_t *entry = NULL;
+    previous_results_t *prev = NULL;
+
+    len = json_object_array_length(array);
+
+    if (len == 0) {
+        return NULL;
+    }
+
+    prev = calloc(1, sizeof(*prev));
+    assert(prev != NULL);
+    prev->header = inspection->name;
+
+    for (i = 0; i < len; i++) {
+        jr = json_object_array_get_idx(array, i);
+        entry = add_json_result(&prev->results, inspection->name, jr);
+
+        /* every result must come from the same inputs */
+        if (entry->fingerprint == NULL || (prev->fingerprint != NULL && strcmp(prev->fingerprint, entry->fingerprint))) {
+            free(prev->fingerprint);
+            free_results(prev->results);
+            free(prev);
+            return NULL;
+        }
+
+        if (prev->fingerprint == NULL) {
+            prev->fingerprint = strdup(entry->fingerprint);
+            assert(prev->fingerprint != NULL);
+        }
+    }
+
+    return prev;
+}
+
+/**
+ * @brief Read the results of a previous run for reuse.
+ *
+ * Only inspections whose results all carry the same fingerprint are
+ * kept.  Results of inspections that were suppressed in the previous
+ * output are not in the file and those inspections will run again.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param path The JSON results file written by a previous run.
+ * @return True on success, false if the file could not be read.
+ */
+bool read_previous_results(struct rpminspect *ri, const char *path)
+{
+    off_t len = 0;
+    char *buf = NULL;
+    json_tokener *tok = NULL;
+    json_object *jo = NULL;
+    const struct inspect *inspection = NULL;
+    previous_results_t *prev = NULL;
+
+    assert(ri != NULL);
+    assert(path != NULL);
+
+    buf = read_file_bytes(path, &len);
+
+    if (buf == NULL) {
+        warnx(_("*** unable to read %s"), path);
+        return false;
+    }
+
+    tok = json_tokener_new();
+    assert(tok != NULL);
+    jo = json_tokener_parse_ex(tok, buf, len);
+
+    if (json_tokener_get_error(tok) != json_tokener_success || !json_object_is_type(jo, json_type_object)) {
+        warnx(_("*** %s is not a JSON results file"), path);
+        json_object_put(jo);
+        json_tokener_free(tok);
+        free(buf);
+        return false;
+    }
+
+    json_object_object_foreach(jo, key, val) {
+        inspection = find_inspection(key);
+
+        if (inspection == NULL || !json_object_is_type(val, json_type_array)) {
+            continue;
+        }
+
+        prev = read_inspection(inspection, val);
+
+        if (prev != NULL) {
+            HASH_ADD_KEYPTR(hh, ri->previous, prev->header, strlen(prev->header), prev);
+        }
+    }
+
+    json_object_put(jo);
+    json_tokener_free(tok);
+    free(buf);
+    return true;
+}
+
+/**
+ * @brief Copy forward the previous results of an inspection if its
+ * inputs have not changed.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param inspection The inspection name.
+ * @return True if the previous results were reused and the
+ * inspection does not need to run.
+ */
+bool reuse_results(struct rpminspect *ri, const char *inspection)
+{
+    const char *fingerprint = NULL;
+    previous_results_t *prev = NULL;
+    results_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(inspection != NULL);
+
+    HASH_FIND_STR(ri->previous, inspection, prev);
+    fingerprint = get_fingerprint(ri, inspection);
+
+    if (prev == NULL || fingerprint == NULL || strcmp(prev->fingerprint, fingerprint)) {
+        return false;
+    }
+
+    if (ri->results == NULL) {
+        ri->results = init_results();
+    }
+
+    while (!TAILQ_EMPTY(prev->results)) {
+        entry = TAILQ_FIRST(prev->results);
+        TAILQ_REMOVE(prev->results, entry, items);
+
+        if (entry->severity > ri->worst_result) {
+            ri->worst_result = entry->severity;
+        }
+
+        TAILQ_INSERT_TAIL(ri->results, entry, items);
+    }
+
+    return true;
+}
+
+/**
+ * @brief Record the fingerprint of an inspection that just ran on
+ * its results.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param inspection The inspection name.
+ */
+void set_results_fingerprint(struct rpminspect *ri, const char *inspection)
+{
+    const char *fingerprint = NULL;
+    results_entry_t *entry = NULL;
+
+    assert(ri != NULL);
+    assert(inspection != NULL);
+
+    fingerprint = get_fingerprint(ri, inspection);
+
+    if (fingerprint == NULL || ri->results == NULL) {
+        return;
+    }
+
+    /* the results of the inspection are the newest ones */
+    for (entry = TAILQ_LAST(ri->results, results_s); entry != NULL; entry = TAILQ_PREV(entry, results_s, items)) {
+        if (entry->fingerprint != NULL || strcmp(entry->header, inspection)) {
+            break;
+        }
+
+        entry->fingerprint = strdup(fingerprint);
+        assert(entry->fingerprint != NULL);
+    }
+
+    return;
+}
+
+/**
+ * @brief Free the table of previous results.
+ *
+ * @param previous The table, may be NULL.
+ */
+void free_previous_results(previous_results_t *previous)
+{
+    previous_results_t *prev = NULL;
+    previous_results_t *tmp_prev = NULL;
+
+    HASH_ITER(hh, previous, prev, tmp_prev) {
+        HASH_DEL(previous, prev);
+        free(prev->fingerprint);
+        free_results(prev->results);
+        free(prev);
+    }
+
+    return;
+}
@@ -7,12 +7,14 @@
 #include <stdbool.h>
 #include <assert.h>
 #include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
 #include <rpm/rpmlib.h>
 #include <rpm/rpmts.h>
 #include <rpm/header.h>
 #include <rpm/rpmmacro.h>
-#include <archive.h>
-#include <archive_entry.h>
 
 #include "rpminspect.h"
 
@@ -266,54 +268,166 @@ char *get_rpm_header_value(const rpmfile_entry_t *file, rpmTag tag)
     return ret;
 }
 
+#ifndef _HAVE_OLD_RPM_API
+/*
+ * Write the current rpmfi archive member to the open file descriptor
+ * fd.  The payload is read in RPM_PAYLOAD_BUFSIZ chunks.  Returns 0
+ * on success, -1 on failure.
+ */
+static int write_payload_member(rpmfi fi, int fd, char *buf, const char *dest)
+{
+    rpm_loff_t left = 0;
+    size_t len = 0;
+    ssize_t nread = 0;
+    ssize_t nwritten = 0;
+    ssize_t off = 0;
+
+    assert(fi != NULL);
+    assert(buf != NULL);
+    assert(dest != NULL);
+
+    left = rpmfiFSize(fi);
+
+    while (left) {
+        len = (left > RPM_PAYLOAD_BUFSIZ ? RPM_PAYLOAD_BUFSIZ : left);
+        nread = rpmfiArchiveRead(fi, buf, len);
+
+        if (nread != (ssize_t) len) {
+            warnx(_("*** error reading %s from RPM payload"), dest);
+            return -1;
+        }
+
+        for (off = 0; off < nread; off += nwritten) {
+            nwritten = write(fd, buf + off, nread - off);
+
+            if (nwritten == -1) {
+                if (errno == EINTR) {
+                    nwritten = 0;
+                    continue;
+                }
+
+                warn("write %s", dest);
+                return -1;
+            }
+        }
+
+        left -= len;
+    }
+
+    return 0;
+}
+
+/*
+ * Create the directories leading to a payload member under
+ * output_dir, and the member itself if it is a directory.  Payload
+ * order does not guarantee parent directories come first.  Each
+ * component is checked with lstat() and one that is not a directory,
+ * like a symlink from an earlier member, is refused so nothing is
+ * written outside output_dir.  This is the same protection as
+ * ARCHIVE_EXTRACT_SECURE_SYMLINKS.
+ */
+static int make_member_dirs(const char *output_dir, const char *localpath, const bool isdir, const mode_t perm)
+{
+    int r = 0;
+    char *path = NULL;
+    char *p = NULL;
+    char *last = NULL;
+    struct stat sb;
+
+    while (*localpath == '/') {
+        localpath++;
+    }
+
+    xasprintf(&path, "%s/%s", output_dir, localpath);
+    assert(path != NULL);
+    p = path + strlen(output_dir) + 1;
+    last = isdir ? path + strlen(path) : strrchr(path, '/');
+
+    while (r == 0 && p <= last) {
+        if (*p != '/' && *p != '\0') {
+            p++;
+            continue;
+        }
+
+        *p = '\0';
+
+        if (lstat(path, &sb) == 0) {
+            if (!S_ISDIR(sb.st_mode)) {
+                warnx(_("*** refusing to extract %s, %s is not a directory"), localpath, path);
+                r = -1;
+            }
+        } else if (errno != ENOENT || mkdir(path, (p == last && isdir) ? perm : (S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) == -1) {
+            warn("mkdir %s", path);
+            r = -1;
+        }
+
+        if (p != last || !isdir) {
+            *p = '/';
+        }
+
+        p++;
+    }
+
+    free(path);
+    return r;
+}
+#endif
+
 /**
- * Given a path to an RPM package, extract the payload to a tar file
- * for later use with extract_rpm().  This happens in cases where
- * libarchive cannot detect the cpio stream in an opened RPM file.
- * The caller must free the returned path string.
+ * Given a path to an RPM package, extract the payload directly to
+ * output_dir using the librpm archive reader.  This is used by
+ * extract_rpm() in cases where libarchive cannot detect the cpio
+ * stream in an opened RPM file, which is the case for packages using
+ * the large file payload format (files over 4 GiB).  Entries are
+ * written straight to their destination paths and the returned
+ * rpmfile_t list is filled in from the librpm file metadata, so no
+ * intermediate archive is created.  The caller must free the
+ * returned list.
  *
  * A lot of this is adapted from rpm2archive.c from the rpm sources.
  *
  * @param rpm The full path to the RPM.
- * @return Full path to the tar file containing the payload or NULL on
- *         error.
+ * @param hdr The RPM header for the package, referenced by each
+ *            returned rpmfile_entry_t.
+ * @param output_dir The directory to extract the payload to.
+ * @return rpmfile_t list of all payload members or NULL on error.
  */
 #ifdef _HAVE_OLD_RPM_API
-char *extract_rpm_payload(__attribute__((unused)) const char *rpm)
+rpmfile_t *extract_rpm_payload(__attribute__((unused)) const char *rpm, __attribute__((unused)) Header hdr, __attribute__((unused)) const char *output_dir)
 {
     /*
-     * only support payload conversion with newer librpm releases
+     * only support payload extraction with newer librpm releases
      * which include the rpmfiles.h and rpmarchive.h headers
      */
 
     return NULL;
 #else
-char *extract_rpm_payload(const char *rpm)
+rpmfile_t *extract_rpm_payload(const char *rpm, Header hdr, const char *output_dir)
 {
-    char *payload = NULL;
+    rpmfile_t *file_list = NULL;
+    rpmfile_entry_t *file_entry = NULL;
     rpmts ts;
     rpmVSFlags vsflags = RPMVSF_MASK_NODIGESTS | RPMVSF_MASK_NOSIGNATURES | RPMVSF_NOHDRCHK;
-    Header hdr = NULL;
+    Header payload_hdr = NULL;
     FD_t fdi = NULL;
     FD_t gzdi = NULL;
     const char *compr = NULL;
     char *rpmio_flags = NULL;
     rpmfiles files = NULL;
     rpmfi fi = NULL;
-    struct archive *archive = NULL;
-    struct archive_entry *entry = NULL;
     char *buf = NULL;
     char *hardlink = NULL;
     rpm_mode_t mode = 0;
+    mode_t perm = 0;
     int nlink = 0;
+    int fd = -1;
     int rc = 0;
+    bool failed = false;
     const char *dn = NULL;
-    char *filename = NULL;
-    rpm_loff_t left;
-    size_t len = 0;
-    size_t read = 0;
 
     assert(rpm != NULL);
+    assert(hdr != NULL);
+    assert(output_dir != NULL);
 
     /* create librpm widgets */
     ts = rpmtsCreate();
@@ -321,7 +435,13 @@ char *extract_rpm_payload(const char *rpm)
 
     /* open the package */
     fdi = Fopen(rpm, "r.ufdio");
-    rc = rpmReadPackageFile(ts, fdi, COMMAND_NAME, &hdr);
+
+    if (fdi == NULL || Ferror(fdi)) {
+        warnx(_("Fopen failed for %s: %s"), rpm, Fstrerror(fdi));
+        goto cleanup;
+    }
+
+    rc = rpmReadPackageFile(ts, fdi, COMMAND_NAME, &payload_hdr);
 
     if (rc == RPMRC_NOTFOUND || rc == RPMRC_FAIL) {
         warn("rpmReadPackageFile");
@@ -329,7 +449,7 @@ char *extract_rpm_payload(const char *rpm)
     }
 
     /* determine how to read the payload */
-    compr = headerGetString(hdr, RPMTAG_PAYLOADCOMPRESSOR);
+    compr = headerGetString(payload_hdr, RPMTAG_PAYLOADCOMPRESSOR);
     xasprintf(&rpmio_flags, "r.%s", compr ? compr : "gzip");
     assert(rpmio_flags != NULL);
 
@@ -342,117 +462,161 @@ char *extract_rpm_payload(const char *rpm)
         goto cleanup;
     }
 
-    files = rpmfilesNew(NULL, hdr, 0, RPMFI_KEEPHEADER);
+    files = rpmfilesNew(NULL, payload_hdr, 0, RPMFI_KEEPHEADER);
     fi = rpmfiNewArchiveReader(gzdi, files, RPMFI_ITER_READ_ARCHIVE_CONTENT_FIRST);
 
-    /* create a new archive with the payload data */
-    archive = archive_write_new();
+    /* Allocate space for the return value */
+    file_list = calloc(1, sizeof(*file_list));
+    assert(file_list != NULL);
+    TAILQ_INIT(file_list);
 
-    if (archive_write_add_filter_gzip(archive) != ARCHIVE_OK) {
-        warnx("archive_write_add_filter_gzip: %s", archive_error_string(archive));
-        goto cleanup;
-    }
+    buf = malloc(RPM_PAYLOAD_BUFSIZ);
+    assert(buf != NULL);
 
-    if (archive_write_set_format_pax_restricted(archive) != ARCHIVE_OK) {
-        warnx("archive_write_set_format_pax_restricted: %s", archive_error_string(archive));
-        goto cleanup;
-    }
+    /* iterate over every entry in the payload */
+    while ((rc = rpmfiNext(fi)) >= 0) {
+        mode = rpmfiFMode(fi);
+        nlink = rpmfiFNlink(fi);
+        dn = rpmfiDN(fi);
 
-    xasprintf(&payload, "%s.tar", rpm);
-    assert(payload != NULL);
+        if (!strcmp(dn, "")) {
+            dn = "/";
+        }
 
-    if (archive_write_open_filename(archive, payload) != ARCHIVE_OK) {
-        warnx("archive_write_open_filename: %s", archive_error_string(archive));
-        goto cleanup;
-    }
+        /* Create a new rpmfile_entry_t for this file */
+        file_entry = calloc(1, sizeof(*file_entry));
+        assert(file_entry != NULL);
 
-    /* iterate over every entry in the payload */
-    entry = archive_entry_new();
+        file_entry->rpm_header = hdr;
+        file_entry->idx = rpmfiFX(fi);
+        file_entry->flags = rpmfiFFlags(fi);
+        file_entry->st.st_mode = mode;
+        file_entry->st.st_size = rpmfiFSize(fi);
+        file_entry->st.st_nlink = nlink;
+        file_entry->st.st_rdev = rpmfiFRdev(fi);
+        file_entry->st.st_mtime = rpmfiFMtime(fi);
 
-    buf = calloc(1, BUFSIZ);
-    assert(buf != NULL);
+        xasprintf(&file_entry->localpath, "%s%s", dn, rpmfiBN(fi));
+        assert(file_entry->localpath != NULL);
+
+        TAILQ_INSERT_TAIL(file_list, file_entry, items);
 
-    while (rc >= 0) {
-        rc = rpmfiNext(fi);
+        /* Are we extracting this file? */
+        if (!(S_ISREG(mode) || S_ISDIR(mode) || S_ISLNK(mode))) {
+            continue;
+        }
 
-        if (rc == RPMERR_ITER_END) {
+        /* Same protection as ARCHIVE_EXTRACT_SECURE_NODOTDOT */
+        if (strstr(file_entry->localpath, "/../") || strsuffix(file_entry->localpath, "/..")) {
+            warnx(_("*** refusing to extract %s from %s"), file_entry->localpath, rpm);
+            failed = true;
             break;
         }
 
-        mode = rpmfiFMode(fi);
-        nlink = rpmfiFNlink(fi);
+        file_entry->fullpath = joinpath(output_dir, file_entry->localpath, NULL);
+        assert(file_entry->fullpath != NULL);
 
-        archive_entry_clear(entry);
-        dn = rpmfiDN(fi);
+        /* Ensure the resulting file is user-rw and global-unwritable */
+        perm = (mode & ~S_IFMT) | S_IRUSR | S_IWUSR;
+        perm &= ~S_IWOTH;
 
-        if (!strcmp(dn, "")) {
-            dn = "/";
+        if (S_ISDIR(mode)) {
+            perm |= S_IXUSR;
+
+            if (make_member_dirs(output_dir, file_entry->localpath, true, perm) == -1) {
+                failed = true;
+                break;
+            }
+
+            if (chmod(file_entry->fullpath, perm) == -1) {
+                warn("chmod %s", file_entry->fullpath);
+                failed = true;
+                break;
+            }
+
+            continue;
         }
 
-        xasprintf(&filename, ".%s%s", dn, rpmfiBN(fi));
-        assert(filename != NULL);
-        archive_entry_copy_pathname(entry, filename);
-        free(filename);
+        if (make_member_dirs(output_dir, file_entry->localpath, false, 0) == -1) {
+            failed = true;
+            break;
+        }
 
-        archive_entry_set_size(entry, rpmfiFSize(fi));
-        archive_entry_set_filetype(entry, mode & S_IFMT);
-        archive_entry_set_perm(entry, mode);
-        archive_entry_set_uname(entry, rpmfiFUser(fi));
-        archive_entry_set_gname(entry, rpmfiFGroup(fi));
-        archive_entry_set_rdev(entry, rpmfiFRdev(fi));
-        archive_entry_set_mtime(entry, rpmfiFMtime(fi), 0);
+        /* unlink(), symlink() and link() do not follow the last component */
+        (void) unlink(file_entry->fullpath);
 
         if (S_ISLNK(mode)) {
-            archive_entry_set_symlink(entry, rpmfiFLink(fi));
+            if (symlink(rpmfiFLink(fi), file_entry->fullpath) == -1) {
+                warn("symlink %s", file_entry->fullpath);
+                failed = true;
+                break;
+            }
+
+            continue;
         }
 
-        if (nlink > 1) {
-            if (rpmfiArchiveHasContent(fi)) {
-                free(hardlink);
-                hardlink = strdup(archive_entry_pathname(entry));
-                assert(hardlink != NULL);
-            } else {
-                archive_entry_set_hardlink(entry, hardlink);
+        /* hard link members without content point at the first member */
+        if (nlink > 1 && !rpmfiArchiveHasContent(fi)) {
+            if (hardlink == NULL || link(hardlink, file_entry->fullpath) == -1) {
+                warn("link %s", file_entry->fullpath);
+                failed = true;
+                break;
             }
+
+            continue;
         }
 
-        archive_write_header(archive, entry);
+        fd = open(file_entry->fullpath, O_WRONLY | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, perm);
 
-        if (S_ISREG(mode) && (nlink == 1 || rpmfiArchiveHasContent(fi))) {
-            left = rpmfiFSize(fi);
+        if (fd == -1) {
+            warn("open %s", file_entry->fullpath);
+            failed = true;
+            break;
+        }
 
-            while (left) {
-                len = (left > BUFSIZ ? BUFSIZ : left);
-                read = rpmfiArchiveRead(fi, buf, len);
+        if (write_payload_member(fi, fd, buf, file_entry->fullpath) == -1) {
+            close(fd);
+            failed = true;
+            break;
+        }
 
-                if (read == len) {
-                    archive_write_data(archive, buf, len);
-                } else {
-                    warnx("error reading file from RPM payload");
-                    break;
-                }
+        if (close(fd) == -1) {
+            warn("close %s", file_entry->fullpath);
+            failed = true;
+            break;
+        }
 
-                left -= len;
-            }
+        if (nlink > 1) {
+            free(hardlink);
+            hardlink = strdup(file_entry->fullpath);
+            assert(hardlink != NULL);
         }
     }
 
-    if (rc == RPMERR_ITER_END) {
-        rc = 0;
+    if (failed || rc != RPMERR_ITER_END) {
+        if (!failed) {
+            warnx(_("*** error reading RPM payload from %s"), rpm);
+        }
+
+        free_files(file_list);
+        file_list = NULL;
     }
 
 cleanup:
     free(hardlink);
     free(buf);
-    Fclose(gzdi);
-    archive_entry_free(entry);
-    archive_write_close(archive);
-    archive_write_free(archive);
-    rpmfilesFree(files);
+
+    if (gzdi) {
+        Fclose(gzdi);
+    } else if (fdi) {
+        Fclose(fdi);
+    }
+
     rpmfiFree(fi);
-    headerFree(hdr);
+    rpmfilesFree(files);
+    headerFree(payload_hdr);
     rpmtsFree(ts);
 
-    return payload;
+    return file_list;
 #endif
 }
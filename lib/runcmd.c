@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: LGPL-3.0-or-later
  */
 
+#include <sched.h>
 #include <stdarg.h>
 #include <stddef.h>
 #include <stdbool.h>
@@ -12,8 +13,13 @@
 #include <errno.h>
 #include <assert.h>
 #include <err.h>
+#include <signal.h>
+#include <time.h>
 #include <sys/types.h>
+#include <sys/resource.h>
 #include <sys/wait.h>
+#include <fcntl.h>
+#include <poll.h>
 #include <unistd.h>
 #include <limits.h>
 
@@ -22,6 +28,250 @@
 #define RD STDIN_FILENO
 #define WR STDOUT_FILENO
 
+/*
+ * Time limits on child processes, see set_command_timeout() and
+ * set_deadline().  Times are in seconds of the monotonic clock and 0
+ * means no limit.  Child processes inherit these.
+ */
+static unsigned int command_timeout = 0;
+static double deadline = 0;
+static unsigned int timeouts = 0;
+
+/* Set by stop_jobs() to end the run_jobs() call in progress */
+static bool stopping = false;
+
+/* Memory in KiB the jobs of run_jobs() may use at once, 0 is no limit */
+static unsigned long memory_budget = 0;
+
+/*
+ * The job lists of the run_jobs() calls in progress and the command
+ * run_cmd_vpe() is waiting for, so kill_jobs() can find the children
+ * from a signal handler.
+ */
+#define MAX_ACTIVE_JOBS 8
+static job_list_t *active_jobs[MAX_ACTIVE_JOBS];
+static volatile sig_atomic_t nactive = 0;
+static volatile pid_t command_pid = 0;
+
+/**
+ * @brief Return the time of the monotonic clock in seconds.
+ */
+double monotonic_time(void)
+{
+    struct timespec ts;
+
+    if (clock_gettime(CLOCK_MONOTONIC, &ts) == -1) {
+        return 0;
+    }
+
+    return ts.tv_sec + (ts.tv_nsec / 1e9);
+}
+
+/**
+ * @brief Limit how long any one command run by run_cmd() or
+ * run_jobs() may take.  A command that runs too long is killed.
+ *
+ * @param seconds The limit, 0 for no limit.
+ */
+void set_command_timeout(const unsigned int seconds)
+{
+    command_timeout = seconds;
+    return;
+}
+
+/**
+ * @brief Set a deadline for all child processes.  Once it passes,
+ * running children are killed and run_jobs() starts no more jobs.
+ *
+ * @param seconds The deadline in seconds from now, 0 for none.
+ */
+void set_deadline(const unsigned int seconds)
+{
+    deadline = (seconds == 0) ? 0 : monotonic_time() + seconds;
+    return;
+}
+
+/**
+ * @brief Return true if a deadline is set with set_deadline().
+ */
+bool have_deadline(void)
+{
+    return (deadline > 0);
+}
+
+/**
+ * @brief Return true if the deadline set with set_deadline() has
+ * passed.
+ */
+bool deadline_passed(void)
+{
+    return (deadline > 0 && monotonic_time() >= deadline);
+}
+
+/**
+ * @brief Return the number of children this process killed because
+ * they ran out of time.
+ */
+unsigned int get_command_timeouts(void)
+{
+    return timeouts;
+}
+
+/**
+ * @brief Stop the run_jobs() call in progress.
+ *
+ * This is meant to be called from the done function of a job.  No
+ * more jobs are started and the ones still running are killed.  Both
+ * are marked as cancelled and passed to their done function.
+ */
+void stop_jobs(void)
+{
+    stopping = true;
+    return;
+}
+
+/**
+ * @brief Kill every child process this process is running.
+ *
+ * Jobs that run in their own process group are killed along with the
+ * group, so the commands they started go too.  This only uses
+ * async-signal-safe calls and is meant for the handler of the signals
+ * that end the program.
+ */
+void kill_jobs(void)
+{
+    sig_atomic_t i = 0;
+    job_entry_t *job = NULL;
+
+    for (i = 0; i < nactive; i++) {
+        TAILQ_FOREACH(job, active_jobs[i], items) {
+            if (job->pid > 0 && job->fd != -1) {
+                (void) kill(job->group ? -job->pid : job->pid, SIGKILL);
+            }
+        }
+    }
+
+    if (command_pid > 0) {
+        (void) kill(command_pid, SIGKILL);
+    }
+
+    return;
+}
+
+/**
+ * @brief Limit the memory the jobs run_jobs() runs at once may use.
+ *
+ * Each job counts for its memory member, or for an equal share of
+ * the budget if that is 0.  A job is not started while the running
+ * jobs would take it over budget, unless nothing else is running.
+ *
+ * @param kib The budget in KiB, 0 for no limit.
+ */
+void set_memory_budget(const unsigned long kib)
+{
+    memory_budget = kib;
+    return;
+}
+
+/*
+ * Return the time a child started at started with the given timeout
+ * must finish by, taking the deadline in to account.  Returns 0 if
+ * there is no limit.
+ */
+static double time_limit(const double started, const unsigned int timeout)
+{
+    double limit = (timeout == 0) ? 0 : started + timeout;
+
+    if (deadline > 0 && (limit == 0 || deadline < limit)) {
+        limit = deadline;
+    }
+
+    return limit;
+}
+
+/* Milliseconds to wait in poll() until limit, -1 if no limit */
+static int poll_timeout(const double limit)
+{
+    double left = 0;
+
+    if (limit == 0) {
+        return -1;
+    }
+
+    left = limit - monotonic_time();
+
+    if (left <= 0) {
+        return 0;
+    }
+
+    /* round up so we do not wake up just before the limit */
+    return (left > INT_MAX / 1000) ? INT_MAX : (int) (left * 1000) + 1;
+}
+
+/*
+ * Set the exit code from a child's wait status and finish off the
+ * collected output.  If the child was signaled, a message naming the
+ * signal is appended to the output, or a message saying it ran out of
+ * time if it was killed for that.  The trailing newline is trimmed.
+ * Returns the output, which may have been reallocated.
+ */
+static char *finish_output(int status, const bool timed_out, int *exitcode, char *output)
+{
+    int i = 0;
+    char *signame = NULL;
+    char *tail = NULL;
+
+    if (WIFEXITED(status)) {
+        if (exitcode) {
+            *exitcode = WEXITSTATUS(status);
+        }
+    } else if (WIFSIGNALED(status)) {
+        if (exitcode) {
+            *exitcode = EXIT_FAILURE;
+        }
+
+        /* generate a string with the signal name if possible */
+        i = WTERMSIG(status);
+
+        if (strsignal(i) == NULL) {
+            xasprintf(&signame, _("%d"), i);
+        } else {
+            xasprintf(&signame, _("%d (%s)"), i, strsignal(i));
+        }
+
+        /* generic output indicating the command we tried to run and the signal received */
+        if (timed_out && output) {
+            xasprintf(&tail, _("%s\n\n%s stopped the command because it ran out of time"), output, COMMAND_NAME);
+            free(output);
+            output = tail;
+        } else if (timed_out) {
+            xasprintf(&output, _("%s stopped the command because it ran out of time"), COMMAND_NAME);
+        } else if (output) {
+            xasprintf(&tail, _("%s\n\n%s tried to run the command and it received signal %s"), output, COMMAND_NAME, signame);
+            free(output);
+            output = tail;
+        } else {
+            xasprintf(&output, _("%s tried to run the command and it received signal %s"), COMMAND_NAME, signame);
+        }
+
+        free(signame);
+    }
+
+    /* There may be no results from the tool */
+    if (output != NULL) {
+        /* Trim trailing newline */
+        tail = rindex(output, '\n');
+
+        if (tail != NULL) {
+            tail[strcspn(tail, "\n")] = 0;
+        }
+    }
+
+    return output;
+}
+
+static char *capture_cmd(int *exitcode, const char *workdir, char **argv, char **errors);
+
 /*
  * Generic fork()/execvp() wrapper to return the output of the
  * process and the exit code (if desired).  This function returns an
@@ -41,21 +291,61 @@
  */
 char *run_cmd_vpe(int *exitcode, const char *workdir, char **argv)
 {
-    int i = 0;
+    return capture_cmd(exitcode, workdir, argv, NULL);
+}
+
+/*
+ * Like run_cmd_vpe(), but only standard output is returned.  If
+ * errors is not NULL, it is set to what the command wrote to standard
+ * error (or NULL if it wrote nothing), otherwise standard error is
+ * discarded.  Use this when the output is parsed or compared and
+ * warnings must not end up in it.
+ */
+char *run_cmd_stdout(int *exitcode, char **errors, const char *workdir, char **argv)
+{
+    char *output = NULL;
+    char *discard = NULL;
+
+    output = capture_cmd(exitcode, workdir, argv, (errors == NULL) ? &discard : errors);
+    free(discard);
+    return output;
+}
+
+/*
+ * Runs argv and returns its output for run_cmd_vpe() and
+ * run_cmd_stdout().  With errors NULL, standard error is collected
+ * along with standard output.  Otherwise it goes to a temporary file
+ * and *errors is set to its contents.
+ */
+static char *capture_cmd(int *exitcode, const char *workdir, char **argv, char **errors)
+{
     int pfd[2];
     int status = 0;
     pid_t proc = 0;
-    FILE *reader = 0;
-    char *signame = NULL;
+    struct pollfd reader;
+    double limit = 0;
+    bool timed_out = false;
+    int i = 0;
     char *output = NULL;
-    char *tail = NULL;
-    size_t n = BUFSIZ;
-    char *buf = NULL;
+    ssize_t n = 0;
+    char buf[BUFSIZ];
+    strbuf_t captured;
     char cwd[PATH_MAX + 1];
+    FILE *errfp = NULL;
+    off_t errlen = 0;
 
     assert(argv != NULL);
     assert(argv[0] != NULL);
 
+    if (errors != NULL) {
+        *errors = NULL;
+        errfp = tmpfile();
+
+        if (errfp == NULL) {
+            warn("tmpfile");
+        }
+    }
+
     /* use working directory if given one */
     if (workdir) {
         /* save current directory */
@@ -78,6 +368,11 @@ char *run_cmd_vpe(int *exitcode, const char *workdir, char **argv)
         }
 
         warn("pipe");
+
+        if (errfp != NULL) {
+            fclose(errfp);
+        }
+
         return NULL;
     }
 
@@ -86,11 +381,21 @@ char *run_cmd_vpe(int *exitcode, const char *workdir, char **argv)
 
     if (proc == 0) {
         /* connect the output */
-        if (dup2(pfd[WR], STDOUT_FILENO) == -1 || dup2(pfd[WR], STDERR_FILENO) == -1) {
+        if (dup2(pfd[WR], STDOUT_FILENO) == -1) {
             warn("dup2");
             _exit(EXIT_FAILURE);
         }
 
+        /* standard error separately if asked, otherwise with the output */
+        if (errors == NULL) {
+            if (dup2(pfd[WR], STDERR_FILENO) == -1) {
+                warn("dup2");
+                _exit(EXIT_FAILURE);
+            }
+        } else if (errfp == NULL || dup2(fileno(errfp), STDERR_FILENO) == -1) {
+            (void) freopen("/dev/null", "w", stderr);
+        }
+
         /* close the pipes */
         if (close(pfd[RD]) == -1 || close(pfd[WR]) == -1) {
             warn("close");
@@ -109,6 +414,8 @@ char *run_cmd_vpe(int *exitcode, const char *workdir, char **argv)
         /* failure */
         warn("fork");
     } else {
+        command_pid = proc;
+
         /* close the pipe */
         if (close(pfd[WR]) == -1) {
             warn("close");
@@ -117,83 +424,83 @@ char *run_cmd_vpe(int *exitcode, const char *workdir, char **argv)
         /*
          * Read in all of the information back from the command and store
          * it as our result.  Just concatenate the string as we read it
-         * back in buffer size chunks.
+         * back in buffer size chunks.  The command is killed if it runs
+         * out of time.
          */
-        reader = fdopen(pfd[RD], "r");
+        memset(&captured, 0, sizeof(captured));
+        limit = time_limit(monotonic_time(), command_timeout);
+        reader.fd = pfd[RD];
+        reader.events = POLLIN;
 
-        if (reader == NULL) {
-            if (exitcode) {
-                *exitcode = EXIT_FAILURE;
-            }
+        while (true) {
+            i = poll(&reader, 1, poll_timeout(limit));
 
-            return NULL;
-        }
+            if (i == 0) {
+                timed_out = true;
+                timeouts++;
 
-        output = NULL;
-        buf = calloc(1, n);
-        assert(buf != NULL);
+                if (kill(proc, SIGKILL) == -1) {
+                    warn("kill");
+                }
 
-        while (getline(&buf, &n, reader) != -1) {
-            xasprintf(&tail, "%s%s", (output == NULL) ? "" : output, buf);
-            assert(tail != NULL);
-            free(output);
-            output = tail;
-        }
+                break;
+            } else if (i == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
 
-        free(buf);
+                warn("poll");
+                break;
+            }
 
-        if (fclose(reader) == -1) {
-            warn("fclose");
-        }
+            n = read(pfd[RD], buf, sizeof(buf));
 
-        /* wait for the command */
-        if (waitpid(proc, &status, 0) == -1) {
-            if (exitcode) {
-                *exitcode = EXIT_FAILURE;
+            if (n > 0) {
+                strbuf_append_len(&captured, buf, n);
+            } else if (n == 0 || errno != EINTR) {
+                break;
             }
-
-            warn("waitpid");
         }
 
-        if (WIFEXITED(status)) {
-            if (exitcode) {
-                *exitcode = WEXITSTATUS(status);
-            }
-        } else if (WIFSIGNALED(status)) {
-            if (exitcode) {
-                *exitcode = EXIT_FAILURE;
-            }
+        /* no output gives NULL */
+        output = (captured.len == 0) ? NULL : strbuf_finish(&captured);
+        strbuf_free(&captured);
 
-            /* generate a string with the signal name if possible */
-            i = WTERMSIG(status);
+        if (close(pfd[RD]) == -1) {
+            warn("close");
+        }
 
-            if (strsignal(i) == NULL) {
-                xasprintf(&signame, _("%d"), i);
-            } else {
-                xasprintf(&signame, _("%d (%s)"), i, strsignal(i));
-            }
+        /* wait for the command */
+        while (waitpid(proc, &status, 0) == -1) {
+            if (errno != EINTR) {
+                if (exitcode) {
+                    *exitcode = EXIT_FAILURE;
+                }
 
-            /* generic output indicating the command we tried to run and the signal received */
-            if (output) {
-                xasprintf(&tail, _("%s\n\n%s tried to run the command and it received signal %s"), output, COMMAND_NAME, signame);
-                free(output);
-                output = tail;
-            } else {
-                xasprintf(&output, _("%s tried to run the command and it received signal %s"), COMMAND_NAME, signame);
+                warn("waitpid");
+                break;
             }
-
-            free(signame);
         }
 
-        /* There may be no results from the tool */
-        if (output != NULL) {
-            /* Trim trailing newline */
-            tail = rindex(output, '\n');
+        command_pid = 0;
+        output = finish_output(status, timed_out, exitcode, output);
+    }
+
+    /* what the command wrote to standard error */
+    if (errfp != NULL) {
+        errlen = ftello(errfp);
+
+        if (errlen > 0 && fseeko(errfp, 0, SEEK_SET) == 0) {
+            *errors = calloc(1, errlen + 1);
+            assert(*errors != NULL);
 
-            if (tail != NULL) {
-                tail[strcspn(tail, "\n")] = 0;
+            if (fread(*errors, 1, errlen, errfp) != (size_t) errlen) {
+                free(*errors);
+                *errors = NULL;
             }
         }
+
+        fclose(errfp);
     }
 
     /* go back to where we started */
@@ -303,6 +610,671 @@ void free_argv(char **argv)
     return;
 }
 
+/*
+ * Start a single job for run_jobs().  Returns true if the child is
+ * running, false otherwise (and the job is marked as failed).
+ */
+static bool start_job(job_entry_t *job)
+{
+    int pfd[2];
+    int r = EXIT_FAILURE;
+
+    assert(job != NULL);
+    assert(job->argv != NULL || job->fn != NULL);
+
+    job->exitcode = EXIT_FAILURE;
+    job->timed_out = false;
+    job->cancelled = false;
+    job->maxrss = 0;
+    job->output = NULL;
+    job->len = 0;
+    job->size = 0;
+    job->fd = -1;
+
+    /*
+     * The pipe is close-on-exec so sibling jobs do not hold each
+     * other's write ends open; dup2() clears it for the child.
+     */
+    if (pipe2(pfd, O_CLOEXEC) == -1) {
+        warn("pipe2");
+        return false;
+    }
+
+    /* do not hand unflushed output to the child */
+    fflush(stdout);
+    fflush(stderr);
+
+    job->started = monotonic_time();
+    job->pid = fork();
+
+    if (job->pid == 0) {
+        if (job->group && setpgid(0, 0) == -1) {
+            warn("setpgid");
+        }
+
+        if (dup2(pfd[WR], STDOUT_FILENO) == -1 || dup2(pfd[WR], STDERR_FILENO) == -1) {
+            warn("dup2");
+            _exit(EXIT_FAILURE);
+        }
+
+        if (close(pfd[RD]) == -1 || close(pfd[WR]) == -1) {
+            warn("close");
+            _exit(EXIT_FAILURE);
+        }
+
+        setlinebuf(stdout);
+        setlinebuf(stderr);
+
+        /* unlike run_cmd_vpe(), the parent stays where it is */
+        if (job->workdir && chdir(job->workdir) == -1) {
+            warn("chdir");
+        }
+
+        if (job->argv) {
+            if (execvp(job->argv[0], job->argv) == -1) {
+                warn("execvp");
+            }
+        } else {
+            r = job->fn(job->data);
+            fflush(stdout);
+            fflush(stderr);
+        }
+
+        _exit(r);
+    } else if (job->pid == -1) {
+        warn("fork");
+        close(pfd[RD]);
+        close(pfd[WR]);
+        return false;
+    }
+
+    /* also done here so the group exists before we ever kill it */
+    if (job->group && setpgid(job->pid, job->pid) == -1 && errno != EACCES) {
+        warn("setpgid");
+    }
+
+    if (close(pfd[WR]) == -1) {
+        warn("close");
+    }
+
+    job->fd = pfd[RD];
+    return true;
+}
+
+/*
+ * The time a job must finish by, 0 if it has no limit.
+ */
+static double job_limit(const job_entry_t *job)
+{
+    unsigned int timeout = job->timeout;
+
+    if (timeout == 0 && job->argv) {
+        timeout = command_timeout;
+    }
+
+    return time_limit(job->started, timeout);
+}
+
+/*
+ * Kill a job that ran out of time or was cancelled, along with its
+ * process group if it has one.
+ */
+static void kill_job(job_entry_t *job)
+{
+    if (kill(job->group ? -job->pid : job->pid, SIGKILL) == -1) {
+        warn("kill");
+    }
+
+    if (stopping) {
+        job->cancelled = true;
+    } else {
+        job->timed_out = true;
+        timeouts++;
+    }
+
+    return;
+}
+
+/*
+ * Append a chunk of child output to a job.
+ */
+static void append_job_output(job_entry_t *job, const char *buf, size_t n)
+{
+    assert(job != NULL);
+
+    if (job->len + n + 1 > job->size) {
+        job->size = (job->size == 0) ? BUFSIZ : job->size;
+
+        while (job->len + n + 1 > job->size) {
+            job->size *= 2;
+        }
+
+        job->output = realloc(job->output, job->size);
+        assert(job->output != NULL);
+    }
+
+    memcpy(job->output + job->len, buf, n);
+    job->len += n;
+    job->output[job->len] = '\0';
+    return;
+}
+
+/*
+ * Reap a finished job and collect its exit code.
+ */
+static void finish_job(job_entry_t *job)
+{
+    int status = 0;
+    struct rusage usage;
+
+    assert(job != NULL);
+
+    if (close(job->fd) == -1) {
+        warn("close");
+    }
+
+    job->fd = -1;
+
+    /* the peak RSS covers the children the job waited for too */
+    while (wait4(job->pid, &status, 0, &usage) == -1) {
+        if (errno != EINTR) {
+            warn("wait4");
+            return;
+        }
+    }
+
+    job->maxrss = usage.ru_maxrss;
+
+    job->output = finish_output(status, job->timed_out, &job->exitcode, job->output);
+    return;
+}
+
+/*
+ * Memory a job counts for against the memory budget.
+ */
+static unsigned long job_memory(const job_entry_t *job, const unsigned int max)
+{
+    if (job->memory > 0) {
+        return job->memory;
+    }
+
+    return memory_budget / max;
+}
+
+/*
+ * Run a list of jobs with at most max of them running at once.  The
+ * output of every job is collected concurrently so a chatty child
+ * never blocks on a full pipe.  This returns once all jobs finish;
+ * the results are in the exitcode and output members of each job.
+ * Once the deadline passes no more jobs are started.  Those jobs are
+ * marked as failed and timed out with a pid of 0.  Jobs not started
+ * or killed after a call to stop_jobs() are marked as cancelled.
+ * With a memory budget set, jobs start in order as long as the
+ * running ones leave room for them.
+ */
+void run_jobs(job_list_t *jobs, const unsigned int max)
+{
+    unsigned int limit = max;
+    unsigned int nrunning = 0;
+    unsigned int i = 0;
+    job_entry_t *next = NULL;
+    job_entry_t **running = NULL;
+    struct pollfd *pfds = NULL;
+    char buf[BUFSIZ];
+    ssize_t n = 0;
+    int wait = -1;
+    int ms = 0;
+    unsigned long memory = 0;
+
+    if (jobs == NULL || TAILQ_EMPTY(jobs)) {
+        return;
+    }
+
+    if (limit == 0) {
+        limit = 1;
+    }
+
+    running = calloc(limit, sizeof(*running));
+    assert(running != NULL);
+    pfds = calloc(limit, sizeof(*pfds));
+    assert(pfds != NULL);
+
+    next = TAILQ_FIRST(jobs);
+    stopping = false;
+
+    if (nactive < MAX_ACTIVE_JOBS) {
+        active_jobs[nactive] = jobs;
+        nactive++;
+    }
+
+    while (next != NULL || nrunning > 0) {
+        /* out of time or stopped, the rest never run */
+        while (next != NULL && (stopping || deadline_passed())) {
+            next->exitcode = EXIT_FAILURE;
+            next->cancelled = stopping;
+            next->timed_out = !stopping;
+            next->pid = 0;
+
+            if (next->done) {
+                next->done(next);
+            }
+
+            next = TAILQ_NEXT(next, items);
+        }
+
+        /* fill the pool */
+        while (next != NULL && nrunning < limit) {
+            if (memory_budget > 0 && nrunning > 0 && memory + job_memory(next, limit) > memory_budget) {
+                break;
+            }
+
+            if (start_job(next)) {
+                running[nrunning] = next;
+                nrunning++;
+                memory += job_memory(next, limit);
+            }
+
+            next = TAILQ_NEXT(next, items);
+        }
+
+        if (nrunning == 0) {
+            continue;
+        }
+
+        /* wake up in time to stop the first job to run out of time */
+        wait = stopping ? 0 : -1;
+
+        for (i = 0; i < nrunning; i++) {
+            pfds[i].fd = running[i]->fd;
+            pfds[i].events = POLLIN;
+            pfds[i].revents = 0;
+            ms = poll_timeout(job_limit(running[i]));
+
+            if (ms != -1 && (wait == -1 || ms < wait)) {
+                wait = ms;
+            }
+        }
+
+        if (poll(pfds, nrunning, wait) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+
+            err(RI_PROGRAM_ERROR, "poll");
+        }
+
+        i = 0;
+
+        while (i < nrunning) {
+            if (stopping || poll_timeout(job_limit(running[i])) == 0) {
+                kill_job(running[i]);
+            } else if (pfds[i].revents == 0) {
+                i++;
+                continue;
+            } else {
+                n = read(running[i]->fd, buf, sizeof(buf));
+
+                if (n > 0) {
+                    append_job_output(running[i], buf, n);
+                    i++;
+                    continue;
+                } else if (n == -1 && errno == EINTR) {
+                    i++;
+                    continue;
+                }
+            }
+
+            /* end of output, out of time, or stopped; reap it and free up the slot */
+            finish_job(running[i]);
+            memory -= job_memory(running[i], limit);
+
+            if (running[i]->done) {
+                running[i]->done(running[i]);
+            }
+
+            nrunning--;
+            running[i] = running[nrunning];
+            pfds[i] = pfds[nrunning];
+        }
+    }
+
+    if (nactive > 0 && active_jobs[nactive - 1] == jobs) {
+        nactive--;
+    }
+
+    free(running);
+    free(pfds);
+    return;
+}
+
+/*
+ * Free a list of jobs.  The argv arrays and output strings are owned
+ * by the jobs, the workdir and data members are not.
+ */
+void free_jobs(job_list_t *jobs)
+{
+    job_entry_t *job = NULL;
+
+    if (jobs == NULL) {
+        return;
+    }
+
+    while (!TAILQ_EMPTY(jobs)) {
+        job = TAILQ_FIRST(jobs);
+        TAILQ_REMOVE(jobs, job, items);
+        free_argv(job->argv);
+        free(job->output);
+        free(job);
+    }
+
+    free(jobs);
+    return;
+}
+
+/*
+ * Number of CPUs this process may use, used as the default number of
+ * concurrent jobs.  This is the number of online CPUs, lowered to the
+ * CPU affinity mask and the cgroup CPU quota in containers.  Always
+ * at least 1.
+ */
+unsigned int online_cpus(void)
+{
+    static unsigned int r = 0;
+    long n = 0;
+    unsigned int cpus = 0;
+    char *cgroup = NULL;
+    cpu_set_t set;
+
+    /* this does not change while running */
+    if (r > 0) {
+        return r;
+    }
+
+    n = sysconf(_SC_NPROCESSORS_ONLN);
+    r = (n < 1) ? 1 : n;
+
+    CPU_ZERO(&set);
+
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        cpus = CPU_COUNT(&set);
+
+        if (cpus > 0 && cpus < r) {
+            r = cpus;
+        }
+    }
+
+    cgroup = get_cgroup();
+
+    if (cgroup != NULL) {
+        cpus = get_cgroup_cpus(CGROUP_ROOT, cgroup);
+
+        if (cpus > 0 && cpus < r) {
+            r = cpus;
+        }
+
+        free(cgroup);
+    }
+
+    DEBUG_PRINT("using %u CPUs\n", r);
+    return r;
+}
+
+/*
+ * Number of concurrent jobs one inspection may use for its own
+ * commands.  The CPUs are split between the ri->jobs inspections
+ * that run at once so they do not start ri->jobs pools as wide as
+ * the machine.  Always at least 1.
+ */
+unsigned int inspection_jobs(const struct rpminspect *ri)
+{
+    unsigned int r = online_cpus();
+
+    if (ri != NULL && ri->jobs > 1) {
+        r /= ri->jobs;
+    }
+
+    return (r < 1) ? 1 : r;
+}
+
+/*
+ * Memory this process may use in KiB.  This is the physical memory,
+ * lowered to the cgroup memory limit in containers.
+ */
+unsigned long available_memory(void)
+{
+    unsigned long long r = 0;
+    unsigned long long limit = 0;
+    long pages = sysconf(_SC_PHYS_PAGES);
+    long size = sysconf(_SC_PAGESIZE);
+    char *cgroup = NULL;
+
+    if (pages > 0 && size > 0) {
+        r = (unsigned long long) pages * size;
+    }
+
+    cgroup = get_cgroup();
+
+    if (cgroup != NULL) {
+        limit = get_cgroup_memory(CGROUP_ROOT, cgroup);
+
+        if (limit > 0 && (r == 0 || limit < r)) {
+            r = limit;
+        }
+
+        free(cgroup);
+    }
+
+    DEBUG_PRINT("using %llu bytes of memory\n", r);
+    return r / 1024;
+}
+
+/* A contiguous slice of the checks handed to one child */
+struct check_chunk {
+    file_check_t *checks;
+    size_t first;
+    size_t count;
+    file_check_fn check;
+};
+
+/*
+ * Job function for run_checks().  Each result is written as a header
+ * line of "<index> <status> <length>" followed by length bytes of
+ * output and a newline, and a line with a period ends them.  The
+ * results go to the job pipe on their own descriptor while stdout
+ * and stderr go to /dev/null, so nothing the check prints can end up
+ * in the middle of a record.
+ */
+static int run_check_chunk(void *data)
+{
+    struct check_chunk *chunk = data;
+    size_t i = 0;
+    size_t len = 0;
+    int status = 0;
+    int fd = -1;
+    int null = -1;
+    char *output = NULL;
+    FILE *fp = NULL;
+
+    assert(chunk != NULL);
+
+    fd = fcntl(STDOUT_FILENO, F_DUPFD_CLOEXEC, 0);
+
+    if (fd == -1 || (fp = fdopen(fd, "w")) == NULL) {
+        warn("fdopen");
+        return EXIT_FAILURE;
+    }
+
+    null = open("/dev/null", O_WRONLY | O_CLOEXEC);
+
+    if (null == -1 || dup2(null, STDOUT_FILENO) == -1 || dup2(null, STDERR_FILENO) == -1) {
+        warn("/dev/null");
+        fclose(fp);
+        return EXIT_FAILURE;
+    }
+
+    close(null);
+
+    for (i = chunk->first; i < chunk->first + chunk->count; i++) {
+        output = NULL;
+        status = chunk->check(chunk->checks[i].file, &output);
+        len = (output == NULL) ? 0 : strlen(output);
+
+        if (fprintf(fp, "%zu %d %zu\n", i, status, len) < 0
+            || fwrite(output == NULL ? "" : output, 1, len, fp) != len
+            || fputc('\n', fp) == EOF) {
+            free(output);
+            break;
+        }
+
+        free(output);
+    }
+
+    /*
+     * The collected output loses its last newline, which would cut
+     * the last record short without the period after it.  Results
+     * not written are run again by the parent.
+     */
+    if (fputs(".\n", fp) == EOF || fclose(fp) != 0) {
+        return EXIT_FAILURE;
+    }
+
+    return EXIT_SUCCESS;
+}
+
+/*
+ * Read the len bytes of results written by run_check_chunk() back in
+ * to the checks.  Reading stops at the first malformed record.
+ */
+static void read_check_chunk(file_check_t *checks, const size_t count, const char *output, const size_t outlen)
+{
+    const char *p = output;
+    const char *last = output + outlen;
+    char *end = NULL;
+    size_t i = 0;
+    size_t len = 0;
+    int status = 0;
+
+    while (p < last) {
+        i = strtoul(p, &end, 10);
+
+        if (end == p || end >= last || *end != ' ') {
+            break;
+        }
+
+        p = end + 1;
+        status = (int) strtol(p, &end, 10);
+
+        if (end == p || end >= last || *end != ' ') {
+            break;
+        }
+
+        p = end + 1;
+        len = strtoul(p, &end, 10);
+
+        if (end == p || end >= last || *end != '\n' || i >= count || (size_t) (last - (end + 1)) < len + 1) {
+            break;
+        }
+
+        p = end + 1;
+
+        if (p[len] != '\n') {
+            break;
+        }
+
+        checks[i].status = status;
+        checks[i].output = NULL;
+
+        if (len > 0) {
+            checks[i].output = malloc(len + 1);
+            assert(checks[i].output != NULL);
+            memcpy(checks[i].output, p, len);
+            checks[i].output[len] = '\0';
+        }
+
+        checks[i].done = true;
+        p += len + 1;
+    }
+
+    return;
+}
+
+/*
+ * Run a check function over an array of files using up to max child
+ * processes.  The files are split in to contiguous chunks so the
+ * cost of each fork() is spread over many files, and any per-process
+ * state the check sets up (parsers and the like) is reused within a
+ * chunk.  Checks that do not come back from a child, for example
+ * because fork() failed, are run here in the calling process.
+ */
+void run_checks(file_check_t *checks, const size_t count, file_check_fn check, const unsigned int max)
+{
+    job_list_t *jobs = NULL;
+    job_entry_t *job = NULL;
+    struct check_chunk *chunks = NULL;
+    size_t nchunks = 0;
+    size_t per = 0;
+    size_t i = 0;
+
+    assert(check != NULL);
+
+    if (checks == NULL || count == 0) {
+        return;
+    }
+
+    /* a few chunks per worker keeps them all busy until the end */
+    if (max > 1 && count > 1) {
+        nchunks = max * 4;
+
+        if (nchunks > count) {
+            nchunks = count;
+        }
+
+        per = (count + nchunks - 1) / nchunks;
+        nchunks = (count + per - 1) / per;
+
+        chunks = calloc(nchunks, sizeof(*chunks));
+        assert(chunks != NULL);
+        jobs = calloc(1, sizeof(*jobs));
+        assert(jobs != NULL);
+        TAILQ_INIT(jobs);
+
+        for (i = 0; i < nchunks; i++) {
+            chunks[i].checks = checks;
+            chunks[i].first = i * per;
+            chunks[i].count = ((i + 1) * per > count) ? count - (i * per) : per;
+            chunks[i].check = check;
+
+            job = calloc(1, sizeof(*job));
+            assert(job != NULL);
+            job->fn = run_check_chunk;
+            job->data = &chunks[i];
+            TAILQ_INSERT_TAIL(jobs, job, items);
+        }
+
+        run_jobs(jobs, max);
+
+        TAILQ_FOREACH(job, jobs, items) {
+            if (job->output) {
+                read_check_chunk(checks, count, job->output, job->len);
+            }
+        }
+
+        free_jobs(jobs);
+        free(chunks);
+    }
+
+    /* anything left over runs here */
+    for (i = 0; i < count; i++) {
+        if (!checks[i].done) {
+            checks[i].output = NULL;
+            checks[i].status = check(checks[i].file, &checks[i].output);
+            checks[i].done = true;
+        }
+    }
+
+    return;
+}
+
 /*
  * Free one of the command line option tables.
  */
@@ -0,0 +1,807 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Inspection scheduler.  With one job the inspections run one after
+ * the other in this process, in the order of inspections[].  With
+ * more, each inspection runs in a child process and the inspections
+ * predicted to take longest (from the runtime history) start first
+ * so a long one does not start last and hold up the whole run.
+ * Inspections with a time limit also run in a child process so they
+ * can be killed.  The child writes its results to a temporary file as
+ * it goes, which is read back in when it finishes.  In fail-fast mode
+ * the cheapest inspections run first and the run stops as soon as a
+ * result reaches the failure threshold.  Results are put back in
+ * inspections[] order at the end so the output does not depend on the
+ * schedule.
+ */
+
+#include <assert.h>
+#include <err.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <rpm/header.h>
+#include <rpm/rpmtag.h>
+
+#include "rpminspect.h"
+
+/* One inspection to run */
+struct task {
+    struct rpminspect *ri;
+    const struct inspect *inspection;
+    size_t index;             /* position in inspections[] */
+    double predicted;         /* seconds, -1 if unknown */
+    double seconds;
+    double memory;            /* predicted peak KiB, -1 if unknown */
+    long maxrss;              /* peak KiB of the child, 0 if unknown */
+    unsigned int timeout;     /* seconds, 0 for no limit */
+    unsigned int timeouts;    /* commands that ran out of time */
+    bool result;
+    bool timed_out;
+    bool cancelled;           /* stopped by fail-fast */
+    bool done;
+    FILE *out;                /* results written by the child */
+};
+
+/*
+ * Name of the package being inspected, the history is kept by this.
+ * It is the source package name when it can be found, so a run on
+ * only some of the binary packages is tracked with the full build.
+ */
+static char *get_package_name(const struct rpminspect *ri)
+{
+    rpmpeer_entry_t *peer = NULL;
+    const char *name = NULL;
+    char *r = NULL;
+    char *dash = NULL;
+    int i = 0;
+
+    if (ri->peers == NULL) {
+        return NULL;
+    }
+
+    TAILQ_FOREACH(peer, ri->peers, items) {
+        if (peer->after_hdr && headerIsSource(peer->after_hdr)) {
+            name = headerGetString(peer->after_hdr, RPMTAG_NAME);
+
+            if (name != NULL) {
+                r = strdup(name);
+                assert(r != NULL);
+                return r;
+            }
+        }
+    }
+
+    /* NAME-VERSION-RELEASE.src.rpm from a binary package */
+    TAILQ_FOREACH(peer, ri->peers, items) {
+        if (peer->after_hdr == NULL) {
+            continue;
+        }
+
+        name = headerGetString(peer->after_hdr, RPMTAG_SOURCERPM);
+
+        if (name == NULL) {
+            continue;
+        }
+
+        r = strdup(name);
+        assert(r != NULL);
+
+        for (i = 0; i < 2 && (dash = strrchr(r, '-')) != NULL; i++) {
+            *dash = '\0';
+        }
+
+        if (i == 2 && *r != '\0') {
+            return r;
+        }
+
+        free(r);
+        r = NULL;
+    }
+
+    return NULL;
+}
+
+/* Number of payload files in the before and after builds */
+static unsigned long count_files(const struct rpminspect *ri)
+{
+    unsigned long r = 0;
+    rpmpeer_entry_t *peer = NULL;
+    rpmfile_entry_t *file = NULL;
+
+    if (ri->peers == NULL) {
+        return 0;
+    }
+
+    TAILQ_FOREACH(peer, ri->peers, items) {
+        if (peer->before_files) {
+            TAILQ_FOREACH(file, peer->before_files, items) {
+                r++;
+            }
+        }
+
+        if (peer->after_files) {
+            TAILQ_FOREACH(file, peer->after_files, items) {
+                r++;
+            }
+        }
+    }
+
+    return r;
+}
+
+/*
+ * Time limit of an inspection from the timeouts configuration, the
+ * "default" entry applies to inspections not listed.  0 is no limit.
+ */
+static unsigned int get_timeout(const struct rpminspect *ri, const char *inspection)
+{
+    string_map_t *entry = NULL;
+
+    HASH_FIND_STR(ri->timeouts, inspection, entry);
+
+    if (entry == NULL) {
+        HASH_FIND_STR(ri->timeouts, TIMEOUT_DEFAULT, entry);
+    }
+
+    if (entry == NULL || entry->value == NULL) {
+        return 0;
+    }
+
+    return strtoul(entry->value, NULL, 10);
+}
+
+/*
+ * Inspections that only look at RPM header data and the spec file.
+ * These take a fraction of a second on any package and catch the most
+ * common failures, so fail-fast mode runs them first.
+ */
+static const char *cheap_inspections[] = {
+    "arch",
+    "changelog",
+    "disttag",
+    "emptyrpm",
+    "license",
+    "metadata",
+    "modularity",
+    "ownership",
+    "rpmdeps",
+    "specname",
+    "subpackages",
+    NULL
+};
+
+static bool is_cheap(const struct task *t)
+{
+    int i = 0;
+
+    for (i = 0; cheap_inspections[i] != NULL; i++) {
+        if (!strcmp(cheap_inspections[i], t->inspection->name)) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/*
+ * Cheapest first for fail-fast mode: the header inspections, then
+ * shortest predicted, then unknown runtimes.
+ */
+static int cmp_cheap_tasks(const void *a, const void *b)
+{
+    const struct task *x = a;
+    const struct task *y = b;
+
+    if (is_cheap(x) != is_cheap(y)) {
+        return is_cheap(x) ? -1 : 1;
+    }
+
+    if (!is_cheap(x) && x->predicted != y->predicted) {
+        if (x->predicted < 0 || y->predicted < 0) {
+            return (x->predicted < 0) ? 1 : -1;
+        }
+
+        return (x->predicted < y->predicted) ? -1 : 1;
+    }
+
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+/* Longest predicted first, unknown runtimes before all of them */
+static int cmp_tasks(const void *a, const void *b)
+{
+    const struct task *x = a;
+    const struct task *y = b;
+
+    if (x->predicted != y->predicted) {
+        if (x->predicted < 0 || y->predicted < 0) {
+            return (x->predicted < 0) ? -1 : 1;
+        }
+
+        return (x->predicted > y->predicted) ? -1 : 1;
+    }
+
+    return (x->index < y->index) ? -1 : (x->index > y->index);
+}
+
+/* True once fail-fast mode should stop the run */
+static bool failed_fast(const struct rpminspect *ri)
+{
+    return ri->fail_fast && ri->worst_result >= ri->threshold;
+}
+
+static void print_running(const struct task *t)
+{
+    char *r = NULL;
+
+    xasprintf(&r, _("Running %s inspection..."), t->inspection->name);
+    assert(r != NULL);
+    printf("%-36s", r);
+    free(r);
+    return;
+}
+
+/*
+ * Add a result for an inspection that ran out of time.  Whatever
+ * results it reported before that are kept.
+ */
+static void add_timeout_result(struct task *t, const char *details)
+{
+    struct result_params params;
+
+    init_result_params(&params);
+    params.header = t->inspection->name;
+    params.severity = RESULT_BAD;
+    params.waiverauth = NOT_WAIVABLE;
+    params.verb = VERB_TIMEOUT;
+    params.noun = t->inspection->name;
+    params.details = (char *) details;
+
+    if (t->seconds < 0) {
+        xasprintf(&params.msg, _("The %s inspection was not run because the deadline passed."), t->inspection->name);
+    } else if (t->timeout > 0 && !deadline_passed()) {
+        xasprintf(&params.msg, _("The %s inspection did not finish within %u seconds; its results are incomplete."), t->inspection->name, t->timeout);
+    } else {
+        xasprintf(&params.msg, _("The %s inspection was stopped at the deadline; its results are incomplete."), t->inspection->name);
+    }
+
+    params.remedy = strdup(_("Inspection time limits are set in the timeouts section of the configuration file and with the --deadline option."));
+    add_result(t->ri, &params);
+    free(params.msg);
+    free(params.remedy);
+    return;
+}
+
+/* Note commands an inspection ran that were killed for taking too long */
+static void add_command_timeout_result(struct task *t)
+{
+    struct result_params params;
+
+    if (t->timeouts == 0) {
+        return;
+    }
+
+    init_result_params(&params);
+    params.header = t->inspection->name;
+    params.severity = RESULT_BAD;
+    params.waiverauth = NOT_WAIVABLE;
+    params.verb = VERB_TIMEOUT;
+    params.noun = t->inspection->name;
+    xasprintf(&params.msg, _("%u command(s) run by the %s inspection ran out of time and were stopped; its results are incomplete."), t->timeouts, t->inspection->name);
+    params.remedy = strdup(_("The command time limit is set in the timeouts section of the configuration file."));
+    add_result(t->ri, &params);
+    free(params.msg);
+    free(params.remedy);
+    return;
+}
+
+/*
+ * Add a result for an inspection fail-fast mode kept from running or
+ * stopped part way.  Whatever results it reported before that are
+ * kept.
+ */
+static void add_cancelled_result(struct task *t)
+{
+    struct result_params params;
+
+    init_result_params(&params);
+    params.header = t->inspection->name;
+    params.severity = RESULT_SKIP;
+    params.verb = VERB_SKIP;
+    params.noun = t->inspection->name;
+
+    if (t->seconds < 0) {
+        xasprintf(&params.msg, _("The %s inspection was not run because --fail-fast stopped the run after a failure."), t->inspection->name);
+    } else {
+        xasprintf(&params.msg, _("The %s inspection was stopped because --fail-fast stopped the run after a failure; its results are incomplete."), t->inspection->name);
+    }
+
+    add_result(t->ri, &params);
+    free(params.msg);
+    return;
+}
+
+/* Run an inspection in this process */
+static void run_task(struct task *t)
+{
+    double start = monotonic_time();
+    unsigned int timeouts = get_command_timeouts();
+
+    t->result = t->inspection->driver(t->ri);
+    t->seconds = monotonic_time() - start;
+    t->timeouts = get_command_timeouts() - timeouts;
+    return;
+}
+
+/*
+ * Job function to run an inspection in a child process.  Results are
+ * written as the inspection adds them so they are not lost if the
+ * child is killed.  A line with a period, the runtime, the result,
+ * and the number of commands that ran out of time ends the output.
+ */
+static int run_task_job(void *data)
+{
+    struct task *t = data;
+
+    t->ri->results_stream = t->out;
+    run_task(t);
+    t->ri->results_stream = NULL;
+
+    fprintf(t->out, ".%f %d %u\n", t->seconds, t->result, t->timeouts);
+
+    if (fflush(t->out) != 0) {
+        warn("fflush");
+    }
+
+    return t->result ? EXIT_SUCCESS : EXIT_FAILURE;
+}
+
+/*
+ * Read back the results written by run_task_job().  Returns true if
+ * the child finished.
+ */
+static bool read_task_results(struct task *t)
+{
+    int result = 0;
+    bool r = false;
+    results_t *results = NULL;
+    results_entry_t *entry = NULL;
+
+    rewind(t->out);
+    results = read_results(t->out, t->inspection->name);
+
+    if (fscanf(t->out, "%lf %d %u", &t->seconds, &result, &t->timeouts) == 3) {
+        t->result = result;
+        r = true;
+    }
+
+    /* partial results of a child that did not finish are kept too */
+    if (results != NULL) {
+        while (!TAILQ_EMPTY(results)) {
+            entry = TAILQ_FIRST(results);
+            TAILQ_REMOVE(results, entry, items);
+
+            if (entry->severity > t->ri->worst_result) {
+                t->ri->worst_result = entry->severity;
+            }
+
+            if (t->ri->results == NULL) {
+                t->ri->results = init_results();
+            }
+
+            TAILQ_INSERT_TAIL(t->ri->results, entry, items);
+        }
+
+        free_results(results);
+    }
+
+    return r;
+}
+
+static void print_outcome(const struct task *t)
+{
+    if (t->cancelled) {
+        printf("%5s", _("stop"));
+    } else if (t->timed_out) {
+        printf("%5s", _("TIME"));
+    } else {
+        printf("%5s", t->result ? _("pass") : _("FAIL"));
+    }
+
+    if (t->seconds < 0) {
+        printf("\n");
+    } else if (t->predicted < 0) {
+        printf(_(" %8.1fs\n"), t->seconds);
+    } else {
+        printf(_(" %8.1fs (predicted %.1fs)\n"), t->seconds, t->predicted);
+    }
+
+    return;
+}
+
+/* Called by run_jobs() when an inspection child finishes */
+static void task_done(job_entry_t *job)
+{
+    struct task *t = job->data;
+    struct result_params params;
+
+    t->done = true;
+
+    if (job->output && *job->output != '\0' && !job->timed_out && !job->cancelled) {
+        fputs(job->output, stderr);
+
+        if (job->output[strlen(job->output) - 1] != '\n') {
+            fputc('\n', stderr);
+        }
+    }
+
+    t->maxrss = job->maxrss;
+
+    if (job->cancelled && job->pid != 0 && read_task_results(t)) {
+        /* finished before fail-fast could stop it */
+        add_command_timeout_result(t);
+        set_results_fingerprint(t->ri, t->inspection->name);
+    } else if (job->cancelled) {
+        /* stopped by fail-fast, anything it found was read in above */
+        t->seconds = (job->pid == 0) ? -1 : monotonic_time() - job->started;
+        t->cancelled = true;
+        t->result = false;
+        add_cancelled_result(t);
+    } else if (job->pid == 0) {
+        /* never started */
+        t->timed_out = true;
+        t->result = false;
+        t->seconds = -1;
+        add_timeout_result(t, NULL);
+    } else if (job->timed_out) {
+        (void) read_task_results(t);
+        t->timed_out = true;
+        t->result = false;
+        t->seconds = monotonic_time() - job->started;
+        add_timeout_result(t, job->output);
+    } else if (read_task_results(t)) {
+        add_command_timeout_result(t);
+        set_results_fingerprint(t->ri, t->inspection->name);
+    } else {
+        /* the child died before reporting, e.g. on a signal */
+        init_result_params(&params);
+        params.header = t->inspection->name;
+        params.severity = RESULT_BAD;
+        params.waiverauth = NOT_WAIVABLE;
+        params.verb = VERB_FAILED;
+        xasprintf(&params.msg, _("The %s inspection did not finish."), t->inspection->name);
+        params.details = job->output;
+        add_result(t->ri, &params);
+        free(params.msg);
+        t->result = false;
+        t->seconds = -1;
+    }
+
+    if (t->ri->verbose) {
+        print_running(t);
+        print_outcome(t);
+    }
+
+    if (failed_fast(t->ri)) {
+        stop_jobs();
+    }
+
+    return;
+}
+
+/* Position of the named inspection in inspections[], -1 if none */
+static int inspection_index(const char *name)
+{
+    int i = 0;
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!strcmp(inspections[i].name, name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Put the results back in inspections[] order.  Results that do not
+ * belong to an inspection, like the diagnostics, stay first.  The
+ * order within each inspection is kept.
+ */
+static void sort_results(struct rpminspect *ri)
+{
+    int i = 0;
+    int n = 0;
+    results_t *buckets = NULL;
+    results_entry_t *entry = NULL;
+
+    if (ri->results == NULL) {
+        return;
+    }
+
+    while (inspections[n].name != NULL) {
+        n++;
+    }
+
+    /* bucket 0 is for results of no inspection */
+    buckets = calloc(n + 1, sizeof(*buckets));
+    assert(buckets != NULL);
+
+    for (i = 0; i <= n; i++) {
+        TAILQ_INIT(&buckets[i]);
+    }
+
+    while (!TAILQ_EMPTY(ri->results)) {
+        entry = TAILQ_FIRST(ri->results);
+        TAILQ_REMOVE(ri->results, entry, items);
+        i = inspection_index(entry->header);
+        TAILQ_INSERT_TAIL(&buckets[i + 1], entry, items);
+    }
+
+    for (i = 0; i <= n; i++) {
+        TAILQ_CONCAT(ri->results, &buckets[i], items);
+    }
+
+    free(buckets);
+    return;
+}
+
+/* Run a task in this process, used when no time limit applies */
+static void run_task_here(struct task *t)
+{
+    if (t->ri->verbose) {
+        print_running(t);
+    }
+
+    run_task(t);
+    t->done = true;
+
+    if (t->timeouts > 0) {
+        add_command_timeout_result(t);
+    } else {
+        set_results_fingerprint(t->ri, t->inspection->name);
+    }
+
+    if (t->ri->verbose) {
+        print_outcome(t);
+    }
+
+    return;
+}
+
+/* An inspection fail-fast mode kept from running */
+static void cancel_task(struct task *t)
+{
+    t->done = true;
+    t->cancelled = true;
+    t->seconds = -1;
+    add_cancelled_result(t);
+
+    if (t->ri->verbose) {
+        print_running(t);
+        print_outcome(t);
+    }
+
+    return;
+}
+
+/*
+ * Run the tasks that have not run yet, in child processes if children
+ * is set.  In fail-fast mode the cheapest tasks start first and the
+ * rest are cancelled once a result reaches the threshold.  Otherwise
+ * with more than one job the longest predicted tasks start first.
+ */
+static void run_tasks(struct rpminspect *ri, struct task *tasks, const size_t ntasks, const bool children)
+{
+    size_t i = 0;
+    job_list_t *jobs = NULL;
+    job_entry_t *job = NULL;
+
+    if (ri->fail_fast) {
+        qsort(tasks, ntasks, sizeof(*tasks), cmp_cheap_tasks);
+    } else if (ri->jobs > 1) {
+        qsort(tasks, ntasks, sizeof(*tasks), cmp_tasks);
+    }
+
+    jobs = calloc(1, sizeof(*jobs));
+    assert(jobs != NULL);
+    TAILQ_INIT(jobs);
+
+    for (i = 0; i < ntasks; i++) {
+        /* already ran in this process, or fail-fast runs it here */
+        if (tasks[i].done || !children) {
+            continue;
+        }
+
+        tasks[i].out = tmpfile();
+
+        if (tasks[i].out == NULL) {
+            warn("tmpfile");
+            continue;
+        }
+
+        job = calloc(1, sizeof(*job));
+        assert(job != NULL);
+        job->fn = run_task_job;
+        job->data = &tasks[i];
+        job->done = task_done;
+        job->timeout = tasks[i].timeout;
+        job->memory = (tasks[i].memory > 0) ? tasks[i].memory : 0;
+        job->group = true;
+        TAILQ_INSERT_TAIL(jobs, job, items);
+    }
+
+    run_jobs(jobs, ri->jobs);
+    free_jobs(jobs);
+
+    /* anything that could not be started runs here */
+    for (i = 0; i < ntasks; i++) {
+        if (tasks[i].out != NULL && fclose(tasks[i].out) != 0) {
+            warn("fclose");
+        }
+
+        if (tasks[i].done) {
+            continue;
+        }
+
+        if (failed_fast(ri)) {
+            cancel_task(&tasks[i]);
+        } else {
+            run_task_here(&tasks[i]);
+        }
+    }
+
+    return;
+}
+
+/**
+ * @brief Run the selected inspections.
+ *
+ * Inspections not selected get a skipped result, unless another
+ * shard reports them (they are not in ri->skipped_tests), and
+ * inspections whose previous results can be reused are not run.
+ * With ri->jobs set to more than 1, that many inspections run at
+ * once in child processes.  Inspections also run in child processes
+ * when they have a timeout or a deadline is set, so they can be
+ * stopped.  An inspection that runs out of time gets a timeout
+ * result after the results it reported so far.  With ri->fail_fast
+ * set, the cheapest inspections run first and the ones left are
+ * skipped or stopped as soon as ri->worst_result reaches
+ * ri->threshold.  The runtime of each inspection is recorded in the
+ * runtime history, which is written out when all of them finish.
+ * The results are left in inspections[] order, so calling this again
+ * after gather_baseline() puts the results for each baseline next to
+ * each other.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @return True if every inspection that ran passed.
+ */
+bool run_inspections(struct rpminspect *ri)
+{
+    size_t i = 0;
+    size_t ntasks = 0;
+    bool r = true;
+    bool children = false;
+    char *msg = NULL;
+    char *package = NULL;
+    unsigned long files = 0;
+    struct task *tasks = NULL;
+    struct task *t = NULL;
+    struct result_params params;
+
+    assert(ri != NULL);
+
+    package = get_package_name(ri);
+    files = count_files(ri);
+
+    while (inspections[i].name != NULL) {
+        i++;
+    }
+
+    tasks = calloc(i + 1, sizeof(*tasks));
+    assert(tasks != NULL);
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        /* test not selected by user */
+        if (!(ri->tests & inspections[i].flag)) {
+            /* another shard runs it or reports it */
+            if (!(ri->skipped_tests & inspections[i].flag)) {
+                continue;
+            }
+
+            /*
+             * tell the user this inspection is skipped when in
+             * verbose mode
+             */
+            if (ri->verbose) {
+                xasprintf(&msg, _("Skipping %s inspection..."), inspections[i].name);
+                assert(msg != NULL);
+                printf("%-36s", msg);
+                free(msg);
+
+                printf("%5s\n", _("skip"));
+            }
+
+            /* add a skipped result for this inspection */
+            init_result_params(&params);
+            params.header = inspections[i].name;
+            params.severity = RESULT_SKIP;
+            params.verb = VERB_SKIP;
+            add_result(ri, &params);
+
+            /* next inspection */
+            continue;
+        }
+
+        /* inspection requires before/after builds and we have one */
+        if (ri->before == NULL && !inspections[i].single_build) {
+            continue;
+        }
+
+        t = &tasks[ntasks];
+        memset(t, 0, sizeof(*t));
+        t->ri = ri;
+        t->inspection = &inspections[i];
+        t->index = i;
+        t->predicted = predict_runtime(ri, package, inspections[i].name, files);
+        t->memory = predict_memory(ri, package, inspections[i].name);
+
+        /* inputs unchanged since the previous run */
+        if (reuse_results(ri, inspections[i].name)) {
+            if (ri->verbose) {
+                print_running(t);
+                printf("%5s\n", _("reuse"));
+            }
+
+            continue;
+        }
+
+        t->timeout = get_timeout(ri, inspections[i].name);
+        ntasks++;
+
+        if (ri->jobs > 1 || t->timeout > 0 || have_deadline()) {
+            children = true;
+        } else if (!ri->fail_fast) {
+            run_task_here(t);
+        }
+    }
+
+    if ((children || ri->fail_fast) && ntasks > 0) {
+        run_tasks(ri, tasks, ntasks, children);
+    }
+
+    /* also merges in results of earlier runs against other baselines */
+    sort_results(ri);
+
+    for (i = 0; i < ntasks; i++) {
+        if (!tasks[i].result) {
+            r = false;
+        }
+
+        /*
+         * inspections that ran out of time record how long they got,
+         * ones fail-fast stopped say nothing about their runtime
+         */
+        if (package != NULL && tasks[i].seconds >= 0 && !tasks[i].cancelled) {
+            record_runtime(ri, package, tasks[i].inspection->name, tasks[i].seconds, files);
+
+            /* only known for inspections run in a child */
+            if (tasks[i].maxrss > 0) {
+                record_memory(ri, package, tasks[i].inspection->name, tasks[i].maxrss);
+            }
+        }
+    }
+
+    if (ri->history_file != NULL && ntasks > 0) {
+        (void) write_history(ri);
+    }
+
+    free(tasks);
+    free(package);
+    return r;
+}
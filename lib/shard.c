@@ -0,0 +1,742 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Sharded runs.  One comparison can be spread over several rpminspect
+ * processes, on one host or on several sharing the working directory.
+ * A coordinator run (--plan-shards) splits the selected inspections
+ * in to shard manifests, balancing the predicted runtimes from the
+ * history, and does not inspect anything.  A worker run (--shard)
+ * runs the inspections of one manifest and writes JSON results.  A
+ * merge run (--merge) combines the JSON results of the workers in to
+ * one report.  A manifest is a small JSON file:
+ *
+ *     { "shard": 1, "shards": 4, "seconds": 310.5,
+ *       "inspections": [ "abidiff", "annocheck", ... ],
+ *       "skipped": [ "kmidiff", ... ] }
+ *
+ * The inspections not selected at all are listed as skipped in the
+ * first manifest only, so the merged report has their skipped
+ * results once.  A worker names its shard in a diagnostics result
+ * with SHARD_NOUN as the noun, which lets the merge check that it
+ * has the results of every shard once.
+ */
+
+#include <assert.h>
+#include <err.h>
+#include <limits.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <json.h>
+
+#include "rpminspect.h"
+
+/* One inspection to place in a shard */
+struct unit {
+    size_t index;             /* position in inspections[] */
+    double cost;              /* predicted seconds */
+    unsigned int shard;       /* 0 based */
+};
+
+/* inspections[] order */
+static int cmp_units_index(const void *a, const void *b)
+{
+    const struct unit *x = a;
+    const struct unit *y = b;
+
+    return (x->index > y->index) - (x->index < y->index);
+}
+
+/* Longest predicted runtime first, then inspections[] order */
+static int cmp_units(const void *a, const void *b)
+{
+    const struct unit *x = a;
+    const struct unit *y = b;
+
+    if (x->cost > y->cost) {
+        return -1;
+    } else if (x->cost < y->cost) {
+        return 1;
+    }
+
+    return cmp_units_index(a, b);
+}
+
+/* Position of the named inspection in inspections[], -1 if none */
+static int inspection_index(const char *name)
+{
+    int i = 0;
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!strcmp(inspections[i].name, name)) {
+            return i;
+        }
+    }
+
+    return -1;
+}
+
+/*
+ * Package name of a build specification, which is a Koji NVR, a
+ * local build directory, or a local package.  The coordinator does
+ * not download the builds, so this is all it has to find the
+ * history of the package by.  NULL if there is no NVR to go on, like
+ * a Koji task ID.
+ */
+static char *spec_package_name(const char *spec)
+{
+    int i = 0;
+    size_t len = 0;
+    char *r = NULL;
+    char *name = NULL;
+    char *dot = NULL;
+    char *dash = NULL;
+
+    if (spec == NULL) {
+        return NULL;
+    }
+
+    r = strdup(spec);
+    assert(r != NULL);
+
+    /* local paths may end in slashes */
+    len = strlen(r);
+
+    while (len > 1 && r[len - 1] == '/') {
+        r[--len] = '\0';
+    }
+
+    name = strrchr(r, '/');
+    name = (name == NULL) ? r : name + 1;
+
+    /* NAME-VERSION-RELEASE.ARCH.rpm */
+    if (strsuffix(name, ".rpm")) {
+        name[strlen(name) - 4] = '\0';
+
+        if ((dot = strrchr(name, '.')) != NULL) {
+            *dot = '\0';
+        }
+    }
+
+    for (i = 0; i < 2 && (dash = strrchr(name, '-')) != NULL; i++) {
+        *dash = '\0';
+    }
+
+    if (i < 2 || *name == '\0') {
+        free(r);
+        return NULL;
+    }
+
+    memmove(r, name, strlen(name) + 1);
+    return r;
+}
+
+/*
+ * Payload files in the last recorded run on the package, so the
+ * history of other packages can be scaled to it.  1 if the package
+ * has no history.
+ */
+static unsigned long recorded_files(const struct rpminspect *ri, const char *package)
+{
+    history_t *pkg = NULL;
+    history_entry_t *entry = NULL;
+    history_entry_t *tmp_entry = NULL;
+
+    if (package == NULL) {
+        return 1;
+    }
+
+    HASH_FIND_STR(ri->history, package, pkg);
+
+    if (pkg == NULL) {
+        return 1;
+    }
+
+    HASH_ITER(hh, pkg->entries, entry, tmp_entry) {
+        if (entry->files >= 1) {
+            return (unsigned long) entry->files;
+        }
+    }
+
+    return 1;
+}
+
+/* Add the names of the inspections in a shard, or all of them */
+static void add_names(json_object *jo, const char *key, const struct unit *units, const size_t nunits, const int shard)
+{
+    size_t i = 0;
+    json_object *ja = NULL;
+
+    ja = json_object_new_array();
+    assert(ja != NULL);
+
+    for (i = 0; i < nunits; i++) {
+        if (shard < 0 || units[i].shard == (unsigned int) shard) {
+            json_object_array_add(ja, json_object_new_string(inspections[units[i].index].name));
+        }
+    }
+
+    json_object_object_add(jo, key, ja);
+    return;
+}
+
+/* Write out a shard manifest */
+static bool write_manifest(const char *path, json_object *jo)
+{
+    FILE *fp = NULL;
+
+    fp = fopen(path, "w");
+
+    if (fp == NULL) {
+        warn(_("error opening %s for writing"), path);
+        return false;
+    }
+
+    fprintf(fp, "%s\n", json_object_to_json_string_ext(jo, JSON_C_TO_STRING_SPACED | JSON_C_TO_STRING_PRETTY));
+
+    if (fclose(fp) != 0) {
+        warn("fclose %s", path);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief Split the selected inspections in to shard manifests.
+ *
+ * Each inspection goes to the shard with the least predicted runtime
+ * so far, longest inspections first.  Inspections with no history
+ * are predicted to take as long as the average of the others.  The
+ * manifests are written to dir as SHARD_MANIFEST and their paths are
+ * printed on stdout.
+ *
+ * @param ri The struct rpminspect for the program, with the history
+ * read in.
+ * @param shards Number of shards to split the inspections in to.
+ * @param dir Directory to write the manifests to, created if needed.
+ * @return True on success, false otherwise.
+ */
+bool write_shard_manifests(struct rpminspect *ri, const unsigned int shards, const char *dir)
+{
+    bool r = true;
+    size_t i = 0;
+    size_t nunits = 0;
+    size_t nskipped = 0;
+    size_t known = 0;
+    unsigned int s = 0;
+    unsigned int least = 0;
+    double total = 0;
+    double *loads = NULL;
+    char *package = NULL;
+    char *name = NULL;
+    char *path = NULL;
+    unsigned long files = 0;
+    struct unit *units = NULL;
+    struct unit *skipped = NULL;
+    json_object *jo = NULL;
+
+    assert(ri != NULL);
+    assert(shards > 0);
+    assert(dir != NULL);
+
+    if (mkdirp(dir, S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH)) {
+        warn("mkdirp %s", dir);
+        return false;
+    }
+
+    while (inspections[i].name != NULL) {
+        i++;
+    }
+
+    units = calloc(i, sizeof(*units));
+    assert(units != NULL);
+    skipped = calloc(i, sizeof(*skipped));
+    assert(skipped != NULL);
+    loads = calloc(shards, sizeof(*loads));
+    assert(loads != NULL);
+
+    package = spec_package_name(ri->after);
+    files = recorded_files(ri, package);
+
+    for (i = 0; inspections[i].name != NULL; i++) {
+        if (!(ri->tests & inspections[i].flag)) {
+            skipped[nskipped++].index = i;
+            continue;
+        }
+
+        units[nunits].index = i;
+        units[nunits].cost = predict_runtime(ri, package, inspections[i].name, files);
+
+        if (units[nunits].cost >= 0) {
+            total += units[nunits].cost;
+            known++;
+        }
+
+        nunits++;
+    }
+
+    for (i = 0; i < nunits; i++) {
+        if (units[i].cost < 0) {
+            units[i].cost = (known > 0) ? total / known : 1;
+        }
+    }
+
+    qsort(units, nunits, sizeof(*units), cmp_units);
+
+    for (i = 0; i < nunits; i++) {
+        least = 0;
+
+        for (s = 1; s < shards; s++) {
+            if (loads[s] < loads[least]) {
+                least = s;
+            }
+        }
+
+        units[i].shard = least;
+        loads[least] += units[i].cost;
+    }
+
+    /* the manifests list the inspections in inspections[] order */
+    qsort(units, nunits, sizeof(*units), cmp_units_index);
+
+    for (s = 0; s < shards && r; s++) {
+        jo = json_object_new_object();
+        assert(jo != NULL);
+        json_object_object_add(jo, "shard", json_object_new_int(s + 1));
+        json_object_object_add(jo, "shards", json_object_new_int(shards));
+        json_object_object_add(jo, "seconds", json_object_new_double(loads[s]));
+        add_names(jo, "inspections", units, nunits, s);
+        add_names(jo, "skipped", skipped, (s == 0) ? nskipped : 0, -1);
+
+        xasprintf(&name, SHARD_MANIFEST, s + 1);
+        path = joinpath(dir, name, NULL);
+        r = write_manifest(path, jo);
+
+        if (r) {
+            printf("%s\n", path);
+        }
+
+        json_object_put(jo);
+        free(name);
+        free(path);
+    }
+
+    free(package);
+    free(loads);
+    free(skipped);
+    free(units);
+    return r;
+}
+
+/* Add the inspections named in a manifest array to a tests mask */
+static bool read_names(json_object *jo, const char *key, const char *path, uint64_t *tests)
+{
+    size_t i = 0;
+    size_t len = 0;
+    int idx = 0;
+    const char *name = NULL;
+    json_object *ja = NULL;
+    json_object *jn = NULL;
+
+    *tests = 0;
+
+    if (!json_object_object_get_ex(jo, key, &ja)) {
+        return true;
+    }
+
+    if (!json_object_is_type(ja, json_type_array)) {
+        warnx(_("*** %s in %s is not a list"), key, path);
+        return false;
+    }
+
+    len = json_object_array_length(ja);
+
+    for (i = 0; i < len; i++) {
+        jn = json_object_array_get_idx(ja, i);
+        name = json_object_is_type(jn, json_type_string) ? json_object_get_string(jn) : NULL;
+        idx = (name == NULL) ? -1 : inspection_index(name);
+
+        if (idx < 0) {
+            warnx(_("*** Unknown inspection in %s: `%s`"), path, (name == NULL) ? "" : name);
+            return false;
+        }
+
+        *tests |= inspections[idx].flag;
+    }
+
+    return true;
+}
+
+/* Read a positive integer member of a manifest */
+static bool read_number(json_object *jo, const char *key, unsigned int *n)
+{
+    int64_t v = 0;
+    json_object *jn = NULL;
+
+    if (!json_object_object_get_ex(jo, key, &jn) || !json_object_is_type(jn, json_type_int)) {
+        return false;
+    }
+
+    v = json_object_get_int64(jn);
+
+    if (v <= 0 || v > UINT_MAX) {
+        return false;
+    }
+
+    *n = (unsigned int) v;
+    return true;
+}
+
+/**
+ * @brief Select the inspections of a shard manifest.
+ *
+ * This replaces the inspections selected by the configuration files
+ * and the command line.  Only the inspections listed as skipped in
+ * the manifest get a skipped result.  The shard number and the number
+ * of shards are kept in ri->shard and ri->shards.
+ *
+ * @param ri The struct rpminspect for the program.
+ * @param path The shard manifest written by write_shard_manifests().
+ * @return True on success, false if the manifest could not be read.
+ */
+bool read_shard_manifest(struct rpminspect *ri, const char *path)
+{
+    bool r = false;
+    off_t len = 0;
+    char *buf = NULL;
+    json_tokener *tok = NULL;
+    json_object *jo = NULL;
+
+    assert(ri != NULL);
+    assert(path != NULL);
+
+    buf = read_file_bytes(path, &len);
+
+    if (buf == NULL) {
+        warnx(_("*** unable to read %s"), path);
+        return false;
+    }
+
+    tok = json_tokener_new();
+    assert(tok != NULL);
+    jo = json_tokener_parse_ex(tok, buf, len);
+
+    if (json_tokener_get_error(tok) != json_tokener_success || !json_object_is_type(jo, json_type_object)
+        || !read_number(jo, "shard", &ri->shard) || !read_number(jo, "shards", &ri->shards)
+        || ri->shard == 0 || ri->shard > ri->shards) {
+        warnx(_("*** %s is not a shard manifest"), path);
+    } else {
+        r = read_names(jo, "inspections", path, &ri->tests) && read_names(jo, "skipped", path, &ri->skipped_tests);
+    }
+
+    json_object_put(jo);
+    json_tokener_free(tok);
+    free(buf);
+    return r;
+}
+
+/* True if the results have a diagnostic with the same message */
+static bool have_diagnostic(const results_t *results, const results_entry_t *diag)
+{
+    results_entry_t *entry = NULL;
+
+    TAILQ_FOREACH(entry, results, items) {
+        if (!strcmp(entry->msg ? entry->msg : "", diag->msg ? diag->msg : "")
+            && !strcmp(entry->details ? entry->details : "", diag->details ? diag->details : "")) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/* True if every result is a skipped one */
+static bool all_skipped(const results_t *results)
+{
+    results_entry_t *entry = NULL;
+
+    TAILQ_FOREACH(entry, results, items) {
+        if (entry->severity != RESULT_SKIP) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/*
+ * True if the JSON result is the diagnostics result naming the shard
+ * of a worker, which is then read in to shard and shards.
+ */
+static bool shard_marker(json_object *jr, unsigned int *shard, unsigned int *shards)
+{
+    int end = 0;
+    const char *noun = NULL;
+    json_object *jn = NULL;
+
+    if (!json_object_object_get_ex(jr, "noun", &jn) || !json_object_is_type(jn, json_type_string)) {
+        return false;
+    }
+
+    noun = json_object_get_string(jn);
+
+    if (sscanf(noun, SHARD_NOUN "%n", shard, shards, &end) != 2 || noun[end] != '\0') {
+        return false;
+    }
+
+    return true;
+}
+
+/*
+ * Read the results of one inspection in a shard's JSON results.  The
+ * shard marker in the diagnostics is left out of the results; shard
+ * and shards are set from it.
+ */
+static results_t *read_shard_inspection(const char *header, json_object *array, unsigned int *shard, unsigned int *shards)
+{
+    size_t i = 0;
+    size_t len = 0;
+    json_object *jr = NULL;
+    results_t *results = NULL;
+
+    results = init_results();
+    len = json_object_array_length(array);
+
+    for (i = 0; i < len; i++) {
+        jr = json_object_array_get_idx(array, i);
+
+        if (!strcmp(header, NAME_DIAGNOSTICS) && shard_marker(jr, shard, shards)) {
+            continue;
+        }
+
+        add_json_result(&results, header, jr);
+    }
+
+    return results;
+}
+
+/*
+ * Check the shard number of one results file against the ones read
+ * so far.  seen holds the file each shard was read from and is
+ * allocated for the number of shards of the first file.
+ */
+static bool check_shard(const char *path, const unsigned int shard, const unsigned int shards, const char ***seen, unsigned int *nseen)
+{
+    if (shard == 0 || shard > shards) {
+        warnx(_("*** %s is not the results of a shard"), path);
+        return false;
+    }
+
+    if (*seen == NULL) {
+        *seen = calloc(shards, sizeof(**seen));
+        assert(*seen != NULL);
+        *nseen = shards;
+    } else if (shards != *nseen) {
+        warnx(_("*** %s is from a run of %u shards, not %u"), path, shards, *nseen);
+        return false;
+    }
+
+    if ((*seen)[shard - 1] != NULL) {
+        warnx(_("*** %s and %s are both shard %u"), (*seen)[shard - 1], path, shard);
+        return false;
+    }
+
+    (*seen)[shard - 1] = path;
+    return true;
+}
+
+/*
+ * Add the results of one inspection of a shard to the merged ones.
+ * Each inspection runs in one shard, the other shards may only have
+ * skipped results for it.  The diagnostics of every shard are kept,
+ * except the ones that are the same in all of them like the version
+ * information.
+ */
+static void merge_inspection(results_t **merged, results_t *results, const char *header, const char *path)
+{
+    results_entry_t *entry = NULL;
+    results_entry_t *next = NULL;
+
+    if (*merged == NULL) {
+        *merged = results;
+        return;
+    }
+
+    if (!strcmp(header, NAME_DIAGNOSTICS)) {
+        entry = TAILQ_FIRST(results);
+
+        /* the duplicates are freed with the rest of the results */
+        while (entry != NULL) {
+            next = TAILQ_NEXT(entry, items);
+
+            if (!have_diagnostic(*merged, entry)) {
+                TAILQ_REMOVE(results, entry, items);
+                TAILQ_INSERT_TAIL(*merged, entry, items);
+            }
+
+            entry = next;
+        }
+    } else if (all_skipped(*merged) && !all_skipped(results)) {
+        free_results(*merged);
+        *merged = results;
+        return;
+    } else if (!all_skipped(results)) {
+        warnx(_("*** %s also has %s results, ignoring them"), path, header);
+    }
+
+    free_results(results);
+    return;
+}
+
+/* Order of the shard results files */
+static int cmp_paths(const void *a, const void *b)
+{
+    return strcmp(*(const char * const *) a, *(const char * const *) b);
+}
+
+/**
+ * @brief Merge the JSON results of the shards of a run.
+ *
+ * The merged results are in inspections[] order with the diagnostics
+ * first.  The files are read in order of their names, so the merged
+ * results do not depend on the order they are given in.  Every shard
+ * of the run has to be given exactly once.
+ *
+ * @param paths The JSON results files written by the shard workers.
+ * @param worst Set to the worst result of the merged results.
+ * @return The merged results, NULL if a file could not be read or a
+ * shard is missing or given more than once.
+ */
+results_t *merge_shard_results(const string_list_t *paths, severity_t *worst)
+{
+    bool ok = true;
+    size_t i = 0;
+    size_t n = 0;
+    size_t npaths = 0;
+    int idx = 0;
+    unsigned int shard = 0;
+    unsigned int shards = 0;
+    unsigned int nseen = 0;
+    const char **seen = NULL;
+    off_t len = 0;
+    char *buf = NULL;
+    const char *header = NULL;
+    const char **sorted = NULL;
+    json_tokener *tok = NULL;
+    json_object *jo = NULL;
+    results_t **merged = NULL;
+    results_t *results = NULL;
+    results_entry_t *entry = NULL;
+    string_entry_t *path = NULL;
+
+    assert(paths != NULL);
+    assert(worst != NULL);
+
+    while (inspections[n].name != NULL) {
+        n++;
+    }
+
+    /* slot 0 is for the diagnostics */
+    merged = calloc(n + 1, sizeof(*merged));
+    assert(merged != NULL);
+
+    TAILQ_FOREACH(path, paths, items) {
+        npaths++;
+    }
+
+    sorted = calloc(npaths + 1, sizeof(*sorted));
+    assert(sorted != NULL);
+
+    TAILQ_FOREACH(path, paths, items) {
+        sorted[i++] = path->data;
+    }
+
+    qsort(sorted, npaths, sizeof(*sorted), cmp_paths);
+
+    for (i = 0; i < npaths && ok; i++) {
+        buf = read_file_bytes(sorted[i], &len);
+
+        if (buf == NULL) {
+            warnx(_("*** unable to read %s"), sorted[i]);
+            ok = false;
+            break;
+        }
+
+        tok = json_tokener_new();
+        assert(tok != NULL);
+        jo = json_tokener_parse_ex(tok, buf, len);
+
+        if (json_tokener_get_error(tok) != json_tokener_success || !json_object_is_type(jo, json_type_object)) {
+            warnx(_("*** %s is not a JSON results file"), sorted[i]);
+            ok = false;
+        } else {
+            shard = 0;
+            shards = 0;
+
+            json_object_object_foreach(jo, key, val) {
+                if (!strcmp(key, NAME_DIAGNOSTICS)) {
+                    idx = -1;
+                    header = NAME_DIAGNOSTICS;
+                } else if ((idx = inspection_index(key)) >= 0) {
+                    header = inspections[idx].name;
+                } else {
+                    warnx(_("*** Unknown inspection in %s: `%s`"), sorted[i], key);
+                    continue;
+                }
+
+                if (json_object_is_type(val, json_type_array)) {
+                    merge_inspection(&merged[idx + 1], read_shard_inspection(header, val, &shard, &shards), header, sorted[i]);
+                }
+            }
+
+            ok = check_shard(sorted[i], shard, shards, &seen, &nseen);
+        }
+
+        json_object_put(jo);
+        json_tokener_free(tok);
+        free(buf);
+    }
+
+    if (ok) {
+        for (i = 0; i < nseen; i++) {
+            if (seen[i] == NULL) {
+                warnx(_("*** The results of shard %zu of %u are missing"), i + 1, nseen);
+                ok = false;
+            }
+        }
+    }
+
+    *worst = RESULT_NULL;
+
+    if (ok) {
+        results = init_results();
+    }
+
+    for (i = 0; i <= n; i++) {
+        if (merged[i] == NULL) {
+            continue;
+        }
+
+        if (ok) {
+            TAILQ_FOREACH(entry, merged[i], items) {
+                if (entry->severity > *worst) {
+                    *worst = entry->severity;
+                }
+            }
+
+            TAILQ_CONCAT(results, merged[i], items);
+        }
+
+        free_results(merged[i]);
+    }
+
+    free(seen);
+    free(sorted);
+    free(merged);
+    return results;
+}
@@ -0,0 +1,502 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Spec file model.  A spec file is read and broken down once in to
+ * its sections, PatchN: and SourceN: tags, %patch applications, and
+ * %define/%global macros.  Inspections query the model cached in the
+ * struct rpminspect instead of reading and scanning the file again.
+ */
+
+#include <assert.h>
+#include <ctype.h>
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <err.h>
+#include <sys/types.h>
+
+#include "rpminspect.h"
+
+/* Section markers recognized by rpmbuild */
+static const char *spec_sections[] = { "%package",
+                                       "%description",
+                                       "%prep",
+                                       "%generate_buildrequires",
+                                       "%conf",
+                                       "%build",
+                                       "%install",
+                                       "%check",
+                                       "%clean",
+                                       "%files",
+                                       "%changelog",
+                                       "%pre",
+                                       "%post",
+                                       "%preun",
+                                       "%postun",
+                                       "%pretrans",
+                                       "%posttrans",
+                                       "%preuntrans",
+                                       "%postuntrans",
+                                       "%verifyscript",
+                                       "%triggerprein",
+                                       "%triggerin",
+                                       "%triggerun",
+                                       "%triggerpostun",
+                                       "%filetriggerin",
+                                       "%filetriggerun",
+                                       "%filetriggerpostun",
+                                       "%transfiletriggerin",
+                                       "%transfiletriggerun",
+                                       "%transfiletriggerpostun",
+                                       "%patchlist",
+                                       "%sourcelist",
+                                       NULL };
+
+/* Returns true if s starts with the word w */
+static bool word_prefix(const char *s, const char *w)
+{
+    size_t len = strlen(w);
+
+    return !strncmp(s, w, len) && (s[len] == '\0' || isspace(s[len]));
+}
+
+static bool is_section(const char *line)
+{
+    int i = 0;
+
+    if (*line != '%') {
+        return false;
+    }
+
+    for (i = 0; spec_sections[i] != NULL; i++) {
+        if (word_prefix(line, spec_sections[i])) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+/**
+ * @brief Returns true if the spec file section is of the named type.
+ *
+ * @param section The spec file section.
+ * @param name The section marker, e.g. SPEC_SECTION_FILES.  An empty
+ * string matches the preamble.
+ * @return True if the section is of the named type.
+ */
+bool spec_section_is(const spec_section_t *section, const char *name)
+{
+    assert(section != NULL);
+    assert(name != NULL);
+
+    if (*name == '\0') {
+        return *section->name == '\0';
+    }
+
+    return word_prefix(section->name, name);
+}
+
+static void add_section(spec_model_t *spec, const char *name, const size_t start)
+{
+    if (spec->nsections > 0) {
+        spec->sections[spec->nsections - 1].end = start;
+    }
+
+    spec->sections = realloc(spec->sections, (spec->nsections + 1) * sizeof(*spec->sections));
+    assert(spec->sections != NULL);
+    spec->sections[spec->nsections].name = name;
+    spec->sections[spec->nsections].start = start;
+    spec->sections[spec->nsections].end = spec->nlines;
+    spec->nsections++;
+    return;
+}
+
+static void add_tag(spec_tag_t **tags, size_t *ntags, const long num, const char *value, const size_t len, const size_t line)
+{
+    *tags = realloc(*tags, (*ntags + 1) * sizeof(**tags));
+    assert(*tags != NULL);
+    (*tags)[*ntags].num = num;
+    (*tags)[*ntags].line = line;
+
+    if (value == NULL) {
+        (*tags)[*ntags].value = NULL;
+    } else {
+        (*tags)[*ntags].value = strndup(value, len);
+        assert((*tags)[*ntags].value != NULL);
+    }
+
+    (*ntags)++;
+    return;
+}
+
+/*
+ * Parse a 'PatchN: file' or 'SourceN: file' line.  Returns true and
+ * adds the tag if the line starts with the given tag name.
+ */
+static bool parse_tag(spec_tag_t **tags, size_t *ntags, const char *tag, const char *line, const size_t n)
+{
+    long num = 0;
+    char *end = NULL;
+    const char *s = NULL;
+
+    if (!strprefix(line, tag)) {
+        return false;
+    }
+
+    /* unnumbered tags are number 0 */
+    s = line + strlen(tag);
+    errno = 0;
+    num = strtol(s, &end, 10);
+
+    if (errno == ERANGE) {
+        warn("strtol");
+        num = -1;
+    }
+
+    s = end;
+
+    while (isspace(*s)) {
+        s++;
+    }
+
+    if (*s != ':') {
+        return false;
+    }
+
+    s++;
+
+    while (isspace(*s)) {
+        s++;
+    }
+
+    add_tag(tags, ntags, num, s, strcspn(s, " \t"), n);
+    return true;
+}
+
+/*
+ * Parse a %patch line from %prep.  This handles '%patchN', '%patch N',
+ * '%patch -PN', and '%patch -P N'.  A %patch line without a number
+ * applies patch 0.
+ */
+static void parse_patch_macro(spec_model_t *spec, const char *line, const size_t n)
+{
+    long num = 0;
+    const char *s = NULL;
+    const char *arg = NULL;
+    const char *opts = NULL;
+    const char *num_arg = NULL;
+    size_t len = 0;
+
+    if (!strprefix(line, SPEC_MACRO_PATCH)) {
+        return;
+    }
+
+    s = line + strlen(SPEC_MACRO_PATCH);
+
+    if (isdigit(*s)) {
+        /* '%patchN' */
+        num_arg = s;
+
+        while (isdigit(*s)) {
+            s++;
+        }
+    }
+
+    if (*s != '\0' && !isspace(*s)) {
+        warnx("*** Unrecognized %%patch line: %s", line);
+        return;
+    }
+
+    /* everything after the macro name is options */
+    while (isspace(*s)) {
+        s++;
+    }
+
+    opts = s;
+
+    /* look for the patch number in the options */
+    while (num_arg == NULL && *s != '\0') {
+        arg = s;
+        len = strcspn(arg, " \t");
+        s = arg + len;
+
+        while (isspace(*s)) {
+            s++;
+        }
+
+        if (!strncmp(arg, SPEC_MACRO_PATCH_P_ARG, len) && len == strlen(SPEC_MACRO_PATCH_P_ARG)) {
+            /* '-P N' */
+            num_arg = s;
+        } else if (strprefix(arg, SPEC_MACRO_PATCH_P_ARG)) {
+            /* '-PN' */
+            num_arg = arg + strlen(SPEC_MACRO_PATCH_P_ARG);
+        } else if (strspn(arg, "0123456789") == len) {
+            /* 'N' */
+            num_arg = arg;
+        }
+    }
+
+    if (num_arg != NULL) {
+        errno = 0;
+        num = strtol(num_arg, NULL, 10);
+
+        if (errno == ERANGE) {
+            warn("strtol");
+            num = -1;
+        }
+    }
+
+    /* drop trailing whitespace from the options */
+    len = strlen(opts);
+
+    while (len > 0 && isspace(opts[len - 1])) {
+        len--;
+    }
+
+    add_tag(&spec->applied, &spec->napplied, num, (len > 0) ? opts : NULL, len, n);
+    return;
+}
+
+/*
+ * Parse a '%define name value' or '%global name value' line.  Macro
+ * functions, multiline macros, and conditional definitions are not
+ * collected.
+ */
+static void parse_macro(spec_model_t *spec, const char *line)
+{
+    string_list_t *fields = NULL;
+    string_entry_t *keyword = NULL;
+    string_entry_t *name = NULL;
+    string_entry_t *value = NULL;
+    spec_macro_t *macro = NULL;
+
+    if (!strprefix(line, SPEC_MACRO_DEFINE) && !strprefix(line, SPEC_MACRO_GLOBAL)) {
+        return;
+    }
+
+    if (strsuffix(line, "\\")) {
+        return;
+    }
+
+    fields = strsplit(line, " \t");
+
+    if (list_len(fields) != 3) {
+        DEBUG_PRINT("ignoring macro line (possibly a function): '%s'\n", line);
+        list_free(fields, free);
+        return;
+    }
+
+    keyword = TAILQ_FIRST(fields);
+    name = TAILQ_NEXT(keyword, items);
+    value = TAILQ_NEXT(name, items);
+
+    if ((!strcmp(keyword->data, SPEC_MACRO_DEFINE) || !strcmp(keyword->data, SPEC_MACRO_GLOBAL)) && !strsuffix(name->data, ")")) {
+        HASH_FIND_STR(spec->macros, name->data, macro);
+
+        if (macro == NULL) {
+            macro = calloc(1, sizeof(*macro));
+            assert(macro != NULL);
+            macro->name = strdup(name->data);
+            assert(macro->name != NULL);
+            HASH_ADD_KEYPTR(hh, spec->macros, macro->name, strlen(macro->name), macro);
+        }
+
+        DEBUG_PRINT("adding macro '%s' with value=|%s|\n", macro->name, value->data);
+        macro->values = list_add(macro->values, value->data);
+    }
+
+    list_free(fields, free);
+    return;
+}
+
+/* Break the spec file buffer in to lines in place */
+static void split_lines(spec_model_t *spec, const size_t len)
+{
+    size_t size = 0;
+    char *s = spec->buf;
+    char *end = spec->buf + len;
+    char *nl = NULL;
+
+    while (s < end) {
+        nl = memchr(s, '\n', end - s);
+
+        if (nl == NULL) {
+            nl = end;
+        }
+
+        *nl = '\0';
+
+        if (nl > s && *(nl - 1) == '\r') {
+            *(nl - 1) = '\0';
+        }
+
+        if (spec->nlines == size) {
+            size = (size == 0) ? BUFSIZ : size * 2;
+            spec->lines = realloc(spec->lines, size * sizeof(*spec->lines));
+            assert(spec->lines != NULL);
+        }
+
+        spec->lines[spec->nlines++] = s;
+        s = nl + 1;
+    }
+
+    return;
+}
+
+static spec_model_t *parse_spec(const char *specfile)
+{
+    size_t i = 0;
+    off_t len = 0;
+    const char *line = NULL;
+    const spec_section_t *section = NULL;
+    spec_model_t *spec = NULL;
+
+    spec = calloc(1, sizeof(*spec));
+    assert(spec != NULL);
+    spec->path = strdup(specfile);
+    assert(spec->path != NULL);
+
+    /* empty or unreadable spec files give an empty model */
+    spec->buf = read_file_bytes(specfile, &len);
+
+    if (spec->buf != NULL) {
+        split_lines(spec, len);
+    }
+
+    spec->changelog = spec->nlines;
+    add_section(spec, "", 0);
+
+    for (i = 0; i < spec->nlines; i++) {
+        line = spec->lines[i];
+
+        while (isspace(*line)) {
+            line++;
+        }
+
+        if (is_section(line)) {
+            add_section(spec, line, i);
+
+            /* nothing from the changelog on is parsed */
+            if (strprefix(line, SPEC_SECTION_CHANGELOG)) {
+                spec->changelog = i;
+                break;
+            }
+
+            continue;
+        }
+
+        section = &spec->sections[spec->nsections - 1];
+
+        if (spec_section_is(section, "") || spec_section_is(section, SPEC_SECTION_PACKAGE)) {
+            if (!parse_tag(&spec->patches, &spec->npatches, SPEC_TAG_PATCH, line, i)) {
+                parse_tag(&spec->sources, &spec->nsources, SPEC_TAG_SOURCE, line, i);
+            }
+        } else if (spec_section_is(section, SPEC_SECTION_PREP)) {
+            parse_patch_macro(spec, line, i);
+        }
+
+        parse_macro(spec, line);
+    }
+
+    return spec;
+}
+
+/**
+ * @brief Return the parsed model of a spec file.
+ *
+ * The spec file is parsed the first time it is asked for and the
+ * model is cached in the struct rpminspect for the rest of the
+ * program run.  Unreadable spec files give an empty model.
+ *
+ * @param ri The struct rpminspect instance for the program run.
+ * @param specfile The path to the RPM spec file.
+ * @return The spec file model, owned by ri.
+ */
+spec_model_t *get_spec_model(struct rpminspect *ri, const char *specfile)
+{
+    spec_model_t *spec = NULL;
+
+    assert(ri != NULL);
+    assert(specfile != NULL);
+
+    HASH_FIND_STR(ri->specs, specfile, spec);
+
+    if (spec == NULL) {
+        spec = parse_spec(specfile);
+        HASH_ADD_KEYPTR(hh, ri->specs, spec->path, strlen(spec->path), spec);
+    }
+
+    return spec;
+}
+
+/**
+ * @brief Look up a macro defined in a spec file.
+ *
+ * @param spec The spec file model.
+ * @param name The macro name without the leading '%'.
+ * @return The macro or NULL if the spec file does not define it.
+ */
+spec_macro_t *get_spec_macro(const spec_model_t *spec, const char *name)
+{
+    spec_macro_t *macro = NULL;
+
+    assert(spec != NULL);
+
+    if (name == NULL) {
+        return NULL;
+    }
+
+    HASH_FIND_STR(spec->macros, name, macro);
+    return macro;
+}
+
+static void free_tags(spec_tag_t *tags, const size_t ntags)
+{
+    size_t i = 0;
+
+    for (i = 0; i < ntags; i++) {
+        free(tags[i].value);
+    }
+
+    free(tags);
+    return;
+}
+
+/**
+ * @brief Free the table of spec file models.
+ *
+ * @param specs The table of spec file models, may be NULL.
+ */
+void free_spec_models(spec_model_t *specs)
+{
+    spec_model_t *spec = NULL;
+    spec_model_t *tmp_spec = NULL;
+    spec_macro_t *macro = NULL;
+    spec_macro_t *tmp_macro = NULL;
+
+    HASH_ITER(hh, specs, spec, tmp_spec) {
+        HASH_DEL(specs, spec);
+
+        HASH_ITER(hh, spec->macros, macro, tmp_macro) {
+            HASH_DEL(spec->macros, macro);
+            free(macro->name);
+            list_free(macro->values, free);
+            free(macro);
+        }
+
+        free_tags(spec->patches, spec->npatches);
+        free_tags(spec->sources, spec->nsources);
+        free_tags(spec->applied, spec->napplied);
+        free(spec->sections);
+        free(spec->lines);
+        free(spec->buf);
+        free(spec->path);
+        free(spec);
+    }
+
+    return;
+}
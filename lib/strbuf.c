@@ -0,0 +1,193 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Growable string buffer.  Appending to a strbuf_t is amortized
+ * constant time per byte, unlike building a string with repeated
+ * xasprintf() or strappend() calls which copy the whole string each
+ * time.  A strbuf_t needs no setup beyond being zeroed.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <assert.h>
+#include "rpminspect.h"
+
+/* Make room for at least len more bytes plus the NUL */
+static void strbuf_grow(strbuf_t *sb, const size_t len)
+{
+    size_t need = sb->len + len + 1;
+
+    if (need <= sb->size) {
+        return;
+    }
+
+    if (sb->size == 0) {
+        sb->size = BUFSIZ;
+    }
+
+    while (sb->size < need) {
+        sb->size *= 2;
+    }
+
+    sb->data = realloc(sb->data, sb->size);
+    assert(sb->data != NULL);
+    return;
+}
+
+/**
+ * @brief Append len bytes of s to the buffer.
+ *
+ * @param sb The string buffer.
+ * @param s The bytes to append, need not be NUL terminated.
+ * @param len The number of bytes to append.
+ */
+void strbuf_append_len(strbuf_t *sb, const char *s, const size_t len)
+{
+    assert(sb != NULL);
+
+    strbuf_grow(sb, len);
+
+    if (len > 0) {
+        memcpy(sb->data + sb->len, s, len);
+    }
+
+    sb->len += len;
+    sb->data[sb->len] = '\0';
+    return;
+}
+
+/**
+ * @brief Append a string to the buffer.
+ *
+ * @param sb The string buffer.
+ * @param s The string to append, NULL is ignored.
+ */
+void strbuf_append(strbuf_t *sb, const char *s)
+{
+    if (s == NULL) {
+        return;
+    }
+
+    strbuf_append_len(sb, s, strlen(s));
+    return;
+}
+
+/**
+ * @brief Append a printf(3) formatted string to the buffer.
+ *
+ * @param sb The string buffer.
+ * @param fmt The format string.
+ */
+void strbuf_appendf(strbuf_t *sb, const char *fmt, ...)
+{
+    va_list ap;
+    int n = 0;
+
+    assert(sb != NULL);
+    assert(fmt != NULL);
+
+    /* try to format in to the space we already have */
+    strbuf_grow(sb, 0);
+    va_start(ap, fmt);
+    n = vsnprintf(sb->data + sb->len, sb->size - sb->len, fmt, ap);
+    va_end(ap);
+    assert(n >= 0);
+
+    if ((size_t) n >= sb->size - sb->len) {
+        strbuf_grow(sb, n);
+        va_start(ap, fmt);
+        n = vsnprintf(sb->data + sb->len, sb->size - sb->len, fmt, ap);
+        va_end(ap);
+        assert(n >= 0);
+    }
+
+    sb->len += n;
+    return;
+}
+
+/**
+ * @brief Replace every occurrence of find in the buffer.
+ *
+ * The buffer is rewritten in one pass.
+ *
+ * @param sb The string buffer.
+ * @param find The substring to find, must not be empty.
+ * @param replace The replacement, NULL removes find.
+ * @return The number of replacements made.
+ */
+size_t strbuf_replace(strbuf_t *sb, const char *find, const char *replace)
+{
+    strbuf_t out;
+    size_t n = 0;
+    size_t find_len = 0;
+    const char *walk = NULL;
+    const char *match = NULL;
+
+    assert(sb != NULL);
+    assert(find != NULL);
+
+    find_len = strlen(find);
+
+    if (sb->len == 0 || find_len == 0 || strstr(sb->data, find) == NULL) {
+        return 0;
+    }
+
+    memset(&out, 0, sizeof(out));
+    walk = sb->data;
+
+    while ((match = strstr(walk, find)) != NULL) {
+        strbuf_append_len(&out, walk, match - walk);
+        strbuf_append(&out, replace);
+        walk = match + find_len;
+        n++;
+    }
+
+    strbuf_append_len(&out, walk, sb->data + sb->len - walk);
+    free(sb->data);
+    *sb = out;
+    return n;
+}
+
+/**
+ * @brief Return the string built in the buffer and reset the buffer.
+ *
+ * @param sb The string buffer.
+ * @return Newly allocated string, an empty string if nothing was
+ * appended; caller must free.
+ */
+char *strbuf_finish(strbuf_t *sb)
+{
+    char *s = NULL;
+
+    assert(sb != NULL);
+
+    if (sb->data == NULL) {
+        s = strdup("");
+        assert(s != NULL);
+    } else {
+        s = realloc(sb->data, sb->len + 1);
+        assert(s != NULL);
+    }
+
+    memset(sb, 0, sizeof(*sb));
+    return s;
+}
+
+/**
+ * @brief Free the string built in the buffer and reset the buffer.
+ *
+ * @param sb The string buffer.
+ */
+void strbuf_free(strbuf_t *sb)
+{
+    assert(sb != NULL);
+
+    free(sb->data);
+    memset(sb, 0, sizeof(*sb));
+    return;
+}
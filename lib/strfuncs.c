@@ -298,6 +298,66 @@ severity_t getseverity(const char *name, const severity_t default_s)
     return s;
 }
 
+/*
+ * Given a verb_t, return a string representing the value.
+ */
+char *strverb(const verb_t verb)
+{
+    switch (verb) {
+        case VERB_ADDED:
+            return _("added");
+        case VERB_REMOVED:
+            return _("removed");
+        case VERB_CHANGED:
+            return _("changed");
+        case VERB_FAILED:
+            return _("failed");
+        case VERB_OK:
+            return _("ok");
+        case VERB_SKIP:
+            return _("skip");
+        case VERB_TIMEOUT:
+            return _("timeout");
+        default:
+            return _("nil");
+    }
+
+    return NULL;
+}
+
+/*
+ * Given a verb string, return a verb_t matching it.  Or return the
+ * default.
+ */
+verb_t getverb(const char *name, const verb_t default_v)
+{
+    verb_t v = default_v;
+
+    if (name == NULL) {
+        return v;
+    }
+
+    if (!strcasecmp(name, _("added"))) {
+        v = VERB_ADDED;
+    } else if (!strcasecmp(name, _("removed"))) {
+        v = VERB_REMOVED;
+    } else if (!strcasecmp(name, _("changed"))) {
+        v = VERB_CHANGED;
+    } else if (!strcasecmp(name, _("failed"))) {
+        v = VERB_FAILED;
+    } else if (!strcasecmp(name, _("ok"))) {
+        v = VERB_OK;
+    } else if (!strcasecmp(name, _("skip"))) {
+        v = VERB_SKIP;
+    } else if (!strcasecmp(name, _("timeout"))) {
+        v = VERB_TIMEOUT;
+    } else if (!strcasecmp(name, _("nil"))) {
+        v = VERB_NIL;
+    }
+
+    return v;
+}
+
 /*
  * Given a type of waiver authorization, return a string representing it.
  */
@@ -317,6 +377,29 @@ char *strwaiverauth(const waiverauth_t waiverauth)
     return NULL;
 }
 
+/*
+ * Given a waiver authorization string, return a waiverauth_t matching
+ * it.  Or return the default.
+ */
+waiverauth_t getwaiverauth(const char *name, const waiverauth_t default_w)
+{
+    waiverauth_t w = default_w;
+
+    if (name == NULL) {
+        return w;
+    }
+
+    if (!strcasecmp(name, _("Not Waivable"))) {
+        w = NOT_WAIVABLE;
+    } else if (!strcasecmp(name, _("Anyone"))) {
+        w = WAIVABLE_BY_ANYONE;
+    } else if (!strcasecmp(name, _("Security"))) {
+        w = WAIVABLE_BY_SECURITY;
+    }
+
+    return w;
+}
+
 /**
  * @brief Given a string s, find the substring "find", and return a
  * newly allocated string with "find" replaced with "replace".  If
@@ -333,11 +416,7 @@ char *strwaiverauth(const waiverauth_t waiverauth)
  */
 char *strreplace(const char *s, const char *find, const char *replace)
 {
-    const char *find_start;
-    size_t find_len;
-    const char *remainder;
-    char *tmp;
-    char *result = NULL;
+    strbuf_t result;
 
     if (s == NULL) {
         return NULL;
@@ -345,50 +424,11 @@ char *strreplace(const char *s, const char *find, const char *replace)
 
     assert(find != NULL);
 
-    find_len = strlen(find);
-    remainder = s;
-
-    while (*remainder != '\0') {
-        find_start = strstr(remainder, find);
-
-        /*
-         * No more instances of find, concat the rest of the string on to the
-         * result and finish
-         */
-        if (find_start == NULL) {
-            xasprintf(&tmp, "%s%s", result ? result : "", remainder);
-            free(result);
-            result = tmp;
-
-            break;
-        } else {
-            /*
-             * Print the string up to the start of the match, then the
-             * "replace" string.  Reset remainder to the end of the match.
-             */
-            if (replace) {
-                xasprintf(&tmp, "%s%.*s%s", result ? result : "", (int) (find_start - remainder), remainder, replace);
-            } else {
-                xasprintf(&tmp, "%s%.*s", result ? result : "", (int) (find_start - remainder), remainder);
-            }
-
-            free(result);
-            result = tmp;
-
-            remainder = find_start + find_len;
-        }
-    }
-
-    /*
-     * Result could be NULL at this point if the input was an empty string.
-     * In that case, just allocate a new empty string
-     */
-    if (result == NULL) {
-        result = strdup(s);
-        assert(result != NULL);
-    }
+    memset(&result, 0, sizeof(result));
+    strbuf_append(&result, s);
+    strbuf_replace(&result, find, replace);
 
-    return result;
+    return strbuf_finish(&result);
 }
 
 /**
@@ -469,21 +509,37 @@ char *strappend(char *dest, ...)
 {
     va_list sl;
     char *s = NULL;
+    size_t len = 0;
+    size_t total = 0;
+    int count = 0;
 
+    /* size everything first so dest is reallocated once */
+    len = (dest == NULL) ? 0 : strlen(dest);
+    total = len;
     va_start(sl, dest);
 
     while ((s = va_arg(sl, char *)) != NULL) {
-        if (dest == NULL) {
-            dest = strdup(s);
-            assert(dest != NULL);
-        } else {
-            dest = realloc(dest, strlen(dest) + strlen(s) + 1);
-            assert(dest != NULL);
-            dest = strcat(dest, s);
-        }
+        total += strlen(s);
+        count++;
+    }
+
+    va_end(sl);
+
+    if (count == 0) {
+        return dest;
+    }
+
+    dest = realloc(dest, total + 1);
+    assert(dest != NULL);
+    va_start(sl, dest);
+
+    while ((s = va_arg(sl, char *)) != NULL) {
+        memcpy(dest + len, s, strlen(s));
+        len += strlen(s);
     }
 
     va_end(sl);
+    dest[len] = '\0';
 
     return dest;
 }
@@ -0,0 +1,388 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: LGPL-3.0-or-later
+ */
+
+/*
+ * Background removal of working trees.  Removing an unpacked build
+ * can take minutes, so instead of doing it before exiting a tree is
+ * renamed in to a TRASH_DIR next to it, which is instant, and a
+ * detached low priority process deletes the trash after rpminspect
+ * exits.  Trash left behind by a run that crashed is swept up by the
+ * next run.
+ */
+
+#include <assert.h>
+#include <dirent.h>
+#include <err.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <libgen.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <limits.h>
+#include <signal.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+#include "rpminspect.h"
+
+/* trash directories this process put something in */
+static string_list_t *trash_dirs = NULL;
+
+/* working trees trash_signalled() moves to the trash */
+#define MAX_SIGNAL_TREES 4
+static char **signal_trees[MAX_SIGNAL_TREES];
+static volatile sig_atomic_t nsignal_trees = 0;
+
+static void add_trash_dir(const char *dir)
+{
+    string_entry_t *entry = NULL;
+
+    if (trash_dirs != NULL) {
+        TAILQ_FOREACH(entry, trash_dirs, items) {
+            if (!strcmp(entry->data, dir)) {
+                return;
+            }
+        }
+    }
+
+    trash_dirs = list_add(trash_dirs, dir);
+    return;
+}
+
+/* Job function to remove one tree in the reaper */
+static int remove_tree(void *data)
+{
+    return rmtree(data, true, false) ? EXIT_FAILURE : EXIT_SUCCESS;
+}
+
+/*
+ * Empty the trash directories.  Each trashed tree is split in to its
+ * top level entries and those are removed in parallel.  The trash
+ * directories themselves are kept so another run can keep using them.
+ */
+static void empty_trash(const string_list_t *dirs)
+{
+    DIR *d = NULL;
+    DIR *t = NULL;
+    struct dirent *de = NULL;
+    struct dirent *te = NULL;
+    char *tree = NULL;
+    char *path = NULL;
+    string_entry_t *entry = NULL;
+    string_list_t *trees = NULL;
+    string_list_t *paths = NULL;
+    job_list_t *jobs = NULL;
+    job_entry_t *job = NULL;
+
+    jobs = calloc(1, sizeof(*jobs));
+    assert(jobs != NULL);
+    TAILQ_INIT(jobs);
+
+    TAILQ_FOREACH(entry, dirs, items) {
+        if ((d = opendir(entry->data)) == NULL) {
+            continue;
+        }
+
+        while ((de = readdir(d)) != NULL) {
+            if (!strcmp(de->d_name, ".") || !strcmp(de->d_name, "..")) {
+                continue;
+            }
+
+            xasprintf(&tree, "%s/%s", entry->data, de->d_name);
+            trees = list_add(trees, tree);
+
+            if ((t = opendir(tree)) != NULL) {
+                while ((te = readdir(t)) != NULL) {
+                    if (!strcmp(te->d_name, ".") || !strcmp(te->d_name, "..")) {
+                        continue;
+                    }
+
+                    xasprintf(&path, "%s/%s", tree, te->d_name);
+                    paths = list_add(paths, path);
+                    free(path);
+                }
+
+                closedir(t);
+            }
+
+            free(tree);
+        }
+
+        closedir(d);
+    }
+
+    if (paths != NULL) {
+        TAILQ_FOREACH(entry, paths, items) {
+            job = calloc(1, sizeof(*job));
+            assert(job != NULL);
+            job->fn = remove_tree;
+            job->data = entry->data;
+            TAILQ_INSERT_TAIL(jobs, job, items);
+        }
+
+        run_jobs(jobs, online_cpus());
+    }
+
+    /* whatever is left, and the now empty trees */
+    if (trees != NULL) {
+        TAILQ_FOREACH(entry, trees, items) {
+            (void) rmtree(entry->data, true, false);
+        }
+    }
+
+    free_jobs(jobs);
+    list_free(paths, free);
+    list_free(trees, free);
+    return;
+}
+
+/*
+ * Empty the given trash directories in a detached process that
+ * outlives this one.
+ */
+static void spawn_reaper(const string_list_t *dirs)
+{
+    pid_t pid = 0;
+    int fd = -1;
+
+    if (dirs == NULL || TAILQ_EMPTY(dirs)) {
+        return;
+    }
+
+    /* anything buffered would be written twice */
+    fflush(stdout);
+    fflush(stderr);
+
+    pid = fork();
+
+    if (pid == -1) {
+        warn("fork");
+        return;
+    } else if (pid > 0) {
+        /* the middle child exits right away */
+        while (waitpid(pid, NULL, 0) == -1 && errno == EINTR) {
+            ;
+        }
+
+        return;
+    }
+
+    /* detach from the terminal and the process group of the run */
+    if (setsid() == -1 || (pid = fork()) == -1) {
+        _exit(EXIT_FAILURE);
+    } else if (pid > 0) {
+        _exit(EXIT_SUCCESS);
+    }
+
+    fd = open("/dev/null", O_RDWR);
+
+    if (fd != -1) {
+        dup2(fd, STDIN_FILENO);
+        dup2(fd, STDOUT_FILENO);
+        dup2(fd, STDERR_FILENO);
+
+        if (fd > STDERR_FILENO) {
+            close(fd);
+        }
+    }
+
+    /* stay out of the way of whatever runs next */
+    (void) setpriority(PRIO_PROCESS, 0, TRASH_NICE);
+    set_deadline(0);
+    set_memory_budget(0);
+    empty_trash(dirs);
+    _exit(EXIT_SUCCESS);
+}
+
+/**
+ * @brief Remove a directory tree in the background.
+ *
+ * The tree is renamed in to TRASH_DIR in its parent directory and is
+ * deleted by reap_trash().  If it cannot be renamed, for example
+ * because the parent is not writable, it is removed right away with
+ * rmtree().
+ *
+ * @param path The directory tree to remove.
+ * @return 0 on success, non-zero if the tree could not be removed.
+ */
+int trash_tree(const char *path)
+{
+    int r = 0;
+    char *tmp = NULL;
+    char *dir = NULL;
+    char *name = NULL;
+    char *target = NULL;
+    struct stat sb;
+
+    if (path == NULL || lstat(path, &sb) == -1) {
+        return 0;
+    }
+
+    if (!S_ISDIR(sb.st_mode)) {
+        return unlink(path);
+    }
+
+    tmp = strdup(path);
+    assert(tmp != NULL);
+    xasprintf(&dir, "%s/%s", dirname(tmp), TRASH_DIR);
+    free(tmp);
+
+    tmp = strdup(path);
+    assert(tmp != NULL);
+    name = basename(tmp);
+    xasprintf(&target, "%s/%s.XXXXXX", dir, name);
+    free(tmp);
+
+    /* an empty directory is replaced by the rename */
+    if ((mkdir(dir, S_IRWXU) == -1 && errno != EEXIST) || mkdtemp(target) == NULL || rename(path, target) == -1) {
+        if (target != NULL) {
+            (void) rmdir(target);
+        }
+
+        r = rmtree(path, true, false);
+    } else {
+        add_trash_dir(dir);
+    }
+
+    free(target);
+    free(dir);
+    return r;
+}
+
+/**
+ * @brief Delete everything trash_tree() moved to the trash.
+ *
+ * This starts a detached, niced process to do the work and returns
+ * right away.  Call it once, before exiting.  Trees registered with
+ * trash_on_signal() are forgotten.
+ */
+void reap_trash(void)
+{
+    nsignal_trees = 0;
+    spawn_reaper(trash_dirs);
+    list_free(trash_dirs, free);
+    trash_dirs = NULL;
+    return;
+}
+
+/**
+ * @brief Delete trash left in a directory by earlier runs.
+ *
+ * Runs that crashed or were killed never got to empty their trash.
+ * Like reap_trash() this returns right away and deletes the trash in
+ * the background.
+ *
+ * @param parent The directory holding a TRASH_DIR, such as the
+ * workdir.
+ */
+void sweep_trash(const char *parent)
+{
+    char *dir = NULL;
+    string_list_t *dirs = NULL;
+
+    assert(parent != NULL);
+
+    xasprintf(&dir, "%s/%s", parent, TRASH_DIR);
+
+    if (access(dir, F_OK) == 0) {
+        dirs = list_add(dirs, dir);
+        spawn_reaper(dirs);
+        list_free(dirs, free);
+    }
+
+    free(dir);
+    return;
+}
+
+/**
+ * @brief Move a working tree to the trash if the program is killed.
+ *
+ * The path is read when trash_signalled() runs, so it may be set
+ * (or changed) after this call.  The trees are forgotten by
+ * reap_trash().
+ *
+ * @param path Address of the path of the tree, such as
+ * &ri->worksubdir.
+ */
+void trash_on_signal(char **path)
+{
+    assert(path != NULL);
+
+    if (nsignal_trees < MAX_SIGNAL_TREES) {
+        signal_trees[nsignal_trees] = path;
+        nsignal_trees++;
+    }
+
+    return;
+}
+
+/*
+ * Copy src to the end of dst of size PATH_MAX, false if it does not
+ * fit.  Safe to use in a signal handler.
+ */
+static bool append_path(char *dst, const char *src)
+{
+    size_t len = strlen(dst);
+    size_t add = strlen(src);
+
+    if (len + add >= PATH_MAX) {
+        return false;
+    }
+
+    memcpy(dst + len, src, add + 1);
+    return true;
+}
+
+/**
+ * @brief Move the trees given to trash_on_signal() to the trash.
+ *
+ * Each tree is renamed in to TRASH_DIR next to it, where the next run
+ * finds it with sweep_trash().  Only async-signal-safe calls are
+ * used, this is meant for the handler of the signals that end the
+ * program.
+ */
+void trash_signalled(void)
+{
+    sig_atomic_t i = 0;
+    const char *path = NULL;
+    const char *base = NULL;
+    static char dir[PATH_MAX];
+    static char target[PATH_MAX];
+
+    for (i = 0; i < nsignal_trees; i++) {
+        path = *signal_trees[i];
+
+        if (path == NULL || (base = strrchr(path, '/')) == NULL || (size_t) (base - path) >= PATH_MAX) {
+            continue;
+        }
+
+        /* <parent>/TRASH_DIR */
+        memcpy(dir, path, base - path);
+        dir[base - path] = '\0';
+
+        if (!append_path(dir, "/") || !append_path(dir, TRASH_DIR)) {
+            continue;
+        }
+
+        /* <parent>/TRASH_DIR/<name>, the names are already unique */
+        target[0] = '\0';
+
+        if (!append_path(target, dir) || !append_path(target, base)) {
+            continue;
+        }
+
+        if (mkdir(dir, S_IRWXU) == -1 && errno != EEXIST) {
+            continue;
+        }
+
+        (void) rename(path, target);
+    }
+
+    return;
+}
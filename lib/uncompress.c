@@ -13,92 +13,14 @@
 #include "rpminspect.h"
 
 /*
- * Create a temporary file containing the uncompressed contents of the
- * specified file.  If the file is not compressed, this function just
- * duplicates it over to the temporary file location.  The optional
- * subdir may specify a subdirectory in worksubdir where the temporary
- * file should go (the directory will be created if necessary).
- * Useful for files that may or may not be compressed but if they are
- * we want to decompress them first and look at the uncompressed
- * output for changes.  The caller must both unlink the created output
- * file and free the returned string (which is the path to the created
- * output file).
+ * Create a libarchive reader that handles a single file that may or
+ * may not be compressed.
  */
-char *uncompress_file(struct rpminspect *ri, const char *infile, const char *subdir)
+static struct archive *new_uncompress_reader(void)
 {
-    int fd = -1;
-    FILE *fp = NULL;
-    struct stat sb;
-    char *outfile = NULL;
-    char *base = NULL;
-    static int mode = S_IRWXU | S_IRGRP | S_IXGRP | S_IROTH | S_IXOTH;
-    int r = -1;
-    size_t size = 0;
-    void *buf[BUFSIZ];
-    struct archive *input = NULL;
-    struct archive_entry *entry = NULL;
-
-    assert(ri != NULL);
-    assert(ri->workdir != NULL);
-    assert(infile != NULL);
-
-    /* subdirectory where the output file goes */
-    if (subdir == NULL) {
-        outfile = strdup(ri->worksubdir);
-    } else {
-        xasprintf(&outfile, "%s/%s", ri->worksubdir, subdir);
-    }
-
-    assert(outfile != NULL);
-
-    /* see if the output directory exists */
-    errno = 0;
-    r = stat(outfile, &sb);
-
-    if ((r == -1) && (errno != ENOENT)) {
-        warn("stat");
-        goto error1;
-    }
+    struct archive *input = archive_read_new();
 
-    /*
-     * only create the subdirectory if we need it (avoids lots of stat
-     * calls later)
-     */
-    if (errno == ENOENT) {
-        if (mkdirp(outfile, mode) == -1) {
-            warn("mkdirp");
-            goto error1;
-        }
-    }
-
-    free(outfile);
-
-    /* create the output file that will be uncompressed */
-    base = rindex(infile, '/') + 1;
-    assert(base != NULL);
-
-    if (subdir == NULL) {
-        xasprintf(&outfile, "%s/%s.XXXXXX", ri->worksubdir, base);
-    } else {
-        xasprintf(&outfile, "%s/%s/%s.XXXXXX", ri->worksubdir, subdir, base);
-    }
-
-    assert(outfile != NULL);
-
-    fd = mkstemp(outfile);
-
-    if (fd == -1) {
-        warn("mkstemp");
-        goto error1;
-    }
-
-    /*
-     * Read in the input file and uncompress it if necessary.  The
-     * uncompressed data is written to the output file we created and
-     * that is used for later diff(1) calls.  Use libarchive here so
-     * we can handle a wide range of compression formats.
-     */
-    input = archive_read_new();
+    assert(input != NULL);
 
     /* initialize only compression filters in libarchive */
 #if ARCHIVE_VERSION_NUMBER < 3000000
@@ -172,70 +94,83 @@ char *uncompress_file(struct rpminspect *ri, const char *infile, const char *sub
     archive_read_support_format_raw(input);
     archive_read_support_format_empty(input);
 
-    /* open the input file, decompress, and write to output */
-    r = archive_read_open_filename(input, infile, 16384);
+    return input;
+}
+
+/*
+ * Uncompress the specified file in to memory.  If the file is not
+ * compressed, its contents are read as-is.  At most max bytes are
+ * uncompressed (0 means the whole file), so callers that only need to
+ * look at the start of a file do not pay for the rest of it.  The
+ * length of the returned data is written to len.  The returned buffer
+ * is always NUL terminated and the caller must free it.  Returns NULL
+ * on error.
+ */
+char *uncompress_to_memory(const char *infile, const size_t max, size_t *len)
+{
+    int r = -1;
+    char *out = NULL;
+    size_t size = 0;
+    size_t used = 0;
+    size_t want = 0;
+    ssize_t n = 0;
+    struct archive *input = NULL;
+    struct archive_entry *entry = NULL;
 
-    if (r != ARCHIVE_OK) {
-        /* just stop trying to uncompress if this errors */
-        goto error2;
+    assert(infile != NULL);
+    assert(len != NULL);
+
+    *len = 0;
+    input = new_uncompress_reader();
+
+    if (archive_read_open_filename(input, infile, 16384) != ARCHIVE_OK) {
+        archive_read_free(input);
+        return NULL;
     }
 
+    size = (max > 0 && max < BUFSIZ) ? max + 1 : BUFSIZ;
+    out = calloc(1, size);
+    assert(out != NULL);
+
     r = archive_read_next_header(input, &entry);
 
     if (r == ARCHIVE_WARN || r == ARCHIVE_FAILED || r == ARCHIVE_FATAL) {
         warn("archive_read_next_header: %s", archive_error_string(input));
-        goto error2;
+        archive_read_free(input);
+        free(out);
+        return NULL;
     }
 
-    if (r == ARCHIVE_OK) {
-        while (1) {
-            size = archive_read_data(input, buf, BUFSIZ);
+    /* anything else is EOF, which is an empty file */
+    while (r == ARCHIVE_OK && (max == 0 || used < max)) {
+        if (used + 1 == size) {
+            size *= 2;
+            out = realloc(out, size);
+            assert(out != NULL);
+        }
 
-            if (size == 0) {
-                break;
-            }
+        want = size - used - 1;
 
-            if (write(fd, buf, size) == -1) {
-                warn("write");
-                goto error2;
-            }
+        if (max > 0 && want > max - used) {
+            want = max - used;
         }
-    } else {
-        /* we hit an EOF or non-existent file, write an empty file */
-        fp = fdopen(fd, "w");
 
-        if (fp == NULL) {
-            warn("fdopen");
-            goto error2;
-        }
+        n = archive_read_data(input, out + used, want);
 
-        /*
-         * NOTE: calling fclose() closes the underlying file
-         * descriptor, so after this call make no calls to close() on
-         * the fd
-         */
-        if (fclose(fp) == -1) {
-            warn("fclose");
-            goto error2;
+        if (n < 0) {
+            warnx("archive_read_data: %s", archive_error_string(input));
+            archive_read_free(input);
+            free(out);
+            return NULL;
+        } else if (n == 0) {
+            break;
         }
 
-        fd = 0;
+        used += n;
     }
 
     archive_read_free(input);
-
-    /* close up our uncompressed file */
-    if (fd && close(fd) == -1) {
-        warn("close");
-        goto error1;
-    }
-
-    return outfile;
-
-error2:
-    close(fd);
-
-error1:
-    free(outfile);
-    return NULL;
+    out[used] = '\0';
+    *len = used;
+    return out;
 }
@@ -12,6 +12,7 @@
 #include <sys/types.h>
 #include <sys/stat.h>
 #include <sys/ioctl.h>
+#include <sys/resource.h>
 #include <signal.h>
 #include <unistd.h>
 #include <string.h>
@@ -31,6 +32,13 @@ extern int strverscmp (const char *, const char *);
 
 #include "rpminspect.h"
 
+/* getopt_long() value of options with no short form */
+#define DEADLINE_OPT 256
+#define FAIL_FAST_OPT 257
+#define PLAN_SHARDS_OPT 258
+#define SHARD_OPT 259
+#define MERGE_OPT 260
+
 void sigabrt_handler(__attribute__ ((unused)) int i)
 {
     rpmFreeRpmrc();
@@ -43,10 +51,35 @@ void sigwinch_handler(__attribute__ ((unused)) int i)
     return;
 }
 
+/* the process that installed sigterm_handler(), not a forked job */
+static pid_t main_pid = 0;
+
+/*
+ * Handler for the signals that end the program.  The inspections and
+ * commands running in child processes, some in their own process
+ * groups, would otherwise keep running without us, so they are
+ * killed first and the working trees moved to the trash.  Then the
+ * signal is raised again to end the program as it would have.
+ */
+void sigterm_handler(int i)
+{
+    int saved = errno;
+
+    if (getpid() == main_pid) {
+        kill_jobs();
+        trash_signalled();
+    }
+
+    errno = saved;
+    signal(i, SIG_DFL);
+    raise(i);
+    return;
+}
+
 static void usage(void)
 {
     printf(_("Compare package builds for policy compliance and consistency.\n\n"));
-    printf(_("Usage: %s [OPTIONS] [before build] [after build]\n"), COMMAND_NAME);
+    printf(_("Usage: %s [OPTIONS] [before build...] [after build]\n"), COMMAND_NAME);
     printf(_("Options:\n"));
     printf(_("  -c FILE, --config=FILE      Configuration file to use\n"));
     printf(_("  -p NAME, --profile=NAME     Configuration profile to use\n"));
@@ -72,6 +105,20 @@ static void usage(void)
     printf(_("  -f, --fetch-only            Fetch builds only, do not perform inspections\n"));
     printf(_("                                (implies -k)\n"));
     printf(_("  -k, --keep                  Do not remove the comparison working files\n"));
+    printf(_("  -R FILE, --reuse=FILE       Reuse unchanged results from a previous\n"));
+    printf(_("                                JSON results FILE\n"));
+    printf(_("  -j N, --jobs=N              Run up to N inspections at once, 'auto'\n"));
+    printf(_("                                fits them to the CPUs and memory\n"));
+    printf(_("                                available (default: 1)\n"));
+    printf(_("  --deadline=SECS             Stop inspecting after SECS seconds and\n"));
+    printf(_("                                report what finished\n"));
+    printf(_("  --fail-fast                 Run the quickest inspections first and\n"));
+    printf(_("                                stop at the first failure\n"));
+    printf(_("  --plan-shards=N             Split the inspections in to N shard\n"));
+    printf(_("                                manifests written to the -o directory\n"));
+    printf(_("  --shard=FILE                Run the inspections of shard manifest FILE\n"));
+    printf(_("  --merge                     Merge the JSON results of the shards\n"));
+    printf(_("                                given as arguments\n"));
     printf(_("  -d, --debug                 Debugging mode output\n"));
     printf(_("  -D, --dump-config           Dump configuration settings (in YAML format)\n"));
     printf(_("  -v, --verbose               Verbose inspection output\n"));
@@ -313,6 +360,7 @@ int main(int argc, char **argv)
 {
     struct sigaction abrt;
     struct sigaction winch;
+    struct sigaction term;
     int c = 0;
     int i = 0;
     int j = 0;
@@ -320,7 +368,7 @@ int main(int argc, char **argv)
     int ret = RI_SUCCESS;
     wordexp_t expand;
     struct stat sb;
-    char *short_options = "c:p:T:E:a:r:nb:o:F:lw:t:s:fkdDv\?V";
+    char *short_options = "c:p:T:E:a:r:nb:o:F:lw:t:s:fkR:j:dDv\?V";
     struct option long_options[] = {
         { "config", required_argument, 0, 'c' },
         { "profile", required_argument, 0, 'p' },
@@ -338,6 +386,13 @@ int main(int argc, char **argv)
         { "suppress", required_argument, 0, 's' },
         { "fetch-only", no_argument, 0, 'f' },
         { "keep", no_argument, 0, 'k' },
+        { "reuse", required_argument, 0, 'R' },
+        { "jobs", required_argument, 0, 'j' },
+        { "deadline", required_argument, 0, DEADLINE_OPT },
+        { "fail-fast", no_argument, 0, FAIL_FAST_OPT },
+        { "plan-shards", required_argument, 0, PLAN_SHARDS_OPT },
+        { "shard", required_argument, 0, SHARD_OPT },
+        { "merge", no_argument, 0, MERGE_OPT },
         { "debug", no_argument, 0, 'd' },
         { "dump-config", no_argument, 0, 'D' },
         { "verbose", no_argument, 0, 'v' },
@@ -351,9 +406,9 @@ int main(int argc, char **argv)
     bool initialized = false;
     char *archopt = NULL;
     char *walk = NULL;
+    char *end = NULL;
     char *token = NULL;
     char *cwd = NULL;
-    char *r = NULL;
     char *output = NULL;
     char *release = NULL;
     bool rebase_detection = true;
@@ -362,7 +417,24 @@ int main(int argc, char **argv)
     char *suppress = NULL;
     int formatidx = -1;
     bool fetch_only = false;
+    string_list_t *fetch_specs = NULL;
+    string_list_t *baselines = NULL;
+    string_entry_t *baseline = NULL;
     bool keep = false;
+    char *reuse = NULL;
+    char *history = NULL;
+    char *memdir = NULL;
+    unsigned long jobs = 1;
+    unsigned long memory = 0;
+    struct rusage self;
+    unsigned long deadline = 0;
+    bool fail_fast = false;
+    unsigned long shards = 0;
+    char *shard = NULL;
+    bool merge = false;
+    string_list_t *shard_results = NULL;
+    results_t *merged = NULL;
+    severity_t worst = RESULT_NULL;
     bool list = false;
     bool verbose = false;
     bool dump_config = false;
@@ -384,7 +456,6 @@ int main(int argc, char **argv)
     struct result_params params;
     size_t cmdlen = 0;
     char *tail = NULL;
-    bool ires = false;
     string_list_t *diags = NULL;
     struct rpminspect *ri = NULL;
 
@@ -403,6 +474,15 @@ int main(int argc, char **argv)
     winch.sa_flags = 0;
     sigaction(SIGWINCH, &winch, NULL);
 
+    /* SIGINT, SIGTERM, and SIGHUP handler to stop the child processes */
+    main_pid = getpid();
+    term.sa_handler = sigterm_handler;
+    sigemptyset(&term.sa_mask);
+    term.sa_flags = 0;
+    sigaction(SIGINT, &term, NULL);
+    sigaction(SIGTERM, &term, NULL);
+    sigaction(SIGHUP, &term, NULL);
+
     /* Set up the i18n environment */
     setlocale(LC_ALL, "");
     bindtextdomain("rpminspect", "/usr/share/locale/");
@@ -519,6 +599,52 @@ int main(int argc, char **argv)
             case 'k':
                 keep = true;
                 break;
+            case 'R':
+                reuse = strdup(optarg);
+                break;
+            case 'j':
+                if (!strcmp(optarg, JOBS_AUTO)) {
+                    jobs = 0;
+                    break;
+                }
+
+                errno = 0;
+                jobs = strtoul(optarg, &end, 10);
+
+                if (errno != 0 || end == optarg || *end != '\0' || jobs == 0 || jobs > UINT_MAX) {
+                    errx(RI_PROGRAM_ERROR, _("*** Invalid number of jobs: `%s`."), optarg);
+                }
+
+                break;
+            case DEADLINE_OPT:
+                errno = 0;
+                deadline = strtoul(optarg, &end, 10);
+
+                if (errno != 0 || end == optarg || *end != '\0' || deadline == 0 || deadline > UINT_MAX) {
+                    errx(RI_PROGRAM_ERROR, _("*** Invalid deadline: `%s`."), optarg);
+                }
+
+                /* counted from the start so fetching the builds uses it up too */
+                set_deadline(deadline);
+                break;
+            case FAIL_FAST_OPT:
+                fail_fast = true;
+                break;
+            case PLAN_SHARDS_OPT:
+                errno = 0;
+                shards = strtoul(optarg, &end, 10);
+
+                if (errno != 0 || end == optarg || *end != '\0' || shards == 0 || shards > UINT_MAX) {
+                    errx(RI_PROGRAM_ERROR, _("*** Invalid number of shards: `%s`."), optarg);
+                }
+
+                break;
+            case SHARD_OPT:
+                shard = strdup(optarg);
+                break;
+            case MERGE_OPT:
+                merge = true;
+                break;
             case 'd':
                 set_debug_mode(true);
                 break;
@@ -599,10 +725,46 @@ int main(int argc, char **argv)
         exit(RI_SUCCESS);
     }
 
+    /* combine the results of the shards of a run and exit */
+    if (merge) {
+        if (optind >= argc) {
+            warnx(_("*** No shard results to merge."));
+            errx(RI_PROGRAM_ERROR, _("*** See `%s --help` for more information."), COMMAND_NAME);
+        }
+
+        for (i = optind; i < argc; i++) {
+            shard_results = list_add(shard_results, argv[i]);
+        }
+
+        merged = merge_shard_results(shard_results, &worst);
+        list_free(shard_results, free);
+
+        if (merged == NULL) {
+            errx(RI_PROGRAM_ERROR, _("*** Unable to merge the shard results."));
+        }
+
+        if (formatidx == -1) {
+            formatidx = 0;                 /* default to 'text' output */
+        }
+
+        formats[formatidx].driver(merged, output, getseverity(threshold, RESULT_VERIFY), getseverity(suppress, RESULT_NULL));
+        ret = (worst >= getseverity(threshold, RESULT_VERIFY)) ? RI_INSPECTION_FAILURE : RI_SUCCESS;
+
+        free_results(merged);
+        free(output);
+        free(threshold);
+        free(suppress);
+        free(cfgfile);
+        free(profile);
+        return ret;
+    }
+
     /* Set up the main program data structure */
     ri = calloc_rpminspect(ri);
     ri->progname = strdup(argv[0]);
     ri->verbose = verbose;
+    ri->jobs = (jobs == 0) ? online_cpus() : jobs;
+    ri->fail_fast = fail_fast;
     ri->rebase_detection = rebase_detection;
 
     /*
@@ -695,6 +857,20 @@ int main(int argc, char **argv)
         free(tmp);
     }
 
+    /* a shard worker runs the inspections its manifest lists */
+    if (shard != NULL) {
+        if (inspection_opt) {
+            warnx(_("*** Ignoring -T and -E with --shard"));
+        }
+
+        if (!read_shard_manifest(ri, shard)) {
+            free_rpminspect(ri);
+            errx(RI_PROGRAM_ERROR, _("*** Unable to read shard manifest %s"), shard);
+        }
+
+        free(shard);
+    }
+
     /* Handle user-specified working directory */
     if (cwd == NULL && fetch_only) {
         /* no workdir specified, but fetch only requested, default to cwd */
@@ -710,7 +886,7 @@ int main(int argc, char **argv)
 
     /* Display the configuration settings for this run */
     if (dump_config) {
-        dump_cfg(ri);
+        dump_cfg(stdout, ri);
     }
 
     /*
@@ -726,6 +902,20 @@ int main(int argc, char **argv)
             /* we got a before and after build */
             ri->before = strdup(argv[optind]);
             ri->after = strdup(argv[optind + 1]);
+        } else if ((optind + 1) < (argc - 1)) {
+            /* one after build against each of several before builds */
+            for (i = optind; i < (argc - 1); i++) {
+                baselines = list_add(baselines, argv[i]);
+            }
+
+            ri->before = strdup(argv[optind]);
+            ri->after = strdup(argv[argc - 1]);
+
+            if (reuse != NULL) {
+                warnx(_("*** Ignoring -R with more than one before build"));
+                free(reuse);
+                reuse = NULL;
+            }
         } else {
             free_rpminspect(ri);
 
@@ -738,6 +928,24 @@ int main(int argc, char **argv)
         }
     }
 
+    /* split the inspections for the shard workers and exit */
+    if (shards > 0) {
+        history = ri->use_history ? get_history_file() : NULL;
+
+        if (history != NULL) {
+            (void) read_history(ri, history);
+            free(history);
+        }
+
+        ret = write_shard_manifests(ri, shards, (output == NULL) ? "." : output) ? RI_SUCCESS : RI_PROGRAM_ERROR;
+
+        free(output);
+        free(reuse);
+        list_free(baselines, free);
+        free_rpminspect(ri);
+        return ret;
+    }
+
     /* initialize librpm, we'll be using it */
     if (init_librpm(ri) != RPMRC_OK) {
         errx(RI_PROGRAM_ERROR, _("*** unable to read RPM configuration"));
@@ -792,30 +1000,41 @@ int main(int argc, char **argv)
         errx(RI_PROGRAM_ERROR, _("*** Unable to create directory %s"), ri->workdir);
     }
 
+    /* a killed run leaves its working directories in the trash */
+    if (!fetch_only && !keep) {
+        trash_on_signal(&ri->worksubdir);
+        trash_on_signal(&ri->spilldir);
+    }
+
+    /* remove what crashed runs left behind */
+    sweep_trash(ri->workdir);
+    memdir = get_memory_workdir(false);
+
+    if (memdir != NULL) {
+        sweep_trash(memdir);
+        free(memdir);
+    }
+
     /* validate and gather the builds specified */
     if (fetch_only) {
-        /* iterate over each specified build and fetch it */
+        /* resolve every specified build, then download them together */
         for (i = optind; i < argc; i++) {
-            ri->after = strdup(argv[i]);
-            assert(ri->after != NULL);
-            j = gather_builds(ri, true);
+            fetch_specs = list_add(fetch_specs, argv[i]);
+        }
 
-            if (j) {
-                free_rpminspect(ri);
-                rpmFreeMacros(NULL);
-                rpmFreeRpmrc();
+        j = (fetch_specs == NULL) ? 0 : fetch_builds(ri, fetch_specs);
+        list_free(fetch_specs, free);
 
-                if (j > 0) {
-                    errx(j, "%s", strexitcode(j));
-                } else {
-                    exit(j);
-                }
-            }
+        if (j) {
+            free_rpminspect(ri);
+            rpmFreeMacros(NULL);
+            rpmFreeRpmrc();
 
-            free(ri->after);
-            ri->after = NULL;
-            free(ri->worksubdir);
-            ri->worksubdir = NULL;
+            if (j > 0) {
+                errx(j, "%s", strexitcode(j));
+            } else {
+                exit(j);
+            }
         }
 
         free_rpminspect(ri);
@@ -871,7 +1090,6 @@ int main(int argc, char **argv)
     add_result_entry(&ri->results, &params);
     free(params.msg);
     free(params.details);
-    list_free(diags, free);
 
     /* add command line information to the results output */
     xasprintf(&params.msg, _("Command line arguments used to invoke %s."), COMMAND_NAME);
@@ -896,6 +1114,18 @@ int main(int argc, char **argv)
     free(params.msg);
     free(params.details);
 
+    /* name the shard so --merge can tell if any are missing */
+    if (ri->shards > 0) {
+        xasprintf(&params.msg, _("Shard %u of %u of a sharded run."), ri->shard, ri->shards);
+        params.details = NULL;
+        xasprintf(&tmp, SHARD_NOUN, ri->shard, ri->shards);
+        params.noun = tmp;
+        add_result_entry(&ri->results, &params);
+        free(params.msg);
+        free(tmp);
+        params.noun = NULL;
+    }
+
     /* report optional local configuration file */
     if (ri->localcfg && ri->locallines && !TAILQ_EMPTY(ri->locallines)) {
         xasprintf(&params.msg, _("Local configuration file: %s"), ri->localcfg);
@@ -955,49 +1185,65 @@ int main(int argc, char **argv)
             }
         }
 
-        for (i = 0; inspections[i].name != NULL; i++) {
-            /* test not selected by user */
-            if (!(ri->tests & inspections[i].flag)) {
-                /*
-                 * tell the user this inspection is skipped when in
-                 * verbose mode
-                 */
-                if (verbose) {
-                    xasprintf(&r, _("Skipping %s inspection..."), inspections[i].name);
-                    assert(r != NULL);
-                    printf("%-36s", r);
-                    free(r);
+        /* fingerprint the inspection inputs for JSON output and reuse */
+        if (reuse != NULL || formatidx == FORMAT_JSON) {
+            compute_fingerprints(ri, diags);
 
-                    printf("%5s\n", _("skip"));
-                }
+            if (reuse != NULL && !read_previous_results(ri, reuse)) {
+                warnx(_("*** Running all inspections"));
+            }
+        }
 
-                /* add a skipped result for this inspection */
-                init_result_params(&params);
-                params.header = inspections[i].name;
-                params.severity = RESULT_SKIP;
-                params.verb = VERB_SKIP;
-                add_result(ri, &params);
+        /* predict inspection runtimes from previous runs to schedule them */
+        history = (ri->use_history && (ri->jobs > 1 || ri->fail_fast)) ? get_history_file() : NULL;
 
-                /* next inspection */
-                continue;
-            }
+        if (history != NULL) {
+            (void) read_history(ri, history);
+            free(history);
+        }
 
-            /* inspection requires before/after builds and we have one */
-            if (ri->before == NULL && !inspections[i].single_build) {
-                continue;
-            }
+        set_command_timeout(ri->command_timeout);
 
-            if (verbose) {
-                xasprintf(&r, _("Running %s inspection..."), inspections[i].name);
-                assert(r != NULL);
-                printf("%-36s", r);
-                free(r);
-            }
+        /* -j auto also keeps the inspections within the memory left */
+        if (jobs == 0 && getrusage(RUSAGE_SELF, &self) == 0) {
+            memory = available_memory();
+            set_memory_budget((memory > (unsigned long) self.ru_maxrss) ? memory - self.ru_maxrss : memory);
+        }
 
-            ires = inspections[i].driver(ri);
+        (void) run_inspections(ri);
 
-            if (verbose) {
-                printf("%5s\n", ires ? _("pass") : _("FAIL"));
+        /* compare the same after build against each other before build */
+        if (baselines != NULL) {
+            set_results_baseline(ri->results, ri->before);
+            baseline = TAILQ_NEXT(TAILQ_FIRST(baselines), items);
+
+            while (baseline != NULL && !(ri->fail_fast && ri->worst_result >= ri->threshold)) {
+                if (verbose) {
+                    printf(_("\nComparing with %s\n"), baseline->data);
+                }
+
+                j = gather_baseline(ri, baseline->data);
+
+                if (j) {
+                    list_free(baselines, free);
+                    free_rpminspect(ri);
+                    rpmFreeMacros(NULL);
+                    rpmFreeRpmrc();
+
+                    if (j > 0) {
+                        errx(j, "%s", strexitcode(j));
+                    } else {
+                        exit(j);
+                    }
+                }
+
+                if (formatidx == FORMAT_JSON) {
+                    compute_fingerprints(ri, diags);
+                }
+
+                (void) run_inspections(ri);
+                set_results_baseline(ri->results, ri->before);
+                baseline = TAILQ_NEXT(baseline, items);
             }
         }
 
@@ -1026,12 +1272,22 @@ int main(int argc, char **argv)
     if (!fetch_only) {
         if (keep) {
             printf(_("\nKeeping working directory: %s\n"), ri->worksubdir);
+
+            if (ri->spilldir != NULL && access(ri->spilldir, F_OK) == 0) {
+                printf(_("Keeping spilled files: %s\n"), ri->spilldir);
+            }
         } else {
-            /* remove the working directories we can */
-            (void) rmtree(ri->worksubdir, true, false);
+            /* remove the working directories we can, in the background */
+            (void) trash_tree(ri->worksubdir);
+            (void) trash_tree(ri->spilldir);
         }
     }
 
+    reap_trash();
+
+    list_free(diags, free);
+    list_free(baselines, free);
+    free(reuse);
     free_rpminspect(ri);
     rpmFreeMacros(NULL);
     rpmFreeRpmrc();
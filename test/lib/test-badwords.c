@@ -11,6 +11,7 @@
 #include "test-main.h"
 
 string_list_t *forbidden_words = NULL;
+matcher_t *badwords = NULL;
 
 int init_test_badwords(void) {
     string_entry_t *entry;
@@ -51,30 +52,42 @@ int init_test_badwords(void) {
     entry->data = strdup("qux");
     TAILQ_INSERT_TAIL(forbidden_words, entry, items);
 
+    /* compile the list the way init_rpminspect() does */
+    if ((badwords = list_to_matcher(forbidden_words, MATCHER_SUBSTRING, true)) == NULL) {
+        return -1;
+    }
+
     return 0;
 }
 
 int clean_test_badwords(void) {
+    free_matcher(badwords);
     list_free(forbidden_words, free);
     return 0;
 }
 
 void test_has_bad_word(void) {
-    RI_ASSERT(has_bad_word("foo", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("bar", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("baz", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("qux", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("flargenblarfle", forbidden_words) == false);
-    RI_ASSERT(has_bad_word("cocacola", forbidden_words) == false);
-    RI_ASSERT(has_bad_word("suse", forbidden_words) == false);
-    RI_ASSERT(has_bad_word("supermonkeyball", forbidden_words) == false);
+    RI_ASSERT(has_bad_word("foo", badwords) == true);
+    RI_ASSERT(has_bad_word("bar", badwords) == true);
+    RI_ASSERT(has_bad_word("baz", badwords) == true);
+    RI_ASSERT(has_bad_word("qux", badwords) == true);
+    RI_ASSERT(has_bad_word("flargenblarfle", badwords) == false);
+    RI_ASSERT(has_bad_word("cocacola", badwords) == false);
+    RI_ASSERT(has_bad_word("suse", badwords) == false);
+    RI_ASSERT(has_bad_word("supermonkeyball", badwords) == false);
 
     /* Ensure bad words match at the start or end of a word, but not the middle */
-    RI_ASSERT(has_bad_word("bazzing", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("is bazzing", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("motherbaz", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("motherbaz other words", forbidden_words) == true);
-    RI_ASSERT(has_bad_word("bebazzled", forbidden_words) == false);
+    RI_ASSERT(has_bad_word("bazzing", badwords) == true);
+    RI_ASSERT(has_bad_word("is bazzing", badwords) == true);
+    RI_ASSERT(has_bad_word("motherbaz", badwords) == true);
+    RI_ASSERT(has_bad_word("motherbaz other words", badwords) == true);
+    RI_ASSERT(has_bad_word("bebazzled", badwords) == false);
+
+    /* Matching ignores case and looks past a match in the middle of a word */
+    RI_ASSERT(has_bad_word("Foo", badwords) == true);
+    RI_ASSERT(has_bad_word("is QUXing", badwords) == true);
+    RI_ASSERT(has_bad_word("bebazzled baz", badwords) == true);
+    RI_ASSERT(has_bad_word("foo", NULL) == false);
 }
 
 CU_pSuite get_suite(void) {
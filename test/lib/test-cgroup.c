@@ -0,0 +1,126 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static char root[] = "/tmp/test-cgroup-XXXXXX";
+
+/* files created under root, removed in reverse order */
+static const char *paths[] = {
+    "/user.slice",
+    "/user.slice/cpu.max",
+    "/user.slice/memory.max",
+    "/user.slice/worker",
+    "/user.slice/worker/cpu.max",
+    "/user.slice/worker/memory.max",
+    NULL
+};
+
+static const char *contents[] = {
+    NULL,
+    "400000 100000\n",
+    "8589934592\n",
+    NULL,
+    "150000 100000\n",
+    "max\n",
+    NULL
+};
+
+int init_test_cgroup(void) {
+    int i = 0;
+    char *fn = NULL;
+    FILE *fp = NULL;
+
+    if (mkdtemp(root) == NULL) {
+        return -1;
+    }
+
+    for (i = 0; paths[i] != NULL; i++) {
+        xasprintf(&fn, "%s%s", root, paths[i]);
+
+        if (contents[i] == NULL) {
+            if (mkdir(fn, 0700) == -1) {
+                free(fn);
+                return -1;
+            }
+        } else {
+            fp = fopen(fn, "w");
+
+            if (fp == NULL) {
+                free(fn);
+                return -1;
+            }
+
+            fputs(contents[i], fp);
+            fclose(fp);
+        }
+
+        free(fn);
+    }
+
+    return 0;
+}
+
+int clean_test_cgroup(void) {
+    int i = 0;
+    char *fn = NULL;
+
+    while (paths[i] != NULL) {
+        i++;
+    }
+
+    while (i-- > 0) {
+        xasprintf(&fn, "%s%s", root, paths[i]);
+        remove(fn);
+        free(fn);
+    }
+
+    rmdir(root);
+    return 0;
+}
+
+void test_get_cgroup_cpus(void) {
+    /* 1.5 CPUs rounds up, the parent allows 4 */
+    RI_ASSERT_EQUAL(get_cgroup_cpus(root, "/user.slice/worker"), 2);
+    RI_ASSERT_EQUAL(get_cgroup_cpus(root, "/user.slice"), 4);
+
+    /* no limit anywhere */
+    RI_ASSERT_EQUAL(get_cgroup_cpus(root, ""), 0);
+    RI_ASSERT_EQUAL(get_cgroup_cpus(root, "/missing"), 0);
+}
+
+void test_get_cgroup_memory(void) {
+    /* "max" on the cgroup itself, the parent limit applies */
+    RI_ASSERT_EQUAL(get_cgroup_memory(root, "/user.slice/worker"), 8589934592ULL);
+    RI_ASSERT_EQUAL(get_cgroup_memory(root, ""), 0);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("cgroup", init_test_cgroup, clean_test_cgroup);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test get_cgroup_cpus()", test_get_cgroup_cpus) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test get_cgroup_memory()", test_get_cgroup_memory) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
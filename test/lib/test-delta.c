@@ -0,0 +1,281 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+/* 100 numbered lines, every tenth one changed in the after version */
+static char *numbered_lines(const bool after)
+{
+    int i = 0;
+    strbuf_t sb;
+
+    memset(&sb, 0, sizeof(sb));
+
+    for (i = 0; i < 100; i++) {
+        strbuf_appendf(&sb, "line %d%s\n", i, (after && i % 10 == 5) ? " changed" : "");
+    }
+
+    return strbuf_finish(&sb);
+}
+
+/* Number of hunks in a diff */
+static int count_hunks(const char *delta)
+{
+    int r = 0;
+    const char *p = delta;
+
+    while (p != NULL) {
+        if (!strncmp(p, "@@ ", 3)) {
+            r++;
+        }
+
+        p = strchr(p, '\n');
+
+        if (p != NULL) {
+            p++;
+        }
+    }
+
+    return r;
+}
+
+/*
+ * Check that a truncated diff is the start of the whole one, ending
+ * on a whole line, followed by the given note about the rest.
+ */
+static void check_truncated(const char *delta, const char *full, const char *note, const size_t max_bytes)
+{
+    size_t cut = 0;
+    const char *last = NULL;
+    char *expected = NULL;
+
+    last = strrchr(delta, '\n');
+    RI_ASSERT_PTR_NOT_NULL(last);
+
+    if (last == NULL) {
+        return;
+    }
+
+    cut = last - delta;
+    RI_ASSERT_TRUE(max_bytes == 0 || cut + 1 <= max_bytes);
+    RI_ASSERT_TRUE(cut < strlen(full));
+    RI_ASSERT_EQUAL(strncmp(delta, full, cut), 0);
+    RI_ASSERT_EQUAL(full[cut], '\n');
+
+    /* the trailing newline of the whole diff is dropped too */
+    xasprintf(&expected, note, strlen(full) - cut);
+    RI_ASSERT_STRING_EQUAL(last + 1, expected);
+    free(expected);
+    return;
+}
+
+void test_delta_lines(void) {
+    char *delta = NULL;
+    const char *before = "1\n2\n3\n4\n5\n6\n7\n";
+    const char *after = "1\n2\n3\n4\nx\n6\n7\n";
+
+    /* no differences */
+    RI_ASSERT_PTR_NULL(get_buffer_delta(before, strlen(before), before, strlen(before), NULL));
+    RI_ASSERT_PTR_NULL(get_buffer_delta(NULL, 0, "", 0, NULL));
+
+    delta = get_buffer_delta(before, strlen(before), after, strlen(after), NULL);
+    RI_ASSERT_PTR_NOT_NULL(delta);
+
+    if (delta != NULL) {
+        RI_ASSERT_STRING_EQUAL(delta, "@@ -2,6 +2,6 @@\n 2\n 3\n 4\n-5\n+x\n 6\n 7");
+    }
+
+    free(delta);
+
+    /* no "\ No newline at end of file" marker */
+    delta = get_buffer_delta("a", 1, "b", 1, NULL);
+    RI_ASSERT_PTR_NOT_NULL(delta);
+
+    if (delta != NULL && strchr(delta, '\n') != NULL) {
+        RI_ASSERT_STRING_EQUAL(strchr(delta, '\n') + 1, "-a\n+b");
+    }
+
+    free(delta);
+}
+
+void test_delta_max_hunks(void) {
+    char *before = numbered_lines(false);
+    char *after = numbered_lines(true);
+    char *full = NULL;
+    char *delta = NULL;
+    delta_opts_t opts = { 0, 0, false };
+
+    full = get_buffer_delta(before, strlen(before), after, strlen(after), &opts);
+    RI_ASSERT_PTR_NOT_NULL(full);
+    RI_ASSERT_EQUAL(count_hunks(full), 10);
+    RI_ASSERT_PTR_NULL(strstr(full, "[diff truncated"));
+
+    /* the hunks past the limit are dropped whole */
+    opts.max_hunks = 2;
+    delta = get_buffer_delta(before, strlen(before), after, strlen(after), &opts);
+    RI_ASSERT_PTR_NOT_NULL(delta);
+
+    if (full != NULL && delta != NULL) {
+        RI_ASSERT_EQUAL(count_hunks(delta), 2);
+        check_truncated(delta, full, "[diff truncated: 2 of 10 hunks shown, %zu bytes omitted]", 0);
+    }
+
+    free(delta);
+
+    /* the limit is not reached */
+    opts.max_hunks = 10;
+    delta = get_buffer_delta(before, strlen(before), after, strlen(after), &opts);
+    RI_ASSERT_PTR_NOT_NULL(delta);
+
+    if (full != NULL && delta != NULL) {
+        RI_ASSERT_STRING_EQUAL(delta, full);
+    }
+
+    free(delta);
+    free(full);
+    free(before);
+    free(after);
+}
+
+void test_delta_max_bytes(void) {
+    char *before = numbered_lines(false);
+    char *after = numbered_lines(true);
+    char *full = NULL;
+    char *delta = NULL;
+    delta_opts_t opts = { 0, 0, false };
+
+    full = get_buffer_delta(before, strlen(before), after, strlen(after), &opts);
+    RI_ASSERT_PTR_NOT_NULL(full);
+
+    opts.max_bytes = 100;
+    delta = get_buffer_delta(before, strlen(before), after, strlen(after), &opts);
+    RI_ASSERT_PTR_NOT_NULL(delta);
+
+    if (full != NULL && delta != NULL) {
+        check_truncated(delta, full, "[diff truncated: %zu bytes omitted]", opts.max_bytes);
+    }
+
+    free(delta);
+
+    /* the default limits leave a small diff alone */
+    delta = get_buffer_delta(before, strlen(before), after, strlen(after), NULL);
+    RI_ASSERT_PTR_NOT_NULL(delta);
+
+    if (full != NULL && delta != NULL) {
+        RI_ASSERT_STRING_EQUAL(delta, full);
+    }
+
+    free(delta);
+    free(full);
+    free(before);
+    free(after);
+}
+
+void test_delta_histogram(void) {
+    size_t len = 0;
+    char *before = NULL;
+    char *after = NULL;
+    char *myers = NULL;
+    char *histogram = NULL;
+    char *delta = NULL;
+    strbuf_t a;
+    strbuf_t b;
+    delta_opts_t opts = { 0, 0, false };
+
+    /* inputs the two algorithms diff differently */
+    const char *x = "x\n{\na\n}\n{\nb\n}\ny\n";
+    const char *y = "x\n{\nb\n}\n{\na\n}\ny\n";
+
+    myers = get_buffer_delta(x, strlen(x), y, strlen(y), &opts);
+    opts.histogram = true;
+    histogram = get_buffer_delta(x, strlen(x), y, strlen(y), &opts);
+    RI_ASSERT_PTR_NOT_NULL(myers);
+    RI_ASSERT_PTR_NOT_NULL(histogram);
+
+    if (myers != NULL && histogram != NULL) {
+        RI_ASSERT_STRING_NOT_EQUAL(myers, histogram);
+    }
+
+    free(myers);
+    free(histogram);
+
+    /* inputs over DELTA_HISTOGRAM_SIZE use histogram without asking */
+    memset(&a, 0, sizeof(a));
+    memset(&b, 0, sizeof(b));
+
+    while (a.len <= DELTA_HISTOGRAM_SIZE) {
+        strbuf_appendf(&a, "padding line %zu\n", len);
+        strbuf_appendf(&b, "padding line %zu\n", len);
+        len++;
+    }
+
+    strbuf_append(&a, x);
+    strbuf_append(&b, y);
+    len = a.len;
+    before = strbuf_finish(&a);
+    after = strbuf_finish(&b);
+
+    opts.histogram = false;
+    myers = get_buffer_delta(before, len, after, len, &opts);
+    opts.histogram = true;
+    histogram = get_buffer_delta(before, len, after, len, &opts);
+    RI_ASSERT_PTR_NOT_NULL(myers);
+    RI_ASSERT_PTR_NOT_NULL(histogram);
+
+    if (myers != NULL && histogram != NULL) {
+        RI_ASSERT_STRING_EQUAL(myers, histogram);
+    }
+
+    /* and so do the default options */
+    delta = get_buffer_delta(before, len, after, len, NULL);
+
+    if (delta != NULL && histogram != NULL) {
+        RI_ASSERT_STRING_EQUAL(delta, histogram);
+    } else {
+        RI_ASSERT_PTR_NOT_NULL(delta);
+    }
+
+    free(delta);
+    free(myers);
+    free(histogram);
+    free(before);
+    free(after);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("delta", NULL, NULL);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test get_buffer_delta()", test_delta_lines) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test get_buffer_delta() max_hunks", test_delta_max_hunks) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test get_buffer_delta() max_bytes", test_delta_max_bytes) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test get_buffer_delta() histogram", test_delta_histogram) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
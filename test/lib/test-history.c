@@ -0,0 +1,166 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static char tmpdir[] = "/tmp/test-history-XXXXXX";
+static char *historyfile = NULL;
+static struct rpminspect ri;
+
+int init_test_history(void) {
+    if (mkdtemp(tmpdir) == NULL) {
+        return -1;
+    }
+
+    xasprintf(&historyfile, "%s/cache/%s", tmpdir, HISTORY_FILE);
+    memset(&ri, 0, sizeof(ri));
+    return 0;
+}
+
+int clean_test_history(void) {
+    char *dir = NULL;
+
+    unlink(historyfile);
+    xasprintf(&dir, "%s/cache", tmpdir);
+    rmdir(dir);
+    rmdir(tmpdir);
+    free(dir);
+    free(historyfile);
+    free(ri.history_file);
+    free_history(ri.history);
+    return 0;
+}
+
+void test_read_missing_history(void) {
+    RI_ASSERT_TRUE(read_history(&ri, historyfile));
+    RI_ASSERT_PTR_NULL(ri.history);
+    RI_ASSERT_EQUAL(predict_runtime(&ri, "pkg", "abidiff", 100), -1);
+}
+
+void test_predict_runtime(void) {
+    /* same package, scaled by the number of files */
+    record_runtime(&ri, "pkg", "abidiff", 10, 100);
+    RI_ASSERT_EQUAL(predict_runtime(&ri, "pkg", "abidiff", 100), 10);
+    RI_ASSERT_EQUAL(predict_runtime(&ri, "pkg", "abidiff", 200), 20);
+
+    /* moving average */
+    record_runtime(&ri, "pkg", "abidiff", 20, 100);
+    RI_ASSERT_EQUAL(predict_runtime(&ri, "pkg", "abidiff", 100), 15);
+
+    /* other packages go by the cost per file */
+    record_runtime(&ri, "other", "abidiff", 5, 100);
+    RI_ASSERT_EQUAL(predict_runtime(&ri, "new", "abidiff", 40), 4);
+    RI_ASSERT_EQUAL(predict_runtime(&ri, "new", "virus", 40), -1);
+}
+
+void test_predict_memory(void) {
+    RI_ASSERT_EQUAL(predict_memory(&ri, "pkg", "abidiff"), -1);
+
+    /* folded in to the moving average of the last record_runtime() */
+    record_memory(&ri, "pkg", "abidiff", 1000);
+    RI_ASSERT_EQUAL(predict_memory(&ri, "pkg", "abidiff"), 1000);
+
+    /* other packages go by the average across all of them */
+    record_memory(&ri, "other", "abidiff", 3000);
+    RI_ASSERT_EQUAL(predict_memory(&ri, "other", "abidiff"), 3000);
+    RI_ASSERT_EQUAL(predict_memory(&ri, "new", "abidiff"), 2000);
+    RI_ASSERT_EQUAL(predict_memory(&ri, "new", "virus"), -1);
+}
+
+void test_history_round_trip(void) {
+    struct rpminspect copy;
+
+    RI_ASSERT_TRUE(write_history(&ri));
+    RI_ASSERT_EQUAL(access(historyfile, R_OK), 0);
+
+    memset(&copy, 0, sizeof(copy));
+    RI_ASSERT_TRUE(read_history(&copy, historyfile));
+    RI_ASSERT_EQUAL(HASH_COUNT(copy.history), 2);
+    RI_ASSERT_EQUAL(predict_runtime(&copy, "pkg", "abidiff", 100), 15);
+    RI_ASSERT_EQUAL(predict_runtime(&copy, "other", "abidiff", 100), 5);
+    RI_ASSERT_EQUAL(predict_memory(&copy, "pkg", "abidiff"), 1000);
+
+    free(copy.history_file);
+    free_history(copy.history);
+}
+
+void test_history_limit(void) {
+    int i = 0;
+    char *name = NULL;
+    history_t *pkg = NULL;
+    struct rpminspect big;
+    struct rpminspect copy;
+
+    /* more packages than are kept, each inspected a second apart */
+    memset(&big, 0, sizeof(big));
+    big.history_file = strdup(historyfile);
+
+    for (i = 0; i < HISTORY_PACKAGES + 10; i++) {
+        xasprintf(&name, "pkg-%d", i);
+        record_runtime(&big, name, "abidiff", 1, 10);
+        HASH_FIND_STR(big.history, name, pkg);
+        RI_ASSERT_PTR_NOT_NULL(pkg);
+        pkg->entries->updated = i + 1;
+        free(name);
+    }
+
+    RI_ASSERT_TRUE(write_history(&big));
+
+    /* the least recently inspected ones are dropped */
+    memset(&copy, 0, sizeof(copy));
+    RI_ASSERT_TRUE(read_history(&copy, historyfile));
+    RI_ASSERT_EQUAL(HASH_COUNT(copy.history), HISTORY_PACKAGES);
+    HASH_FIND_STR(copy.history, "pkg-0", pkg);
+    RI_ASSERT_PTR_NULL(pkg);
+    xasprintf(&name, "pkg-%d", HISTORY_PACKAGES + 9);
+    HASH_FIND_STR(copy.history, name, pkg);
+    RI_ASSERT_PTR_NOT_NULL(pkg);
+    free(name);
+
+    free(big.history_file);
+    free_history(big.history);
+    free(copy.history_file);
+    free_history(copy.history);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("history", init_test_history, clean_test_history);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test read missing history", test_read_missing_history) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test predict_runtime()", test_predict_runtime) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test predict_memory()", test_predict_memory) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test history round trip", test_history_round_trip) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test history limit", test_history_limit) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,143 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+string_list_t *small = NULL;
+string_list_t *large = NULL;
+
+int init_test_listfuncs(void) {
+    int i = 0;
+    char *s = NULL;
+
+    small = list_add(small, "a");
+    small = list_add(small, "b");
+    small = list_add(small, "c");
+
+    /* long enough that the set operations hash it */
+    for (i = 0; i < 32; i++) {
+        xasprintf(&s, "%c", 'b' + i);
+        large = list_add(large, s);
+        free(s);
+    }
+
+    if (small == NULL || large == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int clean_test_listfuncs(void) {
+    list_free(small, free);
+    list_free(large, free);
+    return 0;
+}
+
+void test_list_difference(void) {
+    string_list_t *l = NULL;
+
+    ASSERT_AND_FREE(list_to_string(l = list_difference(small, large), ","), "a");
+    list_free(l, free);
+
+    l = list_difference(large, small);
+    RI_ASSERT_EQUAL(list_len(l), 30);
+    list_free(l, free);
+
+    /* nothing is in an empty list but not in another */
+    RI_ASSERT_PTR_NULL(list_difference(NULL, small));
+
+    ASSERT_AND_FREE(list_to_string(l = list_difference(small, NULL), ","), "a,b,c");
+    list_free(l, free);
+}
+
+void test_list_intersection(void) {
+    string_list_t *l = NULL;
+
+    ASSERT_AND_FREE(list_to_string(l = list_intersection(small, large), ","), "b,c");
+    list_free(l, free);
+
+    ASSERT_AND_FREE(list_to_string(l = list_intersection(large, small), ","), "b,c");
+    list_free(l, free);
+
+    RI_ASSERT_PTR_NULL(list_intersection(small, NULL));
+}
+
+void test_list_union(void) {
+    string_list_t *l = NULL;
+
+    l = list_union(small, large);
+    RI_ASSERT_EQUAL(list_len(l), 33);
+    RI_ASSERT_STRING_EQUAL(TAILQ_FIRST(l)->data, "a");
+    list_free(l, free);
+
+    ASSERT_AND_FREE(list_to_string(l = list_union(small, small), ","), "a,b,c");
+    list_free(l, free);
+}
+
+void test_list_symmetric_difference(void) {
+    string_list_t *l = NULL;
+    string_list_t *one = NULL;
+
+    one = list_add(one, "a");
+
+    /* a - small is empty, but small - a is not */
+    ASSERT_AND_FREE(list_to_string(l = list_symmetric_difference(one, small), ","), "b,c");
+    list_free(l, free);
+
+    RI_ASSERT_PTR_NULL(list_symmetric_difference(small, small));
+
+    list_free(one, free);
+}
+
+void test_string_set(void) {
+    string_set_t *set = list_to_set(large);
+
+    RI_ASSERT_TRUE(set_contains(set, "b"));
+    RI_ASSERT_TRUE(set_contains(set, "c"));
+    RI_ASSERT_FALSE(set_contains(set, "a"));
+    RI_ASSERT_FALSE(set_contains(NULL, "a"));
+    RI_ASSERT_EQUAL(HASH_COUNT(set), 32);
+
+    free_string_set(set);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("listfuncs", init_test_listfuncs, clean_test_listfuncs);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test list_difference()", test_list_difference) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test list_intersection()", test_list_intersection) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test list_union()", test_list_union) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test list_symmetric_difference()", test_list_symmetric_difference) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test string sets", test_string_set) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,116 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdlib.h>
+#include <string.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+string_list_t *patterns = NULL;
+
+int init_test_matcher(void) {
+    patterns = list_add(patterns, "usr/lib/");
+    patterns = list_add(patterns, "usr/");
+    patterns = list_add(patterns, "he");
+    patterns = list_add(patterns, "she");
+    patterns = list_add(patterns, "hers");
+    patterns = list_add(patterns, ".orig");
+
+    if (patterns == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int clean_test_matcher(void) {
+    list_free(patterns, free);
+    return 0;
+}
+
+/* count the matches seen by match_patterns() */
+static bool count_matches(const matcher_pattern_t *pattern __attribute__((unused)), size_t start __attribute__((unused)), void *user_data) {
+    int *count = user_data;
+
+    (*count)++;
+    return false;
+}
+
+void test_match_prefix(void) {
+    matcher_t *m = list_to_matcher(patterns, MATCHER_PREFIX, false);
+
+    RI_ASSERT_PTR_NOT_NULL(m);
+
+    /* the first pattern in list order wins */
+    RI_ASSERT_STRING_EQUAL(match_first(m, "usr/lib/libfoo.so")->pattern, "usr/lib/");
+    RI_ASSERT_STRING_EQUAL(match_first(m, "usr/bin/foo")->pattern, "usr/");
+    RI_ASSERT_STRING_EQUAL(match_first(m, "hers")->pattern, "he");
+    RI_ASSERT_PTR_NULL(match_first(m, "/usr/bin/foo"));
+    RI_ASSERT_PTR_NULL(match_first(m, "us"));
+
+    free_matcher(m);
+}
+
+void test_match_suffix(void) {
+    matcher_t *m = list_to_matcher(patterns, MATCHER_SUFFIX, false);
+
+    RI_ASSERT_PTR_NOT_NULL(m);
+    RI_ASSERT_STRING_EQUAL(match_first(m, "foo.c.orig")->pattern, ".orig");
+    RI_ASSERT_STRING_EQUAL(match_first(m, "ashe")->pattern, "he");
+    RI_ASSERT_PTR_NULL(match_first(m, "foo.orig.c"));
+
+    free_matcher(m);
+}
+
+void test_match_substring(void) {
+    int count = 0;
+    matcher_t *m = list_to_matcher(patterns, MATCHER_SUBSTRING, true);
+
+    RI_ASSERT_PTR_NOT_NULL(m);
+    RI_ASSERT_STRING_EQUAL(match_first(m, "/opt/USR/share")->pattern, "usr/");
+    RI_ASSERT_PTR_NULL(match_first(m, "/opt/bin"));
+
+    /* "ushers" contains she, he, and hers */
+    match_patterns(m, "ushers", count_matches, &count);
+    RI_ASSERT_EQUAL(count, 3);
+
+    free_matcher(m);
+}
+
+void test_match_empty(void) {
+    RI_ASSERT_PTR_NULL(list_to_matcher(NULL, MATCHER_SUBSTRING, false));
+    RI_ASSERT_PTR_NULL(match_first(NULL, "anything"));
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("matcher", init_test_matcher, clean_test_matcher);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test prefix matching", test_match_prefix) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test suffix matching", test_match_suffix) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test substring matching", test_match_substring) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test empty matchers", test_match_empty) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,287 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static char tmpdir[] = "/tmp/test-payload-XXXXXX";
+static char *rpm = NULL;
+static char *large_rpm = NULL;
+static struct rpminspect *ri = NULL;
+
+/*
+ * The package has /usr/x as a symlink to a directory outside of the
+ * extraction directory, followed by a file under /usr/x.
+ */
+static const char *spec =
+    "Name: payload\n"
+    "Version: 1\n"
+    "Release: 1\n"
+    "Summary: payload with a symlinked parent directory\n"
+    "License: GPL-3.0-or-later\n"
+    "BuildArch: noarch\n"
+    "%%global __os_install_post %%{nil}\n"
+    "%%description\n"
+    "payload with a symlinked parent directory\n"
+    "%%install\n"
+    "mkdir -p %%{buildroot}/usr %s/outside\n"
+    "ln -s %s/outside %%{buildroot}/usr/x\n"
+    "echo evil > %%{buildroot}/usr/x/.bashrc\n"
+    "%%files\n"
+    "/usr/x\n"
+    "/usr/x/.bashrc\n";
+
+/*
+ * A file over 4 GiB puts the package in the large file payload
+ * format, which libarchive cannot read.  It is sparse and the payload
+ * is fast zstd so building the package stays quick.
+ */
+#define LARGE_SIZE ((off_t) 4 * 1024 * 1024 * 1024 + 1)
+
+static const char *large_spec =
+    "Name: large\n"
+    "Version: 1\n"
+    "Release: 1\n"
+    "Summary: payload in the large file format\n"
+    "License: GPL-3.0-or-later\n"
+    "BuildArch: noarch\n"
+    "%%global __os_install_post %%{nil}\n"
+    "%%global _binary_payload w1.zstdio\n"
+    "%%description\n"
+    "payload in the large file format\n"
+    "%%install\n"
+    "mkdir -p %%{buildroot}/usr/share/large\n"
+    "truncate -s %jd %%{buildroot}/usr/share/large/big\n"
+    "echo small > %%{buildroot}/usr/share/large/small\n"
+    "ln -s small %%{buildroot}/usr/share/large/link\n"
+    "%%files\n"
+    "%%dir %%attr(0750,-,-) /usr/share/large\n"
+    "%%attr(0644,-,-) /usr/share/large/big\n"
+    "%%attr(0600,-,-) /usr/share/large/small\n"
+    "/usr/share/large/link\n";
+
+/* Write out a spec file and build the named package from it */
+static int build_package(const char *name, const char *contents)
+{
+    FILE *fp = NULL;
+    char *path = NULL;
+    char *cmd = NULL;
+    int r = 0;
+
+    xasprintf(&path, "%s/%s.spec", tmpdir, name);
+    fp = fopen(path, "w");
+
+    if (fp == NULL) {
+        free(path);
+        return -1;
+    }
+
+    fputs(contents, fp);
+    fclose(fp);
+
+    xasprintf(&cmd, "rpmbuild -bb --quiet --define '_topdir %s' --define '_rpmdir %s' --define '_build_name_fmt %s.rpm' %s >/dev/null 2>&1", tmpdir, tmpdir, name, path);
+    r = system(cmd);
+    free(cmd);
+    free(path);
+    return r;
+}
+
+int init_test_payload(void) {
+    char *path = NULL;
+    char *contents = NULL;
+    int r = 0;
+
+    if (mkdtemp(tmpdir) == NULL) {
+        return -1;
+    }
+
+    xasprintf(&contents, spec, tmpdir, tmpdir);
+    r = build_package("payload", contents);
+    free(contents);
+
+    if (r != 0) {
+        return -1;
+    }
+
+    xasprintf(&contents, large_spec, (intmax_t) LARGE_SIZE);
+    r = build_package("large", contents);
+    free(contents);
+
+    if (r != 0) {
+        return -1;
+    }
+
+    /* the file the package would write outside of the extraction */
+    xasprintf(&path, "%s/outside/.bashrc", tmpdir);
+    unlink(path);
+    free(path);
+
+    xasprintf(&rpm, "%s/payload.rpm", tmpdir);
+    xasprintf(&large_rpm, "%s/large.rpm", tmpdir);
+    ri = init_rpminspect(NULL, NULL, NULL);
+
+    if (ri == NULL || init_librpm(ri) != RPMRC_OK) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int clean_test_payload(void) {
+    free(rpm);
+    free(large_rpm);
+    free_rpminspect(ri);
+    rmtree(tmpdir, true, false);
+    return 0;
+}
+
+void test_payload_symlinked_parent(void) {
+    Header hdr = NULL;
+    char *outdir = NULL;
+    char *outside = NULL;
+    rpmfile_t *files = NULL;
+
+    hdr = get_rpm_header(ri, rpm);
+    RI_ASSERT_PTR_NOT_NULL(hdr);
+
+    xasprintf(&outdir, "%s/root", tmpdir);
+    xasprintf(&outside, "%s/outside/.bashrc", tmpdir);
+    RI_ASSERT_EQUAL(mkdirp(outdir, S_IRWXU), 0);
+
+    /* refused, and nothing is written through the symlink */
+    files = extract_rpm_payload(rpm, hdr, outdir);
+    RI_ASSERT_PTR_NULL(files);
+    RI_ASSERT_NOT_EQUAL(access(outside, F_OK), 0);
+
+    free_files(files);
+    free(outdir);
+    free(outside);
+}
+
+/*
+ * Check a payload member in the list and on disk.  The size of
+ * directories depends on the file system they were built on, so
+ * it is not checked.
+ */
+static void check_member(const rpmfile_t *files, const char *localpath, const mode_t mode, const off_t size)
+{
+    rpmfile_entry_t *file = NULL;
+    struct stat sb;
+
+    TAILQ_FOREACH(file, files, items) {
+        if (!strcmp(file->localpath, localpath)) {
+            break;
+        }
+    }
+
+    RI_ASSERT_PTR_NOT_NULL(file);
+
+    if (file == NULL) {
+        return;
+    }
+
+    /* the list has the modes and sizes from the package */
+    RI_ASSERT_EQUAL(file->st.st_mode, mode);
+    RI_ASSERT_PTR_NOT_NULL(file->fullpath);
+
+    if (!S_ISDIR(mode)) {
+        RI_ASSERT_TRUE(file->st.st_size == size);
+    }
+
+    if (file->fullpath == NULL) {
+        return;
+    }
+
+    /* extracted user read-write and not world writable */
+    RI_ASSERT_EQUAL(lstat(file->fullpath, &sb), 0);
+    RI_ASSERT_EQUAL(sb.st_mode & S_IFMT, mode & S_IFMT);
+
+    if (!S_ISLNK(mode)) {
+        RI_ASSERT_EQUAL(sb.st_mode & ~S_IFMT, ((mode & ~S_IFMT) | S_IRUSR | S_IWUSR) & ~S_IWOTH);
+    }
+
+    if (S_ISREG(mode) || S_ISLNK(mode)) {
+        RI_ASSERT_TRUE(sb.st_size == size);
+    }
+
+    return;
+}
+
+void test_payload_large_files(void) {
+    Header hdr = NULL;
+    char *outdir = NULL;
+    char *path = NULL;
+    char *contents = NULL;
+    off_t len = 0;
+    rpmfile_t *files = NULL;
+    rpmfile_entry_t *file = NULL;
+    int n = 0;
+
+    hdr = get_rpm_header(ri, large_rpm);
+    RI_ASSERT_PTR_NOT_NULL(hdr);
+
+    xasprintf(&outdir, "%s/large", tmpdir);
+    RI_ASSERT_EQUAL(mkdirp(outdir, S_IRWXU), 0);
+
+    files = extract_rpm_payload(large_rpm, hdr, outdir);
+    RI_ASSERT_PTR_NOT_NULL(files);
+
+    if (files != NULL) {
+        TAILQ_FOREACH(file, files, items) {
+            n++;
+        }
+
+        RI_ASSERT_EQUAL(n, 4);
+        check_member(files, "/usr/share/large", S_IFDIR | 0750, 0);
+        check_member(files, "/usr/share/large/big", S_IFREG | 0644, LARGE_SIZE);
+        check_member(files, "/usr/share/large/small", S_IFREG | 0600, 6);
+        check_member(files, "/usr/share/large/link", S_IFLNK | 0777, 5);
+    }
+
+    /* the content came through too */
+    xasprintf(&path, "%s/usr/share/large/small", outdir);
+    contents = read_file_bytes(path, &len);
+    RI_ASSERT_PTR_NOT_NULL(contents);
+
+    if (contents != NULL) {
+        RI_ASSERT_STRING_EQUAL(contents, "small\n");
+    }
+
+    free(contents);
+    free(path);
+
+    free_files(files);
+    rmtree(outdir, true, false);
+    free(outdir);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("payload", init_test_payload, clean_test_payload);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test payload with a symlinked parent", test_payload_symlinked_parent) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test large file payload", test_payload_large_files) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
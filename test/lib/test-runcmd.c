@@ -0,0 +1,370 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <signal.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/types.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+#define NFILES 64
+
+static rpmfile_entry_t files[NFILES];
+
+/*
+ * A check that prints things looking like result records to stdout
+ * and stderr, and returns output with newlines in it.
+ */
+static int noisy_check(rpmfile_entry_t *file, char **output)
+{
+    int i = file - files;
+
+    printf("%d 1 5\n", i);
+    fprintf(stderr, "%d 1 99\nwarning: something\n", i + 1);
+    xasprintf(output, "file %d\nsecond line\n", i);
+    return i % 3;
+}
+
+void test_run_checks(void) {
+    int i = 0;
+    char *expected = NULL;
+    file_check_t checks[NFILES];
+
+    memset(checks, 0, sizeof(checks));
+
+    for (i = 0; i < NFILES; i++) {
+        checks[i].file = &files[i];
+    }
+
+    run_checks(checks, NFILES, noisy_check, 4);
+
+    for (i = 0; i < NFILES; i++) {
+        xasprintf(&expected, "file %d\nsecond line\n", i);
+        RI_ASSERT_TRUE(checks[i].done);
+        RI_ASSERT_EQUAL(checks[i].status, i % 3);
+        RI_ASSERT_PTR_NOT_NULL(checks[i].output);
+
+        if (checks[i].output != NULL) {
+            RI_ASSERT_STRING_EQUAL(checks[i].output, expected);
+        }
+
+        free(checks[i].output);
+        free(expected);
+    }
+}
+
+/* A job that sleeps for longer than any test should take */
+static int sleep_job(void *data)
+{
+    (void) data;
+    sleep(30);
+    return EXIT_SUCCESS;
+}
+
+/* A job that starts a sleeping child, prints its PID, and sleeps */
+static int parent_job(void *data)
+{
+    pid_t pid = fork();
+
+    (void) data;
+
+    if (pid == 0) {
+        sleep(30);
+        _exit(EXIT_SUCCESS);
+    }
+
+    printf("%d\n", (int) pid);
+    fflush(stdout);
+    sleep(30);
+    return EXIT_SUCCESS;
+}
+
+/* A job that waits a moment, its done function kills the others */
+static int short_job(void *data)
+{
+    (void) data;
+    sleep(1);
+    return EXIT_SUCCESS;
+}
+
+static void kill_others(job_entry_t *job)
+{
+    (void) job;
+    kill_jobs();
+}
+
+/* True once the process is gone, or a zombie nobody reaped yet */
+static bool process_gone(const pid_t pid)
+{
+    int i = 0;
+    char state = 0;
+    char *path = NULL;
+    FILE *fp = NULL;
+    bool r = false;
+
+    xasprintf(&path, "/proc/%d/stat", (int) pid);
+
+    /* the kill is asynchronous, give it a moment */
+    for (i = 0; i < 50 && !r; i++) {
+        if (kill(pid, 0) == -1 && errno == ESRCH) {
+            r = true;
+        } else if ((fp = fopen(path, "r")) != NULL) {
+            r = (fscanf(fp, "%*d %*s %c", &state) == 1 && state == 'Z');
+            fclose(fp);
+        }
+
+        if (!r) {
+            usleep(100000);
+        }
+    }
+
+    free(path);
+    return r;
+}
+
+static job_list_t *new_jobs(void)
+{
+    job_list_t *jobs = calloc(1, sizeof(*jobs));
+
+    assert(jobs != NULL);
+    TAILQ_INIT(jobs);
+    return jobs;
+}
+
+static job_entry_t *add_job(job_list_t *jobs, int (*fn)(void *))
+{
+    job_entry_t *job = calloc(1, sizeof(*job));
+
+    assert(job != NULL);
+    job->fn = fn;
+    TAILQ_INSERT_TAIL(jobs, job, items);
+    return job;
+}
+
+void test_job_timeout(void) {
+    double started = 0;
+    job_list_t *jobs = new_jobs();
+    job_entry_t *job = add_job(jobs, sleep_job);
+
+    job->timeout = 1;
+    started = monotonic_time();
+    run_jobs(jobs, 1);
+
+    RI_ASSERT_TRUE(job->timed_out);
+    RI_ASSERT_FALSE(job->cancelled);
+    RI_ASSERT_NOT_EQUAL(job->exitcode, EXIT_SUCCESS);
+    RI_ASSERT_TRUE(monotonic_time() - started < 10);
+    free_jobs(jobs);
+}
+
+void test_deadline(void) {
+    double started = 0;
+    job_list_t *jobs = new_jobs();
+    job_entry_t *first = add_job(jobs, sleep_job);
+    job_entry_t *second = add_job(jobs, sleep_job);
+
+    /* the first job is killed at the deadline, the second never runs */
+    set_deadline(1);
+    started = monotonic_time();
+    run_jobs(jobs, 1);
+    set_deadline(0);
+
+    RI_ASSERT_TRUE(first->timed_out);
+    RI_ASSERT_TRUE(first->pid > 0);
+    RI_ASSERT_TRUE(second->timed_out);
+    RI_ASSERT_EQUAL(second->pid, 0);
+    RI_ASSERT_TRUE(monotonic_time() - started < 10);
+    free_jobs(jobs);
+}
+
+void test_group_kill(void) {
+    pid_t child = 0;
+    job_list_t *jobs = new_jobs();
+    job_entry_t *job = add_job(jobs, parent_job);
+
+    /* a job in its own group takes what it started down with it */
+    job->group = true;
+    job->timeout = 2;
+    run_jobs(jobs, 1);
+
+    RI_ASSERT_TRUE(job->timed_out);
+    RI_ASSERT_PTR_NOT_NULL(job->output);
+
+    if (job->output != NULL) {
+        child = atoi(job->output);
+        RI_ASSERT_TRUE(child > 0);
+
+        if (child > 0) {
+            RI_ASSERT_TRUE(process_gone(child));
+        }
+    }
+
+    free_jobs(jobs);
+}
+
+void test_kill_jobs(void) {
+    pid_t child = 0;
+    double started = 0;
+    job_list_t *jobs = new_jobs();
+    job_entry_t *quick = add_job(jobs, short_job);
+    job_entry_t *job = add_job(jobs, parent_job);
+
+    /* what the signal handler does, from the done function here */
+    quick->done = kill_others;
+    job->group = true;
+    started = monotonic_time();
+    run_jobs(jobs, 2);
+
+    RI_ASSERT_EQUAL(quick->exitcode, EXIT_SUCCESS);
+    RI_ASSERT_NOT_EQUAL(job->exitcode, EXIT_SUCCESS);
+    RI_ASSERT_FALSE(job->timed_out);
+    RI_ASSERT_TRUE(monotonic_time() - started < 10);
+
+    if (job->output != NULL) {
+        child = atoi(job->output);
+
+        if (child > 0) {
+            RI_ASSERT_TRUE(process_gone(child));
+        }
+    }
+
+    free_jobs(jobs);
+}
+
+void test_result_stream(void) {
+    FILE *fp = NULL;
+    results_t *results = NULL;
+    results_entry_t *entry = NULL;
+    struct result_params params;
+
+    fp = tmpfile();
+    RI_ASSERT_PTR_NOT_NULL(fp);
+
+    if (fp == NULL) {
+        return;
+    }
+
+    init_result_params(&params);
+    params.header = NAME_ABIDIFF;
+    params.severity = RESULT_BAD;
+    params.waiverauth = WAIVABLE_BY_ANYONE;
+    params.verb = VERB_CHANGED;
+    params.msg = "line one\nline two";
+    params.details = "tab\there";
+    params.noun = "${FILE} on ${ARCH}";
+    params.arch = "x86_64";
+    params.file = "/usr/lib64/libfoo.so.1";
+    add_result_entry(&results, &params);
+
+    /* the fields left out come back as NULL */
+    init_result_params(&params);
+    params.header = "not an inspection";
+    params.severity = RESULT_INFO;
+    params.msg = "second";
+    add_result_entry(&results, &params);
+
+    TAILQ_FOREACH(entry, results, items) {
+        write_result(fp, entry);
+    }
+
+    free_results(results);
+    results = NULL;
+
+    /* a period ends one set of results, then a record cut short */
+    fputs(".", fp);
+    init_result_params(&params);
+    params.header = NAME_ABIDIFF;
+    params.msg = "third";
+    add_result_entry(&results, &params);
+    write_result(fp, TAILQ_FIRST(results));
+    free_results(results);
+    fputs("3 0 0\n5\nab", fp);
+    rewind(fp);
+
+    results = read_results(fp, "fallback");
+    RI_ASSERT_PTR_NOT_NULL(results);
+
+    if (results != NULL) {
+        entry = TAILQ_FIRST(results);
+        RI_ASSERT_STRING_EQUAL(entry->header, NAME_ABIDIFF);
+        RI_ASSERT_EQUAL(entry->severity, RESULT_BAD);
+        RI_ASSERT_EQUAL(entry->waiverauth, WAIVABLE_BY_ANYONE);
+        RI_ASSERT_EQUAL(entry->verb, VERB_CHANGED);
+        RI_ASSERT_STRING_EQUAL(entry->msg, "line one\nline two");
+        RI_ASSERT_STRING_EQUAL(entry->details, "tab\there");
+        RI_ASSERT_PTR_NULL(entry->remedy);
+        RI_ASSERT_STRING_EQUAL(entry->noun, "${FILE} on ${ARCH}");
+        RI_ASSERT_STRING_EQUAL(entry->arch, "x86_64");
+        RI_ASSERT_STRING_EQUAL(entry->file, "/usr/lib64/libfoo.so.1");
+
+        entry = TAILQ_NEXT(entry, items);
+        RI_ASSERT_PTR_NOT_NULL(entry);
+
+        if (entry != NULL) {
+            RI_ASSERT_STRING_EQUAL(entry->header, "fallback");
+            RI_ASSERT_STRING_EQUAL(entry->msg, "second");
+            RI_ASSERT_PTR_NULL(entry->details);
+            RI_ASSERT_PTR_NULL(TAILQ_NEXT(entry, items));
+        }
+    }
+
+    free_results(results);
+
+    /* the partial record after the third is dropped */
+    results = read_results(fp, "fallback");
+    RI_ASSERT_PTR_NOT_NULL(results);
+
+    if (results != NULL) {
+        RI_ASSERT_STRING_EQUAL(TAILQ_FIRST(results)->msg, "third");
+        RI_ASSERT_PTR_NULL(TAILQ_NEXT(TAILQ_FIRST(results), items));
+    }
+
+    free_results(results);
+    fclose(fp);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("runcmd", NULL, NULL);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test run_checks()", test_run_checks) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test job timeout", test_job_timeout) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test deadline", test_deadline) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test process group kill", test_group_kill) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test kill_jobs()", test_kill_jobs) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test write_result() and read_results()", test_result_stream) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,393 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <fcntl.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+#define NFAKES 4
+
+/* An inspection whose driver is replaced for the test */
+struct fake {
+    const char *name;
+    double predicted;         /* seconds in the history, 0 for none */
+    useconds_t sleep;
+    severity_t severity;      /* of the results it adds */
+    int results;              /* how many it adds */
+    int index;                /* in inspections[] */
+    bool (*driver)(struct rpminspect *);  /* the real one */
+};
+
+static struct fake fakes[NFAKES];
+static char orderfile[] = "/tmp/test-schedule-XXXXXX";
+static struct rpminspect ri;
+static rpmpeer_t peers;
+static rpmpeer_entry_t peer;
+static rpmfile_t files;
+static rpmfile_entry_t file;
+
+/*
+ * Write down that the inspection started and report its result.  It
+ * may run in a child process, so the order is kept in a file.
+ */
+static bool run_fake(struct rpminspect *ri, const int i)
+{
+    int j = 0;
+    int fd = -1;
+    char *line = NULL;
+    struct result_params params;
+
+    xasprintf(&line, "%s\n", fakes[i].name);
+    fd = open(orderfile, O_WRONLY | O_APPEND);
+
+    if (fd != -1) {
+        (void) write(fd, line, strlen(line));
+        close(fd);
+    }
+
+    free(line);
+    usleep(fakes[i].sleep);
+
+    for (j = 1; j <= fakes[i].results; j++) {
+        init_result_params(&params);
+        params.header = inspections[fakes[i].index].name;
+        params.severity = fakes[i].severity;
+        params.waiverauth = NOT_WAIVABLE;
+        xasprintf(&params.msg, "%s %d", fakes[i].name, j);
+        add_result(ri, &params);
+        free(params.msg);
+    }
+
+    return fakes[i].severity < RESULT_VERIFY;
+}
+
+static bool fake0(struct rpminspect *ri) { return run_fake(ri, 0); }
+static bool fake1(struct rpminspect *ri) { return run_fake(ri, 1); }
+static bool fake2(struct rpminspect *ri) { return run_fake(ri, 2); }
+static bool fake3(struct rpminspect *ri) { return run_fake(ri, 3); }
+
+static bool (*fake_drivers[NFAKES])(struct rpminspect *) = { fake0, fake1, fake2, fake3 };
+
+/*
+ * Set up the run for the fake inspections.  One payload file with no
+ * package name makes the predictions the seconds in the history.
+ */
+static void setup_fakes(void)
+{
+    int i = 0;
+    int j = 0;
+    int fd = -1;
+
+    memset(&ri, 0, sizeof(ri));
+    ri.before = "before";
+    ri.threshold = RESULT_VERIFY;
+    ri.worst_result = RESULT_NULL;
+
+    TAILQ_INIT(&files);
+    TAILQ_INSERT_TAIL(&files, &file, items);
+    memset(&peer, 0, sizeof(peer));
+    peer.after_files = &files;
+    TAILQ_INIT(&peers);
+    TAILQ_INSERT_TAIL(&peers, &peer, items);
+    ri.peers = &peers;
+
+    for (i = 0; i < NFAKES; i++) {
+        for (j = 0; inspections[j].name != NULL; j++) {
+            if (!strcmp(inspections[j].name, fakes[i].name)) {
+                break;
+            }
+        }
+
+        assert(inspections[j].name != NULL);
+        fakes[i].index = j;
+        fakes[i].driver = inspections[j].driver;
+        inspections[j].driver = fake_drivers[i];
+        ri.tests |= inspections[j].flag;
+
+        if (fakes[i].predicted > 0) {
+            record_runtime(&ri, "other", fakes[i].name, fakes[i].predicted, 1);
+        }
+    }
+
+    fd = open(orderfile, O_WRONLY | O_TRUNC);
+
+    if (fd != -1) {
+        close(fd);
+    }
+
+    return;
+}
+
+static void cleanup_fakes(void)
+{
+    int i = 0;
+
+    for (i = 0; i < NFAKES; i++) {
+        inspections[fakes[i].index].driver = fakes[i].driver;
+    }
+
+    free_results(ri.results);
+    free_history(ri.history);
+    return;
+}
+
+/* The inspections that started, in the order they started */
+static string_list_t *read_order(void)
+{
+    char *buf = NULL;
+    off_t len = 0;
+    string_list_t *r = NULL;
+
+    buf = read_file_bytes(orderfile, &len);
+
+    if (buf != NULL) {
+        r = strsplit(buf, "\n");
+        free(buf);
+    }
+
+    return r;
+}
+
+/* The results of one inspection */
+static results_entry_t *find_result(const char *header)
+{
+    results_entry_t *entry = NULL;
+
+    if (ri.results == NULL) {
+        return NULL;
+    }
+
+    TAILQ_FOREACH(entry, ri.results, items) {
+        if (!strcmp(entry->header, header)) {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+int init_test_schedule(void) {
+    int fd = mkstemp(orderfile);
+
+    if (fd == -1) {
+        return -1;
+    }
+
+    close(fd);
+    return 0;
+}
+
+int clean_test_schedule(void) {
+    unlink(orderfile);
+    return 0;
+}
+
+void test_fail_fast(void) {
+    string_list_t *order = NULL;
+    string_entry_t *entry = NULL;
+    results_entry_t *result = NULL;
+
+    /*
+     * The two header inspections run first, metadata fails right
+     * away while disttag is still running.  The longer inspections
+     * never start.
+     */
+    memset(fakes, 0, sizeof(fakes));
+    fakes[0] = (struct fake) { "abidiff", 1, 0, RESULT_INFO, 1, 0, NULL };
+    fakes[1] = (struct fake) { "metadata", 0, 0, RESULT_BAD, 1, 0, NULL };
+    fakes[2] = (struct fake) { "kmidiff", 2, 0, RESULT_INFO, 1, 0, NULL };
+    fakes[3] = (struct fake) { "disttag", 0, 30000000, RESULT_INFO, 1, 0, NULL };
+    setup_fakes();
+    ri.jobs = 2;
+    ri.fail_fast = true;
+
+    RI_ASSERT_FALSE(run_inspections(&ri));
+
+    order = read_order();
+    RI_ASSERT_PTR_NOT_NULL(order);
+
+    if (order != NULL) {
+        TAILQ_FOREACH(entry, order, items) {
+            RI_ASSERT_TRUE(!strcmp(entry->data, "metadata") || !strcmp(entry->data, "disttag"));
+        }
+    }
+
+    list_free(order, free);
+
+    /* the failure is kept */
+    result = find_result("metadata");
+    RI_ASSERT_PTR_NOT_NULL(result);
+
+    if (result != NULL) {
+        RI_ASSERT_EQUAL(result->severity, RESULT_BAD);
+        RI_ASSERT_STRING_EQUAL(result->msg, "metadata 1");
+    }
+
+    /* stopped part way by stop_jobs() */
+    result = find_result("disttag");
+    RI_ASSERT_PTR_NOT_NULL(result);
+
+    if (result != NULL) {
+        RI_ASSERT_EQUAL(result->severity, RESULT_SKIP);
+        RI_ASSERT_EQUAL(result->verb, VERB_SKIP);
+        RI_ASSERT_PTR_NOT_NULL(strstr(result->msg, "was stopped because --fail-fast"));
+    }
+
+    /* never started */
+    result = find_result("abidiff");
+    RI_ASSERT_PTR_NOT_NULL(result);
+
+    if (result != NULL) {
+        RI_ASSERT_EQUAL(result->severity, RESULT_SKIP);
+        RI_ASSERT_PTR_NOT_NULL(strstr(result->msg, "was not run because --fail-fast"));
+    }
+
+    result = find_result("kmidiff");
+    RI_ASSERT_PTR_NOT_NULL(result);
+
+    if (result != NULL) {
+        RI_ASSERT_EQUAL(result->severity, RESULT_SKIP);
+        RI_ASSERT_PTR_NOT_NULL(strstr(result->msg, "was not run because --fail-fast"));
+    }
+
+    cleanup_fakes();
+}
+
+void test_fail_fast_order(void) {
+    int i = 0;
+    const char *expected[] = { "disttag", "metadata", "kmidiff", "abidiff" };
+    string_list_t *order = NULL;
+    string_entry_t *entry = NULL;
+
+    /* one at a time, header inspections first, then shortest first */
+    memset(fakes, 0, sizeof(fakes));
+    fakes[0] = (struct fake) { "abidiff", 2, 0, RESULT_INFO, 1, 0, NULL };
+    fakes[1] = (struct fake) { "metadata", 0, 0, RESULT_INFO, 1, 0, NULL };
+    fakes[2] = (struct fake) { "kmidiff", 1, 0, RESULT_INFO, 1, 0, NULL };
+    fakes[3] = (struct fake) { "disttag", 0, 0, RESULT_INFO, 1, 0, NULL };
+    setup_fakes();
+    ri.jobs = 1;
+    ri.fail_fast = true;
+
+    RI_ASSERT_TRUE(run_inspections(&ri));
+
+    order = read_order();
+    RI_ASSERT_PTR_NOT_NULL(order);
+
+    if (order != NULL) {
+        TAILQ_FOREACH(entry, order, items) {
+            RI_ASSERT_TRUE(i < NFAKES);
+
+            if (i < NFAKES) {
+                RI_ASSERT_STRING_EQUAL(entry->data, expected[i]);
+            }
+
+            i++;
+        }
+    }
+
+    RI_ASSERT_EQUAL(i, NFAKES);
+    list_free(order, free);
+    cleanup_fakes();
+}
+
+void test_longest_first(void) {
+    int i = 0;
+    string_list_t *order = NULL;
+    string_entry_t *entry = NULL;
+    results_entry_t *result = NULL;
+    const char *expected[] = { "abidiff 1", "disttag 1", "kmidiff 1", "kmidiff 2", "kmidiff 3", "metadata 1", "metadata 2" };
+
+    /*
+     * Two at a time, longest predicted first.  disttag and kmidiff
+     * start together, metadata takes the slot kmidiff leaves and
+     * abidiff the one metadata leaves while disttag still runs.
+     */
+    memset(fakes, 0, sizeof(fakes));
+    fakes[0] = (struct fake) { "abidiff", 5, 0, RESULT_INFO, 1, 0, NULL };
+    fakes[1] = (struct fake) { "metadata", 10, 0, RESULT_INFO, 2, 0, NULL };
+    fakes[2] = (struct fake) { "kmidiff", 50, 200000, RESULT_INFO, 3, 0, NULL };
+    fakes[3] = (struct fake) { "disttag", 100, 600000, RESULT_INFO, 1, 0, NULL };
+    setup_fakes();
+    ri.jobs = 2;
+
+    RI_ASSERT_TRUE(run_inspections(&ri));
+
+    order = read_order();
+    RI_ASSERT_PTR_NOT_NULL(order);
+
+    if (order != NULL) {
+        TAILQ_FOREACH(entry, order, items) {
+            if (i < 2) {
+                RI_ASSERT_TRUE(!strcmp(entry->data, "disttag") || !strcmp(entry->data, "kmidiff"));
+            } else if (i == 2) {
+                RI_ASSERT_STRING_EQUAL(entry->data, "metadata");
+            } else if (i == 3) {
+                RI_ASSERT_STRING_EQUAL(entry->data, "abidiff");
+            }
+
+            i++;
+        }
+    }
+
+    RI_ASSERT_EQUAL(i, NFAKES);
+    list_free(order, free);
+
+    /*
+     * The results the children wrote to their temporary files come
+     * back in inspections[] order, in the order each one added them.
+     */
+    i = 0;
+    RI_ASSERT_PTR_NOT_NULL(ri.results);
+
+    if (ri.results != NULL) {
+        TAILQ_FOREACH(result, ri.results, items) {
+            RI_ASSERT_TRUE(i < 7);
+
+            if (i < 7) {
+                RI_ASSERT_STRING_EQUAL(result->msg, expected[i]);
+                RI_ASSERT_EQUAL(result->severity, RESULT_INFO);
+                RI_ASSERT_EQUAL(result->waiverauth, NOT_WAIVABLE);
+            }
+
+            i++;
+        }
+    }
+
+    RI_ASSERT_EQUAL(i, 7);
+    cleanup_fakes();
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("schedule", init_test_schedule, clean_test_schedule);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test --fail-fast order", test_fail_fast_order) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test --fail-fast stops the run", test_fail_fast) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test longest predicted first", test_longest_first) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -0,0 +1,172 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static const char *spec_text =
+    "%global upstream_version 1.2\n"
+    "%define patchdir patches\n"
+    "%global nothing %{nil} \\\n"
+    "Name: test\n"
+    "Version: %{upstream_version}\n"
+    "Release: 1%{?dist}\n"
+    "Source0: test-%{version}.tar.gz\n"
+    "Source1: extra.conf\n"
+    "Patch0: %{patchdir}/fix.patch\n"
+    "Patch12:\ttypo.patch\n"
+    "\n"
+    "%description\n"
+    "Patch: this is not a tag\n"
+    "\n"
+    "%package devel\n"
+    "Summary: Development files\n"
+    "Patch3: devel.patch\n"
+    "\n"
+    "%prep\n"
+    "%setup -q\n"
+    "%patch0 -p1\n"
+    "%patch -P 12 -p1 -b .typo\n"
+    "%patch -P3\n"
+    "\n"
+    "%files\n"
+    "/usr/bin/test\n"
+    "\n"
+    "%files devel\n"
+    "/usr/include/test.h\n"
+    "\n"
+    "%changelog\n"
+    "%global after changelog\n";
+
+static char specfile[] = "/tmp/test-specfile-XXXXXX";
+static struct rpminspect ri;
+static spec_model_t *spec = NULL;
+
+int init_test_specfile(void) {
+    int fd = -1;
+    size_t len = strlen(spec_text);
+
+    fd = mkstemp(specfile);
+
+    if (fd == -1) {
+        return -1;
+    }
+
+    if (write(fd, spec_text, len) != (ssize_t) len) {
+        close(fd);
+        return -1;
+    }
+
+    close(fd);
+    memset(&ri, 0, sizeof(ri));
+    spec = get_spec_model(&ri, specfile);
+
+    if (spec == NULL) {
+        return -1;
+    }
+
+    return 0;
+}
+
+int clean_test_specfile(void) {
+    free_spec_models(ri.specs);
+    unlink(specfile);
+    return 0;
+}
+
+void test_spec_model_cached(void) {
+    RI_ASSERT_TRUE(get_spec_model(&ri, specfile) == spec);
+    RI_ASSERT_EQUAL(HASH_COUNT(ri.specs), 1);
+}
+
+void test_spec_sections(void) {
+    RI_ASSERT_EQUAL(spec->nsections, 7);
+    RI_ASSERT_TRUE(spec_section_is(&spec->sections[0], ""));
+    RI_ASSERT_EQUAL(spec->sections[0].start, 0);
+    RI_ASSERT_STRING_EQUAL(spec->sections[2].name, "%package devel");
+    RI_ASSERT_TRUE(spec_section_is(&spec->sections[3], SPEC_SECTION_PREP));
+    RI_ASSERT_TRUE(spec_section_is(&spec->sections[5], SPEC_SECTION_FILES));
+    RI_ASSERT_FALSE(spec_section_is(&spec->sections[5], "%file"));
+    RI_ASSERT_STRING_EQUAL(spec->lines[spec->sections[5].start + 1], "/usr/include/test.h");
+    RI_ASSERT_EQUAL(spec->sections[5].end, spec->changelog);
+    RI_ASSERT_STRING_EQUAL(spec->lines[spec->changelog], SPEC_SECTION_CHANGELOG);
+}
+
+void test_spec_tags(void) {
+    RI_ASSERT_EQUAL(spec->nsources, 2);
+    RI_ASSERT_STRING_EQUAL(spec->sources[0].value, "test-%{version}.tar.gz");
+    RI_ASSERT_EQUAL(spec->sources[1].num, 1);
+
+    RI_ASSERT_EQUAL(spec->npatches, 3);
+    RI_ASSERT_EQUAL(spec->patches[0].num, 0);
+    RI_ASSERT_STRING_EQUAL(spec->patches[0].value, "%{patchdir}/fix.patch");
+    RI_ASSERT_EQUAL(spec->patches[1].num, 12);
+    RI_ASSERT_STRING_EQUAL(spec->patches[1].value, "typo.patch");
+    RI_ASSERT_EQUAL(spec->patches[2].num, 3);
+}
+
+void test_spec_applied(void) {
+    RI_ASSERT_EQUAL(spec->napplied, 3);
+    RI_ASSERT_EQUAL(spec->applied[0].num, 0);
+    RI_ASSERT_STRING_EQUAL(spec->applied[0].value, "-p1");
+    RI_ASSERT_EQUAL(spec->applied[1].num, 12);
+    RI_ASSERT_STRING_EQUAL(spec->applied[1].value, "-P 12 -p1 -b .typo");
+    RI_ASSERT_EQUAL(spec->applied[2].num, 3);
+}
+
+void test_spec_macros(void) {
+    spec_macro_t *macro = NULL;
+
+    macro = get_spec_macro(spec, "upstream_version");
+    RI_ASSERT_PTR_NOT_NULL(macro);
+    RI_ASSERT_STRING_EQUAL(TAILQ_FIRST(macro->values)->data, "1.2");
+
+    macro = get_spec_macro(spec, "patchdir");
+    RI_ASSERT_PTR_NOT_NULL(macro);
+    RI_ASSERT_STRING_EQUAL(TAILQ_FIRST(macro->values)->data, "patches");
+
+    /* multiline macros and anything after %changelog are skipped */
+    RI_ASSERT_PTR_NULL(get_spec_macro(spec, "nothing"));
+    RI_ASSERT_PTR_NULL(get_spec_macro(spec, "after"));
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("specfile", init_test_specfile, clean_test_specfile);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test spec model cache", test_spec_model_cached) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test spec sections", test_spec_sections) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test spec tags", test_spec_tags) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test spec %patch lines", test_spec_applied) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test spec macros", test_spec_macros) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
@@ -3,6 +3,7 @@
  * SPDX-License-Identifier: GPL-3.0-or-later
  */
 
+#include <string.h>
 #include <CUnit/Basic.h>
 #include "rpminspect.h"
 
@@ -53,6 +54,14 @@ void test_strwaiverauth(void) {
     RI_ASSERT_EQUAL(strcmp(strwaiverauth(-1), "UnKnOwN"), 0);
 }
 
+void test_getwaiverauth(void) {
+    RI_ASSERT_EQUAL(getwaiverauth("Not Waivable", NULL_WAIVERAUTH), NOT_WAIVABLE);
+    RI_ASSERT_EQUAL(getwaiverauth("anyone", NULL_WAIVERAUTH), WAIVABLE_BY_ANYONE);
+    RI_ASSERT_EQUAL(getwaiverauth("Security", NULL_WAIVERAUTH), WAIVABLE_BY_SECURITY);
+    RI_ASSERT_EQUAL(getwaiverauth("nobody", NOT_WAIVABLE), NOT_WAIVABLE);
+    RI_ASSERT_EQUAL(getwaiverauth(NULL, NULL_WAIVERAUTH), NULL_WAIVERAUTH);
+}
+
 void test_strreplace(void) {
     ASSERT_AND_FREE(strreplace("", "", ""), "");
     ASSERT_AND_FREE(strreplace("start match", "start", "replace"), "replace match");
@@ -63,6 +72,32 @@ void test_strreplace(void) {
             "mreplacetch severreplacel substrings in severreplacel plreplaceces");
 }
 
+void test_strappend(void) {
+    char *s = NULL;
+
+    RI_ASSERT_PTR_NULL(strappend(NULL, NULL));
+    s = strappend(s, "one", NULL);
+    RI_ASSERT_STRING_EQUAL(s, "one");
+    s = strappend(s, ", ", "two", ", ", "three", NULL);
+    ASSERT_AND_FREE(s, "one, two, three");
+}
+
+void test_strbuf(void) {
+    strbuf_t sb;
+
+    memset(&sb, 0, sizeof(sb));
+    ASSERT_AND_FREE(strbuf_finish(&sb), "");
+
+    strbuf_append(&sb, "lorem ");
+    strbuf_append_len(&sb, "ipsum dolor", 5);
+    strbuf_appendf(&sb, " %d %s", 42, "sit");
+    RI_ASSERT_EQUAL(sb.len, strlen("lorem ipsum 42 sit"));
+    RI_ASSERT_EQUAL(strbuf_replace(&sb, "m", "mm"), 2);
+    RI_ASSERT_EQUAL(strbuf_replace(&sb, " ", NULL), 3);
+    ASSERT_AND_FREE(strbuf_finish(&sb), "loremmipsumm42sit");
+    RI_ASSERT_PTR_NULL(sb.data);
+}
+
 void test_strxmlescape(void) {
     ASSERT_AND_FREE(strxmlescape("<"), "&lt;");
     ASSERT_AND_FREE(strxmlescape(">"), "&gt;");
@@ -87,7 +122,10 @@ CU_pSuite get_suite(void) {
         CU_add_test(pSuite, "test printwrap()", test_printwrap) == NULL ||
         CU_add_test(pSuite, "test strseverity()", test_strseverity) == NULL ||
         CU_add_test(pSuite, "test strwaiverauth()", test_strwaiverauth) == NULL ||
+        CU_add_test(pSuite, "test getwaiverauth()", test_getwaiverauth) == NULL ||
         CU_add_test(pSuite, "test strreplace()", test_strreplace) == NULL ||
+        CU_add_test(pSuite, "test strappend()", test_strappend) == NULL ||
+        CU_add_test(pSuite, "test strbuf_t", test_strbuf) == NULL ||
         CU_add_test(pSuite, "test strxmlescape()", test_strxmlescape) == NULL) {
         return NULL;
     }
@@ -0,0 +1,212 @@
+/*
+ * Copyright The rpminspect Project Authors
+ * SPDX-License-Identifier: GPL-3.0-or-later
+ */
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <CUnit/Basic.h>
+#include "rpminspect.h"
+
+#include "test-main.h"
+
+static char root[] = "/tmp/test-trash-XXXXXX";
+static char *trash = NULL;
+
+int init_test_trash(void) {
+    if (mkdtemp(root) == NULL) {
+        return -1;
+    }
+
+    xasprintf(&trash, "%s/%s", root, TRASH_DIR);
+    return 0;
+}
+
+int clean_test_trash(void) {
+    rmtree(root, true, false);
+    free(trash);
+    return 0;
+}
+
+/* Create dir with a subdirectory and a file in each */
+static void make_tree(const char *dir)
+{
+    char *path = NULL;
+    FILE *fp = NULL;
+
+    xasprintf(&path, "%s/sub", dir);
+    RI_ASSERT_EQUAL(mkdirp(path, 0700), 0);
+    free(path);
+
+    xasprintf(&path, "%s/file", dir);
+    fp = fopen(path, "w");
+    RI_ASSERT_PTR_NOT_NULL(fp);
+
+    if (fp != NULL) {
+        fputs("contents\n", fp);
+        fclose(fp);
+    }
+
+    free(path);
+
+    xasprintf(&path, "%s/sub/file", dir);
+    fp = fopen(path, "w");
+    RI_ASSERT_PTR_NOT_NULL(fp);
+
+    if (fp != NULL) {
+        fputs("contents\n", fp);
+        fclose(fp);
+    }
+
+    free(path);
+    return;
+}
+
+/* Number of entries in a directory, -1 if it cannot be read */
+static int count_entries(const char *dir)
+{
+    int r = 0;
+    DIR *d = NULL;
+    struct dirent *de = NULL;
+
+    if ((d = opendir(dir)) == NULL) {
+        return -1;
+    }
+
+    while ((de = readdir(d)) != NULL) {
+        if (strcmp(de->d_name, ".") && strcmp(de->d_name, "..")) {
+            r++;
+        }
+    }
+
+    closedir(d);
+    return r;
+}
+
+/* Wait up to 10 seconds for the detached reaper to empty the trash */
+static int wait_empty(const char *dir)
+{
+    int i = 0;
+    int n = 0;
+
+    for (i = 0; i < 100; i++) {
+        if ((n = count_entries(dir)) == 0) {
+            break;
+        }
+
+        usleep(100000);
+    }
+
+    return n;
+}
+
+void test_trash_tree(void) {
+    char *dir = NULL;
+    char *file = NULL;
+
+    /* nothing to remove */
+    xasprintf(&dir, "%s/missing", root);
+    RI_ASSERT_EQUAL(trash_tree(dir), 0);
+    RI_ASSERT_EQUAL(trash_tree(NULL), 0);
+    free(dir);
+
+    /* a tree is renamed in to the trash next to it */
+    xasprintf(&dir, "%s/tree", root);
+    make_tree(dir);
+    RI_ASSERT_EQUAL(trash_tree(dir), 0);
+    RI_ASSERT_NOT_EQUAL(access(dir, F_OK), 0);
+    RI_ASSERT_EQUAL(count_entries(trash), 1);
+
+    /* a file is removed right away */
+    make_tree(dir);
+    xasprintf(&file, "%s/file", dir);
+    RI_ASSERT_EQUAL(trash_tree(file), 0);
+    RI_ASSERT_NOT_EQUAL(access(file, F_OK), 0);
+    RI_ASSERT_EQUAL(count_entries(trash), 1);
+    free(file);
+
+    /* the same name can be trashed again */
+    RI_ASSERT_EQUAL(trash_tree(dir), 0);
+    RI_ASSERT_NOT_EQUAL(access(dir, F_OK), 0);
+    RI_ASSERT_EQUAL(count_entries(trash), 2);
+    free(dir);
+}
+
+void test_trash_signalled(void) {
+    char *dir = NULL;
+    char *unset = NULL;
+
+    xasprintf(&dir, "%s/killed", root);
+    make_tree(dir);
+    trash_on_signal(&dir);
+    trash_on_signal(&unset);
+    trash_signalled();
+
+    RI_ASSERT_NOT_EQUAL(access(dir, F_OK), 0);
+    RI_ASSERT_EQUAL(count_entries(trash), 3);
+    free(dir);
+}
+
+void test_reap_trash(void) {
+    /* empties what trash_tree() and trash_signalled() moved there */
+    reap_trash();
+    RI_ASSERT_EQUAL(wait_empty(trash), 0);
+
+    /* the trash directory itself is kept for other runs */
+    RI_ASSERT_EQUAL(access(trash, F_OK), 0);
+}
+
+void test_sweep_trash(void) {
+    char *dir = NULL;
+
+    /* trash left by a run that was killed */
+    xasprintf(&dir, "%s/%s/leftover.XXXXXX", root, TRASH_DIR);
+    RI_ASSERT_PTR_NOT_NULL(mkdtemp(dir));
+    make_tree(dir);
+    free(dir);
+
+    RI_ASSERT_EQUAL(count_entries(trash), 1);
+    sweep_trash(root);
+    RI_ASSERT_EQUAL(wait_empty(trash), 0);
+
+    /* no trash at all */
+    xasprintf(&dir, "%s/empty", root);
+    RI_ASSERT_EQUAL(mkdirp(dir, 0700), 0);
+    sweep_trash(dir);
+    RI_ASSERT_EQUAL(count_entries(dir), 0);
+    free(dir);
+}
+
+CU_pSuite get_suite(void) {
+    CU_pSuite pSuite = NULL;
+
+    /* add a suite to the registry */
+    pSuite = CU_add_suite("trash", init_test_trash, clean_test_trash);
+    if (pSuite == NULL) {
+        return NULL;
+    }
+
+    /* add tests to the suite */
+    if (CU_add_test(pSuite, "test trash_tree()", test_trash_tree) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test trash_signalled()", test_trash_signalled) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test reap_trash()", test_reap_trash) == NULL) {
+        return NULL;
+    }
+
+    if (CU_add_test(pSuite, "test sweep_trash()", test_sweep_trash) == NULL) {
+        return NULL;
+    }
+
+    return pSuite;
+}
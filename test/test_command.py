@@ -3,9 +3,22 @@
 # SPDX-License-Identifier: GPL-3.0-or-later
 #
 
+import json
+import os
+import rpmfluff
+import shutil
 import subprocess
+import tempfile
 
-from baseclass import RequiresRpminspect
+from baseclass import (
+    BEFORE_NAME,
+    BEFORE_REL,
+    BEFORE_VER,
+    AFTER_REL,
+    AFTER_VER,
+    RequiresRpminspect,
+    SimpleSrpmBuild,
+)
 
 
 # Verify --help gives help output
@@ -39,3 +52,243 @@ class RpminspectSegv(RequiresRpminspect):
         )
         p.communicate()
         self.assertNotEqual(p.returncode, 139)
+
+
+
+# Verify results reused from a previous JSON run keep what the summary shows
+class RpminspectReuseSummary(RequiresRpminspect):
+    def setUp(self):
+        super().setUp()
+        self.before_rpm = rpmfluff.SimpleRpmBuild(BEFORE_NAME, BEFORE_VER, BEFORE_REL)
+        self.after_rpm = rpmfluff.SimpleRpmBuild(BEFORE_NAME, AFTER_VER, AFTER_REL)
+        self.after_rpm.add_simple_payload_file()
+        self.summaryfile = self.outputfile + ".summary"
+
+    def rpminspect_run(self, *extra):
+        arch = self.before_rpm.get_build_archs()[0]
+        args = [
+            self.rpminspect,
+            "-c",
+            self.conffile,
+            "-r",
+            "GENERIC",
+            "-T",
+            "addedfiles",
+        ]
+        args += list(extra)
+        args.append(self.before_rpm.get_built_rpm(arch))
+        args.append(self.after_rpm.get_built_rpm(arch))
+
+        p = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=subprocess.DEVNULL)
+        p.communicate()
+        return p.returncode
+
+    def runTest(self):
+        self.configFile()
+
+        for rpm in [self.before_rpm, self.after_rpm]:
+            rpm.header += "\n%global __os_install_post %{nil}\n"
+            rpm.do_make()
+
+        self.rpminspect_run("-F", "json", "-o", self.outputfile)
+        self.rpminspect_run("-F", "summary", "-o", self.summaryfile)
+
+        with open(self.summaryfile) as f:
+            expected = f.read()
+
+        self.rpminspect_run("-R", self.outputfile, "-F", "summary", "-o", self.summaryfile)
+
+        with open(self.summaryfile) as f:
+            reused = f.read()
+
+        self.assertIn("added", expected)
+        self.assertEqual(reused, expected)
+
+    def tearDown(self):
+        super().tearDown()
+        self.before_rpm.clean()
+        self.after_rpm.clean()
+
+        if os.path.exists(self.summaryfile):
+            os.unlink(self.summaryfile)
+
+# Verify one after build is compared against each of several before builds
+class RpminspectSeveralBaselines(RequiresRpminspect):
+    def setUp(self):
+        super().setUp()
+        self.baselines = [
+            SimpleSrpmBuild(BEFORE_NAME, BEFORE_VER, BEFORE_REL),
+            SimpleSrpmBuild(BEFORE_NAME, BEFORE_VER, "1.1"),
+        ]
+        self.after_rpm = SimpleSrpmBuild(BEFORE_NAME, AFTER_VER, AFTER_REL)
+
+    def runTest(self):
+        self.configFile()
+
+        for rpm in self.baselines + [self.after_rpm]:
+            rpm.header += "\n%global __os_install_post %{nil}\n"
+            rpm.do_make()
+
+        args = [
+            self.rpminspect,
+            "-c",
+            self.conffile,
+            "-b",
+            self.buildtype,
+            "-F",
+            "json",
+            "-r",
+            "GENERIC",
+            "-T",
+            "metadata",
+            "-o",
+            self.outputfile,
+        ]
+        args += [rpm.get_built_srpm() for rpm in self.baselines]
+        args.append(self.after_rpm.get_built_srpm())
+
+        p = subprocess.Popen(args, stdout=subprocess.DEVNULL, stderr=subprocess.PIPE)
+        (out, err) = p.communicate()
+        self.assertEqual(p.returncode, 0, err.decode("utf-8"))
+
+        with open(self.outputfile) as f:
+            results = json.loads(f.read())
+
+        # one set of metadata results per before build
+        seen = set(r.get("baseline") for r in results["metadata"])
+        self.assertEqual(seen, set(rpm.get_built_srpm() for rpm in self.baselines))
+
+    def tearDown(self):
+        super().tearDown()
+
+        for rpm in self.baselines + [self.after_rpm]:
+            rpm.clean()
+
+
+# Verify sharded workers and a merge give the results of a single run
+class RpminspectShardedRun(RequiresRpminspect):
+    def setUp(self):
+        super().setUp()
+        self.before_rpm = SimpleSrpmBuild(BEFORE_NAME, BEFORE_VER, BEFORE_REL)
+        self.after_rpm = SimpleSrpmBuild(BEFORE_NAME, AFTER_VER, AFTER_REL)
+        self.sharddir = tempfile.mkdtemp()
+
+    def rpminspect_run(self, *extra):
+        args = [
+            self.rpminspect,
+            "-c",
+            self.conffile,
+            "-b",
+            self.buildtype,
+            "-r",
+            "GENERIC",
+        ]
+
+        # the shard workers get the selection from their manifest
+        if not extra[0].startswith("--shard="):
+            args += ["-T", "metadata,disttag,specname,changelog"]
+
+        args += list(extra)
+        args.append(self.before_rpm.get_built_srpm())
+        args.append(self.after_rpm.get_built_srpm())
+
+        p = subprocess.Popen(args, stdout=subprocess.PIPE, stderr=subprocess.DEVNULL)
+        (out, err) = p.communicate()
+        return (p.returncode, out)
+
+    def read_results(self, path):
+        with open(path) as f:
+            results = json.loads(f.read())
+
+        # the diagnostics name the command line of each run
+        del results["diagnostics"]
+
+        for inspection in results.values():
+            for result in inspection:
+                result.pop("fingerprint", None)
+
+        return results
+
+    def runTest(self):
+        self.configFile()
+
+        for rpm in [self.before_rpm, self.after_rpm]:
+            rpm.header += "\n%global __os_install_post %{nil}\n"
+            rpm.do_make()
+
+        # a single run to compare with
+        (single_rc, out) = self.rpminspect_run("-F", "json", "-o", self.outputfile)
+
+        # plan the shards
+        (rc, out) = self.rpminspect_run("--plan-shards=2", "-o", self.sharddir)
+        self.assertEqual(rc, 0)
+        manifests = out.decode("utf-8").split()
+        self.assertEqual(len(manifests), 2)
+
+        # run each shard, the last one first
+        shard_results = []
+
+        for manifest in reversed(manifests):
+            shard_result = manifest.replace(".json", "-results.json")
+            self.rpminspect_run("--shard=" + manifest, "-F", "json", "-o", shard_result)
+            shard_results.append(shard_result)
+
+        merged = os.path.join(self.sharddir, "merged.json")
+        p = subprocess.Popen(
+            [self.rpminspect, "--merge", "-F", "json", "-o", merged] + shard_results,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        )
+        p.communicate()
+
+        self.assertEqual(p.returncode, single_rc)
+        self.assertEqual(self.read_results(merged), self.read_results(self.outputfile))
+        self.assertEqual(
+            list(self.read_results(merged).keys()),
+            list(self.read_results(self.outputfile).keys()),
+        )
+
+        # the merged results keep what the other output formats show
+        single_summary = os.path.join(self.sharddir, "single.txt")
+        merged_summary = os.path.join(self.sharddir, "merged.txt")
+        self.rpminspect_run("-F", "summary", "-o", single_summary)
+        p = subprocess.Popen(
+            [self.rpminspect, "--merge", "-F", "summary", "-o", merged_summary]
+            + shard_results,
+            stdout=subprocess.DEVNULL,
+            stderr=subprocess.DEVNULL,
+        )
+        p.communicate()
+        self.assertEqual(p.returncode, single_rc)
+
+        with open(single_summary) as f:
+            expected = f.read()
+
+        with open(merged_summary) as f:
+            summary = f.read()
+
+        self.assertNotIn("unknown", summary)
+        self.assertEqual(summary, expected)
+
+        # each worker names its shard in the diagnostics
+        for shard_result in shard_results:
+            with open(shard_result) as f:
+                nouns = [d.get("noun") for d in json.loads(f.read())["diagnostics"]]
+
+            self.assertEqual(len([n for n in nouns if n and n.startswith("shard ")]), 1)
+
+        # a missing or duplicated shard is a program error
+        for partial in [shard_results[:1], shard_results[:1] * 2]:
+            p = subprocess.Popen(
+                [self.rpminspect, "--merge", "-F", "json", "-o", merged] + partial,
+                stdout=subprocess.DEVNULL,
+                stderr=subprocess.DEVNULL,
+            )
+            p.communicate()
+            self.assertEqual(p.returncode, 2)
+
+    def tearDown(self):
+        super().tearDown()
+        self.before_rpm.clean()
+        self.after_rpm.clean()
+        shutil.rmtree(self.sharddir, ignore_errors=True)